@@ -0,0 +1,108 @@
+#include "admission.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *policy_names[] = {"block", "reject", "divert", "drop-lowest"};
+
+AdmissionResult admit_to_queue(V_queue *queue, V_queue *overflow, void *item, int policy, AdmissionStats *stats) {
+/**
+ * \brief Offer an item to a bounded FIFO // Oferece um item a uma FIFO limitada
+ *
+ * \details Items in a plain FIFO have no priority, so OVERFLOW_DROP_LOWEST rejects the newcomer like OVERFLOW_REJECT.
+ *          OVERFLOW_DIVERT rejects too once the overflow queue is full.
+ * \details Itens de uma FIFO simples não têm prioridade, então OVERFLOW_DROP_LOWEST recusa o recém-chegado como OVERFLOW_REJECT.
+ *          OVERFLOW_DIVERT também recusa quando a fila de estouro está cheia.
+ *
+ * \return AdmissionResult - What happened to the item // O que aconteceu com o item
+ */
+    AdmissionStats ignored;
+    if (!stats) {
+        stats = &ignored;
+    }
+
+    if (!is_queue_full(queue)) {
+        enqueue(queue, item);
+        stats->admitted++;
+        return ADMIT_ACCEPTED;
+    }
+
+    switch (policy) {
+    case OVERFLOW_BLOCK:
+        return ADMIT_WAIT;
+    case OVERFLOW_DIVERT:
+        if (overflow && !is_queue_full(overflow)) {
+            enqueue(overflow, item);
+            stats->diverted++;
+            return ADMIT_DIVERTED;
+        }
+        break;
+    default:
+        break;
+    }
+
+    stats->rejected++;
+    return ADMIT_REJECTED;
+}
+
+int admission_refill(V_queue *queue, V_queue *overflow) {
+/**
+ * \brief Move items from the overflow queue back while the queue has room // Move itens da fila de estouro de volta enquanto houver espaço
+ *
+ * \return int - Number of items moved // Número de itens movidos
+ */
+    int moved = 0;
+    while (!is_queue_empty(overflow) && !is_queue_full(queue)) {
+        enqueue(queue, queue_pop_front(overflow));
+        moved++;
+    }
+    return moved;
+}
+
+void admission_stats_add(AdmissionStats *total, const AdmissionStats *part) {
+/**
+ * \brief Add the counters of `part` to `total` // Soma os contadores de `part` em `total`
+ */
+    total->admitted += part->admitted;
+    total->rejected += part->rejected;
+    total->diverted += part->diverted;
+    total->dropped += part->dropped;
+    total->waits += part->waits;
+}
+
+void print_admission_stats(const char *label, const AdmissionStats *stats, double seconds) {
+/**
+ * \brief Print one line of admission counters and rates // Imprime uma linha de contadores e taxas de admissão
+ */
+    long offered = stats->admitted + stats->rejected + stats->diverted;
+    printf("%-10s offered %ld: admitted %ld, rejected %ld (%.1lf%%), diverted %ld, dropped %ld, producer waits %ld",
+           label, offered, stats->admitted, stats->rejected, offered > 0 ? 100.0 * stats->rejected / offered : 0.0,
+           stats->diverted, stats->dropped, stats->waits);
+    if (seconds > 0) {
+        printf(" | %.2lf admitted/s, %.2lf rejected/s", stats->admitted / seconds, stats->rejected / seconds);
+    }
+    printf("\n");
+}
+
+int overflow_policy_from_name(const char *name) {
+/**
+ * \brief Parse a policy name // Interpreta o nome de uma política
+ *
+ * \return int - The OverflowPolicy, or -1 if the name is unknown // A OverflowPolicy, ou -1 se o nome for desconhecido
+ */
+    for (int i = OVERFLOW_BLOCK; i <= OVERFLOW_DROP_LOWEST; i++) {
+        if (name && strcmp(name, policy_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *overflow_policy_name(int policy) {
+/**
+ * \brief Name of a policy // Nome de uma política
+ */
+    if (policy < OVERFLOW_BLOCK || policy > OVERFLOW_DROP_LOWEST) {
+        return "unknown";
+    }
+    return policy_names[policy];
+}
@@ -0,0 +1,88 @@
+#ifndef ADMISSION_H_INCLUDED
+#define ADMISSION_H_INCLUDED
+
+#include "queue.h"
+
+/**
+ * \brief What a producer does when a bounded queue is full // O que um produtor faz quando uma fila limitada está cheia
+ */
+typedef enum overflow_policy {
+    OVERFLOW_BLOCK,        // Wait for space (backpressure) // Espera por espaço (contrapressão)
+    OVERFLOW_REJECT,       // Refuse the item and count it // Recusa o item e o contabiliza
+    OVERFLOW_DIVERT,       // Park the item in a bounded overflow queue, moved back when space frees up // Estaciona o item em uma fila de estouro limitada
+    OVERFLOW_DROP_LOWEST   // Evict the lowest priority item to make room; a plain FIFO rejects // Descarta o item de menor prioridade; uma FIFO simples recusa
+} OverflowPolicy;
+
+/**
+ * \brief Outcome of an admission attempt // Resultado de uma tentativa de admissão
+ */
+typedef enum admission_result {
+    ADMIT_ACCEPTED,   // In the queue // Na fila
+    ADMIT_WAIT,       // OVERFLOW_BLOCK and full: wait for space and try again // Cheia com OVERFLOW_BLOCK: espere espaço e tente de novo
+    ADMIT_REJECTED,   // Not queued, the caller still owns the item // Fora da fila, o item continua sendo de quem chamou
+    ADMIT_DIVERTED    // In the overflow queue // Na fila de estouro
+} AdmissionResult;
+
+/**
+ * \brief Admission counters of one queue // Contadores de admissão de uma fila
+ */
+typedef struct admission_stats {
+    long admitted;   // Went straight into the queue // Entraram direto na fila
+    long rejected;   // Refused at the door // Recusados na entrada
+    long diverted;   // Sent to the overflow queue // Enviados para a fila de estouro
+    long dropped;    // Admitted, then evicted for a higher priority item // Admitidos e depois descartados por um item de maior prioridade
+    long waits;      // Times a producer had to wait for space // Vezes que um produtor esperou por espaço
+} AdmissionStats;
+
+/**
+ * \brief Offer an item to a bounded FIFO // Oferece um item a uma FIFO limitada
+ *
+ * \param queue - Queue with its capacity set by set_queue_capacity() // Fila com capacidade definida por set_queue_capacity()
+ * \param overflow - Overflow queue for OVERFLOW_DIVERT, may be NULL // Fila de estouro para OVERFLOW_DIVERT, pode ser NULL
+ * \param item - Data to enqueue // Dados a enfileirar
+ * \param policy - OverflowPolicy applied when the queue is full // Política aplicada quando a fila está cheia
+ * \param stats - Counters to update, may be NULL // Contadores a atualizar, pode ser NULL
+ * \return The AdmissionResult // O AdmissionResult
+ */
+AdmissionResult admit_to_queue(V_queue *queue, V_queue *overflow, void *item, int policy, AdmissionStats *stats);
+
+/**
+ * \brief Move items from the overflow queue back while the queue has room // Move itens da fila de estouro de volta enquanto houver espaço
+ *
+ * \param queue - Bounded queue // Fila limitada
+ * \param overflow - Its overflow queue, may be NULL // Sua fila de estouro, pode ser NULL
+ * \return Number of items moved // Número de itens movidos
+ */
+int admission_refill(V_queue *queue, V_queue *overflow);
+
+/**
+ * \brief Add the counters of `part` to `total` // Soma os contadores de `part` em `total`
+ */
+void admission_stats_add(AdmissionStats *total, const AdmissionStats *part);
+
+/**
+ * \brief Print one line of admission counters and rates // Imprime uma linha de contadores e taxas de admissão
+ *
+ * \param label - Queue name // Nome da fila
+ * \param stats - Counters // Contadores
+ * \param seconds - Elapsed time for the rates, 0 prints no rates // Tempo decorrido para as taxas, 0 não imprime taxas
+ */
+void print_admission_stats(const char *label, const AdmissionStats *stats, double seconds);
+
+/**
+ * \brief Parse a policy name // Interpreta o nome de uma política
+ *
+ * \param name - "block", "reject", "divert" or "drop-lowest"
+ * \return The OverflowPolicy, or -1 if the name is unknown // A OverflowPolicy, ou -1 se o nome for desconhecido
+ */
+int overflow_policy_from_name(const char *name);
+
+/**
+ * \brief Name of a policy // Nome de uma política
+ *
+ * \param policy - OverflowPolicy
+ * \return Constant string // String constante
+ */
+const char *overflow_policy_name(int policy);
+
+#endif // ADMISSION_H_INCLUDED
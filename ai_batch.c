@@ -0,0 +1,297 @@
+#include "ai_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include "rng.h"
+
+// One exam waiting for its diagnosis, lives on the stack of the submitting thread // Um exame esperando diagnóstico, vive na pilha da thread que o submeteu
+typedef struct ai_request {
+    const float *features;
+    double submitted;           // CLOCK_REALTIME seconds, to match pthread_cond_timedwait // Segundos de CLOCK_REALTIME
+    int condition;
+    int done;
+    struct ai_request *next;
+} AiRequest;
+
+struct ai_batcher {
+    const AiModel *model;
+    AiKernel kernel;
+    int max_batch;
+    double timeout_seconds;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t submitted;   // Signals the inference thread // Acorda a thread de inferência
+    pthread_cond_t scored;      // Signals the submitters // Acorda quem submeteu
+    AiRequest *head;
+    AiRequest *tail;
+    int pending;
+    int running;
+    int started;
+    pthread_t thread;
+
+    long batches;
+    long exams;
+    double wait_seconds;
+    double kernel_seconds;
+};
+
+static double realtime_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static double uniform_draw(void) {
+    return rng_uniform();
+}
+
+AiBatcher *create_ai_batcher(const AiModel *model, AiKernel kernel, int max_batch, double timeout_seconds) {
+/**
+ * \brief Create the AI diagnosis stage // Cria o estágio de diagnóstico por IA
+ *
+ * \param model - Model used by the kernel // Modelo usado pelo kernel
+ * \param kernel - Scoring kernel, NULL selects ai_kernel_simd // Kernel de inferência, NULL seleciona ai_kernel_simd
+ * \param max_batch - Exams per batch, clamped to 1..AI_MAX_BATCH // Exames por lote, limitado a 1..AI_MAX_BATCH
+ * \param timeout_seconds - Longest wait for a batch to fill // Maior espera para um lote encher
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return AiBatcher* - Pointer to the stage // Ponteiro para o estágio
+ */
+    AiBatcher *batcher = (AiBatcher*)calloc(1, sizeof(AiBatcher));
+    if (!batcher) {
+        printf("\nError: Memory allocation failed (AI Batcher)\n");
+        exit(1);
+    }
+
+    batcher->model = model;
+    batcher->kernel = kernel ? kernel : ai_kernel_simd;
+    batcher->max_batch = max_batch < 1 ? 1 : (max_batch > AI_MAX_BATCH ? AI_MAX_BATCH : max_batch);
+    batcher->timeout_seconds = timeout_seconds > 0 ? timeout_seconds : 0;
+    pthread_mutex_init(&batcher->mutex, NULL);
+    pthread_cond_init(&batcher->submitted, NULL);
+    pthread_cond_init(&batcher->scored, NULL);
+
+    return batcher;
+}
+
+static void wait_for_batch(AiBatcher *batcher) {
+// Waits until the batch is full or its oldest exam reaches the timeout (mutex held) // Espera o lote encher ou o exame mais antigo atingir o tempo limite
+    double deadline_seconds = batcher->head->submitted + batcher->timeout_seconds;
+    struct timespec deadline;
+    deadline.tv_sec = (time_t)deadline_seconds;
+    deadline.tv_nsec = (long)((deadline_seconds - deadline.tv_sec) * 1e9);
+
+    while (batcher->running && batcher->pending < batcher->max_batch) {
+        if (pthread_cond_timedwait(&batcher->submitted, &batcher->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+}
+
+static void *ai_batcher_thread(void *args) {
+// Inference loop: take a batch, score it with one kernel call, wake its submitters // Laço de inferência: pega um lote, processa com uma chamada do kernel, acorda quem submeteu
+    AiBatcher *batcher = (AiBatcher*)args;
+    AiRequest *batch[AI_MAX_BATCH];
+    float features[AI_MAX_BATCH * AI_FEATURES];
+    float probabilities[AI_MAX_BATCH * AI_CONDITIONS];
+
+    pthread_mutex_lock(&batcher->mutex);
+    for (;;) {
+        while (batcher->pending == 0 && batcher->running) {
+            pthread_cond_wait(&batcher->submitted, &batcher->mutex);
+        }
+        if (batcher->pending == 0) {
+            break; // Stopped and drained
+        }
+        wait_for_batch(batcher);
+
+        int count = 0;
+        while (count < batcher->max_batch && batcher->head) {
+            batch[count++] = batcher->head;
+            batcher->head = batcher->head->next;
+        }
+        if (!batcher->head) {
+            batcher->tail = NULL;
+        }
+        batcher->pending -= count;
+        pthread_mutex_unlock(&batcher->mutex);
+
+        for (int i = 0; i < count; i++) {
+            memcpy(features + i * AI_FEATURES, batch[i]->features, sizeof(float) * AI_FEATURES);
+        }
+        double kernel_start = realtime_seconds();
+        batcher->kernel(batcher->model, features, count, probabilities);
+        double finished = realtime_seconds();
+
+        int conditions[AI_MAX_BATCH];
+        for (int i = 0; i < count; i++) {
+            conditions[i] = ai_sample_condition(probabilities + i * AI_CONDITIONS, uniform_draw());
+        }
+
+        pthread_mutex_lock(&batcher->mutex);
+        for (int i = 0; i < count; i++) {
+            batcher->wait_seconds += finished - batch[i]->submitted;
+            batch[i]->condition = conditions[i];
+            batch[i]->done = 1;
+        }
+        batcher->batches++;
+        batcher->exams += count;
+        batcher->kernel_seconds += finished - kernel_start;
+        pthread_cond_broadcast(&batcher->scored);
+    }
+    pthread_mutex_unlock(&batcher->mutex);
+
+    return NULL;
+}
+
+int ai_batcher_start(AiBatcher *batcher) {
+/**
+ * \brief Start the inference thread // Inicia a thread de inferência
+ *
+ * \return int - 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+    if (!batcher || batcher->started) {
+        return -1;
+    }
+
+    batcher->running = 1;
+    if (pthread_create(&batcher->thread, NULL, ai_batcher_thread, batcher) != 0) {
+        printf("\nError: Could not start AI inference thread\n");
+        batcher->running = 0;
+        return -1;
+    }
+    batcher->started = 1;
+
+    return 0;
+}
+
+const char *ai_diagnose(AiBatcher *batcher, const float *features) {
+/**
+ * \brief Diagnose one exam through the batching stage // Diagnostica um exame pelo estágio de lotes
+ *
+ * \details The caller blocks until the inference thread scores the batch holding this exam. Without a running
+ *          inference thread the exam is scored immediately as a batch of one.
+ * \details Quem chama bloqueia até a thread de inferência processar o lote com este exame. Sem a thread de
+ *          inferência rodando, o exame é processado imediatamente como um lote de um.
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ * \param features - AI_FEATURES values // AI_FEATURES valores
+ *
+ * \return const char* - Name of the condition, NULL if the arguments are invalid // Nome da condição, NULL se os argumentos forem inválidos
+ */
+    if (!batcher || !features) {
+        return NULL;
+    }
+
+    AiRequest request = {features, realtime_seconds(), 0, 0, NULL};
+
+    pthread_mutex_lock(&batcher->mutex);
+    if (!batcher->running) {
+        pthread_mutex_unlock(&batcher->mutex);
+
+        float probabilities[AI_CONDITIONS];
+        double kernel_start = realtime_seconds();
+        batcher->kernel(batcher->model, features, 1, probabilities);
+        double finished = realtime_seconds();
+        request.condition = ai_sample_condition(probabilities, uniform_draw());
+
+        pthread_mutex_lock(&batcher->mutex);
+        batcher->batches++;
+        batcher->exams++;
+        batcher->wait_seconds += finished - request.submitted;
+        batcher->kernel_seconds += finished - kernel_start;
+        pthread_mutex_unlock(&batcher->mutex);
+        return ai_condition_name(request.condition);
+    }
+
+    if (batcher->tail) {
+        batcher->tail->next = &request;
+    } else {
+        batcher->head = &request;
+    }
+    batcher->tail = &request;
+    batcher->pending++;
+    if (batcher->pending == 1 || batcher->pending >= batcher->max_batch) {
+        pthread_cond_signal(&batcher->submitted); // First exam starts the timeout, a full batch ends it
+    }
+
+    while (!request.done) {
+        pthread_cond_wait(&batcher->scored, &batcher->mutex);
+    }
+    pthread_mutex_unlock(&batcher->mutex);
+
+    return ai_condition_name(request.condition);
+}
+
+void ai_batcher_stop(AiBatcher *batcher) {
+/**
+ * \brief Stop the inference thread after scoring every pending exam // Para a thread de inferência depois de processar os exames pendentes
+ */
+    if (!batcher || !batcher->started) {
+        return;
+    }
+
+    pthread_mutex_lock(&batcher->mutex);
+    batcher->running = 0;
+    pthread_cond_broadcast(&batcher->submitted);
+    pthread_mutex_unlock(&batcher->mutex);
+
+    pthread_join(batcher->thread, NULL);
+    batcher->started = 0;
+}
+
+void destroy_ai_batcher(AiBatcher *batcher) {
+/**
+ * \brief Free the stage, stopping it first // Libera o estágio, parando-o antes
+ */
+    if (!batcher) {
+        return;
+    }
+
+    ai_batcher_stop(batcher);
+    pthread_cond_destroy(&batcher->scored);
+    pthread_cond_destroy(&batcher->submitted);
+    pthread_mutex_destroy(&batcher->mutex);
+    free(batcher);
+}
+
+void get_ai_batch_stats(AiBatcher *batcher, AiBatchStats *stats) {
+/**
+ * \brief Copy the counters of the stage // Copia os contadores do estágio
+ */
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(AiBatchStats));
+    if (!batcher) {
+        return;
+    }
+
+    pthread_mutex_lock(&batcher->mutex);
+    stats->batches = batcher->batches;
+    stats->exams = batcher->exams;
+    stats->kernel_seconds = batcher->kernel_seconds;
+    if (batcher->batches > 0) {
+        stats->mean_batch = (double)batcher->exams / batcher->batches;
+    }
+    if (batcher->exams > 0) {
+        stats->mean_wait_seconds = batcher->wait_seconds / batcher->exams;
+    }
+    pthread_mutex_unlock(&batcher->mutex);
+}
+
+void print_ai_batch_stats(AiBatcher *batcher) {
+/**
+ * \brief Print the counters of the stage // Imprime os contadores do estágio
+ */
+    AiBatchStats stats;
+    get_ai_batch_stats(batcher, &stats);
+
+    printf("\nAI Diagnosis:\n");
+    printf("Exams %ld in %ld batches (mean batch %.2lf), mean wait %.3lf ms, kernel time %.3lf ms\n",
+           stats.exams, stats.batches, stats.mean_batch, stats.mean_wait_seconds * 1e3, stats.kernel_seconds * 1e3);
+}
@@ -0,0 +1,78 @@
+#ifndef AI_BATCH_H_INCLUDED
+#define AI_BATCH_H_INCLUDED
+
+#include "ai_model.h"
+
+// AI diagnosis stage: collects exams into batches and scores each batch with one kernel call
+typedef struct ai_batcher AiBatcher;
+
+/**
+ * \brief Counters of the AI stage // Contadores do estágio de IA
+ */
+typedef struct ai_batch_stats {
+    long batches;
+    long exams;
+    double mean_batch;          // Exams per kernel call // Exames por chamada do kernel
+    double mean_wait_seconds;   // From submission until the diagnosis is ready // Da submissão até o diagnóstico ficar pronto
+    double kernel_seconds;      // Time spent inside the kernel // Tempo gasto dentro do kernel
+} AiBatchStats;
+
+/**
+ * \brief Create the AI stage // Cria o estágio de IA
+ *
+ * \param model - Model used by the kernel // Modelo usado pelo kernel
+ * \param kernel - Scoring kernel // Kernel de inferência
+ * \param max_batch - A batch is scored as soon as it holds this many exams (1 to AI_MAX_BATCH) // Um lote é processado assim que tiver essa quantidade de exames
+ * \param timeout_seconds - ... or when its oldest exam has waited this long // ... ou quando o exame mais antigo esperou esse tempo
+ * \return Pointer to the stage // Ponteiro para o estágio
+ */
+AiBatcher *create_ai_batcher(const AiModel *model, AiKernel kernel, int max_batch, double timeout_seconds);
+
+/**
+ * \brief Start the inference thread // Inicia a thread de inferência
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ * \return 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+int ai_batcher_start(AiBatcher *batcher);
+
+/**
+ * \brief Diagnose one exam, waiting until its batch has been scored // Diagnostica um exame, esperando até seu lote ser processado
+ *
+ * \details Thread safe. If the stage is not running, the exam is scored alone by the calling thread.
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ * \param features - AI_FEATURES values of the exam // AI_FEATURES valores do exame
+ * \return Name of the diagnosed condition // Nome da condição diagnosticada
+ */
+const char *ai_diagnose(AiBatcher *batcher, const float *features);
+
+/**
+ * \brief Score the exams still pending and stop the inference thread // Processa os exames pendentes e para a thread de inferência
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ */
+void ai_batcher_stop(AiBatcher *batcher);
+
+/**
+ * \brief Free the stage, stopping it first // Libera o estágio, parando-o antes
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ */
+void destroy_ai_batcher(AiBatcher *batcher);
+
+/**
+ * \brief Copy the counters of the stage // Copia os contadores do estágio
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ * \param stats - Receives the counters // Recebe os contadores
+ */
+void get_ai_batch_stats(AiBatcher *batcher, AiBatchStats *stats);
+
+/**
+ * \brief Print the counters of the stage // Imprime os contadores do estágio
+ *
+ * \param batcher - Pointer to the stage // Ponteiro para o estágio
+ */
+void print_ai_batch_stats(AiBatcher *batcher);
+
+#endif // AI_BATCH_H_INCLUDED
@@ -0,0 +1,250 @@
+#include "ai_model.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rng.h"
+#include "sim_config.h"
+
+#define AI_LANES 4
+
+// GCC vector extensions: 128-bit vectors map to SSE2 on x86-64 and NEON on ARM without extra flags
+typedef float AiVector __attribute__((vector_size(AI_LANES * sizeof(float))));
+typedef int AiMask __attribute__((vector_size(AI_LANES * sizeof(int))));
+
+struct ai_model {
+    float weights[AI_CONDITIONS][AI_FEATURES];
+    float bias[AI_CONDITIONS];
+};
+
+static const char *condition_names[AI_CONDITIONS] = {
+    "Normal Health",
+    "Bronchitis",
+    "Pneumonia",
+    "COVID",
+    "Pulmonary Embolism",
+    "Pleural Effusion",
+    "Pulmonary Fibrosis",
+    "Tuberculosis",
+    "Lung Cancer"
+};
+
+
+AiModel *create_ai_model(unsigned int seed) {
+/**
+ * \brief Create the synthetic diagnosis model // Cria o modelo sintético de diagnóstico
+ *
+ * \param seed - Seed of the weight generator, independent from rng.c // Semente do gerador de pesos, independente de rng.c
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return AiModel* - Pointer to the model // Ponteiro para o modelo
+ */
+    AiModel *model = (AiModel*)malloc(sizeof(AiModel));
+    if (!model) {
+        printf("\nError: Memory allocation failed (AI Model)\n");
+        exit(1);
+    }
+
+    // Same frequencies as diagnostic_by_ai(): the diagnosis_weights of the clinic configuration
+    // Mesmas frequências do diagnostic_by_ai(): os diagnosis_weights da configuração da clínica
+    const int *weights = sim_config()->diagnosis_weights;
+    float total = 0;
+    for (int c = 0; c < AI_CONDITIONS; c++) {
+        total += weights[c];
+    }
+    unsigned int state = seed ? seed : 1;
+    for (int c = 0; c < AI_CONDITIONS; c++) {
+        float prior = weights[c] / total;
+        model->bias[c] = logf(prior > 0 ? prior : 1e-6f); // A condition weighted 0 stays possible, barely
+        for (int f = 0; f < AI_FEATURES; f++) {
+            state = state * 1103515245u + 12345u;
+            model->weights[c][f] = ((state >> 8) / 16777216.0f - 0.5f) * 0.5f;
+        }
+    }
+    return model;
+}
+
+void destroy_ai_model(AiModel *model) {
+/**
+ * \brief Free the model // Libera o modelo
+ */
+    free(model);
+}
+
+static void softmax_row(float *row) {
+// Turns one row of logits into probabilities // Transforma uma linha de logits em probabilidades
+    float largest = row[0];
+    for (int c = 1; c < AI_CONDITIONS; c++) {
+        if (row[c] > largest) {
+            largest = row[c];
+        }
+    }
+
+    float sum = 0;
+    for (int c = 0; c < AI_CONDITIONS; c++) {
+        row[c] = expf(row[c] - largest);
+        sum += row[c];
+    }
+    for (int c = 0; c < AI_CONDITIONS; c++) {
+        row[c] /= sum;
+    }
+}
+
+static AiVector vector_max(AiVector a, AiVector b) {
+    AiMask greater = a > b;
+    return (AiVector)(((AiMask)a & greater) | ((AiMask)b & ~greater));
+}
+
+static AiVector vector_exp(AiVector x) {
+// exp() for x <= 0, relative error below 1e-6 // exp() para x <= 0, erro relativo menor que 1e-6
+    // Clamp so 2^n stays a normal float // Limita para 2^n continuar um float normal
+    x = vector_max(x, (AiVector){0} - 87.0f);
+
+    // x = n * ln2 + r, with n rounded to nearest and |r| <= ln2 / 2
+    AiMask n = __builtin_convertvector(x * 1.44269504f - 0.5f, AiMask);
+    AiVector r = x - __builtin_convertvector(n, AiVector) * 0.69314718f;
+
+    // Taylor series of e^r up to r^6 (Horner) // Série de Taylor de e^r até r^6
+    AiVector p = r * (1.0f / 720) + (1.0f / 120);
+    p = p * r + (1.0f / 24);
+    p = p * r + (1.0f / 6);
+    p = p * r + 0.5f;
+    p = p * r + 1.0f;
+    p = p * r + 1.0f;
+
+    // 2^n built directly in the exponent bits // 2^n montado direto nos bits do expoente
+    AiMask scale = (n + 127) << 23;
+    return p * (AiVector)scale;
+}
+
+void ai_kernel_scalar(const AiModel *model, const float *features, int batch, float *probabilities) {
+/**
+ * \brief Reference kernel used to validate ai_kernel_simd() // Kernel de referência usado para validar ai_kernel_simd()
+ *
+ * \param model - Model weights // Pesos do modelo
+ * \param features - batch * AI_FEATURES values // batch * AI_FEATURES valores
+ * \param batch - Number of exams // Número de exames
+ * \param probabilities - batch * AI_CONDITIONS output values // batch * AI_CONDITIONS valores de saída
+ */
+    for (int b = 0; b < batch; b++) {
+        const float *x = features + b * AI_FEATURES;
+        float *row = probabilities + b * AI_CONDITIONS;
+        for (int c = 0; c < AI_CONDITIONS; c++) {
+            float logit = model->bias[c];
+            for (int f = 0; f < AI_FEATURES; f++) {
+                logit += model->weights[c][f] * x[f];
+            }
+            row[c] = logit;
+        }
+        softmax_row(row);
+    }
+}
+
+void ai_kernel_simd(const AiModel *model, const float *features, int batch, float *probabilities) {
+/**
+ * \brief Vectorized kernel: each SIMD lane is one exam of the batch // Kernel vetorizado: cada lane SIMD é um exame do lote
+ *
+ * \details Features are transposed into lanes of 4 exams, so every weight is broadcast once and multiplied
+ *          against 4 exams at a time. The softmax is vectorized too, with a polynomial exp().
+ * \details As características são transpostas em lanes de 4 exames, então cada peso é replicado uma vez e
+ *          multiplicado por 4 exames de cada vez. O softmax também é vetorizado, com uma exp() polinomial.
+ *
+ * \param model - Model weights // Pesos do modelo
+ * \param features - batch * AI_FEATURES values // batch * AI_FEATURES valores
+ * \param batch - Number of exams // Número de exames
+ * \param probabilities - batch * AI_CONDITIONS output values // batch * AI_CONDITIONS valores de saída
+ */
+    for (int start = 0; start < batch; start += AI_LANES) {
+        int lanes = batch - start < AI_LANES ? batch - start : AI_LANES;
+        float block[AI_LANES][AI_FEATURES] = {{0}};
+        AiVector x[AI_FEATURES];
+        AiVector logits[AI_CONDITIONS];
+
+        // Transpose: x[f][lane] = feature f of exam start + lane, missing lanes stay 0
+        memcpy(block, features + start * AI_FEATURES, sizeof(float) * AI_FEATURES * lanes);
+        for (int f = 0; f < AI_FEATURES; f++) {
+            for (int lane = 0; lane < AI_LANES; lane++) {
+                x[f][lane] = block[lane][f];
+            }
+        }
+
+        AiVector largest = {0};
+        for (int c = 0; c < AI_CONDITIONS; c++) {
+            AiVector sum = x[0] * model->weights[c][0] + model->bias[c];
+            for (int f = 1; f < AI_FEATURES; f++) {
+                sum += x[f] * model->weights[c][f];
+            }
+            logits[c] = sum;
+            largest = c == 0 ? sum : vector_max(largest, sum);
+        }
+
+        // Softmax across the lanes as well // Softmax também nas lanes
+        AiVector total = {0};
+        for (int c = 0; c < AI_CONDITIONS; c++) {
+            logits[c] = vector_exp(logits[c] - largest);
+            total += logits[c];
+        }
+        AiVector inverse = 1.0f / total;
+
+        for (int lane = 0; lane < lanes; lane++) {
+            float *row = probabilities + (start + lane) * AI_CONDITIONS;
+            for (int c = 0; c < AI_CONDITIONS; c++) {
+                row[c] = logits[c][lane] * inverse[lane];
+            }
+        }
+    }
+}
+
+AiKernel ai_kernel_from_name(const char *name) {
+/**
+ * \brief Find a kernel by name // Encontra um kernel pelo nome
+ *
+ * \return AiKernel - The kernel, NULL if unknown // O kernel, NULL se desconhecido
+ */
+    if (!name) {
+        return NULL;
+    }
+    if (strcmp(name, "scalar") == 0) {
+        return ai_kernel_scalar;
+    }
+    if (strcmp(name, "simd") == 0) {
+        return ai_kernel_simd;
+    }
+    return NULL;
+}
+
+void ai_random_features(float *features) {
+/**
+ * \brief Synthetic feature vector, stands in for the features of a real image // Vetor sintético, substitui as características de uma imagem real
+ */
+    for (int f = 0; f < AI_FEATURES; f++) {
+        features[f] = (float)rng_uniform() * 2.0f - 1.0f;
+    }
+}
+
+int ai_sample_condition(const float *probabilities, double uniform) {
+/**
+ * \brief Draw a condition from its probabilities // Sorteia uma condição a partir de suas probabilidades
+ *
+ * \return int - Index of the condition // Índice da condição
+ */
+    double cumulative = 0;
+    for (int c = 0; c < AI_CONDITIONS; c++) {
+        cumulative += probabilities[c];
+        if (uniform < cumulative) {
+            return c;
+        }
+    }
+    return AI_CONDITIONS - 1;
+}
+
+const char *ai_condition_name(int condition) {
+/**
+ * \brief Name of a condition // Nome de uma condição
+ */
+    if (condition < 0 || condition >= AI_CONDITIONS) {
+        return condition_names[0];
+    }
+    return condition_names[condition];
+}
@@ -0,0 +1,80 @@
+#ifndef AI_MODEL_H_INCLUDED
+#define AI_MODEL_H_INCLUDED
+
+#define AI_CONDITIONS 9     // Conditions the model can diagnose // Condições que o modelo pode diagnosticar
+#define AI_FEATURES 16      // Features extracted from each exam // Características extraídas de cada exame
+#define AI_MAX_BATCH 64     // Largest batch a kernel accepts // Maior lote aceito por um kernel
+
+// Multinomial logistic model: probabilities = softmax(weights * features + bias)
+typedef struct ai_model AiModel;
+
+/**
+ * \brief Scoring kernel: turns a batch of feature vectors into condition probabilities // Kernel de inferência: transforma um lote de vetores de características em probabilidades
+ *
+ * \param model - Model weights // Pesos do modelo
+ * \param features - batch * AI_FEATURES values, one exam after the other // batch * AI_FEATURES valores, um exame após o outro
+ * \param batch - Number of exams, 1 to AI_MAX_BATCH // Número de exames, de 1 a AI_MAX_BATCH
+ * \param probabilities - Receives batch * AI_CONDITIONS values, each row sums to 1 // Recebe batch * AI_CONDITIONS valores, cada linha soma 1
+ */
+typedef void (*AiKernel)(const AiModel *model, const float *features, int batch, float *probabilities);
+
+/**
+ * \brief Create the diagnosis model // Cria o modelo de diagnóstico
+ *
+ * \details Weights are derived from `seed`, biases follow the clinic's condition frequencies,
+ *          so random features produce roughly the same diagnoses as diagnostic_by_ai().
+ * \param seed - Seed for the synthetic weights // Semente dos pesos sintéticos
+ * \return Pointer to the model // Ponteiro para o modelo
+ */
+AiModel *create_ai_model(unsigned int seed);
+
+/**
+ * \brief Free the model // Libera o modelo
+ *
+ * \param model - Pointer to the model // Ponteiro para o modelo
+ */
+void destroy_ai_model(AiModel *model);
+
+/**
+ * \brief Reference kernel, one exam and one condition at a time // Kernel de referência, um exame e uma condição por vez
+ */
+void ai_kernel_scalar(const AiModel *model, const float *features, int batch, float *probabilities);
+
+/**
+ * \brief Vectorized kernel, 4 exams per SIMD vector // Kernel vetorizado, 4 exames por vetor SIMD
+ */
+void ai_kernel_simd(const AiModel *model, const float *features, int batch, float *probabilities);
+
+/**
+ * \brief Find a kernel by name // Encontra um kernel pelo nome
+ *
+ * \param name - "scalar" or "simd" // "scalar" ou "simd"
+ * \return The kernel, or NULL if the name is unknown // O kernel, ou NULL se o nome for desconhecido
+ */
+AiKernel ai_kernel_from_name(const char *name);
+
+/**
+ * \brief Fill one feature vector with synthetic values in [-1, 1] // Preenche um vetor de características com valores sintéticos em [-1, 1]
+ *
+ * \param features - AI_FEATURES values // AI_FEATURES valores
+ */
+void ai_random_features(float *features);
+
+/**
+ * \brief Draw a condition from a probability row // Sorteia uma condição a partir de uma linha de probabilidades
+ *
+ * \param probabilities - AI_CONDITIONS values summing to 1 // AI_CONDITIONS valores que somam 1
+ * \param uniform - Random value in [0, 1) // Valor aleatório em [0, 1)
+ * \return Index of the condition // Índice da condição
+ */
+int ai_sample_condition(const float *probabilities, double uniform);
+
+/**
+ * \brief Name of a condition, as used by get_ai_priority() // Nome de uma condição, como usado por get_ai_priority()
+ *
+ * \param condition - Index between 0 and AI_CONDITIONS - 1 // Índice entre 0 e AI_CONDITIONS - 1
+ * \return Constant string, "Normal Health" for invalid indices // String constante, "Normal Health" para índices inválidos
+ */
+const char *ai_condition_name(int condition);
+
+#endif // AI_MODEL_H_INCLUDED
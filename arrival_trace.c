@@ -0,0 +1,303 @@
+#include "arrival_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TRACE_HEADER_BYTES 16
+#define TRACE_LINE_MAX 256   // Longer CSV lines are skipped // Linhas CSV maiores são ignoradas
+
+struct arrival_trace {
+    const char *data;      // Whole file, mapped read only // Arquivo inteiro, mapeado somente leitura
+    size_t bytes;
+    size_t cursor;         // Next byte to parse // Próximo byte a ser lido
+    size_t released;       // Bytes before this offset were handed back to the kernel // Bytes antes deste offset foram devolvidos ao kernel
+    size_t page;
+    int binary;
+    int header_checked;    // CSV: the first data line may be a header // CSV: a primeira linha de dados pode ser um cabeçalho
+    long records;
+    long skipped;
+};
+
+ArrivalTrace *open_arrival_trace(const char *path) {
+/**
+ * \brief Map a CSV or binary trace // Mapeia um trace CSV ou binário
+ *
+ * \param path - Trace file // Arquivo do trace
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ArrivalTrace* - Pointer to the trace, NULL on failure // Ponteiro para o trace, NULL em caso de falha
+ */
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    ArrivalTrace *trace = (ArrivalTrace*)calloc(1, sizeof(ArrivalTrace));
+    if (!trace) {
+        printf("\nError: Memory allocation failed (Arrival Trace)\n");
+        exit(1);
+    }
+    trace->bytes = (size_t)info.st_size;
+    trace->page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (trace->bytes > 0) {
+        void *data = mmap(NULL, trace->bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            free(trace);
+            return NULL;
+        }
+        trace->data = (const char*)data;
+        madvise(data, trace->bytes, MADV_SEQUENTIAL);
+    }
+    close(fd); // The mapping keeps the file alive // O mapeamento mantém o arquivo
+
+    if (trace->bytes >= TRACE_HEADER_BYTES && memcmp(trace->data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+        uint32_t record_size;
+        memcpy(&record_size, trace->data + 8, sizeof(record_size));
+        if (record_size != sizeof(TraceRecord)) {
+            close_arrival_trace(trace); // Written by a build with another record layout // Gravado com outro layout de registro
+            return NULL;
+        }
+        trace->binary = 1;
+        trace->cursor = TRACE_HEADER_BYTES;
+    }
+    return trace;
+}
+
+void close_arrival_trace(ArrivalTrace *trace) {
+/**
+ * \brief Unmap and close a trace // Desmapeia e fecha um trace
+ */
+    if (!trace) {
+        return;
+    }
+    if (trace->data) {
+        munmap((void*)trace->data, trace->bytes);
+    }
+    free(trace);
+}
+
+static void release_parsed(ArrivalTrace *trace) {
+// Drops the pages behind the cursor once a whole chunk was parsed, and prefetches the next chunk
+// Descarta as páginas atrás do cursor quando um bloco inteiro foi lido, e antecipa o próximo bloco
+    if (trace->cursor - trace->released < TRACE_CHUNK) {
+        return;
+    }
+
+    size_t end = trace->cursor / trace->page * trace->page;
+    madvise((void*)(trace->data + trace->released), end - trace->released, MADV_DONTNEED);
+    trace->released = end;
+
+    size_t ahead = trace->bytes - end < TRACE_CHUNK ? trace->bytes - end : TRACE_CHUNK;
+    if (ahead > 0) {
+        madvise((void*)(trace->data + end), ahead, MADV_WILLNEED);
+    }
+}
+
+static int parse_timestamp(const char *field, double *seconds) {
+// Seconds, or HH:MM:SS[.fff] turned into seconds since midnight // Segundos, ou HH:MM:SS[.fff] convertido em segundos desde a meia-noite
+    char *end;
+    if (strchr(field, ':')) {
+        long hours = strtol(field, &end, 10);
+        if (*end != ':') {
+            return -1;
+        }
+        long minutes = strtol(end + 1, &end, 10);
+        if (*end != ':') {
+            return -1;
+        }
+        double rest = strtod(end + 1, &end);
+        if (*end != '\0' || minutes < 0 || minutes > 59 || rest < 0 || rest >= 61) {
+            return -1;
+        }
+        *seconds = hours * 3600.0 + minutes * 60.0 + rest;
+        return 0;
+    }
+
+    *seconds = strtod(field, &end);
+    return end != field && *end == '\0' ? 0 : -1;
+}
+
+static char *trim_field(char *field) {
+// Removes surrounding spaces and one pair of double quotes // Remove espaços das pontas e um par de aspas
+    while (isspace((unsigned char)*field)) {
+        field++;
+    }
+    size_t length = strlen(field);
+    while (length > 0 && isspace((unsigned char)field[length - 1])) {
+        field[--length] = '\0';
+    }
+    if (length >= 2 && field[0] == '"' && field[length - 1] == '"') {
+        field[length - 1] = '\0';
+        field++;
+    }
+    return field;
+}
+
+static int parse_csv_line(char *line, TraceRecord *record) {
+// Splits "timestamp,patient_id,name[,condition]" // Separa "timestamp,patient_id,name[,condition]"
+    char *fields[4] = {NULL, NULL, NULL, NULL};
+    int count = 0;
+    char *cursor = line;
+
+    while (count < 4) {
+        fields[count++] = cursor;
+        char *comma = strchr(cursor, ',');
+        if (!comma) {
+            break;
+        }
+        *comma = '\0';
+        cursor = comma + 1;
+    }
+    if (count < 3) {
+        return -1;
+    }
+
+    char *end;
+    char *id = trim_field(fields[1]);
+    long patient_id = strtol(id, &end, 10);
+    if (parse_timestamp(trim_field(fields[0]), &record->timestamp) != 0 || end == id || *end != '\0') {
+        return -1;
+    }
+
+    record->patient_id = (int)patient_id;
+    snprintf(record->name, TRACE_NAME_MAX, "%s", trim_field(fields[2]));
+    snprintf(record->condition, TRACE_CONDITION_MAX, "%s", count == 4 ? trim_field(fields[3]) : "");
+    return 0;
+}
+
+static int next_csv_record(ArrivalTrace *trace, TraceRecord *record) {
+// Parses lines until one is valid; the line is copied so strtod never reads past the mapping
+// Lê linhas até uma ser válida; a linha é copiada para o strtod nunca ler além do mapeamento
+    char line[TRACE_LINE_MAX];
+
+    while (trace->cursor < trace->bytes) {
+        const char *start = trace->data + trace->cursor;
+        const char *newline = memchr(start, '\n', trace->bytes - trace->cursor);
+        size_t length = newline ? (size_t)(newline - start) : trace->bytes - trace->cursor;
+        trace->cursor += length + (newline ? 1 : 0);
+
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        if (length == 0 || start[0] == '#') {
+            continue;
+        }
+        if (length >= TRACE_LINE_MAX) {
+            trace->skipped++;
+            continue;
+        }
+
+        memcpy(line, start, length);
+        line[length] = '\0';
+
+        int header = !trace->header_checked;
+        trace->header_checked = 1;
+        if (parse_csv_line(line, record) != 0) {
+            if (!header) {
+                trace->skipped++;
+            }
+            continue;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+int arrival_trace_next(ArrivalTrace *trace, TraceRecord *record) {
+/**
+ * \brief Read the next record // Lê o próximo registro
+ *
+ * \param trace - Pointer to the trace // Ponteiro para o trace
+ * \param record - Receives the record // Recebe o registro
+ *
+ * \return int - 1 if a record was read, 0 at the end of the trace // 1 se um registro foi lido, 0 no fim do trace
+ */
+    if (!trace || !record) {
+        return 0;
+    }
+
+    int found;
+    if (trace->binary) {
+        found = trace->bytes - trace->cursor >= sizeof(TraceRecord);
+        if (found) {
+            memcpy(record, trace->data + trace->cursor, sizeof(TraceRecord));
+            record->name[TRACE_NAME_MAX - 1] = '\0';
+            record->condition[TRACE_CONDITION_MAX - 1] = '\0';
+            trace->cursor += sizeof(TraceRecord);
+        }
+    } else {
+        found = next_csv_record(trace, record);
+    }
+
+    if (found) {
+        trace->records++;
+    }
+    release_parsed(trace);
+    return found;
+}
+
+void get_arrival_trace_stats(ArrivalTrace *trace, TraceStats *stats) {
+/**
+ * \brief Copy the reading statistics // Copia as estatísticas de leitura
+ */
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(TraceStats));
+    if (!trace) {
+        return;
+    }
+    stats->records = trace->records;
+    stats->skipped = trace->skipped;
+    stats->bytes = trace->bytes;
+    stats->consumed = trace->cursor;
+    stats->binary = trace->binary;
+}
+
+long write_binary_trace(ArrivalTrace *trace, FILE *output) {
+/**
+ * \brief Write the rest of a trace as a binary trace // Grava o restante de um trace como trace binário
+ *
+ * \param trace - Trace to read // Trace a ser lido
+ * \param output - File opened for binary writing // Arquivo aberto para escrita binária
+ *
+ * \return long - Records written, -1 on a write error // Registros gravados, -1 em caso de erro de escrita
+ */
+    char header[TRACE_HEADER_BYTES] = {0};
+    uint32_t record_size = sizeof(TraceRecord);
+    memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    memcpy(header + 8, &record_size, sizeof(record_size));
+    if (fwrite(header, sizeof(header), 1, output) != 1) {
+        return -1;
+    }
+
+    long written = 0;
+    TraceRecord record;
+    while (arrival_trace_next(trace, &record)) {
+        TraceRecord clean;
+        memset(&clean, 0, sizeof(clean)); // No stack garbage in the padding // Sem lixo da pilha no preenchimento
+        clean.timestamp = record.timestamp;
+        clean.patient_id = record.patient_id;
+        memcpy(clean.name, record.name, strlen(record.name));
+        memcpy(clean.condition, record.condition, strlen(record.condition));
+        if (fwrite(&clean, sizeof(clean), 1, output) != 1) {
+            return -1;
+        }
+        written++;
+    }
+    return written;
+}
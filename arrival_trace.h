@@ -0,0 +1,85 @@
+#ifndef ARRIVAL_TRACE_H_INCLUDED
+#define ARRIVAL_TRACE_H_INCLUDED
+
+#include <stdio.h>
+
+#define TRACE_NAME_MAX 52         // Bytes of a patient name, terminator included // Bytes do nome do paciente, com o terminador
+#define TRACE_CONDITION_MAX 32    // Bytes of a condition name, terminator included // Bytes do nome da condição, com o terminador
+#define TRACE_CHUNK (64u << 20)   // Parsed bytes released from memory at a time // Bytes já lidos liberados da memória de uma vez
+#define TRACE_MAGIC "CLNTRC1"     // First 8 bytes of a binary trace // Primeiros 8 bytes de um trace binário
+
+/**
+ * \brief One arrival of a trace // Uma chegada de um trace
+ *
+ * \details Binary traces store this struct as is (native byte order), after a 16 byte header:
+ *          TRACE_MAGIC (8 bytes, NUL padded), the record size and a reserved word (uint32 each).
+ */
+typedef struct trace_record {
+    double timestamp;                      // Seconds; only the differences between records matter // Segundos; só as diferenças entre registros importam
+    int patient_id;
+    char name[TRACE_NAME_MAX];
+    char condition[TRACE_CONDITION_MAX];   // Ground truth, "" when the trace doesn't have it // Condição real, "" se o trace não tiver
+} TraceRecord;
+
+/**
+ * \brief Reading statistics of a trace // Estatísticas de leitura de um trace
+ */
+typedef struct trace_stats {
+    long records;          // Records returned so far // Registros retornados até agora
+    long skipped;          // Malformed CSV lines ignored // Linhas CSV malformadas ignoradas
+    size_t bytes;          // Size of the file // Tamanho do arquivo
+    size_t consumed;       // Bytes parsed so far // Bytes lidos até agora
+    int binary;            // 1 for a binary trace, 0 for CSV // 1 para trace binário, 0 para CSV
+} TraceStats;
+
+// Memory mapped arrival trace, read front to back // Trace de chegadas mapeado em memória, lido do início ao fim
+typedef struct arrival_trace ArrivalTrace;
+
+/**
+ * \brief Map a CSV or binary trace // Mapeia um trace CSV ou binário
+ *
+ * \details CSV lines are "timestamp,patient_id,name[,condition]". The timestamp is either seconds or HH:MM:SS[.fff];
+ *          blank lines, lines starting with '#' and a header line are ignored. The format is picked by the magic.
+ * \details Linhas CSV são "timestamp,patient_id,name[,condition]". O timestamp é em segundos ou HH:MM:SS[.fff];
+ *          linhas vazias, começando com '#' e um cabeçalho são ignorados. O formato é escolhido pelo magic.
+ * \param path - Trace file // Arquivo do trace
+ * \return Pointer to the trace, NULL if the file can't be opened, mapped, or has a bad binary header // Ponteiro para o trace, NULL em caso de falha
+ */
+ArrivalTrace *open_arrival_trace(const char *path);
+
+/**
+ * \brief Unmap and close a trace // Desmapeia e fecha um trace
+ *
+ * \param trace - Pointer to the trace // Ponteiro para o trace
+ */
+void close_arrival_trace(ArrivalTrace *trace);
+
+/**
+ * \brief Read the next record // Lê o próximo registro
+ *
+ * \details Pages already parsed are dropped every TRACE_CHUNK bytes, so resident memory stays bounded however big the file is.
+ * \details Páginas já lidas são descartadas a cada TRACE_CHUNK bytes, então a memória residente fica limitada qualquer que seja o arquivo.
+ * \param trace - Pointer to the trace // Ponteiro para o trace
+ * \param record - Receives the record // Recebe o registro
+ * \return 1 if a record was read, 0 at the end of the trace // 1 se um registro foi lido, 0 no fim do trace
+ */
+int arrival_trace_next(ArrivalTrace *trace, TraceRecord *record);
+
+/**
+ * \brief Copy the reading statistics // Copia as estatísticas de leitura
+ *
+ * \param trace - Pointer to the trace // Ponteiro para o trace
+ * \param stats - Receives the values // Recebe os valores
+ */
+void get_arrival_trace_stats(ArrivalTrace *trace, TraceStats *stats);
+
+/**
+ * \brief Write the rest of a trace as a binary trace // Grava o restante de um trace como trace binário
+ *
+ * \param trace - Trace to read (CSV or binary) // Trace a ser lido (CSV ou binário)
+ * \param output - File opened for binary writing // Arquivo aberto para escrita binária
+ * \return Records written, -1 on a write error // Registros gravados, -1 em caso de erro de escrita
+ */
+long write_binary_trace(ArrivalTrace *trace, FILE *output);
+
+#endif // ARRIVAL_TRACE_H_INCLUDED
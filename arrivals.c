@@ -0,0 +1,175 @@
+#include "arrivals.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *kind_names[] = {"poisson", "varying", "batch"};
+
+struct arrival_process {
+    ArrivalConfig config;
+    double clock;          // Simulated time of the last arrival // Tempo simulado da última chegada
+    unsigned int seed;     // rand_r() state, independent from the other threads // Estado do rand_r(), independente das outras threads
+};
+
+static double uniform_open(ArrivalProcess *process) {
+// Uniform value in (0, 1), never 0 so log() stays finite // Valor uniforme em (0, 1), nunca 0
+    return ((double)rand_r(&process->seed) + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+static double exponential(ArrivalProcess *process, double rate) {
+// Inverse transform sampling of an exponential gap // Amostragem por transformada inversa de um intervalo exponencial
+    return -log(uniform_open(process)) / rate;
+}
+
+ArrivalProcess *create_arrival_process(const ArrivalConfig *config, unsigned int seed) {
+/**
+ * \brief Create an arrival process starting at time 0 // Cria um processo de chegadas começando no tempo 0
+ *
+ * \param config - Distribution and its parameters // Distribuição e seus parâmetros
+ * \param seed - Same seed, same arrivals // Mesma semente, mesmas chegadas
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ArrivalProcess* - Pointer to the process, NULL if the parameters are invalid // Ponteiro para o processo, NULL se os parâmetros forem inválidos
+ */
+    if (!config || config->rate <= 0 || config->kind < ARRIVAL_POISSON || config->kind > ARRIVAL_BATCH) {
+        return NULL;
+    }
+    if (config->kind == ARRIVAL_VARYING && (config->amplitude < 0 || config->amplitude > 1 || config->period <= 0)) {
+        return NULL;
+    }
+    if (config->kind == ARRIVAL_BATCH && config->batch_mean < 1) {
+        return NULL;
+    }
+
+    ArrivalProcess *process = (ArrivalProcess*)malloc(sizeof(ArrivalProcess));
+    if (!process) {
+        printf("\nError: Memory allocation failed (Arrival Process)\n");
+        exit(1);
+    }
+
+    process->config = *config;
+    process->clock = 0;
+    process->seed = seed;
+    return process;
+}
+
+void destroy_arrival_process(ArrivalProcess *process) {
+/**
+ * \brief Free an arrival process // Libera um processo de chegadas
+ */
+    free(process);
+}
+
+double arrival_rate_at(const ArrivalConfig *config, double time) {
+/**
+ * \brief Instantaneous arrival rate // Taxa de chegada instantânea
+ *
+ * \details Only ARRIVAL_VARYING changes over time: rate * (1 + amplitude * sin(2 pi t / period)).
+ * \details Apenas ARRIVAL_VARYING muda com o tempo: rate * (1 + amplitude * sen(2 pi t / period)).
+ *
+ * \return double - Patients per second // Pacientes por segundo
+ */
+    if (config->kind != ARRIVAL_VARYING) {
+        return config->rate;
+    }
+    return config->rate * (1.0 + config->amplitude * sin(2.0 * M_PI * time / config->period));
+}
+
+double arrival_next(ArrivalProcess *process, int *count) {
+/**
+ * \brief Sample the next arrival // Sorteia a próxima chegada
+ *
+ * \param process - Pointer to the process // Ponteiro para o processo
+ * \param count - Receives how many patients arrive together // Recebe quantos pacientes chegam juntos
+ *
+ * \details ARRIVAL_VARYING uses thinning (Lewis and Shedler): candidates come at the peak rate and each one
+ *          is kept with probability rate(t) / peak. ARRIVAL_BATCH draws groups at rate / batch_mean, so the
+ *          patient rate stays `rate`.
+ * \details ARRIVAL_VARYING usa thinning (Lewis e Shedler): candidatos chegam na taxa de pico e cada um é
+ *          mantido com probabilidade rate(t) / pico. ARRIVAL_BATCH sorteia grupos na taxa rate / batch_mean,
+ *          mantendo a taxa de pacientes em `rate`.
+ *
+ * \return double - Simulated seconds since the previous arrival // Segundos simulados desde a chegada anterior
+ */
+    const ArrivalConfig *config = &process->config;
+    double previous = process->clock;
+    int arriving = 1;
+
+    switch (config->kind) {
+    case ARRIVAL_VARYING: {
+        double peak = config->rate * (1.0 + config->amplitude);
+        double time = previous;
+        do {
+            time += exponential(process, peak);
+        } while (uniform_open(process) * peak > arrival_rate_at(config, time));
+        process->clock = time;
+        break;
+    }
+    case ARRIVAL_BATCH: {
+        process->clock += exponential(process, config->rate / config->batch_mean);
+        if (config->batch_mean > 1) {
+            // Geometric on {1, 2, ...} with mean batch_mean // Geométrica em {1, 2, ...} com média batch_mean
+            double stop = 1.0 / config->batch_mean;
+            arriving = 1 + (int)floor(log(uniform_open(process)) / log(1.0 - stop));
+        }
+        break;
+    }
+    default:
+        process->clock += exponential(process, config->rate);
+        break;
+    }
+
+    if (count) {
+        *count = arriving;
+    }
+    return process->clock - previous;
+}
+
+double arrival_clock(ArrivalProcess *process) {
+/**
+ * \brief Simulated time of the last sampled arrival // Tempo simulado da última chegada sorteada
+ */
+    return process ? process->clock : 0;
+}
+
+void get_arrival_state(ArrivalProcess *process, ArrivalState *state) {
+/**
+ * \brief Copy the clock and the random state // Copia o relógio e o estado aleatório
+ */
+    state->clock = process->clock;
+    state->seed = process->seed;
+}
+
+void set_arrival_state(ArrivalProcess *process, const ArrivalState *state) {
+/**
+ * \brief Continue from a saved state // Continua de um estado salvo
+ */
+    process->clock = state->clock;
+    process->seed = state->seed;
+}
+
+int arrival_kind_from_name(const char *name) {
+/**
+ * \brief Parse a distribution name // Interpreta o nome de uma distribuição
+ *
+ * \return int - The ArrivalKind, or -1 if the name is unknown // O ArrivalKind, ou -1 se o nome for desconhecido
+ */
+    for (int i = ARRIVAL_POISSON; i <= ARRIVAL_BATCH; i++) {
+        if (name && strcmp(name, kind_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *arrival_kind_name(int kind) {
+/**
+ * \brief Name of a distribution // Nome de uma distribuição
+ */
+    if (kind < ARRIVAL_POISSON || kind > ARRIVAL_BATCH) {
+        return "unknown";
+    }
+    return kind_names[kind];
+}
@@ -0,0 +1,113 @@
+#ifndef ARRIVALS_H_INCLUDED
+#define ARRIVALS_H_INCLUDED
+
+
+/**
+ * \brief Distribution of the patient arrivals // Distribuição das chegadas de pacientes
+ */
+typedef enum arrival_kind {
+    ARRIVAL_POISSON,   // Exponential gaps with a constant rate // Intervalos exponenciais com taxa constante
+    ARRIVAL_VARYING,   // Poisson with a sinusoidal rate (rush hours), sampled by thinning // Poisson com taxa senoidal (horários de pico), amostrado por thinning
+    ARRIVAL_BATCH      // Groups arrive as a Poisson process, group size is geometric // Grupos chegam como processo de Poisson, tamanho geométrico
+} ArrivalKind;
+
+/**
+ * \brief Parameters of an arrival process // Parâmetros de um processo de chegadas
+ */
+typedef struct arrival_config {
+    int kind;            // ArrivalKind
+    double rate;         // Mean patients per simulated second // Média de pacientes por segundo simulado
+    double amplitude;    // ARRIVAL_VARYING: rate swings between rate * (1 - amplitude) and rate * (1 + amplitude), 0 to 1 // Amplitude da variação, de 0 a 1
+    double period;       // ARRIVAL_VARYING: seconds of one full cycle // Segundos de um ciclo completo
+    double batch_mean;   // ARRIVAL_BATCH: mean patients per group, at least 1 // Média de pacientes por grupo, pelo menos 1
+} ArrivalConfig;
+
+// Generator of arrival instants with its own clock and random state // Gerador de instantes de chegada com relógio e estado aleatório próprios
+typedef struct arrival_process ArrivalProcess;
+
+/**
+ * \brief Where an arrival process is, saved in checkpoints // Onde um processo de chegadas está, salvo nos checkpoints
+ */
+typedef struct arrival_state {
+    double clock;        // Simulated time of the last sampled arrival // Tempo simulado da última chegada sorteada
+    unsigned int seed;   // rand_r() state // Estado do rand_r()
+} ArrivalState;
+
+/**
+ * \brief Create an arrival process starting at time 0 // Cria um processo de chegadas começando no tempo 0
+ *
+ * \param config - Distribution and its parameters // Distribuição e seus parâmetros
+ * \param seed - Same seed, same arrivals // Mesma semente, mesmas chegadas
+ * \return Pointer to the process, NULL if the parameters are invalid // Ponteiro para o processo, NULL se os parâmetros forem inválidos
+ */
+ArrivalProcess *create_arrival_process(const ArrivalConfig *config, unsigned int seed);
+
+/**
+ * \brief Free an arrival process // Libera um processo de chegadas
+ *
+ * \param process - Pointer to the process // Ponteiro para o processo
+ */
+void destroy_arrival_process(ArrivalProcess *process);
+
+/**
+ * \brief Sample the next arrival // Sorteia a próxima chegada
+ *
+ * \details The caller sleeps for the returned gap (or schedules an event at that time) instead of polling.
+ * \details Quem chama dorme pelo intervalo retornado (ou agenda um evento nesse instante) em vez de consultar periodicamente.
+ * \param process - Pointer to the process // Ponteiro para o processo
+ * \param count - Receives how many patients arrive together, 1 unless ARRIVAL_BATCH // Recebe quantos pacientes chegam juntos
+ * \return Simulated seconds since the previous arrival // Segundos simulados desde a chegada anterior
+ */
+double arrival_next(ArrivalProcess *process, int *count);
+
+/**
+ * \brief Simulated time of the last sampled arrival // Tempo simulado da última chegada sorteada
+ *
+ * \param process - Pointer to the process // Ponteiro para o processo
+ * \return Seconds since the start // Segundos desde o início
+ */
+double arrival_clock(ArrivalProcess *process);
+
+/**
+ * \brief Copy the clock and the random state // Copia o relógio e o estado aleatório
+ *
+ * \param process - Pointer to the process // Ponteiro para o processo
+ * \param state - Receives the state // Recebe o estado
+ */
+void get_arrival_state(ArrivalProcess *process, ArrivalState *state);
+
+/**
+ * \brief Continue from a saved state; the next arrival is the one the saved process would have sampled
+ *        // Continua de um estado salvo; a próxima chegada é a que o processo salvo teria sorteado
+ *
+ * \param process - Pointer to a process with the same ArrivalConfig // Ponteiro para um processo com a mesma ArrivalConfig
+ * \param state - State from get_arrival_state() // Estado de get_arrival_state()
+ */
+void set_arrival_state(ArrivalProcess *process, const ArrivalState *state);
+
+/**
+ * \brief Instantaneous arrival rate at a simulated time // Taxa de chegada instantânea em um tempo simulado
+ *
+ * \param config - Distribution and its parameters // Distribuição e seus parâmetros
+ * \param time - Seconds since the start // Segundos desde o início
+ * \return Patients per second // Pacientes por segundo
+ */
+double arrival_rate_at(const ArrivalConfig *config, double time);
+
+/**
+ * \brief Parse a distribution name // Interpreta o nome de uma distribuição
+ *
+ * \param name - "poisson", "varying" or "batch" // "poisson", "varying" ou "batch"
+ * \return The ArrivalKind, or -1 if the name is unknown // O ArrivalKind, ou -1 se o nome for desconhecido
+ */
+int arrival_kind_from_name(const char *name);
+
+/**
+ * \brief Name of a distribution // Nome de uma distribuição
+ *
+ * \param kind - ArrivalKind
+ * \return Constant string // String constante
+ */
+const char *arrival_kind_name(int kind);
+
+#endif // ARRIVALS_H_INCLUDED
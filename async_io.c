@@ -0,0 +1,464 @@
+#include "async_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sched.h>
+#include <linux/io_uring.h>
+
+/*
+ * io_uring without liburing // io_uring sem liburing
+ *
+ * The kernel shares two rings with the process: submissions (an array of indexes into the SQE array) and
+ * completions. This process is the only producer of the submission ring and the only consumer of the completion
+ * ring, so it owns their tail and head; the kernel's side is read with acquire loads and ours is published with
+ * release stores.
+ */
+
+#define ASYNC_IO_ALIGN 4096            // Page aligned buffers // Buffers alinhados à página
+#define RING_ENTRIES (2 * ASYNC_IO_BUFFERS) // A write and its linked sync per buffer // Uma gravação e sua sincronização por buffer
+#define SYNC_TAG 0xffffu               // user_data of the syncs; writes carry their buffer index // user_data das sincronizações
+
+typedef struct uring {
+    int fd;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;                     // Same mapping as sq_ring with IORING_FEAT_SINGLE_MMAP // Mesmo mapeamento com SINGLE_MMAP
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_claimed;               // Tail past the entries being filled, published by submit() // Cauda das entradas sendo preenchidas
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+} Uring;
+
+struct async_file {
+    int fd;
+    AsyncIoKind kind;                  // ASYNC_IO_URING only while the ring works // Só enquanto o anel funciona
+    int fixed;                         // Buffers registered // Buffers registrados
+    int sync_every;
+    int unsynced;                      // Writes since the last sync // Gravações desde a última sincronização
+    int resync;                        // A linked sync was cancelled, sync once the writes land // Sincronização cancelada
+    int failed;
+    int buffer_size;
+    int buffer_count;
+    char *buffers;
+    int current;                       // Buffer being filled // Buffer sendo enchido
+    int busy[ASYNC_IO_BUFFERS];        // Bytes in flight, 0 for a free buffer // Bytes em voo, 0 para buffer livre
+    long long targets[ASYNC_IO_BUFFERS]; // Offset of each write in flight // Posição de cada gravação em voo
+    int in_flight;                     // Submitted operations not completed yet // Operações enviadas e não completadas
+    long long offset;                  // End of the file // Fim do arquivo
+    Uring ring;
+    AsyncIoStats stats;
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned submit, unsigned complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, submit, complete, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void *argument, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, argument, count);
+}
+
+static void close_ring(Uring *ring) {
+    if (ring->sqes && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd); // Also drops the registered buffers // Também libera os buffers registrados
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+static int open_ring(Uring *ring) {
+// Sets up a ring and maps its three regions, -1 if the kernel refuses // Cria um anel e mapeia suas três regiões
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = uring_setup(RING_ENTRIES, &params);
+    if (ring->fd < 0) {
+        return -1;
+    }
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close_ring(ring);
+        return -1;
+    }
+    ring->cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? ring->sq_ring :
+                    mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        close_ring(ring);
+        return -1;
+    }
+    char *sq = (char*)ring->sq_ring;
+    char *cq = (char*)ring->cq_ring;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    ring->sq_claimed = *ring->sq_tail;
+    return 0;
+}
+
+static struct io_uring_sqe *next_sqe(Uring *ring) {
+// Claims the next submission slot; the kernel sees it only once submit() publishes the tail
+// Reserva a próxima entrada de submissão; o kernel só a vê quando submit() publica a cauda
+    unsigned index = ring->sq_claimed++ & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    return sqe;
+}
+
+AsyncFile *create_async_file(int fd, int buffer_size, AsyncIoKind kind, int sync_every) {
+/**
+ * \brief Create the output of a file // Cria a saída de um arquivo
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return AsyncFile* - Pointer to the output // Ponteiro para a saída
+ */
+    AsyncFile *file = (AsyncFile*)calloc(1, sizeof(AsyncFile));
+    if (!file) {
+        printf("\nError: Memory allocation failed (Async file)\n");
+        exit(1);
+    }
+    file->fd = fd;
+    file->sync_every = sync_every > 0 ? sync_every : 0;
+    file->buffer_size = (buffer_size + ASYNC_IO_ALIGN - 1) / ASYNC_IO_ALIGN * ASYNC_IO_ALIGN;
+    file->ring.fd = -1;
+    file->kind = kind == ASYNC_IO_URING && open_ring(&file->ring) == 0 ? ASYNC_IO_URING : ASYNC_IO_WRITE;
+    file->buffer_count = file->kind == ASYNC_IO_URING ? ASYNC_IO_BUFFERS : 1; // pwrite() needs only one
+    file->buffers = (char*)aligned_alloc(ASYNC_IO_ALIGN, (size_t)file->buffer_count * file->buffer_size);
+    if (!file->buffers) {
+        printf("\nError: Memory allocation failed (Async file buffers)\n");
+        exit(1);
+    }
+    if (file->kind == ASYNC_IO_URING) {
+        struct iovec buffers[ASYNC_IO_BUFFERS];
+        for (int i = 0; i < file->buffer_count; i++) {
+            buffers[i].iov_base = file->buffers + (size_t)i * file->buffer_size;
+            buffers[i].iov_len = file->buffer_size;
+        }
+        // Pinned once, so the kernel doesn't map the pages on every write // Fixados uma vez, sem mapear a cada gravação
+        file->fixed = uring_register(file->ring.fd, IORING_REGISTER_BUFFERS, buffers, file->buffer_count) == 0;
+    }
+    file->stats.files = 1;
+    file->stats.uring = file->kind == ASYNC_IO_URING;
+    file->stats.fixed = file->fixed;
+    return file;
+}
+
+void destroy_async_file(AsyncFile *file) {
+/**
+ * \brief Wait for every write, then free the output without closing the file // Espera as gravações e libera a saída sem fechar o arquivo
+ */
+    if (!file) {
+        return;
+    }
+    async_file_wait(file);
+    if (file->kind == ASYNC_IO_URING) {
+        close_ring(&file->ring);
+    }
+    free(file->buffers);
+    free(file);
+}
+
+static int write_all(AsyncFile *file, const char *data, int length, long long offset) {
+// pwrite() until done, the fallback and the finish of short io_uring writes // pwrite() até o fim
+    while (length > 0) {
+        ssize_t done = pwrite(file->fd, data, length, offset);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            file->failed = 1;
+            return -1;
+        }
+        data += done;
+        length -= (int)done;
+        offset += done;
+    }
+    return 0;
+}
+
+static void sync_now(AsyncFile *file) {
+    if (fdatasync(file->fd) != 0) {
+        file->failed = 1;
+    }
+    file->stats.syncs++;
+}
+
+static void reap(AsyncFile *file) {
+// Handles every completion posted so far // Trata todas as conclusões já postadas
+    Uring *ring = &file->ring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        unsigned tag = (unsigned)cqe->user_data;
+        int result = cqe->res;
+        head++;
+        file->in_flight--;
+        if (tag == SYNC_TAG) {
+            if (result == -ECANCELED) {
+                file->resync = 1; // Its write came back short: sync after the pwrite() below // Gravação curta
+            } else if (result < 0) {
+                file->failed = 1;
+            }
+            continue;
+        }
+        int length = file->busy[tag];
+        int written = result > 0 ? result : 0;
+        if (written < length) { // Short or failed: finish it here, the buffer is still intact // Termina aqui
+            file->stats.retries++;
+            write_all(file, file->buffers + (size_t)tag * file->buffer_size + written, length - written,
+                      file->targets[tag] + written);
+        }
+        file->busy[tag] = 0;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    if (file->resync && file->in_flight == 0) {
+        file->resync = 0;
+        sync_now(file);
+    }
+}
+
+static void drain_ring(AsyncFile *file) {
+// Waits for every operation the kernel took, so none reads a buffer or lands a write once the ring is gone. The
+// completions are posted to the mapped ring even if io_uring_enter() keeps failing, so they are polled then
+// Espera todas as operações que o kernel recebeu, para nenhuma ler um buffer ou gravar depois que o anel se vai. As
+// conclusões chegam ao anel mapeado mesmo se io_uring_enter() continuar falhando, então são consultadas
+    Uring *ring = &file->ring;
+    while (file->in_flight > 0) {
+        if (__atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) == *ring->cq_head &&
+            uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            sched_yield();
+        }
+        reap(file);
+    }
+}
+
+static void fall_back(AsyncFile *file) {
+// The ring stopped working: wait for what the kernel took, close the ring and write with pwrite() every buffer it
+// never took (reap() already finished the ones it did); pwrite() from now on
+// O anel parou: espera o que o kernel recebeu, fecha o anel e grava com pwrite() cada buffer que ele nunca recebeu
+// (reap() já terminou os recebidos); pwrite() daqui em diante
+    if (file->kind != ASYNC_IO_URING) {
+        return;
+    }
+    drain_ring(file);
+    close_ring(&file->ring);
+    for (int i = 0; i < file->buffer_count; i++) {
+        if (file->busy[i]) {
+            file->stats.retries++;
+            write_all(file, file->buffers + (size_t)i * file->buffer_size, file->busy[i], file->targets[i]);
+            file->busy[i] = 0;
+        }
+    }
+    if (file->sync_every > 0) {
+        sync_now(file); // A linked sync may have been cancelled // Uma sincronização ligada pode ter sido cancelada
+    }
+    file->kind = ASYNC_IO_WRITE;
+    file->fixed = 0;
+    file->in_flight = 0;
+    file->resync = 0;
+    file->current = 0;
+    file->stats.uring = 0;
+    file->stats.fixed = 0;
+}
+
+static int wait_completion(AsyncFile *file) {
+// Blocks until at least one operation completes, -1 if the file fell back to pwrite() // Bloqueia até uma operação terminar
+    int result;
+    do {
+        result = uring_enter(file->ring.fd, 0, 1, IORING_ENTER_GETEVENTS);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+        fall_back(file);
+        return -1;
+    }
+    reap(file);
+    return 0;
+}
+
+static int submit(AsyncFile *file, unsigned count) {
+// Publishes the `count` entries filled since the last call and hands them to the kernel; on failure the ones it never
+// took stop counting as in flight
+// Publica as `count` entradas preenchidas desde a última chamada e as entrega ao kernel; em caso de falha as que ele
+// nunca recebeu deixam de contar como em voo
+    Uring *ring = &file->ring;
+    __atomic_store_n(ring->sq_tail, ring->sq_claimed, __ATOMIC_RELEASE); // Every field of the entries is written // Todos os campos escritos
+    while (count > 0) {
+        int result = uring_enter(ring->fd, count, 0, 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EBUSY) && file->in_flight > (int)count) {
+            // Completion queue full: let an earlier operation finish first // Fila de conclusões cheia
+            if (uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) >= 0 || errno == EINTR) {
+                reap(file);
+                continue;
+            }
+        }
+        if (result <= 0) {
+            file->in_flight -= (int)count;
+            return -1;
+        }
+        count -= (unsigned)result;
+    }
+    return 0;
+}
+
+char *async_file_buffer(AsyncFile *file) {
+/**
+ * \brief Buffer to fill next // Buffer a encher em seguida
+ */
+    return file->buffers + (size_t)file->current * file->buffer_size;
+}
+
+int async_file_write(AsyncFile *file, int length) {
+/**
+ * \brief Write the first `length` bytes of the buffer at the end of the file // Grava os primeiros `length` bytes do buffer no fim do arquivo
+ *
+ * \return int - 0 on success, -1 on failure // 0 em sucesso, -1 em caso de falha
+ */
+    if (length <= 0) {
+        return file->failed ? -1 : 0;
+    }
+    int sync = file->sync_every > 0 && ++file->unsynced >= file->sync_every;
+    if (sync) {
+        file->unsynced = 0;
+    }
+    file->stats.writes++;
+    if (file->kind != ASYNC_IO_URING) {
+        write_all(file, async_file_buffer(file), length, file->offset);
+        file->offset += length;
+        if (sync) {
+            sync_now(file);
+        }
+        return file->failed ? -1 : 0;
+    }
+
+    int index = file->current;
+    struct io_uring_sqe *sqe = next_sqe(&file->ring);
+    sqe->opcode = file->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = file->fd;
+    sqe->addr = (unsigned long long)(uintptr_t)async_file_buffer(file);
+    sqe->len = (unsigned)length;
+    sqe->off = (unsigned long long)file->offset;
+    sqe->buf_index = file->fixed ? (unsigned short)index : 0;
+    sqe->user_data = (unsigned long long)index;
+    if (sync) {
+        // Drained: starts after every earlier write, so the linked data sync covers all of them
+        // Drenada: começa depois de todas as gravações anteriores, então a sincronização ligada cobre todas
+        sqe->flags = IOSQE_IO_DRAIN | IOSQE_IO_LINK;
+        struct io_uring_sqe *fsync = next_sqe(&file->ring);
+        fsync->opcode = IORING_OP_FSYNC;
+        fsync->fd = file->fd;
+        fsync->fsync_flags = IORING_FSYNC_DATASYNC;
+        fsync->user_data = SYNC_TAG;
+        file->stats.syncs++;
+    }
+    file->busy[index] = length;
+    file->targets[index] = file->offset;
+    file->offset += length;
+    file->in_flight += sync ? 2 : 1;
+    if (submit(file, sync ? 2u : 1u) != 0) {
+        fall_back(file); // Writes this buffer too // Grava este buffer também
+        return file->failed ? -1 : 0;
+    }
+
+    file->current = (file->current + 1) % file->buffer_count;
+    reap(file); // Buffers already written are free again // Buffers já gravados ficam livres de novo
+    while (file->kind == ASYNC_IO_URING && file->busy[file->current]) {
+        file->stats.stalls++;
+        wait_completion(file);
+    }
+    return file->failed ? -1 : 0;
+}
+
+int async_file_wait(AsyncFile *file) {
+/**
+ * \brief Wait until every queued write and sync is done // Espera todas as gravações e sincronizações enfileiradas
+ *
+ * \return int - 0 on success, -1 on failure // 0 em sucesso, -1 em caso de falha
+ */
+    while (file->kind == ASYNC_IO_URING && file->in_flight > 0) {
+        wait_completion(file); // Falls back when io_uring_enter() fails, which empties the ring // Esvazia o anel se falhar
+    }
+    int status = file->failed ? -1 : 0;
+    file->failed = 0;
+    return status;
+}
+
+void async_file_rewind(AsyncFile *file, long long offset) {
+/**
+ * \brief Write from `offset` on, after the file was truncated // Grava a partir de `offset`, depois que o arquivo foi truncado
+ */
+    file->offset = offset;
+}
+
+void add_async_file_stats(const AsyncFile *file, AsyncIoStats *stats) {
+/**
+ * \brief Add the counters of a file to `stats` // Soma os contadores de um arquivo em `stats`
+ */
+    stats->files += file->stats.files;
+    stats->uring += file->stats.uring;
+    stats->fixed += file->stats.fixed;
+    stats->writes += file->stats.writes;
+    stats->syncs += file->stats.syncs;
+    stats->stalls += file->stats.stalls;
+    stats->retries += file->stats.retries;
+}
+
+int async_io_from_name(const char *name) {
+/**
+ * \brief Output kind from its command line name // Tipo de saída a partir do nome na linha de comando
+ *
+ * \return int - ASYNC_IO_WRITE, ASYNC_IO_URING or -1 // ASYNC_IO_WRITE, ASYNC_IO_URING ou -1
+ */
+    if (name && strcmp(name, "write") == 0) {
+        return ASYNC_IO_WRITE;
+    }
+    if (name && strcmp(name, "uring") == 0) {
+        return ASYNC_IO_URING;
+    }
+    return -1;
+}
@@ -0,0 +1,113 @@
+#ifndef ASYNC_IO_H_INCLUDED
+#define ASYNC_IO_H_INCLUDED
+
+#define ASYNC_IO_BUFFERS 4             // Buffers per file with io_uring: one filling, the others in flight // Um enchendo, os outros em voo
+
+typedef enum async_io_kind {
+    ASYNC_IO_WRITE,                    // pwrite() and fdatasync() on the calling thread // Na thread que chama
+    ASYNC_IO_URING                     // Queued to io_uring, falling back to ASYNC_IO_WRITE without it // Enfileirado no io_uring
+} AsyncIoKind;
+
+/**
+ * \brief Counters of one file, or summed over many // Contadores de um arquivo, ou somados de vários
+ */
+typedef struct async_io_stats {
+    int files;
+    int uring;                         // Files on io_uring, the rest fell back to pwrite() // Arquivos no io_uring
+    int fixed;                         // Files whose buffers are registered with the kernel // Com buffers registrados
+    long writes;                       // Buffers written // Buffers gravados
+    long syncs;                        // fdatasync() calls or linked IORING_OP_FSYNC // Sincronizações
+    long stalls;                       // Times every buffer was in flight and the writer waited // Vezes que o escritor esperou
+    long retries;                      // Short or failed io_uring writes finished with pwrite() // Terminadas com pwrite()
+} AsyncIoStats;
+
+// Output of one file descriptor through a few buffers, written by one thread at a time
+// Saída de um descritor de arquivo por alguns buffers, escrita por uma thread por vez
+typedef struct async_file AsyncFile;
+
+/**
+ * \brief Create the output of a file // Cria a saída de um arquivo
+ *
+ * \details With ASYNC_IO_URING the file gets its own ring, set up with raw io_uring_setup/io_uring_enter/
+ *          io_uring_register system calls, and ASYNC_IO_BUFFERS buffers registered as fixed buffers. A full buffer is
+ *          queued as IORING_OP_WRITE_FIXED and the writer goes on filling the next one; every sync_every writes, the
+ *          write is drained behind the earlier ones and linked to an IORING_OP_FSYNC with IORING_FSYNC_DATASYNC, so the
+ *          data sync covers everything before it without a blocking call. If the kernel refuses io_uring (old kernel,
+ *          seccomp, io_uring_disabled) the file falls back to pwrite(); if it refuses only the registration, plain
+ *          IORING_OP_WRITE is used.
+ * \details Com ASYNC_IO_URING o arquivo tem seu próprio anel, criado com as chamadas de sistema io_uring_setup/
+ *          io_uring_enter/io_uring_register diretamente, e ASYNC_IO_BUFFERS buffers registrados como fixos. Um buffer
+ *          cheio é enfileirado como IORING_OP_WRITE_FIXED e o escritor segue enchendo o próximo; a cada sync_every
+ *          gravações, a gravação espera as anteriores e é ligada a um IORING_OP_FSYNC com IORING_FSYNC_DATASYNC. Se o
+ *          kernel recusar o io_uring, o arquivo usa pwrite(); se recusar só o registro, usa IORING_OP_WRITE.
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ * \param fd - Open file, written at explicit offsets from 0 (not O_APPEND) // Arquivo aberto, gravado em posições explícitas a partir de 0
+ * \param buffer_size - Bytes of each buffer // Bytes de cada buffer
+ * \param kind - ASYNC_IO_WRITE or ASYNC_IO_URING // ASYNC_IO_WRITE ou ASYNC_IO_URING
+ * \param sync_every - Data sync after every N buffers written, 0 for never // Sincroniza a cada N buffers, 0 para nunca
+ * \return Pointer to the output; the descriptor stays owned by the caller // Ponteiro para a saída; o descritor continua do chamador
+ */
+AsyncFile *create_async_file(int fd, int buffer_size, AsyncIoKind kind, int sync_every);
+
+/**
+ * \brief Wait for every write, then free the output without closing the file // Espera as gravações e libera a saída sem fechar o arquivo
+ *
+ * \param file - Pointer to the output, may be NULL // Ponteiro para a saída, pode ser NULL
+ */
+void destroy_async_file(AsyncFile *file);
+
+/**
+ * \brief Buffer to fill next // Buffer a encher em seguida
+ *
+ * \param file - Pointer to the output // Ponteiro para a saída
+ * \return buffer_size bytes owned by the caller until async_file_write() // Bytes do chamador até async_file_write()
+ */
+char *async_file_buffer(AsyncFile *file);
+
+/**
+ * \brief Write the first `length` bytes of the buffer at the end of the file // Grava os primeiros `length` bytes do buffer no fim do arquivo
+ *
+ * \details With io_uring this only queues the write; it waits only when every buffer is still in flight. The buffer
+ *          from async_file_buffer() changes after this call.
+ * \details Com io_uring isto só enfileira a gravação; espera só quando todos os buffers ainda estão em voo. O buffer
+ *          de async_file_buffer() muda depois desta chamada.
+ * \param file - Pointer to the output // Ponteiro para a saída
+ * \param length - 0 to buffer_size bytes // 0 a buffer_size bytes
+ * \return 0 on success, -1 if an earlier or this write failed // 0 em sucesso, -1 se esta ou uma gravação anterior falhou
+ */
+int async_file_write(AsyncFile *file, int length);
+
+/**
+ * \brief Wait until every queued write and sync is done // Espera todas as gravações e sincronizações enfileiradas
+ *
+ * \param file - Pointer to the output // Ponteiro para a saída
+ * \return 0 if every write since the last wait succeeded, -1 otherwise // 0 se todas as gravações desde a última espera deram certo
+ */
+int async_file_wait(AsyncFile *file);
+
+/**
+ * \brief Write from `offset` on, after the file was truncated (call async_file_wait() first)
+ *        // Grava a partir de `offset`, depois que o arquivo foi truncado (chame async_file_wait() antes)
+ *
+ * \param file - Pointer to the output // Ponteiro para a saída
+ * \param offset - New end of the file // Novo fim do arquivo
+ */
+void async_file_rewind(AsyncFile *file, long long offset);
+
+/**
+ * \brief Add the counters of a file to `stats` // Soma os contadores de um arquivo em `stats`
+ *
+ * \param file - Pointer to the output // Ponteiro para a saída
+ * \param stats - Receives the sums // Recebe as somas
+ */
+void add_async_file_stats(const AsyncFile *file, AsyncIoStats *stats);
+
+/**
+ * \brief Output kind from its command line name // Tipo de saída a partir do nome na linha de comando
+ *
+ * \param name - "write" or "uring" // "write" ou "uring"
+ * \return AsyncIoKind, or -1 for an unknown name // AsyncIoKind, ou -1 para nome desconhecido
+ */
+int async_io_from_name(const char *name);
+
+#endif // ASYNC_IO_H_INCLUDED
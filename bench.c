@@ -0,0 +1,640 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include "queue.h"
+#include "patient.h"
+#include "exam.h"
+#include "medical_check.h"
+#include "logger.h"
+#include "ai_model.h"
+#include "xray_image.h"
+#include "rng.h"
+
+/*
+ * Microbenchmarks for the TADs used by the simulation // Microbenchmarks dos TADs usados pela simulação
+ *
+ * Every benchmark runs `iterations` operations per thread. Multi-threaded variants share one structure
+ * behind one mutex, the same way the simulation shares them behind queue_mutex.
+ * Results are printed as JSON (one object per benchmark) with ns/op and ops/s.
+ */
+
+#define BENCH_DEFAULT_ITERATIONS 200000
+#define BENCH_MAX_THREADS 64
+
+typedef struct bench_context BenchContext;
+typedef long (*BenchFunction)(BenchContext *context, int thread_index, long iterations); // Returns a checksum of the results
+
+struct bench_context {
+    pthread_mutex_t mutex;        // Shared lock for the contended variants // Trava compartilhada das variantes com contenção
+    pthread_barrier_t start;
+    V_queue *queue;
+    ExamPriorityQueue *priority_queue;
+    Exam **exams;                 // Pre-built exams with conditions of every priority // Exames pré-criados com condições de todas as prioridades
+    int exam_count;
+    FILE *sink;                   // /dev/null for the print_*_db benchmarks
+    Patient *patient;
+    Exam *exam;
+    Report *report;
+    int param;
+    AiModel *ai_model;
+    float *ai_features;           // AI_MAX_BATCH random feature vectors // AI_MAX_BATCH vetores de características aleatórios
+    XrayImage *image;             // Acquired image and its half size working copy // Imagem adquirida e sua cópia de trabalho com metade do tamanho
+    XrayImage *scratch;
+    XrayKernels image_kernels;
+    int shared;                   // 1 when threads use the shared structure under `mutex` // 1 quando as threads usam a estrutura compartilhada
+    BenchFunction function;
+};
+
+typedef struct bench_thread {
+    BenchContext *context;
+    int index;
+    long iterations;
+    double start;                 // Its own clock readings: the main thread may run late on a busy CPU // Suas próprias leituras do relógio
+    double end;
+    long checksum;                // Keeps results alive so the compiler can't drop the work // Mantém os resultados vivos
+} BenchThread;
+
+static const char *conditions[] = {
+    "Normal Health", "Bronchitis", "Pneumonia", "COVID", "Pulmonary Embolism",
+    "Pleural Effusion", "Pulmonary Fibrosis", "Tuberculosis", "Lung Cancer"
+};
+#define CONDITION_COUNT 9
+
+static int first_result = 1;
+static volatile long checksum; // Sum of the thread checksums, written after the joins // Soma dos checksums das threads
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static struct tm *bench_time(void) {
+    static struct tm fixed;
+    time_t now = time(NULL);
+    localtime_r(&now, &fixed);
+    return &fixed;
+}
+
+static void lock_if_shared(BenchContext *context) {
+    if (context->shared) {
+        pthread_mutex_lock(&context->mutex);
+    }
+}
+
+static void unlock_if_shared(BenchContext *context) {
+    if (context->shared) {
+        pthread_mutex_unlock(&context->mutex);
+    }
+}
+
+/* ----- Benchmarks ----- */
+
+static long bench_patient_queue(BenchContext *context, int thread_index, long iterations) {
+// enqueue + P_denqueue pairs on a queue kept at `param` elements // Pares enqueue + P_denqueue em uma fila mantida com `param` elementos
+    long sum = 0;
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        enqueue(context->queue, context->patient);
+        Patient *patient = P_denqueue(context->queue);
+        unlock_if_shared(context);
+        sum += patient != NULL;
+    }
+    return sum;
+}
+
+static long bench_exam_queue(BenchContext *context, int thread_index, long iterations) {
+// enqueue + E_dequeue pairs // Pares enqueue + E_dequeue
+    long sum = 0;
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        enqueue(context->queue, context->exam);
+        Exam *exam = E_dequeue(context->queue);
+        unlock_if_shared(context);
+        sum += exam != NULL;
+    }
+    return sum;
+}
+
+static long bench_priority_queue(BenchContext *context, int thread_index, long iterations) {
+// insert_in_priority_queue + get_priority_exams with `param` exams already waiting // Inserção + retirada com `param` exames esperando
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        Exam *exam = context->exams[(i + thread_index) % context->exam_count];
+        lock_if_shared(context);
+        insert_in_priority_queue(context->priority_queue, exam);
+        Exam *next = get_priority_exams(context->priority_queue);
+        unlock_if_shared(context);
+        sum += next != NULL;
+    }
+    return sum;
+}
+
+static long bench_queue_size(BenchContext *context, int thread_index, long iterations) {
+// queue_size on a queue holding `param` elements // queue_size em uma fila com `param` elementos
+    long sum = 0;
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        sum += queue_size(context->queue);
+        unlock_if_shared(context);
+    }
+    return sum;
+}
+
+static long bench_priority_waiting(BenchContext *context, int thread_index, long iterations) {
+// priority_queue_waiting with `param` exams waiting // priority_queue_waiting com `param` exames esperando
+    long sum = 0;
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        sum += priority_queue_waiting(context->priority_queue);
+        unlock_if_shared(context);
+    }
+    return sum;
+}
+
+static long bench_patient_lifecycle(BenchContext *context, int thread_index, long iterations) {
+// create_patient + destroy_patient
+    const struct tm *arrival = bench_time();
+    (void)context;
+    for (long i = 0; i < iterations; i++) {
+        Patient *patient = create_patient(thread_index, "Ana Almeida", arrival);
+        destroy_patient(patient);
+    }
+    return 0;
+}
+
+static long bench_exam_lifecycle(BenchContext *context, int thread_index, long iterations) {
+// create_exam + destroy_exam
+    const struct tm *exam_time = bench_time();
+    (void)context;
+    for (long i = 0; i < iterations; i++) {
+        Exam *exam = create_exam(thread_index, 1, 1, conditions[i % CONDITION_COUNT], exam_time);
+        destroy_exam(exam);
+    }
+    return 0;
+}
+
+static long bench_report_lifecycle(BenchContext *context, int thread_index, long iterations) {
+// create_report + free_report
+    const struct tm *report_time = bench_time();
+    (void)context;
+    for (long i = 0; i < iterations; i++) {
+        Report *report = create_report(thread_index, conditions[i % CONDITION_COUNT], report_time);
+        free_report(report);
+    }
+    return 0;
+}
+
+static long bench_ai_priority(BenchContext *context, int thread_index, long iterations) {
+// get_ai_priority cycling through every condition // get_ai_priority percorrendo todas as condições
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += get_ai_priority(context->exams[(i + thread_index) % context->exam_count]);
+    }
+    return sum;
+}
+
+static long bench_print_patient_db(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        print_patient_db(context->patient, context->sink);
+        unlock_if_shared(context);
+    }
+    return 0;
+}
+
+static long bench_print_exam_db(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        print_exam_db(context->exam, context->sink);
+        unlock_if_shared(context);
+    }
+    return 0;
+}
+
+static long bench_print_report_db(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        lock_if_shared(context);
+        print_report_db(context->report, context->sink);
+        unlock_if_shared(context);
+    }
+    return 0;
+}
+
+static long bench_ai_kernel(BenchContext *context, AiKernel kernel, long iterations) {
+// One kernel call over a batch of `param` exams per operation // Uma chamada do kernel sobre um lote de `param` exames por operação
+    long sum = 0;
+    float probabilities[AI_MAX_BATCH * AI_CONDITIONS];
+    for (long i = 0; i < iterations; i++) {
+        kernel(context->ai_model, context->ai_features, context->param, probabilities);
+        sum += probabilities[0] > 0.5f;
+    }
+    return sum;
+}
+
+static long bench_ai_scalar(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    return bench_ai_kernel(context, ai_kernel_scalar, iterations);
+}
+
+static long bench_ai_simd(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    return bench_ai_kernel(context, ai_kernel_simd, iterations);
+}
+
+static long bench_xray_generate(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        generate_xray_image(context->image, (unsigned int)i);
+    }
+    return 0;
+}
+
+static long bench_xray_downsample(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        xray_downsample(context->image, context->scratch, context->image_kernels);
+    }
+    return 0;
+}
+
+static long bench_xray_normalize(BenchContext *context, int thread_index, long iterations) {
+// Downsampled again each time, otherwise the image would already be normalized // Reduzida de novo a cada vez, senão já estaria normalizada
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        xray_downsample(context->image, context->scratch, XRAY_SIMD);
+        xray_normalize(context->scratch, context->image_kernels);
+    }
+    return 0;
+}
+
+static long bench_xray_equalize(BenchContext *context, int thread_index, long iterations) {
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        xray_equalize(context->scratch, context->image_kernels);
+    }
+    return 0;
+}
+
+static long bench_xray_features(BenchContext *context, int thread_index, long iterations) {
+    long sum = 0;
+    float features[XRAY_FEATURES];
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        xray_extract_features(context->scratch, features, context->image_kernels);
+        sum += features[0] > 0;
+    }
+    return sum;
+}
+
+static long bench_xray_pipeline(BenchContext *context, int thread_index, long iterations) {
+    long sum = 0;
+    float features[XRAY_FEATURES];
+    (void)thread_index;
+    for (long i = 0; i < iterations; i++) {
+        xray_preprocess(context->image, context->scratch, features, context->image_kernels);
+        sum += features[0] > 0;
+    }
+    return sum;
+}
+
+static int xray_kernels_match(int size) {
+// Validates every SIMD image kernel against the scalar reference, pixel for pixel // Valida cada kernel SIMD contra a referência escalar, pixel a pixel
+    XrayImage *image = create_xray_image(size, size);
+    XrayImage *reference = create_xray_image(size / 2, size / 2);
+    XrayImage *vectorized = create_xray_image(size / 2, size / 2);
+    float reference_features[XRAY_FEATURES], vectorized_features[XRAY_FEATURES];
+    size_t bytes = (size_t)(size / 2) * (size / 2);
+    int match = 1;
+
+    generate_xray_image(image, 3);
+    xray_downsample(image, reference, XRAY_SCALAR);
+    xray_downsample(image, vectorized, XRAY_SIMD);
+    match &= memcmp(reference->pixels, vectorized->pixels, bytes) == 0;
+    xray_normalize(reference, XRAY_SCALAR);
+    xray_normalize(vectorized, XRAY_SIMD);
+    match &= memcmp(reference->pixels, vectorized->pixels, bytes) == 0;
+    xray_equalize(reference, XRAY_SCALAR);
+    xray_equalize(vectorized, XRAY_SIMD);
+    match &= memcmp(reference->pixels, vectorized->pixels, bytes) == 0;
+    xray_extract_features(reference, reference_features, XRAY_SCALAR);
+    xray_extract_features(vectorized, vectorized_features, XRAY_SIMD);
+    match &= memcmp(reference_features, vectorized_features, sizeof(reference_features)) == 0;
+
+    destroy_xray_image(vectorized);
+    destroy_xray_image(reference);
+    destroy_xray_image(image);
+    return match;
+}
+
+static float ai_kernels_max_difference(BenchContext *context) {
+// Validates the SIMD kernel against the scalar reference // Valida o kernel SIMD contra a referência escalar
+    float reference[AI_MAX_BATCH * AI_CONDITIONS];
+    float vectorized[AI_MAX_BATCH * AI_CONDITIONS];
+    float largest = 0;
+
+    for (int batch = 1; batch <= AI_MAX_BATCH; batch++) {
+        ai_kernel_scalar(context->ai_model, context->ai_features, batch, reference);
+        ai_kernel_simd(context->ai_model, context->ai_features, batch, vectorized);
+        for (int i = 0; i < batch * AI_CONDITIONS; i++) {
+            float difference = reference[i] > vectorized[i] ? reference[i] - vectorized[i] : vectorized[i] - reference[i];
+            if (difference > largest) {
+                largest = difference;
+            }
+        }
+    }
+    return largest;
+}
+
+/* ----- Harness ----- */
+
+static void *bench_thread_main(void *args) {
+    BenchThread *thread = (BenchThread*)args;
+    pthread_barrier_wait(&thread->context->start);
+    thread->start = now_seconds();
+    thread->checksum = thread->context->function(thread->context, thread->index, thread->iterations);
+    thread->end = now_seconds();
+    return NULL;
+}
+
+static void prefill_queue(V_queue *queue, void *data, int count) {
+    for (int i = 0; i < count; i++) {
+        enqueue(queue, data);
+    }
+}
+
+static void prefill_priority_queue(BenchContext *context, int count) {
+    for (int i = 0; i < count; i++) {
+        insert_in_priority_queue(context->priority_queue, context->exams[i % context->exam_count]);
+    }
+}
+
+static void drain_queue(V_queue *queue) {
+// The queue only holds borrowed pointers: remove the nodes without destroying the data // A fila só guarda ponteiros emprestados
+    while (!is_queue_empty(queue)) {
+        E_dequeue(queue);
+    }
+}
+
+static void drain_priority_queue(ExamPriorityQueue *queue) {
+    while (!is_priority_queue_empty(queue)) {
+        get_priority_exams(queue);
+    }
+}
+
+static void run_benchmark(BenchContext *context, const char *name, BenchFunction function,
+                          int param, int threads, long iterations) {
+// Runs one benchmark and prints its JSON object // Executa um benchmark e imprime seu objeto JSON
+    pthread_t ids[BENCH_MAX_THREADS];
+    BenchThread args[BENCH_MAX_THREADS];
+
+    context->function = function;
+    context->param = param;
+    context->shared = threads > 1;
+    pthread_barrier_init(&context->start, NULL, threads + 1);
+
+    for (int i = 0; i < threads; i++) {
+        args[i].context = context;
+        args[i].index = i;
+        args[i].iterations = iterations;
+        pthread_create(&ids[i], NULL, bench_thread_main, &args[i]);
+    }
+
+    pthread_barrier_wait(&context->start); // Every thread is created before any starts // Todas criadas antes de começar
+
+    // From the first worker starting to the last one finishing // Do primeiro a começar ao último a terminar
+    double start = 0, end = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        if (i == 0 || args[i].start < start) {
+            start = args[i].start;
+        }
+        if (i == 0 || args[i].end > end) {
+            end = args[i].end;
+        }
+        checksum += args[i].checksum;
+    }
+    pthread_barrier_destroy(&context->start);
+    double elapsed = end - start;
+
+    double operations = (double)iterations * threads;
+    printf("%s    {\"name\": \"%s\", \"param\": %d, \"threads\": %d, \"iterations\": %ld, "
+           "\"seconds\": %.6f, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f}",
+           first_result ? "" : ",\n", name, param, threads, iterations,
+           elapsed, elapsed * 1e9 / operations, operations / elapsed);
+    first_result = 0;
+    fflush(stdout);
+}
+
+static int matches(const char *filter, const char *name) {
+    return !filter || strstr(name, filter) != NULL;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -n, --iterations N   Operations per thread (default %d)\n", BENCH_DEFAULT_ITERATIONS);
+    printf("  -t, --threads N      Threads for the contended variants (default 4, max %d)\n", BENCH_MAX_THREADS);
+    printf("  -f, --filter TEXT    Only run benchmarks whose name contains TEXT\n");
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option options[] = {
+        {"iterations", required_argument, NULL, 'n'},
+        {"threads", required_argument, NULL, 't'},
+        {"filter", required_argument, NULL, 'f'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const int backlogs[] = {0, 100, 10000};
+    long iterations = BENCH_DEFAULT_ITERATIONS;
+    int contended_threads = 4;
+    const char *filter = NULL;
+    int option;
+
+    while ((option = getopt_long(argc, argv, "n:t:f:h", options, NULL)) != -1) {
+        switch (option) {
+        case 'n': iterations = atol(optarg); break;
+        case 't': contended_threads = atoi(optarg); break;
+        case 'f': filter = optarg; break;
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (iterations < 1 || contended_threads < 1 || contended_threads > BENCH_MAX_THREADS) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    log_set_quiet(1); // The TADs log on every call; benchmarks measure the work, not the console
+    rng_seed(1);
+
+    BenchContext context;
+    memset(&context, 0, sizeof(context));
+    pthread_mutex_init(&context.mutex, NULL);
+    context.queue = create_queue();
+    context.priority_queue = new_priority_queue();
+    context.sink = fopen("/dev/null", "w");
+    if (!context.queue || !context.sink) {
+        printf("Error: could not set up the benchmarks\n");
+        return 1;
+    }
+
+    context.exam_count = CONDITION_COUNT;
+    context.exams = (Exam**)malloc(sizeof(Exam*) * CONDITION_COUNT);
+    if (!context.exams) {
+        printf("Error: Memory allocation failed (bench exams)\n");
+        return 1;
+    }
+    for (int i = 0; i < CONDITION_COUNT; i++) {
+        context.exams[i] = create_exam(i + 1, 1, i + 1, conditions[i], bench_time());
+    }
+    context.patient = create_patient(1, "Ana Almeida", bench_time());
+    context.exam = context.exams[0];
+    context.report = create_report(1, conditions[1], bench_time());
+
+    context.ai_model = create_ai_model(1);
+    context.ai_features = (float*)malloc(sizeof(float) * AI_MAX_BATCH * AI_FEATURES);
+    if (!context.ai_features) {
+        printf("Error: Memory allocation failed (bench features)\n");
+        return 1;
+    }
+    for (int i = 0; i < AI_MAX_BATCH; i++) {
+        ai_random_features(context.ai_features + i * AI_FEATURES);
+    }
+    float ai_difference = ai_kernels_max_difference(&context);
+    if (ai_difference > 1e-5f) {
+        fprintf(stderr, "Error: SIMD AI kernel differs from the scalar reference by %g\n", ai_difference);
+        return 1;
+    }
+
+    // Odd sizes exercise the scalar tails of the SIMD loops // Tamanhos ímpares exercitam as sobras escalares dos laços SIMD
+    static const int validation_sizes[] = {64, 131, 512, 1026};
+    for (int i = 0; i < 4; i++) {
+        if (!xray_kernels_match(validation_sizes[i])) {
+            fprintf(stderr, "Error: SIMD image kernels differ from the scalar reference at %dx%d\n", validation_sizes[i], validation_sizes[i]);
+            return 1;
+        }
+    }
+
+    int variants[2] = {1, contended_threads};
+    int variant_count = contended_threads > 1 ? 2 : 1;
+
+    printf("{\n  \"iterations\": %ld,\n  \"benchmarks\": [\n", iterations);
+
+    for (int v = 0; v < variant_count; v++) {
+        int threads = variants[v];
+
+        if (matches(filter, "queue/enqueue_P_denqueue")) {
+            run_benchmark(&context, "queue/enqueue_P_denqueue", bench_patient_queue, 0, threads, iterations);
+        }
+        if (matches(filter, "queue/enqueue_E_dequeue")) {
+            run_benchmark(&context, "queue/enqueue_E_dequeue", bench_exam_queue, 0, threads, iterations);
+        }
+
+        for (int b = 0; b < 3; b++) {
+            if (matches(filter, "priority/insert_get")) {
+                prefill_priority_queue(&context, backlogs[b]);
+                run_benchmark(&context, "priority/insert_get", bench_priority_queue, backlogs[b], threads, iterations);
+                drain_priority_queue(context.priority_queue);
+            }
+            // queue_size and priority_queue_waiting read counts kept by the queues: the backlog shouldn't change them
+            if (matches(filter, "queue/queue_size")) {
+                prefill_queue(context.queue, context.exam, backlogs[b]);
+                run_benchmark(&context, "queue/queue_size", bench_queue_size, backlogs[b], threads, iterations);
+                drain_queue(context.queue);
+            }
+            if (matches(filter, "priority/waiting")) {
+                prefill_priority_queue(&context, backlogs[b]);
+                run_benchmark(&context, "priority/waiting", bench_priority_waiting, backlogs[b], threads, iterations);
+                drain_priority_queue(context.priority_queue);
+            }
+        }
+
+        if (matches(filter, "alloc/patient")) {
+            run_benchmark(&context, "alloc/patient", bench_patient_lifecycle, 0, threads, iterations);
+        }
+        if (matches(filter, "alloc/exam")) {
+            run_benchmark(&context, "alloc/exam", bench_exam_lifecycle, 0, threads, iterations);
+        }
+        if (matches(filter, "alloc/report")) {
+            run_benchmark(&context, "alloc/report", bench_report_lifecycle, 0, threads, iterations);
+        }
+        if (matches(filter, "lookup/get_ai_priority")) {
+            run_benchmark(&context, "lookup/get_ai_priority", bench_ai_priority, 0, threads, iterations);
+        }
+        if (matches(filter, "db/print_patient_db")) {
+            run_benchmark(&context, "db/print_patient_db", bench_print_patient_db, 0, threads, iterations);
+        }
+        if (matches(filter, "db/print_exam_db")) {
+            run_benchmark(&context, "db/print_exam_db", bench_print_exam_db, 0, threads, iterations);
+        }
+        if (matches(filter, "db/print_report_db")) {
+            run_benchmark(&context, "db/print_report_db", bench_print_report_db, 0, threads, iterations);
+        }
+        // Image kernels at two resolutions; param is the acquired image side, iterations are scaled to the pixel count
+        static const int image_sizes[] = {512, 2048};
+        for (int s = 0; threads == 1 && s < 2; s++) {
+            static const char *kernel_names[] = {"scalar", "simd"};
+            long image_iterations = iterations / (image_sizes[s] * image_sizes[s] / 1024) + 1;
+            context.image = create_xray_image(image_sizes[s], image_sizes[s]);
+            context.scratch = create_xray_image(image_sizes[s] / 2, image_sizes[s] / 2);
+            generate_xray_image(context.image, 3);
+            xray_downsample(context.image, context.scratch, XRAY_SCALAR);
+
+            if (matches(filter, "xray/generate")) {
+                run_benchmark(&context, "xray/generate", bench_xray_generate, image_sizes[s], threads, image_iterations);
+            }
+            for (int k = 0; k < 2; k++) {
+                char name[64];
+                context.image_kernels = k == 0 ? XRAY_SCALAR : XRAY_SIMD;
+                struct { const char *stage; BenchFunction function; } stages[] = {
+                    {"downsample", bench_xray_downsample}, {"normalize", bench_xray_normalize},
+                    {"equalize", bench_xray_equalize}, {"features", bench_xray_features}, {"pipeline", bench_xray_pipeline}
+                };
+                for (int st = 0; st < 5; st++) {
+                    snprintf(name, sizeof(name), "xray/%s_%s", stages[st].stage, kernel_names[k]);
+                    if (matches(filter, name)) {
+                        run_benchmark(&context, name, stages[st].function, image_sizes[s], threads, image_iterations);
+                    }
+                }
+            }
+            destroy_xray_image(context.scratch);
+            destroy_xray_image(context.image);
+        }
+        // The kernels share nothing, so only the single thread variant is meaningful; param is the batch size
+        for (int batch = 1; threads == 1 && batch <= AI_MAX_BATCH; batch *= 4) {
+            if (matches(filter, "ai/kernel_scalar")) {
+                run_benchmark(&context, "ai/kernel_scalar", bench_ai_scalar, batch, threads, iterations / batch + 1);
+            }
+            if (matches(filter, "ai/kernel_simd")) {
+                run_benchmark(&context, "ai/kernel_simd", bench_ai_simd, batch, threads, iterations / batch + 1);
+            }
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    for (int i = 0; i < CONDITION_COUNT; i++) {
+        destroy_exam(context.exams[i]);
+    }
+    free(context.exams);
+    free(context.ai_features);
+    destroy_ai_model(context.ai_model);
+    destroy_patient(context.patient);
+    free_report(context.report);
+    E_free_queue(context.queue);
+    free_priority_queue(context.priority_queue);
+    fclose(context.sink);
+    pthread_mutex_destroy(&context.mutex);
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*
+ * File layout // Formato do arquivo
+ *
+ *   CheckpointHeader | CheckpointState | SavedPatient x patients | SavedExam x exams | uint64 FNV-1a of all before
+ *
+ * Raw structs in the byte order of the machine: a checkpoint is restored by the same build that wrote it, and the
+ * sizes in the header refuse any other one.
+ */
+
+typedef struct checkpoint_header {
+    char magic[8];                   // CHECKPOINT_MAGIC, not terminated // Não terminado
+    uint32_t version;
+    uint32_t state_size;             // sizeof(CheckpointState)
+    uint32_t patient_size;           // sizeof(SavedPatient)
+    uint32_t exam_size;              // sizeof(SavedExam)
+    uint32_t patients;
+    uint32_t exams;
+} CheckpointHeader;
+
+typedef struct saved_patient {
+    int32_t place;                   // CheckpointPlace
+    PatientRecord record;
+} SavedPatient;
+
+typedef struct saved_exam {
+    int32_t place;                   // CheckpointPlace
+    ExamRecord record;
+} SavedExam;
+
+typedef struct ledger_entry {
+    Exam *exam;                      // Identifies the exam, never dereferenced after exam_ledger_add() // Só identifica o exame
+    int started;                     // A doctor took it // Um médico o pegou
+    ExamRecord record;
+} LedgerEntry;
+
+struct exam_ledger {
+    pthread_mutex_t mutex;
+    LedgerEntry *entries;
+    int size;
+    int capacity;
+};
+
+struct checkpoint_writer {
+    SavedPatient *patients;
+    int patient_count;
+    int patient_capacity;
+    SavedExam *exams;
+    int exam_count;
+    int exam_capacity;
+};
+
+struct checkpoint {
+    unsigned char *data;             // The whole file // O arquivo inteiro
+    const CheckpointHeader *header;
+    const CheckpointState *state;
+    const SavedPatient *patients;
+    const SavedExam *exams;
+};
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+// FNV-1a, continued over each block written // FNV-1a, continuado a cada bloco gravado
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+static void *grow(void *array, int *capacity, size_t item_size, const char *what) {
+// Doubles an array, 64 items at first // Dobra um array, 64 itens no início
+    int wanted = *capacity ? *capacity * 2 : 64;
+    void *bigger = realloc(array, wanted * item_size);
+    if (!bigger) {
+        printf("\nError: Memory allocation failed (%s)\n", what);
+        exit(1);
+    }
+    *capacity = wanted;
+    return bigger;
+}
+
+ExamLedger *create_exam_ledger(void) {
+/**
+ * \brief Create an empty ledger // Cria um registro vazio
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ExamLedger* - Pointer to the ledger // Ponteiro para o registro
+ */
+    ExamLedger *ledger = (ExamLedger*)calloc(1, sizeof(ExamLedger));
+    if (!ledger) {
+        printf("\nError: Memory allocation failed (Exam Ledger)\n");
+        exit(1);
+    }
+    pthread_mutex_init(&ledger->mutex, NULL);
+    return ledger;
+}
+
+void destroy_exam_ledger(ExamLedger *ledger) {
+/**
+ * \brief Free the ledger // Libera o registro
+ */
+    if (!ledger) {
+        return;
+    }
+    pthread_mutex_destroy(&ledger->mutex);
+    free(ledger->entries);
+    free(ledger);
+}
+
+void exam_ledger_lock(ExamLedger *ledger) {
+/**
+ * \brief Lock the ledger // Trava o registro
+ */
+    if (ledger) {
+        pthread_mutex_lock(&ledger->mutex);
+    }
+}
+
+void exam_ledger_unlock(ExamLedger *ledger) {
+/**
+ * \brief Unlock the ledger // Destrava o registro
+ */
+    if (ledger) {
+        pthread_mutex_unlock(&ledger->mutex);
+    }
+}
+
+void exam_ledger_add(ExamLedger *ledger, Exam *exam) {
+/**
+ * \brief Record an exam handed to the doctors // Registra um exame entregue aos médicos
+ */
+    if (!ledger) {
+        return;
+    }
+    if (ledger->size == ledger->capacity) {
+        ledger->entries = (LedgerEntry*)grow(ledger->entries, &ledger->capacity, sizeof(LedgerEntry), "Exam Ledger");
+    }
+    LedgerEntry *entry = &ledger->entries[ledger->size++];
+    entry->exam = exam;
+    entry->started = 0;
+    pack_exam(exam, &entry->record);
+}
+
+static LedgerEntry *find_entry(ExamLedger *ledger, Exam *exam) {
+// The ledger holds only the exams the doctors have at once, so a linear search is enough // Busca linear basta
+    for (int i = 0; i < ledger->size; i++) {
+        if (ledger->entries[i].exam == exam) {
+            return &ledger->entries[i];
+        }
+    }
+    return NULL;
+}
+
+void exam_ledger_start(ExamLedger *ledger, Exam *exam) {
+/**
+ * \brief Mark an exam as taken by a doctor // Marca um exame como pego por um médico
+ */
+    LedgerEntry *entry = ledger ? find_entry(ledger, exam) : NULL;
+    if (entry) {
+        entry->started = 1;
+    }
+}
+
+void exam_ledger_remove(ExamLedger *ledger, Exam *exam) {
+/**
+ * \brief Forget an exam; the last entry takes the freed place // Esquece um exame; a última entrada ocupa o lugar liberado
+ */
+    LedgerEntry *entry = ledger ? find_entry(ledger, exam) : NULL;
+    if (entry) {
+        *entry = ledger->entries[--ledger->size];
+    }
+}
+
+CheckpointWriter *begin_checkpoint(void) {
+/**
+ * \brief Start collecting a checkpoint // Começa a coletar um checkpoint
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return CheckpointWriter* - Pointer to the writer // Ponteiro para o coletor
+ */
+    CheckpointWriter *writer = (CheckpointWriter*)calloc(1, sizeof(CheckpointWriter));
+    if (!writer) {
+        printf("\nError: Memory allocation failed (Checkpoint)\n");
+        exit(1);
+    }
+    return writer;
+}
+
+void checkpoint_add_patient(CheckpointWriter *writer, CheckpointPlace place, Patient *patient) {
+/**
+ * \brief Save a patient // Salva um paciente
+ */
+    if (writer->patient_count == writer->patient_capacity) {
+        writer->patients = (SavedPatient*)grow(writer->patients, &writer->patient_capacity, sizeof(SavedPatient), "Checkpoint");
+    }
+    SavedPatient *saved = &writer->patients[writer->patient_count++];
+    saved->place = place;
+    pack_patient(patient, &saved->record);
+}
+
+static void add_exam_record(CheckpointWriter *writer, CheckpointPlace place, const ExamRecord *record) {
+    if (writer->exam_count == writer->exam_capacity) {
+        writer->exams = (SavedExam*)grow(writer->exams, &writer->exam_capacity, sizeof(SavedExam), "Checkpoint");
+    }
+    SavedExam *saved = &writer->exams[writer->exam_count++];
+    saved->place = place;
+    saved->record = *record;
+}
+
+void checkpoint_add_exam(CheckpointWriter *writer, CheckpointPlace place, Exam *exam) {
+/**
+ * \brief Save an exam // Salva um exame
+ */
+    ExamRecord record;
+    pack_exam(exam, &record);
+    add_exam_record(writer, place, &record);
+}
+
+void checkpoint_add_ledger(CheckpointWriter *writer, ExamLedger *ledger) {
+/**
+ * \brief Save every exam of a ledger // Salva cada exame do registro
+ */
+    if (!ledger) {
+        return;
+    }
+    for (int i = 0; i < ledger->size; i++) {
+        add_exam_record(writer, ledger->entries[i].started ? CHECKPOINT_EXAM_DOCTORS : CHECKPOINT_EXAM_ROUTED,
+                        &ledger->entries[i].record);
+    }
+}
+
+static int write_block(FILE *file, const void *data, size_t size, uint64_t *hash) {
+    *hash = fnv1a(*hash, data, size);
+    return size == 0 || fwrite(data, size, 1, file) == 1 ? 0 : -1;
+}
+
+static void free_writer(CheckpointWriter *writer) {
+    free(writer->patients);
+    free(writer->exams);
+    free(writer);
+}
+
+int commit_checkpoint(CheckpointWriter *writer, const CheckpointState *state, const char *path) {
+/**
+ * \brief Write the checkpoint and free the writer // Grava o checkpoint e libera o coletor
+ *
+ * \return int - 0 on success, -1 with errno set // 0 em caso de sucesso, -1 com errno definido
+ */
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        free_writer(writer);
+        return -1;
+    }
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.state_size = sizeof(CheckpointState);
+    header.patient_size = sizeof(SavedPatient);
+    header.exam_size = sizeof(SavedExam);
+    header.patients = writer->patient_count;
+    header.exams = writer->exam_count;
+
+    uint64_t hash = FNV_OFFSET;
+    int failed = write_block(file, &header, sizeof(header), &hash) ||
+                 write_block(file, state, sizeof(*state), &hash) ||
+                 write_block(file, writer->patients, writer->patient_count * sizeof(SavedPatient), &hash) ||
+                 write_block(file, writer->exams, writer->exam_count * sizeof(SavedExam), &hash) ||
+                 fwrite(&hash, sizeof(hash), 1, file) != 1 ||
+                 fflush(file) != 0 || fsync(fileno(file)) != 0;
+    failed = fclose(file) != 0 || failed;
+    free_writer(writer);
+    if (failed || rename(temporary, path) != 0) {
+        int saved_errno = errno;
+        unlink(temporary);
+        errno = saved_errno;
+        return -1;
+    }
+    return 0;
+}
+
+Checkpoint *load_checkpoint(const char *path) {
+/**
+ * \brief Read a checkpoint // Lê um checkpoint
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return Checkpoint* - Pointer to the checkpoint, NULL if it can't be used // Ponteiro para o checkpoint, NULL se não puder ser usado
+ */
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < (long)(sizeof(CheckpointHeader) + sizeof(CheckpointState) + sizeof(uint64_t))) {
+        fclose(file);
+        return NULL;
+    }
+
+    Checkpoint *checkpoint = (Checkpoint*)calloc(1, sizeof(Checkpoint));
+    unsigned char *data = (unsigned char*)malloc(size);
+    if (!checkpoint || !data) {
+        printf("\nError: Memory allocation failed (Checkpoint)\n");
+        exit(1);
+    }
+    int read_ok = fread(data, size, 1, file) == 1;
+    fclose(file);
+    checkpoint->data = data;
+
+    const CheckpointHeader *header = (const CheckpointHeader*)data;
+    size_t expected = sizeof(CheckpointHeader) + sizeof(CheckpointState);
+    int valid = read_ok && memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == CHECKPOINT_VERSION && header->state_size == sizeof(CheckpointState) &&
+                header->patient_size == sizeof(SavedPatient) && header->exam_size == sizeof(SavedExam);
+    if (valid) {
+        expected += (size_t)header->patients * sizeof(SavedPatient) + (size_t)header->exams * sizeof(SavedExam);
+        uint64_t stored;
+        valid = (size_t)size == expected + sizeof(stored);
+        if (valid) {
+            memcpy(&stored, data + expected, sizeof(stored));
+            valid = stored == fnv1a(FNV_OFFSET, data, expected);
+        }
+    }
+    if (!valid) {
+        free_checkpoint(checkpoint);
+        return NULL;
+    }
+
+    // Every block is a multiple of 8 bytes, so the records are aligned inside the buffer // Registros alinhados no buffer
+    checkpoint->header = header;
+    checkpoint->state = (const CheckpointState*)(data + sizeof(CheckpointHeader));
+    checkpoint->patients = (const SavedPatient*)(data + sizeof(CheckpointHeader) + sizeof(CheckpointState));
+    checkpoint->exams = (const SavedExam*)(checkpoint->patients + header->patients);
+    return checkpoint;
+}
+
+void free_checkpoint(Checkpoint *checkpoint) {
+/**
+ * \brief Free a checkpoint // Libera um checkpoint
+ */
+    if (!checkpoint) {
+        return;
+    }
+    free(checkpoint->data);
+    free(checkpoint);
+}
+
+const CheckpointState *get_checkpoint_state(const Checkpoint *checkpoint) {
+/**
+ * \brief Counters and generator states of a checkpoint // Contadores e estados dos geradores de um checkpoint
+ */
+    return checkpoint->state;
+}
+
+int checkpoint_patient_count(const Checkpoint *checkpoint) {
+/**
+ * \brief Number of saved patients // Número de pacientes salvos
+ */
+    return (int)checkpoint->header->patients;
+}
+
+Patient *checkpoint_patient(const Checkpoint *checkpoint, int index, CheckpointPlace *place) {
+/**
+ * \brief Rebuild a saved patient // Reconstrói um paciente salvo
+ *
+ * \return Patient* - New patient // Novo paciente
+ */
+    const SavedPatient *saved = &checkpoint->patients[index];
+    *place = (CheckpointPlace)saved->place;
+    return unpack_patient(&saved->record);
+}
+
+int checkpoint_exam_count(const Checkpoint *checkpoint) {
+/**
+ * \brief Number of saved exams // Número de exames salvos
+ */
+    return (int)checkpoint->header->exams;
+}
+
+Exam *checkpoint_exam(const Checkpoint *checkpoint, int index, CheckpointPlace *place) {
+/**
+ * \brief Rebuild a saved exam // Reconstrói um exame salvo
+ *
+ * \return Exam* - New exam // Novo exame
+ */
+    const SavedExam *saved = &checkpoint->exams[index];
+    *place = (CheckpointPlace)saved->place;
+    return unpack_exam(&saved->record);
+}
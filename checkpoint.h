@@ -0,0 +1,225 @@
+#ifndef CHECKPOINT_H_INCLUDED
+#define CHECKPOINT_H_INCLUDED
+
+#include "pipeline_record.h"
+#include "admission.h"
+#include "shutdown.h"
+#include "arrivals.h"
+#include "dashboard.h"
+#include "rng.h"
+#include "stream_stats.h"
+
+#define CHECKPOINT_MAGIC "CLINCKPT"
+#define CHECKPOINT_VERSION 3
+
+/**
+ * \brief Where a saved patient or exam was when the checkpoint was taken // Onde um paciente ou exame salvo estava no checkpoint
+ */
+typedef enum checkpoint_place {
+    CHECKPOINT_PATIENT_QUEUE,      // Waiting for a machine // Esperando uma máquina
+    CHECKPOINT_PATIENT_OVERFLOW,   // Parked by OVERFLOW_DIVERT // Estacionado por OVERFLOW_DIVERT
+    CHECKPOINT_EXAM_QUEUE,         // Waiting in a priority level // Esperando em um nível de prioridade
+    CHECKPOINT_EXAM_OVERFLOW,      // Parked in the overflow queue of its level // Estacionado na fila de estouro do seu nível
+    CHECKPOINT_EXAM_PENDING,       // OVERFLOW_BLOCK: waiting for room in the priority queue // Esperando espaço na fila de prioridade
+    CHECKPOINT_EXAM_ROUTED,        // In the deque of a doctor // Na deque de um médico
+    CHECKPOINT_EXAM_DOCTORS        // A doctor is writing its report // Um médico está escrevendo o laudo
+} CheckpointPlace;
+
+/**
+ * \brief Counters and generator states of a run, the fixed part of a checkpoint // Contadores e estados dos geradores, a parte fixa de um checkpoint
+ *
+ * \details Names follow the counters of main.c and DashboardSnapshot. // Os nomes seguem os contadores de main.c e DashboardSnapshot.
+ */
+typedef struct checkpoint_state {
+    double tempo_total;                          // Simulated time // Tempo simulado
+    double time_reports;
+    int pacientes_totais;
+    int reports_finalizados;
+    int reports_tempo_ok;
+    int ia_exames_realizados;
+    int trace_labeled;
+    int trace_agreed;
+    int pacientes_fila_prioridade;
+    int machines;                                // Pool size after the SIGUSR1/SIGUSR2 resizes // Tamanho do pool após os redimensionamentos
+    ReportStream reports;                        // Report statistics, windows included // Estatísticas dos laudos, com as janelas
+    int report_histogram[DASHBOARD_HIST_BINS];
+    AdmissionStats patient_admission;
+    AdmissionStats exam_admission[6];            // Per priority level (index 0 = priority 1) // Por nível de prioridade
+    StageAccount stages[SHUTDOWN_STAGE_COUNT];
+    RngState rng;
+    ArrivalState arrival;
+    int arriving;                                // Patients already sampled that had not arrived yet // Pacientes já sorteados que ainda não tinham chegado
+    double arrival_gap;                          // Their gap // O intervalo deles
+    long long db_sizes[3];                       // Bytes of db_patient.txt, db_exam.txt and db_report.txt // Bytes dos arquivos db_*.txt
+} CheckpointState;
+
+// Exams handed to the doctors and not reported yet, so a checkpoint can save them // Exames entregues aos médicos e ainda sem laudo
+typedef struct exam_ledger ExamLedger;
+
+// A checkpoint being collected, written by commit_checkpoint() // Um checkpoint sendo coletado, gravado por commit_checkpoint()
+typedef struct checkpoint_writer CheckpointWriter;
+
+// A checkpoint read back from disk // Um checkpoint lido do disco
+typedef struct checkpoint Checkpoint;
+
+/**
+ * \brief Create an empty ledger // Cria um registro vazio
+ *
+ * \return Pointer to the ledger // Ponteiro para o registro
+ */
+ExamLedger *create_exam_ledger(void);
+
+/**
+ * \brief Free the ledger; the exams are not touched // Libera o registro; os exames não são tocados
+ *
+ * \param ledger - Pointer to the ledger, may be NULL // Ponteiro para o registro, pode ser NULL
+ */
+void destroy_exam_ledger(ExamLedger *ledger);
+
+/**
+ * \brief Lock the ledger; every other ledger call needs it locked // Trava o registro; as outras chamadas precisam dele travado
+ *
+ * \details A doctor keeps it locked from its counters until its report line is written, so a checkpoint sees the
+ *          exam either in the ledger or in db_report.txt and the counters, never in both or in neither.
+ * \details Um médico o mantém travado dos contadores até a linha do laudo ser escrita, então um checkpoint vê o
+ *          exame no registro ou em db_report.txt e nos contadores, nunca nos dois nem em nenhum.
+ * \param ledger - Pointer to the ledger, NULL does nothing // Ponteiro para o registro, NULL não faz nada
+ */
+void exam_ledger_lock(ExamLedger *ledger);
+
+/**
+ * \brief Unlock the ledger // Destrava o registro
+ *
+ * \param ledger - Pointer to the ledger, NULL does nothing // Ponteiro para o registro, NULL não faz nada
+ */
+void exam_ledger_unlock(ExamLedger *ledger);
+
+/**
+ * \brief Record an exam handed to the doctors // Registra um exame entregue aos médicos
+ *
+ * \param ledger - Locked ledger, NULL does nothing // Registro travado, NULL não faz nada
+ * \param exam - The exam; it is flattened now, the pointer only identifies it later // O exame; é achatado agora, o ponteiro só o identifica depois
+ */
+void exam_ledger_add(ExamLedger *ledger, Exam *exam);
+
+/**
+ * \brief Mark an exam as taken by a doctor, once SHUTDOWN_STAGE_EXAMS counted it // Marca um exame como pego por um médico
+ *
+ * \param ledger - Locked ledger, NULL does nothing // Registro travado, NULL não faz nada
+ * \param exam - Pointer given to exam_ledger_add() // Ponteiro dado a exam_ledger_add()
+ */
+void exam_ledger_start(ExamLedger *ledger, Exam *exam);
+
+/**
+ * \brief Forget an exam that was reported or abandoned // Esquece um exame que recebeu laudo ou foi abandonado
+ *
+ * \param ledger - Locked ledger, NULL does nothing // Registro travado, NULL não faz nada
+ * \param exam - Pointer given to exam_ledger_add() // Ponteiro dado a exam_ledger_add()
+ */
+void exam_ledger_remove(ExamLedger *ledger, Exam *exam);
+
+/**
+ * \brief Start collecting a checkpoint // Começa a coletar um checkpoint
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ * \return Pointer to the writer // Ponteiro para o coletor
+ */
+CheckpointWriter *begin_checkpoint(void);
+
+/**
+ * \brief Save a patient // Salva um paciente
+ *
+ * \param writer - Pointer to the writer // Ponteiro para o coletor
+ * \param place - CheckpointPlace of the patient // CheckpointPlace do paciente
+ * \param patient - The patient, only read // O paciente, só lido
+ */
+void checkpoint_add_patient(CheckpointWriter *writer, CheckpointPlace place, Patient *patient);
+
+/**
+ * \brief Save an exam; its image is not saved // Salva um exame; sua imagem não é salva
+ *
+ * \param writer - Pointer to the writer // Ponteiro para o coletor
+ * \param place - CheckpointPlace of the exam // CheckpointPlace do exame
+ * \param exam - The exam, only read // O exame, só lido
+ */
+void checkpoint_add_exam(CheckpointWriter *writer, CheckpointPlace place, Exam *exam);
+
+/**
+ * \brief Save every exam of a ledger, as CHECKPOINT_EXAM_DOCTORS once started, CHECKPOINT_EXAM_ROUTED before
+ *        // Salva cada exame do registro, como CHECKPOINT_EXAM_DOCTORS depois de iniciado, CHECKPOINT_EXAM_ROUTED antes
+ *
+ * \param writer - Pointer to the writer // Ponteiro para o coletor
+ * \param ledger - Locked ledger, NULL saves nothing // Registro travado, NULL não salva nada
+ */
+void checkpoint_add_ledger(CheckpointWriter *writer, ExamLedger *ledger);
+
+/**
+ * \brief Write the checkpoint and free the writer // Grava o checkpoint e libera o coletor
+ *
+ * \details Written to <path>.tmp, synced, then renamed over `path`: a crash leaves the previous checkpoint intact.
+ * \details Gravado em <path>.tmp, sincronizado e renomeado sobre `path`: uma queda mantém o checkpoint anterior intacto.
+ * \param writer - Pointer to the writer // Ponteiro para o coletor
+ * \param state - Counters and generator states // Contadores e estados dos geradores
+ * \param path - Checkpoint file // Arquivo do checkpoint
+ * \return 0 on success, -1 with errno set // 0 em caso de sucesso, -1 com errno definido
+ */
+int commit_checkpoint(CheckpointWriter *writer, const CheckpointState *state, const char *path);
+
+/**
+ * \brief Read a checkpoint // Lê um checkpoint
+ *
+ * \details One read of the whole file; the records are used in place. A file from another version or build,
+ *          cut short or with a bad checksum is refused.
+ * \details Uma leitura do arquivo inteiro; os registros são usados no lugar. Um arquivo de outra versão ou build,
+ *          truncado ou com checksum errado é recusado.
+ * \param path - Checkpoint file // Arquivo do checkpoint
+ * \return Pointer to the checkpoint, NULL if it can't be used // Ponteiro para o checkpoint, NULL se não puder ser usado
+ */
+Checkpoint *load_checkpoint(const char *path);
+
+/**
+ * \brief Free a checkpoint // Libera um checkpoint
+ *
+ * \param checkpoint - Pointer to the checkpoint, may be NULL // Ponteiro para o checkpoint, pode ser NULL
+ */
+void free_checkpoint(Checkpoint *checkpoint);
+
+/**
+ * \brief Counters and generator states of a checkpoint // Contadores e estados dos geradores de um checkpoint
+ *
+ * \param checkpoint - Pointer to the checkpoint // Ponteiro para o checkpoint
+ * \return Pointer valid until free_checkpoint() // Ponteiro válido até free_checkpoint()
+ */
+const CheckpointState *get_checkpoint_state(const Checkpoint *checkpoint);
+
+/**
+ * \brief Number of saved patients // Número de pacientes salvos
+ */
+int checkpoint_patient_count(const Checkpoint *checkpoint);
+
+/**
+ * \brief Rebuild a saved patient // Reconstrói um paciente salvo
+ *
+ * \param checkpoint - Pointer to the checkpoint // Ponteiro para o checkpoint
+ * \param index - 0 to checkpoint_patient_count() - 1, in the saved order // Na ordem salva
+ * \param place - Receives where it was // Recebe onde ele estava
+ * \return New patient // Novo paciente
+ */
+Patient *checkpoint_patient(const Checkpoint *checkpoint, int index, CheckpointPlace *place);
+
+/**
+ * \brief Number of saved exams // Número de exames salvos
+ */
+int checkpoint_exam_count(const Checkpoint *checkpoint);
+
+/**
+ * \brief Rebuild a saved exam, without image // Reconstrói um exame salvo, sem imagem
+ *
+ * \param checkpoint - Pointer to the checkpoint // Ponteiro para o checkpoint
+ * \param index - 0 to checkpoint_exam_count() - 1, in the saved order // Na ordem salva
+ * \param place - Receives where it was // Recebe onde ele estava
+ * \return New exam // Novo exame
+ */
+Exam *checkpoint_exam(const Checkpoint *checkpoint, int index, CheckpointPlace *place);
+
+#endif // CHECKPOINT_H_INCLUDED
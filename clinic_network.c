@@ -0,0 +1,369 @@
+#define _GNU_SOURCE
+#include "clinic_network.h"
+#include "spsc_channel.h"
+#include "queue.h"
+#include "patient.h"
+#include "exam.h"
+#include "rx_machine.h"
+#include "medical_check.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Progress a shard publishes for the others, alone on its cache line // Progresso que um shard publica, sozinho na sua linha de cache
+typedef struct clinic_progress {
+    _Alignas(SPSC_CACHE_LINE) atomic_long created;    // Patients that arrived here, wherever they end up // Pacientes que chegaram aqui
+    atomic_long reported;                              // Reports written here // Laudos gravados aqui
+    atomic_int arrivals_done;
+} ClinicProgress;
+
+typedef struct clinic_shard {
+    ClinicNetwork *network;
+    int index;
+    ClinicConfig config;
+
+    V_queue *patients;
+    RxPool *machines;
+    ExamPriorityQueue *exams;
+    int exams_waiting;
+    FILE *patient_file;
+    FILE *exam_file;
+    FILE *report_file;
+
+    SpscChannel *patients_out;   // To the next clinic, owned by the next clinic's patients_in // Para a próxima clínica
+    SpscChannel *exams_out;
+    SpscChannel *patients_in;    // From the previous clinic // Da clínica anterior
+    SpscChannel *exams_in;
+
+    double arrival_credit;       // Fraction of an arrival carried to the next tick // Fração de chegada levada ao próximo ciclo
+    ClinicStats stats;
+    pthread_t thread;
+} ClinicShard;
+
+struct clinic_network {
+    int count;
+    int pin;
+    atomic_int stopping;         // A clinic could not be started, the others give up // Uma clínica não pôde iniciar, as outras desistem
+    ClinicShard *shards[CLINIC_MAX];
+    ClinicProgress *progress;    // One slot per shard // Uma posição por shard
+};
+
+static FILE *open_clinic_db(const char *dir, const char *name, int index) {
+    char path[512];
+    if (!dir) {
+        return fopen("/dev/null", "w");
+    }
+    snprintf(path, sizeof(path), "%s/%s_%d.txt", dir, name, index);
+    return fopen(path, "w");
+}
+
+ClinicNetwork *create_clinic_network(int count, const ClinicConfig *configs, int channel_capacity, const char *db_dir) {
+/**
+ * \brief Create the clinics and the channels between them // Cria as clínicas e os canais entre elas
+ *
+ * \param count - Clinics, 1 to CLINIC_MAX // Clínicas, de 1 a CLINIC_MAX
+ * \param configs - One ClinicConfig per clinic // Uma ClinicConfig por clínica
+ * \param channel_capacity - Slots of each channel // Posições de cada canal
+ * \param db_dir - Directory of the db files, NULL for /dev/null // Diretório dos arquivos, NULL para /dev/null
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ClinicNetwork* - Pointer to the network, NULL if a parameter is invalid or a file can't be opened // Ponteiro para a rede, NULL se inválido
+ */
+    if (count < 1 || count > CLINIC_MAX || channel_capacity < 1) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (configs[i].patients < 0 || configs[i].load <= 0 || configs[i].machines < 1 || configs[i].doctors < 1 ||
+            configs[i].patient_transfer < 0 || configs[i].exam_transfer < 0) {
+            return NULL;
+        }
+    }
+
+    ClinicNetwork *network = (ClinicNetwork*)calloc(1, sizeof(ClinicNetwork));
+    ClinicProgress *progress = (ClinicProgress*)aligned_alloc(SPSC_CACHE_LINE, count * sizeof(ClinicProgress));
+    if (!network || !progress) {
+        printf("\nError: Memory allocation failed (Clinic Network)\n");
+        exit(1);
+    }
+    network->count = count;
+    network->progress = progress;
+    atomic_init(&network->stopping, 0);
+
+    for (int i = 0; i < count; i++) {
+        atomic_init(&progress[i].created, 0);
+        atomic_init(&progress[i].reported, 0);
+        atomic_init(&progress[i].arrivals_done, 0);
+
+        ClinicShard *shard = (ClinicShard*)calloc(1, sizeof(ClinicShard));
+        if (!shard) {
+            printf("\nError: Memory allocation failed (Clinic %d)\n", i);
+            exit(1);
+        }
+        network->shards[i] = shard;
+        shard->network = network;
+        shard->index = i;
+        shard->config = configs[i];
+        shard->patients = create_queue();
+        shard->machines = create_machines(configs[i].machines);
+        shard->exams = new_priority_queue();
+        shard->patient_file = open_clinic_db(db_dir, "db_patient", i);
+        shard->exam_file = open_clinic_db(db_dir, "db_exam", i);
+        shard->report_file = open_clinic_db(db_dir, "db_report", i);
+        shard->stats.core = -1;
+        if (!shard->patient_file || !shard->exam_file || !shard->report_file) {
+            destroy_clinic_network(network);
+            return NULL;
+        }
+    }
+
+    // A single clinic has nobody to transfer to // Uma clínica sozinha não tem para quem transferir
+    if (count > 1) {
+        for (int i = 0; i < count; i++) {
+            ClinicShard *next = network->shards[(i + 1) % count];
+            network->shards[i]->patients_out = next->patients_in = create_spsc_channel(channel_capacity);
+            network->shards[i]->exams_out = next->exams_in = create_spsc_channel(channel_capacity);
+        }
+    }
+    return network;
+}
+
+void destroy_clinic_network(ClinicNetwork *network) {
+/**
+ * \brief Free the network, its clinics and whatever they still hold // Libera a rede, as clínicas e o que elas ainda têm
+ */
+    if (!network) {
+        return;
+    }
+    for (int i = 0; i < network->count; i++) {
+        ClinicShard *shard = network->shards[i];
+        if (!shard) {
+            continue;
+        }
+        void *item;
+        if (shard->patients_in) {
+            while ((item = spsc_receive(shard->patients_in)) != NULL) {
+                destroy_patient((Patient*)item);
+            }
+            destroy_spsc_channel(shard->patients_in);
+        }
+        if (shard->exams_in) {
+            while ((item = spsc_receive(shard->exams_in)) != NULL) {
+                destroy_exam((Exam*)item);
+            }
+            destroy_spsc_channel(shard->exams_in);
+        }
+        P_free_queue(shard->patients);
+        free_priority_queue(shard->exams);
+        destroy_machines(shard->machines);
+        if (shard->patient_file) fclose(shard->patient_file);
+        if (shard->exam_file) fclose(shard->exam_file);
+        if (shard->report_file) fclose(shard->report_file);
+        free(shard);
+    }
+    free(network->progress);
+    free(network);
+}
+
+static int network_finished(ClinicNetwork *network) {
+// Every clinic stopped admitting and every patient that arrived anywhere was reported somewhere
+// Todas as clínicas pararam de admitir e todo paciente que chegou foi laudado em algum lugar
+    long created = 0;
+    long reported = 0;
+    for (int i = 0; i < network->count; i++) {
+        if (!atomic_load_explicit(&network->progress[i].arrivals_done, memory_order_acquire)) {
+            return 0;
+        }
+    }
+    // `created` is final once every arrivals_done is set, and `reported` never passes it
+    for (int i = 0; i < network->count; i++) {
+        created += atomic_load_explicit(&network->progress[i].created, memory_order_acquire);
+    }
+    for (int i = 0; i < network->count; i++) {
+        reported += atomic_load_explicit(&network->progress[i].reported, memory_order_acquire);
+    }
+    return created == reported;
+}
+
+static int receive_transfers(ClinicShard *shard) {
+// Takes in what the previous clinic sent; transferred items are never forwarded again // Recebe o que a clínica anterior enviou
+    int received = 0;
+    void *item;
+    if (!shard->patients_in) {
+        return 0;
+    }
+    while ((item = spsc_receive(shard->patients_in)) != NULL) {
+        enqueue(shard->patients, item);
+        shard->stats.patients_received++;
+        received++;
+    }
+    while ((item = spsc_receive(shard->exams_in)) != NULL) {
+        insert_in_priority_queue(shard->exams, (Exam*)item);
+        shard->exams_waiting++;
+        shard->stats.exams_received++;
+        received++;
+    }
+    return received;
+}
+
+static int admit_arrivals(ClinicShard *shard) {
+// New patients of this tick; over patient_transfer they go to the next clinic while its channel has room
+// Novos pacientes do ciclo; acima de patient_transfer vão para a próxima clínica enquanto o canal tiver espaço
+    int arrived = 0;
+    shard->arrival_credit += shard->config.load;
+    while (shard->arrival_credit >= 1 && shard->stats.arrivals < shard->config.patients) {
+        shard->arrival_credit -= 1;
+        Patient *patient = patient_in();
+        print_patient_db(patient, shard->patient_file);
+        shard->stats.arrivals++;
+        arrived++;
+
+        if (shard->patients_out && shard->config.patient_transfer > 0 &&
+            queue_size(shard->patients) >= shard->config.patient_transfer && spsc_send(shard->patients_out, patient)) {
+            shard->stats.patients_sent++;
+        } else {
+            enqueue(shard->patients, patient);
+        }
+    }
+    return arrived;
+}
+
+static int run_machines(ClinicShard *shard) {
+// Each machine examines one waiting patient per tick // Cada máquina examina um paciente por ciclo
+    int done = 0;
+    for (int i = 0; i < shard->config.machines && !is_queue_empty(shard->patients); i++) {
+        Patient *patient = P_denqueue(shard->patients);
+        Exam *exam = verify_and_ocupate(shard->machines, patient);
+        destroy_patient(patient);
+        print_exam_db(exam, shard->exam_file);
+        shard->stats.exams++;
+        done++;
+
+        if (shard->exams_out && shard->config.exam_transfer > 0 &&
+            shard->exams_waiting >= shard->config.exam_transfer && spsc_send(shard->exams_out, exam)) {
+            shard->stats.exams_sent++; // Read by the next clinic's doctors // Lido pelos médicos da próxima clínica
+        } else {
+            insert_in_priority_queue(shard->exams, exam);
+            shard->exams_waiting++;
+        }
+    }
+    return done;
+}
+
+static int run_doctors(ClinicShard *shard) {
+// Each doctor reports the most urgent waiting exam per tick // Cada médico lauda o exame mais urgente por ciclo
+    int done = 0;
+    for (int i = 0; i < shard->config.doctors && shard->exams_waiting > 0; i++) {
+        Exam *exam = get_priority_exams(shard->exams);
+        shard->exams_waiting--;
+        Report *report = do_medical_report(exam);
+        print_report_db(report, shard->report_file);
+        free_report(report);
+        destroy_exam(exam);
+        shard->stats.reports++;
+        done++;
+    }
+    return done;
+}
+
+static double thread_cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void *clinic_thread(void *args) {
+// The whole clinic on one thread: receive, admit, examine, report, publish progress // A clínica inteira em uma thread
+    ClinicShard *shard = (ClinicShard*)args;
+    ClinicNetwork *network = shard->network;
+    ClinicProgress *progress = &network->progress[shard->index];
+    rng_bind_stream(shard->index); // No lock per draw, CLINIC_MAX fits in RNG_STREAMS // Sem lock por sorteio
+
+    if (network->pin) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(shard->index % (cpus > 0 ? cpus : 1), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    while (!atomic_load_explicit(&network->stopping, memory_order_relaxed)) {
+        int work = receive_transfers(shard);
+        int arrived = admit_arrivals(shard);
+        work += arrived + run_machines(shard) + run_doctors(shard);
+        shard->stats.ticks++;
+
+        int queued = queue_size(shard->patients);
+        if (queued > shard->stats.peak_patients) shard->stats.peak_patients = queued;
+        if (shard->exams_waiting > shard->stats.peak_exams) shard->stats.peak_exams = shard->exams_waiting;
+
+        atomic_store_explicit(&progress->created, shard->stats.arrivals, memory_order_release);
+        atomic_store_explicit(&progress->reported, shard->stats.reports, memory_order_release);
+        if (shard->stats.arrivals == shard->config.patients && !atomic_load_explicit(&progress->arrivals_done, memory_order_relaxed)) {
+            atomic_store_explicit(&progress->arrivals_done, 1, memory_order_release);
+        }
+
+        if (work == 0) {
+            // Nothing local and nothing received: only now look at the other shards // Só agora olha os outros shards
+            shard->stats.idle_ticks++;
+            if (network_finished(network)) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+
+    fflush(shard->patient_file);
+    fflush(shard->exam_file);
+    fflush(shard->report_file);
+    shard->stats.core = sched_getcpu();
+    shard->stats.cpu_seconds = thread_cpu_seconds();
+    return NULL;
+}
+
+int run_clinic_network(ClinicNetwork *network, int pin) {
+/**
+ * \brief Run every clinic on its own thread until all patients are reported // Executa cada clínica na sua thread até todos os laudos
+ *
+ * \return int - 0 on success, -1 if a thread could not be started // 0 em caso de sucesso, -1 se uma thread não pôde ser criada
+ */
+    network->pin = pin;
+    int started = 0;
+    for (; started < network->count; started++) {
+        if (pthread_create(&network->shards[started]->thread, NULL, clinic_thread, network->shards[started]) != 0) {
+            break;
+        }
+    }
+    if (started < network->count) {
+        // The clinics already running can't finish without the others // As clínicas já rodando não terminam sem as outras
+        atomic_store_explicit(&network->stopping, 1, memory_order_relaxed);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(network->shards[i]->thread, NULL);
+    }
+    return started == network->count ? 0 : -1;
+}
+
+int clinic_network_size(ClinicNetwork *network) {
+/**
+ * \brief Number of clinics // Número de clínicas
+ */
+    return network->count;
+}
+
+void get_clinic_stats(ClinicNetwork *network, int clinic, ClinicStats *stats) {
+/**
+ * \brief Copy the counters of one clinic // Copia os contadores de uma clínica
+ */
+    if (clinic < 0 || clinic >= network->count) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = network->shards[clinic]->stats;
+}
@@ -0,0 +1,94 @@
+#ifndef CLINIC_NETWORK_H_INCLUDED
+#define CLINIC_NETWORK_H_INCLUDED
+
+#define CLINIC_MAX 64     // Clinics in one network // Clínicas em uma rede
+
+/**
+ * \brief Size and load of one clinic // Tamanho e carga de uma clínica
+ */
+typedef struct clinic_config {
+    long patients;          // Patients arriving at this clinic // Pacientes que chegam a esta clínica
+    double load;            // Arrivals per tick; machines and doctors handle one each per tick // Chegadas por ciclo; máquinas e médicos atendem um por ciclo
+    int machines;
+    int doctors;
+    int patient_transfer;   // Waiting patients above which new arrivals go to the next clinic, 0 never // Pacientes esperando acima dos quais as chegadas vão para a próxima clínica
+    int exam_transfer;      // Waiting exams above which new exams go to the next clinic's doctors, 0 never // Exames esperando acima dos quais os novos vão para os médicos da próxima clínica
+} ClinicConfig;
+
+/**
+ * \brief Counters of one clinic after a run // Contadores de uma clínica depois de uma execução
+ */
+typedef struct clinic_stats {
+    long arrivals;            // Patients that arrived here // Pacientes que chegaram aqui
+    long patients_sent;       // Arrivals transferred to the next clinic // Chegadas transferidas para a próxima clínica
+    long patients_received;   // Patients transferred from the previous clinic // Pacientes recebidos da clínica anterior
+    long exams;               // Exams done by the machines // Exames feitos pelas máquinas
+    long exams_sent;          // Exams sent for remote reading // Exames enviados para leitura remota
+    long exams_received;      // Exams read here for the previous clinic // Exames lidos aqui para a clínica anterior
+    long reports;
+    long ticks;               // Loop iterations // Iterações do laço
+    long idle_ticks;          // Iterations with nothing to do // Iterações sem nada a fazer
+    int peak_patients;        // Longest patient queue // Maior fila de pacientes
+    int peak_exams;           // Longest priority queue // Maior fila de prioridade
+    int core;                 // CPU the clinic ran on at the end, -1 if unknown // CPU em que a clínica rodava no fim
+    double cpu_seconds;       // CPU time of the clinic's thread // Tempo de CPU da thread da clínica
+} ClinicStats;
+
+/**
+ * \brief Clinics run as shards: each one owns its queues, machines, doctors, counters and db files and runs on
+ *        its own thread, pinned to its own core. Clinic i sends overflow patients and exams for remote reading to
+ *        clinic i + 1 (mod count) over two SPSC channels; those channels are the only state the shards share,
+ *        besides one padded progress slot per shard read when a shard goes idle.
+ * \brief Clínicas como shards: cada uma tem suas filas, máquinas, médicos, contadores e arquivos e roda na sua
+ *        própria thread, fixada no seu núcleo. A clínica i envia pacientes excedentes e exames para leitura remota
+ *        à clínica i + 1 (mod count) por dois canais SPSC, o único estado compartilhado além do progresso de cada shard.
+ */
+typedef struct clinic_network ClinicNetwork;
+
+/**
+ * \brief Create the clinics and the channels between them // Cria as clínicas e os canais entre elas
+ *
+ * \param count - Clinics, 1 to CLINIC_MAX // Clínicas, de 1 a CLINIC_MAX
+ * \param configs - One ClinicConfig per clinic // Uma ClinicConfig por clínica
+ * \param channel_capacity - Slots of each channel // Posições de cada canal
+ * \param db_dir - Directory for db_patient_<i>.txt, db_exam_<i>.txt and db_report_<i>.txt, NULL for /dev/null // Diretório dos arquivos, NULL para /dev/null
+ * \return Pointer to the network, NULL if a parameter is invalid or a file can't be opened // Ponteiro para a rede, NULL se um parâmetro for inválido
+ */
+ClinicNetwork *create_clinic_network(int count, const ClinicConfig *configs, int channel_capacity, const char *db_dir);
+
+/**
+ * \brief Free the network, its clinics and whatever they still hold // Libera a rede, as clínicas e o que elas ainda têm
+ *
+ * \param network - Pointer to the network // Ponteiro para a rede
+ */
+void destroy_clinic_network(ClinicNetwork *network);
+
+/**
+ * \brief Run every clinic on its own thread until all patients are reported // Executa cada clínica na sua thread até todos os laudos
+ *
+ * \details Uses the time scale of time_control.c: run it with set_time_scale(0), so exams cost only their CPU work.
+ * \details Usa a escala de tempo do time_control.c: execute com set_time_scale(0).
+ * \param network - Pointer to the network // Ponteiro para a rede
+ * \param pin - 1 pins clinic i to CPU i modulo the online CPUs // 1 fixa a clínica i na CPU i módulo as CPUs disponíveis
+ * \return 0 on success, -1 if a thread could not be started // 0 em caso de sucesso, -1 se uma thread não pôde ser criada
+ */
+int run_clinic_network(ClinicNetwork *network, int pin);
+
+/**
+ * \brief Number of clinics // Número de clínicas
+ *
+ * \param network - Pointer to the network // Ponteiro para a rede
+ * \return Clinics // Clínicas
+ */
+int clinic_network_size(ClinicNetwork *network);
+
+/**
+ * \brief Copy the counters of one clinic // Copia os contadores de uma clínica
+ *
+ * \param network - Pointer to the network // Ponteiro para a rede
+ * \param clinic - Index of the clinic // Índice da clínica
+ * \param stats - Receives the counters // Recebe os contadores
+ */
+void get_clinic_stats(ClinicNetwork *network, int clinic, ClinicStats *stats);
+
+#endif // CLINIC_NETWORK_H_INCLUDED
@@ -0,0 +1,300 @@
+#include "dashboard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "seqlock.h"
+#include "sim_config.h"
+
+#define DASHBOARD_BUFFER 4096
+#define ANSI_HOME_CLEAR "\033[H\033[2J"
+#define ANSI_BOLD "\033[1m"
+#define ANSI_RESET "\033[0m"
+
+struct dashboard {
+    double refresh_seconds;
+    int running;
+    int started;
+    atomic_int published;           // At least one snapshot was published // Pelo menos um snapshot foi publicado
+    pthread_t thread;
+    SeqLock snapshot_lock;          // The producer never waits for the renderer // O produtor nunca espera o painel
+    pthread_mutex_t state_mutex;
+    pthread_cond_t wakeup;
+    DashboardSnapshot snapshot;
+};
+
+Dashboard *create_dashboard(double refresh_seconds) {
+/**
+ * \brief Create a dashboard redrawing at a fixed rate // Cria um painel redesenhado a uma taxa fixa
+ *
+ * \param refresh_seconds - Interval between redraws, values <= 0 fall back to one second // Intervalo entre redesenhos, valores <= 0 usam um segundo
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return Dashboard* - Pointer to the new dashboard // Ponteiro para o novo painel
+ */
+    Dashboard *dashboard = (Dashboard*)calloc(1, sizeof(Dashboard));
+    if (!dashboard) {
+        printf("\nError: Memory allocation failed (Dashboard)\n");
+        exit(1);
+    }
+
+    dashboard->refresh_seconds = refresh_seconds > 0 ? refresh_seconds : 1.0;
+    seqlock_init(&dashboard->snapshot_lock);
+    atomic_init(&dashboard->published, 0);
+    pthread_mutex_init(&dashboard->state_mutex, NULL);
+    pthread_cond_init(&dashboard->wakeup, NULL);
+
+    return dashboard;
+}
+
+int dashboard_publish(Dashboard *dashboard, const DashboardSnapshot *snapshot) {
+/**
+ * \brief Publish a new snapshot without blocking // Publica um novo snapshot sem bloquear
+ *
+ * \details A seqlock write: the producer never waits and never skips a snapshot; a renderer that was copying
+ *          meanwhile copies again. There must be a single producer.
+ * \details Uma escrita de seqlock: o produtor nunca espera nem pula um snapshot; um painel que estava copiando
+ *          copia de novo. Deve haver um único produtor.
+ *
+ * \return int - 1 if published, 0 without a dashboard or snapshot // 1 se publicado, 0 sem painel ou snapshot
+ */
+    if (!dashboard || !snapshot) {
+        return 0;
+    }
+
+    seqlock_write(&dashboard->snapshot_lock, &dashboard->snapshot, snapshot, sizeof(DashboardSnapshot));
+    atomic_store_explicit(&dashboard->published, 1, memory_order_release);
+
+    return 1;
+}
+
+void dashboard_histogram_add(int *histogram, double seconds) {
+/**
+ * \brief Add a duration to the histogram, clamping to the last bin // Adiciona uma duração ao histograma, limitando à última faixa
+ */
+    if (!histogram) {
+        return;
+    }
+
+    int bin = seconds > 0 ? (int)(seconds / DASHBOARD_HIST_WIDTH) : 0;
+    if (bin >= DASHBOARD_HIST_BINS) {
+        bin = DASHBOARD_HIST_BINS - 1;
+    }
+    histogram[bin]++;
+}
+
+double dashboard_percentile(const int *histogram, double percentile) {
+/**
+ * \brief Estimate a percentile from a histogram // Estima um percentil a partir de um histograma
+ *
+ * \return double - Upper bound of the bin holding the percentile, or 0 if the histogram is empty // Limite superior da faixa do percentil, ou 0 se vazio
+ */
+    long total = 0;
+    for (int i = 0; i < DASHBOARD_HIST_BINS; i++) {
+        total += histogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    long rank = (long)(percentile / 100.0 * total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    long seen = 0;
+    for (int i = 0; i < DASHBOARD_HIST_BINS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return (i + 1) * DASHBOARD_HIST_WIDTH;
+        }
+    }
+    return DASHBOARD_HIST_BINS * DASHBOARD_HIST_WIDTH;
+}
+
+static int render_bar(char *out, size_t size, int value, int scale) {
+// Draws a proportional bar of '#' characters // Desenha uma barra proporcional de caracteres '#'
+    char bar[41];
+    int width = scale > 0 ? value * 40 / scale : 0;
+    if (width > 40) {
+        width = 40;
+    }
+    memset(bar, '#', width);
+    bar[width] = '\0';
+    return snprintf(out, size, "%-40s", bar);
+}
+
+static size_t render_snapshot(const DashboardSnapshot *s, char *buffer, size_t size) {
+// Formats the whole screen into one buffer so it is written with a single call // Formata a tela inteira em um buffer para ser escrita com uma única chamada
+    static const char *labels[DASHBOARD_PRIORITIES] = {"Low", "Low", "Medium", "Medium", "High", "Urgent"};
+    size_t used = 0;
+
+#define DASH_APPEND(...) \
+    do { \
+        if (used < size) { \
+            int written = snprintf(buffer + used, size - used, __VA_ARGS__); \
+            if (written > 0) used += (size_t)written; \
+        } \
+    } while (0)
+
+    int deepest = s->patients_waiting;
+    for (int i = 0; i < DASHBOARD_PRIORITIES; i++) {
+        if (s->priority_depth[i] > deepest) {
+            deepest = s->priority_depth[i];
+        }
+    }
+
+    DASH_APPEND(ANSI_HOME_CLEAR);
+    DASH_APPEND(ANSI_BOLD "========== X-Ray Clinic Dashboard ==========" ANSI_RESET "\n");
+    DASH_APPEND("Simulated Time:        %8.2lf s\n", s->tempo_total);
+    DASH_APPEND("Patients Arrived:      %8d\n", s->pacientes_totais);
+    DASH_APPEND("IA Exams Performed:    %8d\n", s->ia_exames_realizados);
+    DASH_APPEND("Reports Finalized:     %8d   (delayed > %.3f: %d)\n", s->reports_finalizados, sim_config()->report_limit, s->reports_tempo_ok);
+
+    DASH_APPEND("\n" ANSI_BOLD "Queues" ANSI_RESET "\n");
+    DASH_APPEND("  Waiting for machine  %5d ", s->patients_waiting);
+    if (used < size) used += render_bar(buffer + used, size - used, s->patients_waiting, deepest);
+    DASH_APPEND("\n");
+    for (int i = DASHBOARD_PRIORITIES - 1; i >= 0; i--) {
+        DASH_APPEND("  Priority %d %-8s  %5d ", i + 1, labels[i], s->priority_depth[i]);
+        if (used < size) used += render_bar(buffer + used, size - used, s->priority_depth[i], deepest);
+        DASH_APPEND("\n");
+    }
+
+    if (s->patients_rejected > 0 || s->patients_diverted > 0 || s->exams_rejected > 0 || s->exams_dropped > 0 || s->exams_diverted > 0) {
+        double rate_time = s->tempo_total > 0 ? s->tempo_total : 1;
+        DASH_APPEND("  Overflow             %5d patients, %d exams parked\n", s->patients_diverted, s->exams_diverted);
+        DASH_APPEND("  Turned away          %5ld patients (%.2lf/s), %ld exams rejected, %ld dropped\n",
+                    s->patients_rejected, s->patients_rejected / rate_time, s->exams_rejected, s->exams_dropped);
+    }
+
+    DASH_APPEND("\n" ANSI_BOLD "X-Ray Machines" ANSI_RESET "\n");
+    DASH_APPEND("  Occupancy            %2d/%-2d ", s->machines_busy, s->machines_total);
+    if (used < size) used += render_bar(buffer + used, size - used, s->machines_busy, s->machines_total);
+    DASH_APPEND("\n");
+    DASH_APPEND("  Utilization          %7.1lf%%\n", s->machine_utilization * 100);
+
+    DASH_APPEND("\n" ANSI_BOLD "Doctors" ANSI_RESET "\n");
+    DASH_APPEND("  Reports in progress  %5d\n", s->doctors_active);
+    DASH_APPEND("  Mean busy doctors    %8.2lf\n", s->tempo_total > 0 ? s->time_reports / s->tempo_total : 0.0);
+    DASH_APPEND("  Report time p50/p90/p99: %.2lf / %.2lf / %.2lf s\n",
+                dashboard_percentile(s->report_histogram, 50),
+                dashboard_percentile(s->report_histogram, 90),
+                dashboard_percentile(s->report_histogram, 99));
+    // What the doctors do now: the window and the EWMA follow a change, the all-time mean barely moves after an hour
+    const SlidingWindow *window = &s->reports.window;
+    DASH_APPEND("  Last %.0lf s:  %6.2lf reports/s, mean %.2lf s\n", window->seconds,
+                sliding_window_rate(window, s->tempo_total), sliding_window_mean(window));
+    for (int i = 0; i < DASHBOARD_PRIORITIES; i++) {
+        const StreamStats *stats = &s->reports.priority[i];
+        if (stats->count > 0) {
+            DASH_APPEND("  Priority %d: %.2lf s now, EWMA %.2lf, mean %.2lf +/- %.2lf (%ld reports)\n", i + 1,
+                        sliding_window_mean(&s->reports.priority_window[i]), stats->ewma, stats->mean,
+                        stream_stats_stddev(stats), stats->count);
+        }
+    }
+    DASH_APPEND("============================================\n");
+
+#undef DASH_APPEND
+
+    return used < size ? used : size - 1;
+}
+
+static void *dashboard_renderer(void *args) {
+// Renderer loop: copy the latest snapshot, draw it, wait for the next tick // Laço do painel: copia o último snapshot, desenha, espera o próximo tique
+    Dashboard *dashboard = (Dashboard*)args;
+    DashboardSnapshot local;
+    char buffer[DASHBOARD_BUFFER];
+
+    pthread_mutex_lock(&dashboard->state_mutex);
+    while (dashboard->running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        long nanos = (long)(dashboard->refresh_seconds * 1e9);
+        deadline.tv_sec += nanos / 1000000000L;
+        deadline.tv_nsec += nanos % 1000000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int wait_result = 0;
+        while (dashboard->running && wait_result != ETIMEDOUT) {
+            wait_result = pthread_cond_timedwait(&dashboard->wakeup, &dashboard->state_mutex, &deadline);
+        }
+        if (!dashboard->running) {
+            break;
+        }
+        pthread_mutex_unlock(&dashboard->state_mutex);
+
+        int have_snapshot = atomic_load_explicit(&dashboard->published, memory_order_acquire);
+        seqlock_read(&dashboard->snapshot_lock, &local, &dashboard->snapshot, sizeof(DashboardSnapshot));
+
+        if (have_snapshot) {
+            size_t length = render_snapshot(&local, buffer, sizeof(buffer));
+            fwrite(buffer, 1, length, stdout);
+            fflush(stdout);
+        }
+
+        pthread_mutex_lock(&dashboard->state_mutex);
+    }
+    pthread_mutex_unlock(&dashboard->state_mutex);
+
+    return NULL;
+}
+
+int dashboard_start(Dashboard *dashboard) {
+/**
+ * \brief Start the renderer thread // Inicia a thread de desenho
+ *
+ * \return int - 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+    if (!dashboard || dashboard->started) {
+        return -1;
+    }
+
+    dashboard->running = 1;
+    if (pthread_create(&dashboard->thread, NULL, dashboard_renderer, dashboard) != 0) {
+        printf("\nError: Could not start dashboard thread\n");
+        dashboard->running = 0;
+        return -1;
+    }
+    dashboard->started = 1;
+
+    return 0;
+}
+
+void dashboard_stop(Dashboard *dashboard) {
+/**
+ * \brief Stop and join the renderer thread // Para e aguarda a thread de desenho
+ */
+    if (!dashboard || !dashboard->started) {
+        return;
+    }
+
+    pthread_mutex_lock(&dashboard->state_mutex);
+    dashboard->running = 0;
+    pthread_cond_signal(&dashboard->wakeup);
+    pthread_mutex_unlock(&dashboard->state_mutex);
+
+    pthread_join(dashboard->thread, NULL);
+    dashboard->started = 0;
+}
+
+void destroy_dashboard(Dashboard *dashboard) {
+/**
+ * \brief Free the dashboard, stopping the renderer first // Libera o painel, parando a thread antes
+ */
+    if (!dashboard) {
+        return;
+    }
+
+    dashboard_stop(dashboard);
+    pthread_cond_destroy(&dashboard->wakeup);
+    pthread_mutex_destroy(&dashboard->state_mutex);
+    free(dashboard);
+}
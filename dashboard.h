@@ -0,0 +1,95 @@
+#ifndef DASHBOARD_H_INCLUDED
+#define DASHBOARD_H_INCLUDED
+
+#include "stream_stats.h"
+
+#define DASHBOARD_PRIORITIES 6
+#define DASHBOARD_HIST_BINS 128      // Report duration histogram bins // Faixas do histograma de duração dos laudos
+#define DASHBOARD_HIST_WIDTH 0.100   // Seconds covered by each bin // Segundos cobertos por cada faixa
+
+typedef struct dashboard Dashboard;
+
+/**
+ * \brief Point-in-time copy of every value the dashboard draws // Cópia instantânea de todos os valores desenhados pelo painel
+ * \details The queue fields are filled while holding the simulation lock, so they belong to the same instant;
+ *          the report fields come from the merged counter shards, each shard consistent on its own.
+ */
+typedef struct dashboard_snapshot {
+    double tempo_total;                          // Simulated time // Tempo simulado
+    int pacientes_totais;                        // Patients arrived // Pacientes que chegaram
+    int patients_waiting;                        // Patients waiting for a machine // Pacientes esperando uma máquina
+    int priority_depth[DASHBOARD_PRIORITIES];    // Exams waiting per priority (index 0 = priority 1) // Exames esperando por prioridade
+    long patients_rejected;                      // Turned away by a full patient queue // Recusados pela fila de pacientes cheia
+    int patients_diverted;                       // Parked in the patient overflow queue // Estacionados na fila de estouro de pacientes
+    long exams_rejected;                         // Refused by a full priority queue // Recusados pela fila de prioridade cheia
+    long exams_dropped;                          // Evicted for more urgent exams // Descartados por exames mais urgentes
+    int exams_diverted;                          // Parked in the exam overflow queues // Estacionados nas filas de estouro de exames
+    int machines_total;
+    int machines_busy;
+    double machine_utilization;                  // Fraction of machine time spent on exams // Fração do tempo das máquinas em exames
+    int doctors_active;                          // Reports in progress // Laudos em andamento
+    int ia_exames_realizados;
+    int reports_finalizados;
+    int reports_tempo_ok;
+    double time_reports;                         // Sum of report durations // Soma das durações dos laudos
+    ReportStream reports;                        // Report durations, windows advanced to tempo_total // Durações dos laudos
+    int report_histogram[DASHBOARD_HIST_BINS];   // Report durations // Durações dos laudos
+} DashboardSnapshot;
+
+/**
+ * \brief Create a dashboard redrawing at a fixed rate // Cria um painel redesenhado a uma taxa fixa
+ *
+ * \param refresh_seconds - Interval between redraws // Intervalo entre redesenhos
+ * \return Pointer to the dashboard // Ponteiro para o painel
+ */
+Dashboard *create_dashboard(double refresh_seconds);
+
+/**
+ * \brief Start the renderer thread // Inicia a thread de desenho
+ *
+ * \param dashboard - Pointer to the dashboard // Ponteiro para o painel
+ * \return 0 on success, -1 if the thread could not be created // 0 em caso de sucesso, -1 se a thread não pôde ser criada
+ */
+int dashboard_start(Dashboard *dashboard);
+
+/**
+ * \brief Publish a new snapshot without ever blocking the caller (single producer) // Publica um novo snapshot sem nunca bloquear quem chama
+ *
+ * \param dashboard - Pointer to the dashboard // Ponteiro para o painel
+ * \param snapshot - Snapshot to be copied // Snapshot a ser copiado
+ * \return 1 if published, 0 without a dashboard or snapshot // 1 se publicado, 0 sem painel ou snapshot
+ */
+int dashboard_publish(Dashboard *dashboard, const DashboardSnapshot *snapshot);
+
+/**
+ * \brief Stop and join the renderer thread // Para e aguarda a thread de desenho
+ *
+ * \param dashboard - Pointer to the dashboard // Ponteiro para o painel
+ */
+void dashboard_stop(Dashboard *dashboard);
+
+/**
+ * \brief Free the dashboard (stopping it first if needed) // Libera o painel (parando-o antes se necessário)
+ *
+ * \param dashboard - Pointer to the dashboard // Ponteiro para o painel
+ */
+void destroy_dashboard(Dashboard *dashboard);
+
+/**
+ * \brief Add a report duration to a histogram // Adiciona a duração de um laudo a um histograma
+ *
+ * \param histogram - Array with DASHBOARD_HIST_BINS bins // Array com DASHBOARD_HIST_BINS faixas
+ * \param seconds - Duration in seconds // Duração em segundos
+ */
+void dashboard_histogram_add(int *histogram, double seconds);
+
+/**
+ * \brief Estimate a percentile from a histogram // Estima um percentil a partir de um histograma
+ *
+ * \param histogram - Array with DASHBOARD_HIST_BINS bins // Array com DASHBOARD_HIST_BINS faixas
+ * \param percentile - Percentile between 0 and 100 // Percentil entre 0 e 100
+ * \return Upper bound of the bin holding the percentile, or 0 if empty // Limite superior da faixa que contém o percentil, ou 0 se vazio
+ */
+double dashboard_percentile(const int *histogram, double percentile);
+
+#endif // DASHBOARD_H_INCLUDED
@@ -0,0 +1,381 @@
+#include "db_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "async_io.h"
+
+/*
+ * Shard layout // Formato das fatias
+ *
+ *   (DbLogFrame | record bytes) x records
+ *
+ * Raw structs in the byte order of the machine, like the checkpoints: shards are merged by the build that wrote them.
+ * A frame is only accepted whole, with its magic and checksum, so a crash in the middle of a write() loses that
+ * record and nothing before it. With io_uring the buffers in flight can land out of order, so a crash may also leave a
+ * gap of zeros: the records after it are dropped like a torn frame.
+ */
+
+#define DB_LOG_CACHE_LINE 64
+#define FNV_OFFSET 0x811c9dc5u
+
+typedef struct db_log_frame {
+    uint32_t magic;                    // DB_LOG_MAGIC
+    uint32_t length;                   // Record bytes after the frame // Bytes do registro depois do quadro
+    uint64_t timestamp;                // CLOCK_MONOTONIC nanoseconds, strictly increasing in the shard // Nanossegundos
+    uint64_t sequence;                 // Records before it in the shard // Registros antes dele na fatia
+    uint32_t checksum;                 // FNV-1a of the record bytes // FNV-1a dos bytes do registro
+    uint32_t shard;
+} DbLogFrame;
+
+typedef struct db_log_shard {
+    _Alignas(DB_LOG_CACHE_LINE) pthread_mutex_t mutex; // Uncontended unless threads share the shard or a merge runs
+    int fd;                            // -1 until the first record // -1 até o primeiro registro
+    int used;                          // Bytes waiting in the buffer // Bytes esperando no buffer
+    uint64_t sequence;
+    uint64_t last_time;
+    char *buffer;                      // Filled by the writer, owned by `output` // Enchido pelo escritor, de `output`
+    AsyncFile *output;
+} DbLogShard;
+
+struct db_log {
+    char *path;
+    AsyncIoKind io;
+    int sync_every;
+    DbLogShard shards[DB_LOG_SHARDS];
+};
+
+typedef struct merge_cursor {
+    FILE *input;
+    int shard;
+    DbLogFrame frame;
+    char record[DB_LOG_MAX_RECORD];
+} MergeCursor;
+
+static _Thread_local int writer_slot = -1;   // Shard of the calling thread in every log // Fatia da thread em todos os logs
+static atomic_int writer_slots;
+
+static uint32_t fnv1a(const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    uint32_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+static void shard_path(char *buffer, size_t size, const char *path, int shard) {
+    snprintf(buffer, size, "%s.%d.shard", path, shard);
+}
+
+static uint64_t monotonic_nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+DbLog *create_db_log(const char *path, AsyncIoKind io, int sync_every) {
+/**
+ * \brief Create the log of a db file // Cria o log de um arquivo db
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return DbLog* - Pointer to the log // Ponteiro para o log
+ */
+    DbLog *log = (DbLog*)aligned_alloc(DB_LOG_CACHE_LINE, sizeof(DbLog));
+    char *copy = strdup(path);
+    if (!log || !copy) {
+        printf("\nError: Memory allocation failed (DB Log)\n");
+        exit(1);
+    }
+    log->path = copy;
+    log->io = io;
+    log->sync_every = sync_every;
+    char name[4096];
+    for (int i = 0; i < DB_LOG_SHARDS; i++) {
+        DbLogShard *shard = &log->shards[i];
+        pthread_mutex_init(&shard->mutex, NULL);
+        shard->fd = -1;
+        shard->used = 0;
+        shard->sequence = 0;
+        shard->last_time = 0;
+        shard->buffer = NULL;
+        shard->output = NULL;
+        shard_path(name, sizeof(name), path, i);
+        unlink(name); // Left by an earlier run // Deixada por uma execução anterior
+    }
+    return log;
+}
+
+void destroy_db_log(DbLog *log) {
+/**
+ * \brief Close every shard and remove the shard files // Fecha as fatias e remove os arquivos
+ */
+    if (!log) {
+        return;
+    }
+    char name[4096];
+    for (int i = 0; i < DB_LOG_SHARDS; i++) {
+        DbLogShard *shard = &log->shards[i];
+        if (shard->fd >= 0) {
+            destroy_async_file(shard->output);
+            close(shard->fd);
+            shard_path(name, sizeof(name), log->path, i);
+            unlink(name);
+        }
+        pthread_mutex_destroy(&shard->mutex);
+    }
+    free(log->path);
+    free(log);
+}
+
+static int flush_shard(DbLogShard *shard) {
+// Hands the buffer to the output and takes the next one, mutex held // Entrega o buffer à saída e pega o próximo, com o mutex
+    int status = async_file_write(shard->output, shard->used);
+    shard->buffer = async_file_buffer(shard->output);
+    shard->used = 0;
+    return status;
+}
+
+static int open_shard(DbLog *log, DbLogShard *shard, int index) {
+// First record of the shard, mutex held // Primeiro registro da fatia, com o mutex
+    char name[4096];
+    shard_path(name, sizeof(name), log->path, index);
+    // Written at explicit offsets, so writes in flight can complete in any order // Gravada em posições explícitas
+    shard->fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (shard->fd < 0) {
+        return -1;
+    }
+    shard->output = create_async_file(shard->fd, DB_LOG_BUFFER, log->io, log->sync_every);
+    shard->buffer = async_file_buffer(shard->output);
+    return 0;
+}
+
+int db_log_append(DbLog *log, const char *record, int length) {
+/**
+ * \brief Append one record to the calling thread's shard // Acrescenta um registro à fatia da thread que chama
+ *
+ * \return int - 0 on success, -1 on failure // 0 em sucesso, -1 em caso de falha
+ */
+    if (length < 0 || length > DB_LOG_MAX_RECORD) {
+        return -1;
+    }
+    if (writer_slot < 0) {
+        writer_slot = atomic_fetch_add(&writer_slots, 1) % DB_LOG_SHARDS;
+    }
+    DbLogShard *shard = &log->shards[writer_slot];
+    pthread_mutex_lock(&shard->mutex);
+    if (shard->fd < 0 && open_shard(log, shard, writer_slot) != 0) {
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    if (shard->used + (int)sizeof(DbLogFrame) + length > DB_LOG_BUFFER && flush_shard(shard) != 0) {
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    DbLogFrame frame;
+    frame.magic = DB_LOG_MAGIC;
+    frame.length = (uint32_t)length;
+    frame.timestamp = monotonic_nanoseconds();
+    if (frame.timestamp <= shard->last_time) {
+        frame.timestamp = shard->last_time + 1; // Two records in the same nanosecond keep their order
+    }
+    shard->last_time = frame.timestamp;
+    frame.sequence = shard->sequence++;
+    frame.checksum = fnv1a(record, length);
+    frame.shard = (uint32_t)writer_slot;
+    memcpy(shard->buffer + shard->used, &frame, sizeof(frame));
+    memcpy(shard->buffer + shard->used + sizeof(frame), record, length);
+    shard->used += (int)sizeof(frame) + length;
+    pthread_mutex_unlock(&shard->mutex);
+    return 0;
+}
+
+static int read_frame(MergeCursor *cursor, DbLogMerge *merge) {
+// Next whole frame of a shard, 0 at its end or at a torn frame // Próximo quadro inteiro, 0 no fim ou em um quadro cortado
+    size_t got = fread(&cursor->frame, 1, sizeof(DbLogFrame), cursor->input);
+    if (got == 0 && feof(cursor->input)) {
+        return 0;
+    }
+    if (got != sizeof(DbLogFrame) || cursor->frame.magic != DB_LOG_MAGIC || cursor->frame.length > DB_LOG_MAX_RECORD ||
+        fread(cursor->record, 1, cursor->frame.length, cursor->input) != cursor->frame.length ||
+        fnv1a(cursor->record, cursor->frame.length) != cursor->frame.checksum) {
+        merge->torn++;
+        return 0;
+    }
+    return 1;
+}
+
+static int cursor_before(const MergeCursor *a, const MergeCursor *b) {
+// Timestamp order; equal timestamps go by shard // Ordem de horário; horários iguais vão pela fatia
+    if (a->frame.timestamp != b->frame.timestamp) {
+        return a->frame.timestamp < b->frame.timestamp;
+    }
+    return a->shard < b->shard;
+}
+
+static void sift_down(MergeCursor **heap, int count, int at) {
+    for (;;) {
+        int smallest = at;
+        int left = 2 * at + 1;
+        int right = left + 1;
+        if (left < count && cursor_before(heap[left], heap[smallest])) {
+            smallest = left;
+        }
+        if (right < count && cursor_before(heap[right], heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == at) {
+            return;
+        }
+        MergeCursor *swap = heap[at];
+        heap[at] = heap[smallest];
+        heap[smallest] = swap;
+        at = smallest;
+    }
+}
+
+static int merge_shards(FILE **inputs, const int *indexes, int count, FILE *output, DbLogMerge *merge) {
+// Streaming k-way merge: the heap holds the next frame of every shard not yet exhausted
+// Junção de k vias em fluxo: o heap guarda o próximo quadro de cada fatia ainda não esgotada
+    MergeCursor *cursors = (MergeCursor*)malloc((count > 0 ? count : 1) * sizeof(MergeCursor));
+    MergeCursor *heap[DB_LOG_SHARDS];
+    if (!cursors) {
+        printf("\nError: Memory allocation failed (DB Log merge)\n");
+        exit(1);
+    }
+    int live = 0;
+    for (int i = 0; i < count; i++) {
+        cursors[i].input = inputs[i];
+        cursors[i].shard = indexes[i];
+        if (read_frame(&cursors[i], merge)) {
+            heap[live++] = &cursors[i];
+        }
+    }
+    for (int i = live / 2 - 1; i >= 0; i--) {
+        sift_down(heap, live, i);
+    }
+    int failed = 0;
+    while (live > 0) {
+        MergeCursor *next = heap[0];
+        if (fwrite(next->record, 1, next->frame.length, output) != next->frame.length) {
+            failed = 1;
+            break;
+        }
+        merge->records++;
+        if (!read_frame(next, merge)) {
+            heap[0] = heap[--live];
+        }
+        sift_down(heap, live, 0);
+    }
+    free(cursors);
+    return failed || fflush(output) != 0 ? -1 : 0;
+}
+
+int db_log_merge(DbLog *log, FILE *output, DbLogMerge *merge) {
+/**
+ * \brief Merge every shard into the canonical file, in timestamp order, and empty the shards
+ *        // Junta todas as fatias no arquivo canônico, em ordem de horário, e esvazia as fatias
+ *
+ * \return int - 0 on success, -1 on failure // 0 em sucesso, -1 em caso de falha
+ */
+    DbLogMerge counts = {0, 0, 0};
+    FILE *inputs[DB_LOG_SHARDS];
+    int indexes[DB_LOG_SHARDS];
+    int failed = 0;
+    for (int i = 0; i < DB_LOG_SHARDS; i++) { // Always in index order, so two merges can't deadlock
+        pthread_mutex_lock(&log->shards[i].mutex);
+    }
+    for (int i = 0; i < DB_LOG_SHARDS && !failed; i++) {
+        DbLogShard *shard = &log->shards[i];
+        if (shard->fd < 0) {
+            continue;
+        }
+        // Read through the shard's own descriptor: a forked what-if branch may have unlinked the name
+        // Lida pelo descritor da própria fatia: um ramo criado por fork pode ter removido o nome
+        int flushed = flush_shard(shard) == 0;
+        flushed = async_file_wait(shard->output) == 0 && flushed; // Every queued write has landed // Todas as gravações chegaram
+        int fd = flushed ? dup(shard->fd) : -1;
+        FILE *input = fd >= 0 && lseek(fd, 0, SEEK_SET) == 0 ? fdopen(fd, "rb") : NULL;
+        if (!input) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            failed = 1;
+            break;
+        }
+        inputs[counts.shards] = input;
+        indexes[counts.shards++] = i;
+    }
+    if (!failed) {
+        failed = merge_shards(inputs, indexes, counts.shards, output, &counts) != 0;
+    }
+    for (int i = 0; i < counts.shards; i++) {
+        fclose(inputs[i]);
+        DbLogShard *shard = &log->shards[indexes[i]];
+        if (!failed && ftruncate(shard->fd, 0) != 0) {
+            failed = 1; // The records stay in the shard and would be merged twice // Os registros ficariam duplicados
+        }
+        if (!failed) {
+            async_file_rewind(shard->output, 0);
+        }
+    }
+    for (int i = DB_LOG_SHARDS - 1; i >= 0; i--) {
+        pthread_mutex_unlock(&log->shards[i].mutex);
+    }
+    if (merge) {
+        *merge = counts;
+    }
+    return failed ? -1 : 0;
+}
+
+int db_log_recover(const char *path, FILE *output, DbLogMerge *merge) {
+/**
+ * \brief Merge the shard files a crashed run left behind, then delete them // Junta as fatias deixadas por uma execução interrompida e as apaga
+ *
+ * \return int - 0 on success, -1 on failure // 0 em sucesso, -1 em caso de falha
+ */
+    DbLogMerge counts = {0, 0, 0};
+    FILE *inputs[DB_LOG_SHARDS];
+    int indexes[DB_LOG_SHARDS];
+    char name[4096];
+    for (int i = 0; i < DB_LOG_SHARDS; i++) {
+        shard_path(name, sizeof(name), path, i);
+        FILE *input = fopen(name, "rb");
+        if (input) {
+            inputs[counts.shards] = input;
+            indexes[counts.shards++] = i;
+        }
+    }
+    int failed = merge_shards(inputs, indexes, counts.shards, output, &counts) != 0;
+    for (int i = 0; i < counts.shards; i++) {
+        fclose(inputs[i]);
+        if (!failed) {
+            shard_path(name, sizeof(name), path, indexes[i]);
+            unlink(name);
+        }
+    }
+    if (merge) {
+        *merge = counts;
+    }
+    return failed ? -1 : 0;
+}
+
+void add_db_log_io_stats(DbLog *log, AsyncIoStats *stats) {
+/**
+ * \brief Add the output counters of every shard to `stats` // Soma os contadores de saída de cada fatia em `stats`
+ */
+    for (int i = 0; i < DB_LOG_SHARDS; i++) {
+        DbLogShard *shard = &log->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        if (shard->output) {
+            add_async_file_stats(shard->output, stats);
+        }
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
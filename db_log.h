@@ -0,0 +1,98 @@
+#ifndef DB_LOG_H_INCLUDED
+#define DB_LOG_H_INCLUDED
+
+#include <stdio.h>
+#include "async_io.h"
+
+#define DB_LOG_SHARDS 64               // Writer threads with a shard of their own; more share them round robin // Threads com fatia própria
+#define DB_LOG_BUFFER (64 * 1024)      // Bytes buffered per shard before a write // Bytes acumulados por fatia antes de uma gravação
+#define DB_LOG_MAX_RECORD 4096         // Longest record, framing excluded // Maior registro, sem o cabeçalho
+#define DB_LOG_MAGIC 0x474f4c44u       // "DLOG" in every frame header // Em todo cabeçalho de quadro
+
+/**
+ * \brief Outcome of a merge // Resultado de uma junção
+ */
+typedef struct db_log_merge {
+    long records;                      // Records written to the output, in timestamp order // Registros gravados na saída
+    long torn;                         // Shards that ended in a partial or corrupt frame, dropped from there // Fatias terminadas em quadro parcial
+    int shards;                        // Shard files read // Arquivos de fatia lidos
+} DbLogMerge;
+
+// One db file written by many threads, each appending framed records to its own shard file
+// Um arquivo db escrito por várias threads, cada uma acrescentando registros enquadrados ao seu próprio arquivo de fatia
+typedef struct db_log DbLog;
+
+/**
+ * \brief Create the log of a db file // Cria o log de um arquivo db
+ *
+ * \details Shards are "<path>.<n>.shard", created by each writer thread on its first record. Shards left by an earlier
+ *          run are deleted here: recover them first with db_log_recover(). Each shard writes its full buffers through
+ *          an AsyncFile, so with ASYNC_IO_URING the writer thread queues them and goes on.
+ * \details As fatias são "<path>.<n>.shard", criadas por cada thread no seu primeiro registro. Fatias deixadas por uma
+ *          execução anterior são apagadas aqui: recupere-as antes com db_log_recover(). Cada fatia grava seus buffers
+ *          cheios por um AsyncFile, então com ASYNC_IO_URING a thread escritora os enfileira e segue.
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ * \param path - The canonical db file, e.g. "db_report.txt" // O arquivo db canônico
+ * \param io - ASYNC_IO_WRITE or ASYNC_IO_URING // ASYNC_IO_WRITE ou ASYNC_IO_URING
+ * \param sync_every - fdatasync every N buffers of a shard, 0 for never // fdatasync a cada N buffers de uma fatia, 0 para nunca
+ * \return Pointer to the log // Ponteiro para o log
+ */
+DbLog *create_db_log(const char *path, AsyncIoKind io, int sync_every);
+
+/**
+ * \brief Close every shard and remove the shard files // Fecha as fatias e remove os arquivos
+ *
+ * \param log - Pointer to the log, may be NULL; merge it first to keep its records // Pode ser NULL; junte-o antes para manter os registros
+ */
+void destroy_db_log(DbLog *log);
+
+/**
+ * \brief Append one record to the calling thread's shard // Acrescenta um registro à fatia da thread que chama
+ *
+ * \details The record is framed with its length, a CLOCK_MONOTONIC timestamp (strictly increasing within the shard)
+ *          and an FNV-1a checksum, and copied whole into the shard buffer: it can't interleave with another record.
+ * \details O registro é enquadrado com seu tamanho, um horário CLOCK_MONOTONIC (estritamente crescente na fatia) e um
+ *          checksum FNV-1a, e copiado inteiro no buffer da fatia: não se mistura com outro registro.
+ * \param log - Pointer to the log // Ponteiro para o log
+ * \param record - Record bytes, e.g. from format_report_db() // Bytes do registro
+ * \param length - 0 to DB_LOG_MAX_RECORD bytes // 0 a DB_LOG_MAX_RECORD bytes
+ * \return 0 on success, -1 if the record is too long or the shard can't be written // 0 em sucesso, -1 em caso de falha
+ */
+int db_log_append(DbLog *log, const char *record, int length);
+
+/**
+ * \brief Merge every shard into the canonical file, in timestamp order, and empty the shards
+ *        // Junta todas as fatias no arquivo canônico, em ordem de horário, e esvazia as fatias
+ *
+ * \details Streaming k-way merge over a binary heap: one frame per shard is in memory at a time. Writers block on their
+ *          shard while it runs, so a merge at any moment appends exactly the records appended before it.
+ * \details Junção de k vias em fluxo sobre um heap binário: um quadro por fatia fica na memória por vez. Os escritores
+ *          esperam pela sua fatia durante a junção, então ela acrescenta exatamente os registros anteriores a ela.
+ * \param log - Pointer to the log // Ponteiro para o log
+ * \param output - The canonical file, records are appended at its position // O arquivo canônico, os registros são acrescentados
+ * \param merge - Receives the counts, may be NULL // Recebe as contagens, pode ser NULL
+ * \return 0 on success, -1 if a shard can't be flushed, read or emptied // 0 em sucesso, -1 em caso de falha
+ */
+int db_log_merge(DbLog *log, FILE *output, DbLogMerge *merge);
+
+/**
+ * \brief Merge the shard files a crashed run left behind, then delete them // Junta as fatias deixadas por uma execução interrompida e as apaga
+ *
+ * \details A shard ending in a frame cut by the crash keeps every whole record before it. // Uma fatia terminada em um
+ *          quadro cortado mantém todos os registros inteiros antes dele.
+ * \param path - The canonical db file the shards belong to // O arquivo db canônico das fatias
+ * \param output - Where the records are appended // Onde os registros são acrescentados
+ * \param merge - Receives the counts, may be NULL // Recebe as contagens, pode ser NULL
+ * \return 0 on success (also with no shards), -1 if a shard can't be read // 0 em sucesso (também sem fatias), -1 em caso de falha
+ */
+int db_log_recover(const char *path, FILE *output, DbLogMerge *merge);
+
+/**
+ * \brief Add the output counters of every shard opened so far to `stats` // Soma os contadores de saída das fatias abertas em `stats`
+ *
+ * \param log - Pointer to the log // Ponteiro para o log
+ * \param stats - Receives the sums, zero it first // Recebe as somas, zere-o antes
+ */
+void add_db_log_io_stats(DbLog *log, AsyncIoStats *stats);
+
+#endif // DB_LOG_H_INCLUDED
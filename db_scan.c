@@ -0,0 +1,667 @@
+#include "db_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ai_model.h"
+#include "sim_config.h"
+
+#define SCAN_LANES 16                  // Bytes per vector // Bytes por vetor
+#define SCAN_BLOCK 64                  // Bytes per bitmask // Bytes por máscara
+#define SCAN_CHUNKS_PER_THREAD 8       // Spare chunks, so a slow chunk doesn't leave the other threads idle // Pedaços de sobra
+#define SCAN_MIN_CHUNK (1 << 20)       // Smaller files get fewer chunks // Arquivos menores recebem menos pedaços
+#define SCAN_HASH_SLOTS 16
+#define SCAN_UNKNOWN AI_CONDITIONS     // Condition index of the names the hash doesn't know // Índice dos nomes desconhecidos
+#define SCAN_NONE SIZE_MAX
+
+typedef unsigned char ScanVector __attribute__((vector_size(SCAN_LANES)));
+
+// Priority of each condition, the same as get_ai_priority() // Prioridade de cada condição, a mesma do get_ai_priority()
+static const int condition_priority[AI_CONDITIONS] = {1, 2, 3, 4, 4, 4, 5, 5, 6};
+
+// Perfect hash of the 9 condition names: ((length * 18 + last byte) >> 1) & 15 gives each one its own slot
+// Hash perfeito dos 9 nomes de condições: cada um cai numa posição própria
+static const signed char condition_slots[SCAN_HASH_SLOTS] = {-1, 2, -1, 1, -1, 7, -1, 5, 4, 0, -1, 6, 8, -1, -1, 3};
+
+typedef struct exam_slot {
+    unsigned int time;                 // Seconds since 1970 // Segundos desde 1970
+    int condition;
+} ExamSlot;
+
+typedef struct exam_entry {
+    int id;
+    ExamSlot slot;
+} ExamEntry;
+
+typedef struct scan_chunk {
+    size_t begin;
+    size_t end;
+    DbScanResult *tally;               // This chunk's aggregates, summed in file order // Agregados deste pedaço
+    ExamEntry *exams;                  // DB_EXAMS: the exams in file order // Os exames na ordem do arquivo
+    long exam_count;
+    long exam_capacity;
+} ScanChunk;
+
+typedef struct scan_record {
+    int open;                          // An "ID:" line was read // Uma linha "ID:" foi lida
+    int id;
+    int exam_id;
+    long long time;                    // -1 until read // -1 até ser lido
+    int condition;                     // -1 until read // -1 até ser lido
+} ScanRecord;
+
+struct db_scan {
+    int threads;
+    DbScanKernel kernel;
+    double delay_limit;
+    DbScanResult result;
+    ExamSlot *index;                   // Exams of the last DB_EXAMS file grouped by ID, in file order // Exames agrupados por ID
+    long *offsets;                     // Exams of ID i are index[offsets[i]] to index[offsets[i + 1] - 1]
+    int max_id;                        // -1 without exams // -1 sem exames
+};
+
+typedef struct scan_job {
+    DbScan *scan;
+    DbKind kind;
+    const char *data;
+    ScanChunk *chunks;
+    int chunk_count;
+    atomic_int next;                   // Next chunk to take // Próximo pedaço a pegar
+} ScanJob;
+
+typedef struct scan_state {
+    ScanJob *job;
+    ScanChunk *chunk;
+    ScanRecord record;
+} ScanState;
+
+static void reset_result(DbScanResult *result) {
+    memset(result, 0, sizeof(*result));
+    result->first_time = -1;
+    result->last_time = -1;
+    for (int i = 0; i <= DB_SCAN_PRIORITIES; i++) {
+        stream_stats_init(&result->turnaround[i]);
+    }
+}
+
+static void merge_result(DbScanResult *into, const DbScanResult *from) {
+// Adds every aggregate of `from` to `into` // Soma todos os agregados de `from` em `into`
+    into->patients += from->patients;
+    into->exams += from->exams;
+    into->reports += from->reports;
+    into->malformed += from->malformed;
+    into->bytes += from->bytes;
+    into->seconds += from->seconds;
+    if (from->first_time >= 0 && (into->first_time < 0 || from->first_time < into->first_time)) {
+        into->first_time = from->first_time;
+    }
+    if (from->last_time > into->last_time) {
+        into->last_time = from->last_time;
+    }
+    for (int i = 0; i < DB_SCAN_CONDITIONS; i++) {
+        into->exam_conditions[i] += from->exam_conditions[i];
+        into->report_conditions[i] += from->report_conditions[i];
+    }
+    into->matched += from->matched;
+    into->ambiguous += from->ambiguous;
+    into->kept += from->kept;
+    into->delayed += from->delayed;
+    for (int p = 0; p <= DB_SCAN_PRIORITIES; p++) {
+        stream_stats_merge(&into->turnaround[p], &from->turnaround[p]);
+        if (from->turnaround[p].count == 0) {
+            continue; // Empty histogram // Histograma vazio
+        }
+        for (int s = 0; s < DB_SCAN_SECONDS; s++) {
+            into->histogram[p][s] += from->histogram[p][s];
+        }
+    }
+}
+
+DbScan *create_db_scan(int threads, DbScanKernel kernel) {
+/**
+ * \brief Create an empty scan // Cria uma leitura vazia
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return DbScan* - Pointer to the scan // Ponteiro para a leitura
+ */
+    DbScan *scan = (DbScan*)malloc(sizeof(DbScan));
+    if (!scan) {
+        printf("\nError: Memory allocation failed (DB Scan)\n");
+        exit(1);
+    }
+    scan->threads = threads > 0 ? threads : 1;
+    scan->kernel = kernel;
+    scan->delay_limit = sim_config()->report_limit;
+    reset_result(&scan->result);
+    scan->index = NULL;
+    scan->offsets = NULL;
+    scan->max_id = -1;
+    return scan;
+}
+
+void destroy_db_scan(DbScan *scan) {
+/**
+ * \brief Free a scan // Libera uma leitura
+ */
+    if (scan) {
+        free(scan->index);
+        free(scan->offsets);
+        free(scan);
+    }
+}
+
+static int condition_index(const char *text, size_t length) {
+// Index of a condition name, SCAN_UNKNOWN if it isn't one // Índice do nome de uma condição
+    if (length == 0) {
+        return SCAN_UNKNOWN;
+    }
+    int condition = condition_slots[((length * 18 + (unsigned char)text[length - 1]) >> 1) & (SCAN_HASH_SLOTS - 1)];
+    if (condition < 0) {
+        return SCAN_UNKNOWN;
+    }
+    const char *name = ai_condition_name(condition);
+    return strncmp(name, text, length) == 0 && name[length] == '\0' ? condition : SCAN_UNKNOWN;
+}
+
+static int parse_digits(const char *text, int count) {
+// Value of `count` decimal digits, -1 if one isn't a digit // Valor de `count` dígitos, -1 se algum não for dígito
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned digit = (unsigned char)text[i] - '0';
+        if (digit > 9) {
+            return -1;
+        }
+        value = value * 10 + (int)digit;
+    }
+    return value;
+}
+
+static long long parse_time(const char *text, size_t length) {
+// "YYYY-MM-DD hh:mm:ss" to seconds since 1970 taken as UTC, -1 if malformed // Para segundos desde 1970, -1 se inválido
+    if (length < 19 || text[4] != '-' || text[7] != '-' || text[10] != ' ' || text[13] != ':' || text[16] != ':') {
+        return -1;
+    }
+    int year = parse_digits(text, 4);
+    int month = parse_digits(text + 5, 2);
+    int day = parse_digits(text + 8, 2);
+    int hour = parse_digits(text + 11, 2);
+    int minute = parse_digits(text + 14, 2);
+    int second = parse_digits(text + 17, 2);
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || hour < 0 || minute < 0 || second < 0) {
+        return -1;
+    }
+    // Days from the civil date, without mktime() and its time zone lookups // Dias a partir da data civil, sem mktime()
+    int y = year - (month <= 2);
+    int era = y / 400;
+    int year_of_era = y - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    long long days = (long long)era * 146097 + day_of_era - 719468;
+    return days * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+static int parse_id(const char *text, size_t length) {
+// A non-negative decimal number, -1 otherwise // Um número decimal não negativo, -1 caso contrário
+    if (length == 0 || length > 9) {
+        return -1;
+    }
+    return parse_digits(text, (int)length);
+}
+
+static const ExamSlot *find_exam(const DbScan *scan, int id, long long time, int *ambiguous) {
+// Latest exam with this ID not newer than `time`, NULL if none; `ambiguous` if another one has the same second
+// Exame mais recente com este ID não mais novo que `time`, NULL se nenhum; `ambiguous` se outro tem o mesmo segundo
+    *ambiguous = 0;
+    if (id < 0 || id > scan->max_id) {
+        return NULL;
+    }
+    long low = scan->offsets[id];
+    long high = scan->offsets[id + 1];
+    while (low < high) { // First exam newer than `time` // Primeiro exame mais novo que `time`
+        long middle = low + (high - low) / 2;
+        if ((long long)scan->index[middle].time <= time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == scan->offsets[id]) {
+        return NULL;
+    }
+    *ambiguous = low - 1 > scan->offsets[id] && scan->index[low - 2].time == scan->index[low - 1].time;
+    return &scan->index[low - 1];
+}
+
+static void add_exam(ScanChunk *chunk, int id, long long time, int condition) {
+    if (chunk->exam_count == chunk->exam_capacity) {
+        chunk->exam_capacity = chunk->exam_capacity ? chunk->exam_capacity * 2 : 4096;
+        chunk->exams = (ExamEntry*)realloc(chunk->exams, chunk->exam_capacity * sizeof(ExamEntry));
+        if (!chunk->exams) {
+            printf("\nError: Memory allocation failed (DB Scan exams)\n");
+            exit(1);
+        }
+    }
+    ExamEntry *entry = &chunk->exams[chunk->exam_count++];
+    entry->id = id;
+    entry->slot.time = (unsigned int)time;
+    entry->slot.condition = condition;
+}
+
+static void finish_record(ScanState *state) {
+// Counts the record read so far // Conta o registro lido até aqui
+    ScanRecord *record = &state->record;
+    if (!record->open) {
+        return;
+    }
+    DbScanResult *tally = state->chunk->tally;
+    const DbScan *scan = state->job->scan;
+    DbKind kind = state->job->kind;
+    record->open = 0;
+    if (kind == DB_PATIENTS) {
+        tally->patients++;
+    } else if (kind == DB_EXAMS) {
+        tally->exams++;
+    } else {
+        tally->reports++;
+    }
+    if (record->time < 0 || (kind != DB_PATIENTS && record->condition < 0)) {
+        tally->malformed++;
+        return;
+    }
+    if (tally->first_time < 0 || record->time < tally->first_time) {
+        tally->first_time = record->time;
+    }
+    if (record->time > tally->last_time) {
+        tally->last_time = record->time;
+    }
+    if (kind == DB_EXAMS) {
+        tally->exam_conditions[record->condition]++;
+        if (record->id >= 0 && record->id <= DB_SCAN_MAX_ID) {
+            add_exam(state->chunk, record->id, record->time, record->condition);
+        }
+    } else if (kind == DB_REPORTS) {
+        tally->report_conditions[record->condition]++;
+        int ambiguous;
+        const ExamSlot *exam = find_exam(scan, record->exam_id, record->time, &ambiguous);
+        if (!exam) {
+            return;
+        }
+        tally->matched++;
+        tally->ambiguous += ambiguous;
+        if (exam->condition == record->condition) {
+            tally->kept++;
+        }
+        long long turnaround = record->time - (long long)exam->time;
+        if (turnaround > scan->delay_limit) {
+            tally->delayed++;
+        }
+        int bin = turnaround < DB_SCAN_SECONDS ? (int)turnaround : DB_SCAN_SECONDS - 1;
+        // The doctor's diagnosis sets the priority, as in write_report() // O diagnóstico do médico define a prioridade
+        int priority = record->condition < SCAN_UNKNOWN ? condition_priority[record->condition] : 0;
+        stream_stats_add(&tally->turnaround[0], (double)turnaround);
+        tally->histogram[0][bin]++;
+        if (priority > 0) {
+            stream_stats_add(&tally->turnaround[priority], (double)turnaround);
+            tally->histogram[priority][bin]++;
+        }
+    }
+}
+
+static void handle_line(ScanState *state, const char *data, size_t start, size_t colon, size_t end) {
+// One "Key: value" line; `colon` is its first ':' or SCAN_NONE // Uma linha "Chave: valor"
+    if (end > start && data[end - 1] == '\r') {
+        end--;
+    }
+    if (colon == SCAN_NONE || colon >= end) {
+        return; // Blank or foreign line // Linha vazia ou estranha
+    }
+    const char *key = data + start;
+    size_t key_length = colon - start;
+    size_t value_start = colon + 1 < end && data[colon + 1] == ' ' ? colon + 2 : colon + 1;
+    const char *value = data + value_start;
+    size_t value_length = end - value_start;
+    ScanRecord *record = &state->record;
+
+    switch (key_length) { // The length and the first byte tell every key apart // O tamanho e o primeiro byte distinguem as chaves
+    case 2:
+        if (key[0] == 'I' && key[1] == 'D') {
+            finish_record(state);
+            record->open = 1;
+            record->id = parse_id(value, value_length);
+            record->exam_id = -1;
+            record->time = -1;
+            record->condition = -1;
+        }
+        break;
+    case 7:
+        if (memcmp(key, "Exam ID", 7) == 0) {
+            record->exam_id = parse_id(value, value_length);
+        }
+        break;
+    case 9:
+        if (memcmp(key, "Condition", 9) == 0) {
+            record->condition = condition_index(value, value_length);
+        } else if (memcmp(key, "Exam Time", 9) == 0) {
+            record->time = parse_time(value, value_length);
+        }
+        break;
+    case 11:
+        if (memcmp(key, "Report Time", 11) == 0) {
+            record->time = parse_time(value, value_length);
+        }
+        break;
+    case 12:
+        if (memcmp(key, "Arrival Time", 12) == 0) {
+            record->time = parse_time(value, value_length);
+        }
+        break;
+    default:
+        break; // Name, RX ID and Patient ID aren't aggregated // Não são agregados
+    }
+}
+
+static void scan_bytes_scalar(ScanState *state, size_t from, size_t to, size_t *line, size_t *colon) {
+// Reference scanner, one byte at a time // Leitor de referência, um byte por vez
+    const char *data = state->job->data;
+    for (size_t at = from; at < to; at++) {
+        if (data[at] == '\n') {
+            handle_line(state, data, *line, *colon, at);
+            *line = at + 1;
+            *colon = SCAN_NONE;
+        } else if (data[at] == ':' && *colon == SCAN_NONE) {
+            *colon = at;
+        }
+    }
+}
+
+static uint64_t lane_bits(ScanVector matches) {
+// One bit per byte of a comparison result, like SSE2's movemask // Um bit por byte do resultado de uma comparação
+    uint64_t halves[2];
+    memcpy(halves, &matches, sizeof(halves));
+    uint64_t low = ((halves[0] & 0x8080808080808080ULL) * 0x0002040810204081ULL) >> 56;
+    uint64_t high = ((halves[1] & 0x8080808080808080ULL) * 0x0002040810204081ULL) >> 56;
+    return low | high << 8;
+}
+
+static void scan_bytes_simd(ScanState *state, size_t from, size_t to, size_t *line, size_t *colon) {
+// Builds newline and colon bitmasks of 64 bytes, then visits only their set bits // Visita só os bits ligados das máscaras
+    const char *data = state->job->data;
+    size_t at = from;
+    for (; at + SCAN_BLOCK <= to; at += SCAN_BLOCK) {
+        uint64_t newlines = 0;
+        uint64_t colons = 0;
+        for (int lane = 0; lane < SCAN_BLOCK; lane += SCAN_LANES) {
+            ScanVector bytes;
+            memcpy(&bytes, data + at + lane, SCAN_LANES);
+            newlines |= lane_bits((ScanVector)(bytes == '\n')) << lane;
+            colons |= lane_bits((ScanVector)(bytes == ':')) << lane;
+        }
+        uint64_t events = newlines | colons;
+        while (events) {
+            int bit = __builtin_ctzll(events);
+            events &= events - 1;
+            if (newlines >> bit & 1) {
+                handle_line(state, data, *line, *colon, at + bit);
+                *line = at + bit + 1;
+                *colon = SCAN_NONE;
+            } else if (*colon == SCAN_NONE) {
+                *colon = at + bit;
+            }
+        }
+    }
+    scan_bytes_scalar(state, at, to, line, colon); // The last partial block // O último bloco incompleto
+}
+
+static void scan_chunk(ScanJob *job, ScanChunk *chunk) {
+// Parses the records of one chunk into its own tally // Lê os registros de um pedaço no seu próprio agregado
+    chunk->tally = (DbScanResult*)malloc(sizeof(DbScanResult));
+    if (!chunk->tally) {
+        printf("\nError: Memory allocation failed (DB Scan tally)\n");
+        exit(1);
+    }
+    reset_result(chunk->tally);
+    ScanState state = {job, chunk, {0, -1, -1, -1, -1}};
+    size_t line = chunk->begin;
+    size_t colon = SCAN_NONE;
+    if (job->scan->kernel == DB_SCAN_SIMD) {
+        scan_bytes_simd(&state, chunk->begin, chunk->end, &line, &colon);
+    } else {
+        scan_bytes_scalar(&state, chunk->begin, chunk->end, &line, &colon);
+    }
+    if (line < chunk->end) {
+        handle_line(&state, job->data, line, colon, chunk->end); // A file not ending with a newline // Arquivo sem quebra de linha final
+    }
+    finish_record(&state);
+}
+
+static void *scan_worker(void *argument) {
+    ScanJob *job = (ScanJob*)argument;
+    for (;;) {
+        int chunk = atomic_fetch_add(&job->next, 1);
+        if (chunk >= job->chunk_count) {
+            return NULL;
+        }
+        scan_chunk(job, &job->chunks[chunk]);
+    }
+}
+
+static size_t record_start(const char *data, size_t size, size_t from) {
+// First record starting at or after `from` // Primeiro registro começando em `from` ou depois
+    if (from == 0) {
+        return 0;
+    }
+    size_t at = from - 1;
+    while (at < size) {
+        const char *newline = memchr(data + at, '\n', size - at);
+        if (!newline) {
+            return size;
+        }
+        at = (size_t)(newline - data) + 1;
+        if (size - at >= 4 && memcmp(data + at, "ID: ", 4) == 0) {
+            return at;
+        }
+    }
+    return size;
+}
+
+static int compare_slots(const void *a, const void *b) {
+    unsigned int first = ((const ExamSlot*)a)->time;
+    unsigned int second = ((const ExamSlot*)b)->time;
+    return (first > second) - (first < second);
+}
+
+static void build_exam_index(DbScan *scan, ScanChunk *chunks, int count) {
+// Groups the exams by ID with a counting sort, keeping the file order inside each ID // Agrupa os exames por ID
+    free(scan->index);
+    free(scan->offsets);
+    scan->index = NULL;
+    scan->offsets = NULL;
+    scan->max_id = -1;
+    long total = 0;
+    for (int c = 0; c < count; c++) {
+        for (long i = 0; i < chunks[c].exam_count; i++) {
+            if (chunks[c].exams[i].id > scan->max_id) {
+                scan->max_id = chunks[c].exams[i].id;
+            }
+        }
+        total += chunks[c].exam_count;
+    }
+    if (scan->max_id < 0) {
+        return;
+    }
+    scan->offsets = (long*)calloc((size_t)scan->max_id + 2, sizeof(long));
+    scan->index = (ExamSlot*)malloc((total > 0 ? total : 1) * sizeof(ExamSlot));
+    if (!scan->offsets || !scan->index) {
+        printf("\nError: Memory allocation failed (DB Scan index)\n");
+        exit(1);
+    }
+    for (int c = 0; c < count; c++) {
+        for (long i = 0; i < chunks[c].exam_count; i++) {
+            scan->offsets[chunks[c].exams[i].id + 1]++;
+        }
+    }
+    for (int id = 0; id <= scan->max_id; id++) {
+        scan->offsets[id + 1] += scan->offsets[id];
+    }
+    long *fill = (long*)malloc(((size_t)scan->max_id + 1) * sizeof(long));
+    if (!fill) {
+        printf("\nError: Memory allocation failed (DB Scan index)\n");
+        exit(1);
+    }
+    memcpy(fill, scan->offsets, ((size_t)scan->max_id + 1) * sizeof(long));
+    for (int c = 0; c < count; c++) {
+        for (long i = 0; i < chunks[c].exam_count; i++) {
+            scan->index[fill[chunks[c].exams[i].id]++] = chunks[c].exams[i].slot;
+        }
+    }
+    free(fill);
+    for (int id = 0; id <= scan->max_id; id++) { // Files are written in time order; sort only an ID that isn't
+        for (long i = scan->offsets[id] + 1; i < scan->offsets[id + 1]; i++) {
+            if (scan->index[i].time < scan->index[i - 1].time) {
+                qsort(scan->index + scan->offsets[id], scan->offsets[id + 1] - scan->offsets[id], sizeof(ExamSlot), compare_slots);
+                break;
+            }
+        }
+    }
+}
+
+int db_scan_file(DbScan *scan, DbKind kind, const char *path) {
+/**
+ * \brief Map a db file and parse it across the threads // Mapeia um arquivo db e o lê com todas as threads
+ *
+ * \return int - 0 on success, -1 if the file can't be opened or mapped // 0 em sucesso, -1 em caso de falha
+ */
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    const char *data = NULL;
+    if (size > 0) {
+        void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = (const char*)mapped;
+    }
+    close(fd);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int count = scan->threads * SCAN_CHUNKS_PER_THREAD;
+    if ((size_t)count > size / SCAN_MIN_CHUNK + 1) {
+        count = (int)(size / SCAN_MIN_CHUNK + 1);
+    }
+    ScanChunk *chunks = (ScanChunk*)calloc(count, sizeof(ScanChunk));
+    if (!chunks) {
+        printf("\nError: Memory allocation failed (DB Scan chunks)\n");
+        exit(1);
+    }
+    for (int c = 0; c < count; c++) { // Even cuts, each moved forward to the next record // Cortes iguais, cada um levado ao próximo registro
+        chunks[c].begin = c == 0 ? 0 : chunks[c - 1].end;
+        chunks[c].end = c == count - 1 ? size : record_start(data, size, size / count * (c + 1));
+        if (chunks[c].end < chunks[c].begin) {
+            chunks[c].end = chunks[c].begin;
+        }
+    }
+
+    ScanJob job = {scan, kind, data, chunks, count, 0};
+    int threads = scan->threads < count ? scan->threads : count;
+    pthread_t workers[threads];
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&workers[t], NULL, scan_worker, &job);
+    }
+    scan_worker(&job); // The calling thread is worker 0 // A thread que chama é a trabalhadora 0
+    for (int t = 1; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    DbScanResult *total = (DbScanResult*)malloc(sizeof(DbScanResult));
+    if (!total) {
+        printf("\nError: Memory allocation failed (DB Scan tally)\n");
+        exit(1);
+    }
+    reset_result(total);
+    for (int c = 0; c < count; c++) {
+        merge_result(total, chunks[c].tally);
+        free(chunks[c].tally);
+    }
+    if (kind == DB_EXAMS) {
+        build_exam_index(scan, chunks, count);
+    }
+    for (int c = 0; c < count; c++) {
+        free(chunks[c].exams);
+    }
+    free(chunks);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    total->bytes = (long long)size;
+    total->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    merge_result(&scan->result, total);
+    free(total);
+    if (data) {
+        munmap((void*)data, size);
+    }
+    return 0;
+}
+
+void get_db_scan_result(DbScan *scan, DbScanResult *result) {
+/**
+ * \brief Copy the aggregates of every file read so far // Copia os agregados de todos os arquivos lidos
+ */
+    *result = scan->result;
+}
+
+int db_scan_percentile(const DbScanResult *result, int priority, double fraction) {
+/**
+ * \brief Turnaround percentile from the histogram // Percentil do tempo entre exame e laudo pelo histograma
+ *
+ * \return int - Whole seconds, -1 without reports // Segundos inteiros, -1 sem laudos
+ */
+    if (priority < 0 || priority > DB_SCAN_PRIORITIES || result->turnaround[priority].count == 0) {
+        return -1;
+    }
+    long wanted = (long)(fraction * result->turnaround[priority].count + 0.999999);
+    if (wanted < 1) {
+        wanted = 1;
+    }
+    long seen = 0;
+    for (int s = 0; s < DB_SCAN_SECONDS; s++) {
+        seen += result->histogram[priority][s];
+        if (seen >= wanted) {
+            return s;
+        }
+    }
+    return DB_SCAN_SECONDS - 1;
+}
+
+int db_scan_kernel_from_name(const char *name) {
+/**
+ * \brief Kernel from its command line name // Kernel a partir do nome na linha de comando
+ *
+ * \return int - DB_SCAN_SIMD, DB_SCAN_SCALAR or -1 // DB_SCAN_SIMD, DB_SCAN_SCALAR ou -1
+ */
+    if (name && strcmp(name, "simd") == 0) {
+        return DB_SCAN_SIMD;
+    }
+    if (name && strcmp(name, "scalar") == 0) {
+        return DB_SCAN_SCALAR;
+    }
+    return -1;
+}
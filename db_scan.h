@@ -0,0 +1,115 @@
+#ifndef DB_SCAN_H_INCLUDED
+#define DB_SCAN_H_INCLUDED
+
+#include "stream_stats.h"
+
+#define DB_SCAN_CONDITIONS 10          // The 9 conditions of the AI model, then every unknown name // As 9 condições e os nomes desconhecidos
+#define DB_SCAN_PRIORITIES 6
+#define DB_SCAN_SECONDS 4096           // Turnaround histogram bins of 1 s, the last one holds everything longer // Faixas de 1 s
+#define DB_SCAN_MAX_ID (1 << 24)       // Exams with larger IDs are counted but can't be joined to a report // Exames com IDs maiores não são ligados
+
+typedef enum db_kind {
+    DB_PATIENTS,                       // db_patient.txt
+    DB_EXAMS,                          // db_exam.txt
+    DB_REPORTS                         // db_report.txt, scanned after db_exam.txt to join the two // Lido depois do db_exam.txt
+} DbKind;
+
+typedef enum db_scan_kernel {
+    DB_SCAN_SCALAR,                    // One byte at a time, the reference // Um byte por vez, a referência
+    DB_SCAN_SIMD                       // Newline and colon bitmasks of 64 bytes at a time // Máscaras de quebras de linha e dois-pontos
+} DbScanKernel;
+
+/**
+ * \brief Aggregates of the scanned db files // Agregados dos arquivos db lidos
+ *
+ * \details Turnarounds go from the exam's "Exam Time" to the report's "Report Time": wall clock seconds, as written
+ *          in the files. A report is joined to the latest exam with its Exam ID that is not newer than the report.
+ *          Exam IDs repeat, so on busy files several exams may share that ID and second; such joins are a guess
+ *          and are counted in `ambiguous`.
+ * \details Os tempos vão do "Exam Time" do exame ao "Report Time" do laudo: segundos do relógio, como gravados nos
+ *          arquivos. Um laudo é ligado ao exame mais recente com seu Exam ID que não seja mais novo que o laudo.
+ *          Os Exam IDs se repetem, então em arquivos cheios vários exames podem ter esse ID e segundo; essas
+ *          ligações são um palpite e são contadas em `ambiguous`.
+ */
+typedef struct db_scan_result {
+    long patients;
+    long exams;
+    long reports;
+    long malformed;                                  // Records missing a time or a condition // Registros sem horário ou condição
+    long long bytes;                                 // Bytes parsed // Bytes lidos
+    double seconds;                                  // Wall time spent parsing // Tempo real gasto lendo
+    long long first_time;                            // Earliest timestamp, seconds since 1970, -1 if none // Horário mais antigo
+    long long last_time;                             // Latest timestamp // Horário mais recente
+    long exam_conditions[DB_SCAN_CONDITIONS];        // AI diagnoses // Diagnósticos da IA
+    long report_conditions[DB_SCAN_CONDITIONS];      // Doctor's diagnoses // Diagnósticos do médico
+    long matched;                                    // Reports joined to their exam // Laudos ligados ao seu exame
+    long ambiguous;                                  // Joined while other exams had the ID in the same second // Ligados entre vários candidatos
+    long kept;                                       // Joined reports keeping the AI diagnosis // Laudos que mantêm o diagnóstico da IA
+    long delayed;                                    // Turnarounds over report_limit wall seconds, not the simulated delay // Acima do report_limit em segundos reais
+    StreamStats turnaround[DB_SCAN_PRIORITIES + 1];  // Index 0 = every report, then priority 1 to 6 // Índice 0 = todos
+    long histogram[DB_SCAN_PRIORITIES + 1][DB_SCAN_SECONDS];
+} DbScanResult;
+
+// Parallel parser of the db_*.txt files, summing every file it reads // Leitor paralelo dos arquivos db_*.txt
+typedef struct db_scan DbScan;
+
+/**
+ * \brief Create an empty scan // Cria uma leitura vazia
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ * \param threads - Parser threads, at least 1 // Threads de leitura, ao menos 1
+ * \param kernel - DB_SCAN_SIMD or DB_SCAN_SCALAR, both give the same aggregates // Ambos dão os mesmos agregados
+ * \return Pointer to the scan // Ponteiro para a leitura
+ */
+DbScan *create_db_scan(int threads, DbScanKernel kernel);
+
+/**
+ * \brief Free a scan // Libera uma leitura
+ *
+ * \param scan - Pointer to the scan, may be NULL // Ponteiro para a leitura, pode ser NULL
+ */
+void destroy_db_scan(DbScan *scan);
+
+/**
+ * \brief Map a db file and parse it across the threads // Mapeia um arquivo db e o lê com todas as threads
+ *
+ * \details The file is cut into record-aligned chunks (each starts at an "ID: " line), many more than threads, and
+ *          every thread takes the next chunk until none is left. Chunk results are summed in file order, so the
+ *          aggregates don't depend on the thread count. Condition names are found with a perfect hash.
+ * \details O arquivo é cortado em pedaços alinhados a registros (cada um começa numa linha "ID: "), muito mais que
+ *          threads, e cada thread pega o próximo pedaço até não sobrar nenhum. Os resultados são somados na ordem do
+ *          arquivo, então os agregados não dependem do número de threads. As condições usam um hash perfeito.
+ * \param scan - Pointer to the scan // Ponteiro para a leitura
+ * \param kind - Format of the file; DB_REPORTS joins with the last DB_EXAMS file // Formato do arquivo
+ * \param path - Path of the file // Caminho do arquivo
+ * \return 0 on success, -1 if the file can't be opened or mapped // 0 em sucesso, -1 se o arquivo não pode ser aberto ou mapeado
+ */
+int db_scan_file(DbScan *scan, DbKind kind, const char *path);
+
+/**
+ * \brief Copy the aggregates of every file read so far // Copia os agregados de todos os arquivos lidos
+ *
+ * \param scan - Pointer to the scan // Ponteiro para a leitura
+ * \param result - Receives the aggregates // Recebe os agregados
+ */
+void get_db_scan_result(DbScan *scan, DbScanResult *result);
+
+/**
+ * \brief Turnaround percentile // Percentil do tempo entre exame e laudo
+ *
+ * \param result - Pointer to the aggregates // Ponteiro para os agregados
+ * \param priority - 1 to DB_SCAN_PRIORITIES, 0 for every report // 0 para todos os laudos
+ * \param fraction - 0.5 for the median, 0.99 for p99 // 0.5 para a mediana
+ * \return Whole seconds, DB_SCAN_SECONDS - 1 meaning at least that, -1 without reports // Segundos inteiros, -1 sem laudos
+ */
+int db_scan_percentile(const DbScanResult *result, int priority, double fraction);
+
+/**
+ * \brief Kernel from its command line name // Kernel a partir do nome na linha de comando
+ *
+ * \param name - "simd" or "scalar" // "simd" ou "scalar"
+ * \return DbScanKernel, or -1 for an unknown name // DbScanKernel, ou -1 para nome desconhecido
+ */
+int db_scan_kernel_from_name(const char *name);
+
+#endif // DB_SCAN_H_INCLUDED
@@ -0,0 +1,404 @@
+#include "doctors.h"
+#include "work_deque.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+static const char *specialty_names[SPECIALTY_COUNT] = {"general", "infectious", "pulmonology", "oncology"};
+
+typedef struct doctor {
+    struct doctor_pool *pool;
+    int index;
+    DoctorSpecialty specialty;
+    WorkDeque *deque;        // Exams routed to this doctor; the submitting thread owns the bottom // Exames roteados; a thread que submete é dona da base
+    atomic_int busy;         // 1 while writing a report // 1 enquanto escreve um laudo
+    pthread_t thread;
+    DoctorStats stats;       // Written by the doctor thread, `routed` by the submitting thread // Escritos pela thread do médico, `routed` pela que submete
+} Doctor;
+
+struct doctor_pool {
+    Doctor doctors[DOCTOR_MAX];
+    int size;
+    DoctorWork work;
+    void *context;
+    atomic_int backlog;      // Exams in all the deques // Exames em todos os deques
+    atomic_int busy;         // Doctors writing a report // Médicos escrevendo um laudo
+    pthread_mutex_t mutex;   // Only guards the sleep of idle doctors // Protege apenas o sono dos médicos ociosos
+    pthread_cond_t work_ready;
+    unsigned wakeups;        // Bumped with every broadcast, so a doctor never sleeps through one // Incrementado a cada aviso
+    int running;
+    int stopping;
+};
+
+DoctorSpecialty specialty_for_condition(const char *condition) {
+/**
+ * \brief Specialty that covers a condition // Especialidade que cobre uma condição
+ *
+ * \return DoctorSpecialty - SPECIALTY_GENERAL for Normal Health and unknown names // SPECIALTY_GENERAL para Normal Health e nomes desconhecidos
+ */
+    if (!condition) {
+        return SPECIALTY_GENERAL;
+    }
+    if (strcmp(condition, "Lung Cancer") == 0) {
+        return SPECIALTY_ONCOLOGY;
+    }
+    if (strcmp(condition, "Pneumonia") == 0 || strcmp(condition, "COVID") == 0 || strcmp(condition, "Tuberculosis") == 0) {
+        return SPECIALTY_INFECTIOUS;
+    }
+    if (strcmp(condition, "Bronchitis") == 0 || strcmp(condition, "Pulmonary Embolism") == 0 ||
+        strcmp(condition, "Pleural Effusion") == 0 || strcmp(condition, "Pulmonary Fibrosis") == 0) {
+        return SPECIALTY_PULMONOLOGY;
+    }
+    return SPECIALTY_GENERAL;
+}
+
+int specialty_from_name(const char *name) {
+/**
+ * \brief Parse a specialty name // Interpreta o nome de uma especialidade
+ *
+ * \return int - The DoctorSpecialty, or -1 if the name is unknown // A DoctorSpecialty, ou -1 se o nome for desconhecido
+ */
+    for (int i = 0; i < SPECIALTY_COUNT; i++) {
+        if (name && strcmp(name, specialty_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *specialty_name(DoctorSpecialty specialty) {
+/**
+ * \brief Name of a specialty // Nome de uma especialidade
+ */
+    if (specialty < 0 || specialty >= SPECIALTY_COUNT) {
+        return "unknown";
+    }
+    return specialty_names[specialty];
+}
+
+DoctorPool *create_doctor_pool(const char *roster, DoctorWork work, void *context) {
+/**
+ * \brief Create the doctors, not started yet // Cria os médicos, ainda parados
+ *
+ * \param roster - Comma separated specialties, NULL for DOCTOR_DEFAULT_ROSTER // Especialidades separadas por vírgula
+ * \param work - Called by a doctor thread for each exam it takes // Chamada pela thread do médico para cada exame que pega
+ * \param context - Passed to `work` // Repassado para `work`
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return DoctorPool* - Pointer to the pool, NULL if the roster is invalid // Ponteiro para o pool, NULL se a lista for inválida
+ */
+    if (!work) {
+        return NULL;
+    }
+
+    // The whole roster is validated before anything is allocated
+    int specialties[DOCTOR_MAX];
+    int count = 0;
+    const char *cursor = roster ? roster : DOCTOR_DEFAULT_ROSTER;
+    while (*cursor) {
+        char name[32];
+        size_t length = strcspn(cursor, ",");
+        if (length == 0 || length >= sizeof(name) || count == DOCTOR_MAX) {
+            return NULL;
+        }
+        memcpy(name, cursor, length);
+        name[length] = '\0';
+        if ((specialties[count] = specialty_from_name(name)) < 0) {
+            return NULL;
+        }
+        count++;
+        cursor += length;
+        if (*cursor == ',') {
+            cursor++;
+        }
+    }
+    if (count == 0) {
+        return NULL;
+    }
+
+    DoctorPool *pool = (DoctorPool*)calloc(1, sizeof(DoctorPool));
+    if (!pool) {
+        printf("\nError: Memory allocation failed (Doctor Pool)\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        pool->doctors[i].pool = pool;
+        pool->doctors[i].index = i;
+        pool->doctors[i].specialty = (DoctorSpecialty)specialties[i];
+        pool->doctors[i].stats.specialty = (DoctorSpecialty)specialties[i];
+        pool->doctors[i].deque = create_work_deque();
+        atomic_init(&pool->doctors[i].busy, 0);
+    }
+    pool->size = count;
+    pool->work = work;
+    pool->context = context;
+    atomic_init(&pool->backlog, 0);
+    atomic_init(&pool->busy, 0);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    return pool;
+}
+
+static Exam *steal_from_peers(DoctorPool *pool, int self) {
+// An idle doctor takes the oldest exam of the longest deque whose owner can't get to it soon: the owner is
+// busy, or has more than one exam waiting. An idle owner is left its single exam, which keeps the affinity.
+// Um médico ocioso pega o exame mais antigo do maior deque cujo dono não vai atendê-lo logo: o dono está
+// ocupado, ou tem mais de um exame esperando. Um dono ocioso fica com seu único exame, mantendo a afinidade.
+    for (;;) {
+        int victim = -1;
+        long longest = 0;
+        for (int i = 0; i < pool->size; i++) {
+            if (i == self) {
+                continue;
+            }
+            long waiting = work_deque_size(pool->doctors[i].deque);
+            int owner_busy = atomic_load(&pool->doctors[i].busy);
+            if ((waiting > 1 || (waiting == 1 && owner_busy)) && waiting > longest) {
+                victim = i;
+                longest = waiting;
+            }
+        }
+        if (victim < 0) {
+            return NULL;
+        }
+        Exam *exam = (Exam*)work_deque_steal(pool->doctors[victim].deque);
+        if (exam) {
+            return exam;
+        }
+        // Another thief won the exam: look again rather than sleep with exams left // Outro ladrão ganhou: procura de novo
+    }
+}
+
+static void wake_doctors(DoctorPool *pool) {
+// Idle doctors look for work again // Os médicos ociosos procuram trabalho de novo
+    pthread_mutex_lock(&pool->mutex);
+    pool->wakeups++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void *doctor_thread(void *args) {
+// Own deque first, then a peer's, then sleep until something changes // Primeiro o próprio deque, depois o de um colega, depois dorme
+    Doctor *doctor = (Doctor*)args;
+    DoctorPool *pool = doctor->pool;
+    int self = doctor->index;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        int stopping = pool->stopping;
+        unsigned wakeups = pool->wakeups; // Read before looking for work // Lido antes de procurar trabalho
+        pthread_mutex_unlock(&pool->mutex);
+        if (stopping) {
+            break;
+        }
+
+        int stolen = 0;
+        Exam *exam = (Exam*)work_deque_steal(doctor->deque);
+        if (!exam && (exam = steal_from_peers(pool, self)) != NULL) {
+            stolen = 1;
+        }
+
+        if (exam) {
+            // Busy goes up before the backlog goes down, so backlog + busy never reads 0 while an exam is in hand
+            atomic_store(&doctor->busy, 1);
+            atomic_fetch_add(&pool->busy, 1);
+            atomic_fetch_sub(&pool->backlog, 1);
+            doctor->stats.reports++;
+            doctor->stats.stolen += stolen;
+            doctor->stats.matched += specialty_for_condition(get_exam_condition(exam)) == doctor->specialty;
+            if (stolen) {
+                LOG_DEBUG(LOG_CAT_REPORT, "\nDoctor %d (%s) stole exam %d", self + 1, specialty_names[doctor->specialty], get_exam_id(exam));
+            }
+            if (work_deque_size(doctor->deque) > 0) {
+                wake_doctors(pool); // Busy now, so what waits in its deque may be stolen // Ocupado, então seus exames podem ser roubados
+            }
+            pool->work(exam, self, pool->context);
+            atomic_fetch_sub(&pool->busy, 1);
+            atomic_store(&doctor->busy, 0);
+            continue;
+        }
+
+        // Nothing to take, or only exams their idle owners are about to take: sleep until an exam is routed, an owner
+        // gets busy with exams still waiting, or the pool stops
+        // Nada a pegar, ou só exames que seus donos ociosos vão pegar: dorme até um exame ser roteado, um dono ficar
+        // ocupado com exames esperando, ou o pool parar
+        pthread_mutex_lock(&pool->mutex);
+        while (!pool->stopping && pool->wakeups == wakeups) {
+            pthread_cond_wait(&pool->work_ready, &pool->mutex);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return NULL;
+}
+
+int doctor_pool_start(DoctorPool *pool) {
+/**
+ * \brief Start one thread per doctor // Inicia uma thread por médico
+ *
+ * \return int - 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+    if (!pool || pool->running) {
+        return -1;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = 0; // After doctor_pool_stop() the pool may start again // Depois de doctor_pool_stop() o pool pode recomeçar
+    for (int i = 0; i < pool->size; i++) {
+        if (pthread_create(&pool->doctors[i].thread, NULL, doctor_thread, &pool->doctors[i]) != 0) {
+            pool->stopping = 1;
+            pthread_mutex_unlock(&pool->mutex);
+            for (int j = 0; j < i; j++) {
+                pthread_join(pool->doctors[j].thread, NULL);
+            }
+            return -1;
+        }
+    }
+    pool->running = 1;
+    pthread_mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+int submit_exam_to_doctors(DoctorPool *pool, Exam *exam) {
+/**
+ * \brief Route an exam to the least loaded doctor of its specialty // Roteia um exame para o médico menos ocupado da especialidade
+ *
+ * \return int - Index of the doctor it was routed to // Índice do médico para quem foi roteado
+ */
+    DoctorSpecialty wanted = specialty_for_condition(get_exam_condition(exam));
+    int chosen[3] = {-1, -1, -1};  // Best specialist, best general doctor, best anyone // Melhor especialista, clínico e qualquer um
+    long load[3] = {0, 0, 0};
+
+    for (int i = 0; i < pool->size; i++) {
+        long current = work_deque_size(pool->doctors[i].deque) + atomic_load(&pool->doctors[i].busy);
+        int tiers[3] = {pool->doctors[i].specialty == wanted, pool->doctors[i].specialty == SPECIALTY_GENERAL, 1};
+        for (int t = 0; t < 3; t++) {
+            if (tiers[t] && (chosen[t] < 0 || current < load[t])) {
+                chosen[t] = i;
+                load[t] = current;
+            }
+        }
+    }
+    int target = chosen[0] >= 0 ? chosen[0] : chosen[1] >= 0 ? chosen[1] : chosen[2];
+
+    work_deque_push(pool->doctors[target].deque, exam);
+    pool->doctors[target].stats.routed++;
+    atomic_fetch_add(&pool->backlog, 1);
+    wake_doctors(pool); // The owner takes it if idle, otherwise an idle peer steals it
+    return target;
+}
+
+int doctor_pool_backlog(DoctorPool *pool) {
+/**
+ * \brief Exams routed and not taken yet // Exames roteados e ainda não pegos
+ */
+    return pool ? atomic_load(&pool->backlog) : 0;
+}
+
+int doctor_pool_busy(DoctorPool *pool) {
+/**
+ * \brief Doctors writing a report right now // Médicos escrevendo um laudo agora
+ */
+    return pool ? atomic_load(&pool->busy) : 0;
+}
+
+int doctor_pool_size(DoctorPool *pool) {
+/**
+ * \brief Number of doctors // Número de médicos
+ */
+    return pool ? pool->size : 0;
+}
+
+int doctor_pool_stop(DoctorPool *pool) {
+/**
+ * \brief Stop the doctors once they finish the exam in hand, and free the exams still routed // Para os médicos e libera os exames ainda roteados
+ *
+ * \return int - Number of exams freed without a report // Número de exames liberados sem laudo
+ */
+    if (!pool) {
+        return 0;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    int running = pool->running;
+    pool->stopping = 1;
+    pool->running = 0;
+    pool->wakeups++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (running) {
+        for (int i = 0; i < pool->size; i++) {
+            pthread_join(pool->doctors[i].thread, NULL);
+        }
+    }
+
+    int freed = 0;
+    for (int i = 0; i < pool->size; i++) {
+        Exam *exam;
+        while ((exam = (Exam*)work_deque_steal(pool->doctors[i].deque)) != NULL) {
+            destroy_exam(exam);
+            atomic_fetch_sub(&pool->backlog, 1);
+            freed++;
+        }
+    }
+    return freed;
+}
+
+void destroy_doctor_pool(DoctorPool *pool) {
+/**
+ * \brief Free the pool, stopping it first // Libera o pool, parando-o antes
+ */
+    if (!pool) {
+        return;
+    }
+    doctor_pool_stop(pool);
+    for (int i = 0; i < pool->size; i++) {
+        destroy_work_deque(pool->doctors[i].deque);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_ready);
+    free(pool);
+}
+
+int get_doctor_stats(DoctorPool *pool, DoctorStats *stats, int max_stats) {
+/**
+ * \brief Copy the counters of every doctor // Copia os contadores de cada médico
+ *
+ * \details Exact once the pool is stopped; while it runs the values may lag by a report.
+ * \details Exatos com o pool parado; durante a execução podem estar um laudo atrasados.
+ *
+ * \return int - Number of doctors copied // Número de médicos copiados
+ */
+    if (!pool || !stats) {
+        return 0;
+    }
+    int count = pool->size < max_stats ? pool->size : max_stats;
+    for (int i = 0; i < count; i++) {
+        stats[i] = pool->doctors[i].stats;
+    }
+    return count;
+}
+
+void print_doctor_stats(DoctorPool *pool) {
+/**
+ * \brief Print the counters of every doctor // Imprime os contadores de cada médico
+ */
+    DoctorStats stats[DOCTOR_MAX];
+    int count = get_doctor_stats(pool, stats, DOCTOR_MAX);
+    long reports = 0, stolen = 0, matched = 0;
+
+    printf("\nDoctors (work stealing):\n");
+    for (int i = 0; i < count; i++) {
+        printf("Doctor %d (%s): routed %ld, reports %ld, stolen %ld, own specialty %ld\n",
+               i + 1, specialty_names[stats[i].specialty], stats[i].routed, stats[i].reports, stats[i].stolen, stats[i].matched);
+        reports += stats[i].reports;
+        stolen += stats[i].stolen;
+        matched += stats[i].matched;
+    }
+    if (reports > 0) {
+        printf("Total: %ld reports, %.1lf%% stolen, %.1lf%% by a doctor of the exam's specialty\n",
+               reports, 100.0 * stolen / reports, 100.0 * matched / reports);
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef DOCTORS_H_INCLUDED
+#define DOCTORS_H_INCLUDED
+
+#include "exam.h"
+
+#define DOCTOR_MAX 64                                                           // Doctors in one pool // Médicos em um pool
+#define DOCTOR_DEFAULT_ROSTER "general,general,infectious,pulmonology,oncology" // Default team // Equipe padrão
+
+/**
+ * \brief Specialty of a doctor // Especialidade de um médico
+ */
+typedef enum doctor_specialty {
+    SPECIALTY_GENERAL,      // Normal Health and anything no specialist covers // Normal Health e o que nenhum especialista cobre
+    SPECIALTY_INFECTIOUS,   // Pneumonia, COVID, Tuberculosis
+    SPECIALTY_PULMONOLOGY,  // Bronchitis, Pulmonary Embolism, Pleural Effusion, Pulmonary Fibrosis
+    SPECIALTY_ONCOLOGY,     // Lung Cancer
+    SPECIALTY_COUNT
+} DoctorSpecialty;
+
+/**
+ * \brief Writes the report of one exam and takes ownership of it // Escreve o laudo de um exame e assume o exame
+ *
+ * \param exam - Exam taken by the doctor // Exame pego pelo médico
+ * \param doctor - Index of the doctor in the pool // Índice do médico no pool
+ * \param context - Pointer given to create_doctor_pool() // Ponteiro passado para create_doctor_pool()
+ */
+typedef void (*DoctorWork)(Exam *exam, int doctor, void *context);
+
+/**
+ * \brief Counters of one doctor // Contadores de um médico
+ */
+typedef struct doctor_stats {
+    DoctorSpecialty specialty;
+    long reports;     // Exams taken // Exames pegos
+    long stolen;      // ... from another doctor's deque // ... do deque de outro médico
+    long matched;     // ... of the doctor's own specialty // ... da especialidade do médico
+    long routed;      // Exams routed to this doctor // Exames roteados para este médico
+} DoctorStats;
+
+// Team of doctor threads, each with a work stealing deque of routed exams // Equipe de threads de médicos com deques de roubo de trabalho
+typedef struct doctor_pool DoctorPool;
+
+/**
+ * \brief Create the doctors, not started yet // Cria os médicos, ainda parados
+ *
+ * \param roster - Comma separated specialties, e.g. "general,oncology"; NULL for DOCTOR_DEFAULT_ROSTER // Especialidades separadas por vírgula
+ * \param work - Called by a doctor thread for each exam it takes // Chamada pela thread do médico para cada exame que pega
+ * \param context - Passed to `work` // Repassado para `work`
+ * \return Pointer to the pool, NULL if the roster is invalid // Ponteiro para o pool, NULL se a lista for inválida
+ */
+DoctorPool *create_doctor_pool(const char *roster, DoctorWork work, void *context);
+
+/**
+ * \brief Start one thread per doctor // Inicia uma thread por médico
+ *
+ * \details A pool stopped by doctor_pool_stop() can be started again; its counters are kept.
+ * \details Um pool parado por doctor_pool_stop() pode ser iniciado de novo; os contadores são mantidos.
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \return 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+int doctor_pool_start(DoctorPool *pool);
+
+/**
+ * \brief Route an exam to the least loaded doctor of its specialty // Roteia um exame para o médico menos ocupado da especialidade
+ *
+ * \details Without a specialist for the condition, a general doctor gets it; without one, the least loaded doctor.
+ *          Only one thread may submit, it is the owner end of every deque.
+ * \details Sem especialista para a condição, um clínico geral recebe; sem clínico, o médico menos ocupado.
+ *          Apenas uma thread pode submeter, ela é a dona de todos os deques.
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \param exam - Exam waiting for its report // Exame esperando o laudo
+ * \return Index of the doctor it was routed to // Índice do médico para quem foi roteado
+ */
+int submit_exam_to_doctors(DoctorPool *pool, Exam *exam);
+
+/**
+ * \brief Exams routed and not taken yet // Exames roteados e ainda não pegos
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \return Number of exams // Número de exames
+ */
+int doctor_pool_backlog(DoctorPool *pool);
+
+/**
+ * \brief Doctors writing a report right now // Médicos escrevendo um laudo agora
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \return Number of doctors // Número de médicos
+ */
+int doctor_pool_busy(DoctorPool *pool);
+
+/**
+ * \brief Number of doctors // Número de médicos
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \return Number of doctors // Número de médicos
+ */
+int doctor_pool_size(DoctorPool *pool);
+
+/**
+ * \brief Stop the doctors once they finish the exam in hand, and free the exams still routed // Para os médicos e libera os exames ainda roteados
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \return Number of exams freed without a report // Número de exames liberados sem laudo
+ */
+int doctor_pool_stop(DoctorPool *pool);
+
+/**
+ * \brief Free the pool, stopping it first // Libera o pool, parando-o antes
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ */
+void destroy_doctor_pool(DoctorPool *pool);
+
+/**
+ * \brief Copy the counters of every doctor // Copia os contadores de cada médico
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ * \param stats - Array of at least `max_stats` entries // Array com pelo menos `max_stats` posições
+ * \param max_stats - Size of the array // Tamanho do array
+ * \return Number of doctors copied // Número de médicos copiados
+ */
+int get_doctor_stats(DoctorPool *pool, DoctorStats *stats, int max_stats);
+
+/**
+ * \brief Print the counters of every doctor // Imprime os contadores de cada médico
+ *
+ * \param pool - Pointer to the pool // Ponteiro para o pool
+ */
+void print_doctor_stats(DoctorPool *pool);
+
+/**
+ * \brief Specialty that covers a condition // Especialidade que cobre uma condição
+ *
+ * \param condition - Condition name // Nome da condição
+ * \return The DoctorSpecialty, SPECIALTY_GENERAL for unknown names // A DoctorSpecialty, SPECIALTY_GENERAL para nomes desconhecidos
+ */
+DoctorSpecialty specialty_for_condition(const char *condition);
+
+/**
+ * \brief Parse a specialty name // Interpreta o nome de uma especialidade
+ *
+ * \param name - "general", "infectious", "pulmonology" or "oncology"
+ * \return The DoctorSpecialty, or -1 if the name is unknown // A DoctorSpecialty, ou -1 se o nome for desconhecido
+ */
+int specialty_from_name(const char *name);
+
+/**
+ * \brief Name of a specialty // Nome de uma especialidade
+ *
+ * \param specialty - DoctorSpecialty
+ * \return Constant string // String constante
+ */
+const char *specialty_name(DoctorSpecialty specialty);
+
+#endif // DOCTORS_H_INCLUDED
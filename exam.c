@@ -3,6 +3,7 @@
 #include <time.h>
 #include <string.h>
 #include "exam.h"
+#include "logger.h"
 
 struct exam{
     int id;
@@ -10,6 +11,7 @@ struct exam{
     int patient_id;
     char *condition;
     struct tm *exam_time;
+    ImageBuffer *image;   // Handle to the exam image in the buffer store, NULL if none // Handle da imagem do exame no pool de buffers
 
 
 };
@@ -36,7 +38,7 @@ Exam *create_exam(int id, int rx_id, int patient_id, const char * condition, con
 
     /* Checks if the time pointer is NULL // Verifica se o ponteiro de time é nulo */
     if (!exam_time) {
-        printf("\nError: Exam's time cannot be NULL\n");
+        LOG_ERROR(LOG_CAT_EXAM, "\nError: Exam's time cannot be NULL");
         return NULL;
     }
 
@@ -44,7 +46,7 @@ Exam *create_exam(int id, int rx_id, int patient_id, const char * condition, con
     // Aloca memória para estrutura de exame e verifica se a alocação foi bem-sucedida */
     Exam *new_exam = (Exam*)malloc(sizeof(Exam));
     if (!new_exam) {
-        printf("\nFailed to allocate memory for exam's structure\n");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for exam's structure");
         return NULL;
     }
 
@@ -52,7 +54,7 @@ Exam *create_exam(int id, int rx_id, int patient_id, const char * condition, con
     // Aloca memória para o horário do exame e verifica se a alocação foi bem-sucedida */
     new_exam->exam_time = (struct tm*)malloc(sizeof(struct tm));
     if (!new_exam->exam_time) {
-        printf("\nFailed to allocate memory for time structure\n");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for time structure");
         free(new_exam);
         return NULL;
     }
@@ -61,6 +63,7 @@ Exam *create_exam(int id, int rx_id, int patient_id, const char * condition, con
     new_exam->id = id;
     new_exam->patient_id = patient_id;
     new_exam->rx_id = rx_id;
+    new_exam->image = NULL;
 
     /* Copy the tm structure // Copia a estrutura tm */
     memcpy(new_exam->exam_time, exam_time, sizeof(struct tm));
@@ -70,7 +73,7 @@ Exam *create_exam(int id, int rx_id, int patient_id, const char * condition, con
 
     new_exam->condition = (char*)malloc(strlen(condition)+1*sizeof(char));
     if(!new_exam->condition){
-        printf("\nFailed to allocate memory for condition str\n");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for condition str");
         free(new_exam);
         return NULL;
     }
@@ -93,7 +96,7 @@ void destroy_exam(Exam *old_exam) {
 
     /* Checks if the exam pointer is NULL // Verifica se o ponteiro do exame é nulo */
     if (!old_exam) {
-        printf("\nNULL POINTER!!\n");
+        LOG_ERROR(LOG_CAT_EXAM, "\nNULL POINTER!!");
         return;
     }
 
@@ -108,9 +111,12 @@ void destroy_exam(Exam *old_exam) {
 
     }
 
+    /* Drop the exam's reference to its image // Solta a referência do exame à sua imagem */
+    image_buffer_release(old_exam->image);
+
     /* Free the exam structure itself // Libera a própria estrutura do exame */
     free(old_exam);
-    printf("Memory Allocation Freed!(Exam)\n");
+    LOG_DEBUG(LOG_CAT_MEMORY, "Memory Allocation Freed!(Exam)");
 }
 
 int get_exam_id(Exam *exam) {
@@ -127,7 +133,7 @@ int get_exam_id(Exam *exam) {
 
     /* Checks if the exam pointer is NULL // Verifica se o ponteiro do exame é nulo */
     if (!exam) {
-        printf("\nError: NULL exam pointer\n");
+        LOG_ERROR(LOG_CAT_EXAM, "\nError: NULL exam pointer");
         return 1;
     }
 
@@ -148,7 +154,7 @@ int get_exam_patient_id(Exam *exam) {
 
     /* Checks if the exam pointer is NULL // Verifica se o ponteiro do exame é nulo */
     if (!exam) {
-        fprintf(stderr, "Error: NULL exam pointer\n");
+        LOG_ERROR(LOG_CAT_EXAM, "Error: NULL exam pointer");
         return 1;
     }
 
@@ -169,7 +175,7 @@ int get_exam_rx_id(Exam *exam) {
 
     /* Checks if the exam pointer is NULL // Verifica se o ponteiro do exame é nulo */
     if (!exam) {
-        fprintf(stderr, "Error: NULL exam pointer\n");
+        LOG_ERROR(LOG_CAT_EXAM, "Error: NULL exam pointer");
         return 1;
     }
 
@@ -189,7 +195,7 @@ struct tm *get_exam_time(Exam *exam) {
 
     /* Checks if the exam pointer is NULL // Verifica se o ponteiro do exame é nulo */
     if (!exam) {
-        printf("\nError: NULL exam pointer\n");
+        LOG_ERROR(LOG_CAT_EXAM, "\nError: NULL exam pointer");
         return NULL;
     }
 
@@ -212,20 +218,22 @@ void print_exam(Exam *exam) {
      * \details Esta função imprime o ID, ID do paciente, ID da máquina, condição e data e hora do exame de maneira formatada.
      *
      */
-    if (exam) {
-        printf("\n\t=============================\n");
-        printf("\t          AI EXAM\n");
-        printf("\t=============================\n");
-        printf("\tExam ID         : %d\n", get_exam_id(exam));
-        printf("\tPatient ID      : %d\n", get_exam_patient_id(exam));
-        printf("\tX-ray Machine ID: %d\n", get_exam_rx_id(exam));
-        printf("\tCondition       : %s\n", exam->condition);
-
+    if (exam && log_enabled(LOG_LEVEL_INFO, LOG_CAT_EXAM)) {
         char buffer[100];
         strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", get_exam_time(exam));
-        printf("\tDate and Time   : %s\n", buffer);
 
-        printf("\t=============================\n");
+        /* The whole banner is one log record // O banner inteiro é um único registro */
+        LOG_INFO(LOG_CAT_EXAM,
+                 "\n\t=============================\n"
+                 "\t          AI EXAM\n"
+                 "\t=============================\n"
+                 "\tExam ID         : %d\n"
+                 "\tPatient ID      : %d\n"
+                 "\tX-ray Machine ID: %d\n"
+                 "\tCondition       : %s\n"
+                 "\tDate and Time   : %s\n"
+                 "\t=============================\n",
+                 get_exam_id(exam), get_exam_patient_id(exam), get_exam_rx_id(exam), exam->condition, buffer);
     }
 }
 
@@ -242,27 +250,11 @@ void print_exam_db(Exam *current_exam, FILE *exam_file){
      * \warning Se o ponteiro do exame ou o ponteiro do arquivo forem NULL, uma mensagem de erro é impressa e o programa é encerrado.
      */
 
-    if(current_exam && exam_file){
-
-    fprintf(exam_file, "ID: %d\n", get_exam_id(current_exam));
-    fprintf(exam_file, "RX ID: %d\n", get_exam_rx_id(current_exam));
-    fprintf(exam_file, "Patient ID: %d\n", get_exam_patient_id(current_exam));
-    fprintf(exam_file, "Condition: %s\n", get_exam_condition(current_exam));
-
-    const struct tm *exam_time = get_exam_time(current_exam);
-
-
-    if (exam_time) {
-
-    fprintf(exam_file, "Exam Time: %d-%02d-%02d %02d:%02d:%02d\n",
-            exam_time->tm_year + 1900,
-            exam_time->tm_mon + 1,
-            exam_time->tm_mday,
-            exam_time->tm_hour,
-            exam_time->tm_min,
-            exam_time->tm_sec);
+    char record[EXAM_DB_RECORD];
+    int length = format_exam_db(current_exam, record, sizeof(record));
+    if(length >= 0 && exam_file){
 
-    }
+    fwrite(record, 1, length, exam_file); // One call: records written by different threads never mix
 
     }else{
     printf("Error saving Exam on DB");
@@ -271,3 +263,73 @@ void print_exam_db(Exam *current_exam, FILE *exam_file){
 
 
 }
+
+int format_exam_db(Exam *exam, char *buffer, int size){
+    /** \brief Format the db record of an exam // Formata o registro db de um exame
+     *
+     * \param exam - Pointer to exam's structure // Ponteiro para a estrutura do exame
+     * \param buffer - Receives the record, the same lines print_exam_db() writes // Recebe o registro, as mesmas linhas que print_exam_db() grava
+     * \param size - Bytes of the buffer // Bytes do buffer
+     * \return Length of the record, -1 if the exam is NULL or the record doesn't fit // Tamanho do registro, -1 se o exame for NULL ou o registro não couber
+     */
+    if (!exam) {
+        return -1;
+    }
+    int length = snprintf(buffer, size, "ID: %d\nRX ID: %d\nPatient ID: %d\nCondition: %s\n",
+                          get_exam_id(exam), get_exam_rx_id(exam), get_exam_patient_id(exam), get_exam_condition(exam));
+    const struct tm *exam_time = get_exam_time(exam);
+    if (exam_time && length < size) {
+        length += snprintf(buffer + length, size - length, "Exam Time: %d-%02d-%02d %02d:%02d:%02d\n",
+                           exam_time->tm_year + 1900,
+                           exam_time->tm_mon + 1,
+                           exam_time->tm_mday,
+                           exam_time->tm_hour,
+                           exam_time->tm_min,
+                           exam_time->tm_sec);
+    }
+    return length < size ? length : -1;
+}
+
+void set_exam_image(Exam *exam, ImageBuffer *image) {
+    /** \brief Attach an image buffer to the exam // Anexa um buffer de imagem ao exame
+     *
+     * \param exam - Pointer to exam's structure // Ponteiro para a estrutura do exame
+     * \param image - Buffer whose reference now belongs to the exam // Buffer cuja referência agora pertence ao exame
+     *
+     * \details Only the handle is stored: the pixels stay where the machine wrote them, and moving the exam through
+     *          the priority queue moves the handle with it. A previous image is released.
+     * \details Apenas o handle é guardado: os pixels ficam onde a máquina os escreveu, e mover o exame pela fila de
+     *          prioridade move o handle junto. Uma imagem anterior é liberada.
+     */
+    if (!exam) {
+        LOG_ERROR(LOG_CAT_EXAM, "\nError: NULL exam pointer");
+        return;
+    }
+    if (exam->image != image) {
+        image_buffer_release(exam->image);
+    }
+    exam->image = image;
+}
+
+ImageBuffer *get_exam_image(Exam *exam) {
+    /** \brief Returns the exam's image without taking a reference // Retorna a imagem do exame sem pegar uma referência
+     *
+     * \param exam - Pointer to exam's structure // Ponteiro para a estrutura do exame
+     * \return Image handle, NULL if the exam has none // Handle da imagem, NULL se o exame não tiver
+     */
+    return exam ? exam->image : NULL;
+}
+
+void release_exam_image(Exam *exam) {
+    /** \brief Give the exam's image back to the buffer store // Devolve a imagem do exame ao pool de buffers
+     *
+     * \param exam - Pointer to exam's structure // Ponteiro para a estrutura do exame
+     *
+     * \details Called once the report is written, so the buffer is reused while the exam record lives on.
+     * \details Chamada assim que o laudo é escrito, para o buffer ser reutilizado enquanto o registro do exame continua.
+     */
+    if (exam && exam->image) {
+        image_buffer_release(exam->image);
+        exam->image = NULL;
+    }
+}
@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <time.h>
 #include <stddef.h>  // Para definir NULL e outros tipos úteis
+#include "image_store.h"
+
+#define EXAM_DB_RECORD 256  // Bytes of an exam db record // Bytes de um registro db de exame
 
 typedef struct exam Exam;
 
@@ -80,4 +83,38 @@ void print_exam(Exam *e);
  */
 
 void print_exam_db(Exam *current_exam, FILE *exam_file);
+
+/**
+ * Formats the exam's db record, the lines print_exam_db() writes.
+ *
+ * @param exam Pointer to the exam.
+ * @param buffer Receives the record.
+ * @param size Bytes of the buffer, EXAM_DB_RECORD is always enough.
+ * @return Length of the record, -1 if the exam is NULL or the record doesn't fit.
+ */
+int format_exam_db(Exam *exam, char *buffer, int size);
+
+/**
+ * Attaches an image buffer to the exam; the exam takes over the caller's reference.
+ *
+ * @param exam Pointer to the exam.
+ * @param image Image handle from the buffer store.
+ */
+void set_exam_image(Exam *exam, ImageBuffer *image);
+
+/**
+ * Retrieves the exam's image handle, without taking a reference.
+ *
+ * @param exam Pointer to the exam.
+ * @return Image handle, or NULL if the exam has no image.
+ */
+ImageBuffer *get_exam_image(Exam *exam);
+
+/**
+ * Returns the exam's image to the buffer store (called once the report is written).
+ *
+ * @param exam Pointer to the exam.
+ */
+void release_exam_image(Exam *exam);
+
 #endif // EXAM_H_INCLUDED
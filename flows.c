@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/resource.h>
+#include "patient.h"
+#include "exam.h"
+#include "rx_machine.h"
+#include "medical_check.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+#include "arrivals.h"
+#include "task_runtime.h"
+
+/*
+ * Patient flows as tasks // Fluxos de pacientes como tarefas
+ *
+ * Every patient is one task of the M:N runtime instead of a thread: arrival -> wait for a machine -> exam ->
+ * wait for a doctor (most urgent first) -> report -> DB write. A task keeps only its Flow state between steps,
+ * so hundreds of thousands of flows are alive at once on a few worker threads. Exam and report durations use the
+ * same model as main.c, on the runtime's virtual clock: a whole simulated day runs as fast as the steps do.
+ * Results are JSON: wall and simulated seconds, steps/s, peak concurrent flows, memory per flow, latencies.
+ */
+
+#define FLOWS_DEFAULT_PATIENTS 100000
+#define FLOWS_DEFAULT_WORKERS 4
+#define FLOWS_DEFAULT_RATE 1.0     // Patients per simulated second, above what 5 doctors can report // Acima do que 5 médicos conseguem laudar
+
+typedef enum flow_state {
+    FLOW_ARRIVING,   // Sleeping until its arrival time // Dormindo até o horário de chegada
+    FLOW_ARRIVED,    // In the clinic, asks for a machine // Na clínica, pede uma máquina
+    FLOW_EXAMINING,  // Holds a machine, runs the exam // Com uma máquina, faz o exame
+    FLOW_EXAMINED,   // Exam done, frees the machine and asks for a doctor // Exame feito, libera a máquina e pede um médico
+    FLOW_REPORTING,  // Holds a doctor, waits for the report duration // Com um médico, espera a duração do laudo
+    FLOW_REPORTED    // Report written // Laudo gravado
+} FlowState;
+
+typedef struct flow {
+    double arrival;     // Simulated arrival time // Tempo simulado de chegada
+    Exam *exam;
+    FlowState state;
+} Flow;
+
+typedef struct flow_clinic {
+    RxPool *machines;
+    TaskSemaphore *machine_permits;
+    TaskSemaphore *doctor_permits;
+    FILE *patient_file;
+    FILE *exam_file;
+    FILE *report_file;
+
+    pthread_mutex_t stats_mutex;
+    long reports;
+    long reports_delayed;
+    double latency_sum;     // Arrival to report, simulated seconds // Da chegada ao laudo, segundos simulados
+    double latency_max;
+} FlowClinic;
+
+static FlowClinic clinic;
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static FILE *open_db(const char *dir, const char *name) {
+    char path[512];
+    if (!dir) {
+        return fopen("/dev/null", "w");
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return fopen(path, "w");
+}
+
+static TaskStatus patient_flow(Task *task, void *data) {
+// One patient from arrival to report; every wait returns TASK_BLOCKED and resumes at the next state
+// Um paciente da chegada ao laudo; cada espera retorna TASK_BLOCKED e continua no próximo estado
+    Flow *flow = (Flow*)data;
+
+    switch (flow->state) {
+    case FLOW_ARRIVING:
+        flow->state = FLOW_ARRIVED;
+        task_sleep(task, flow->arrival - task_now(task_runtime(task)));
+        return TASK_BLOCKED;
+
+    case FLOW_ARRIVED:
+        flow->state = FLOW_EXAMINING;
+        if (!task_sem_acquire(task, clinic.machine_permits, 0)) {
+            return TASK_BLOCKED; // Resumes at FLOW_EXAMINING holding the machine // Volta em FLOW_EXAMINING já com a máquina
+        }
+        /* fall through */
+
+    case FLOW_EXAMINING: {
+        Patient *patient = patient_in();
+        flockfile(clinic.patient_file);
+        print_patient_db(patient, clinic.patient_file);
+        funlockfile(clinic.patient_file);
+
+        // The permit guarantees a free machine, so this never waits // A permissão garante uma máquina livre, então nunca espera
+        flow->exam = verify_and_ocupate(clinic.machines, patient);
+        destroy_patient(patient);
+        flockfile(clinic.exam_file);
+        print_exam_db(flow->exam, clinic.exam_file);
+        funlockfile(clinic.exam_file);
+
+        flow->state = FLOW_EXAMINED;
+        task_sleep(task, pre_random_time()); // Same exam duration as main.c // Mesma duração de exame do main.c
+        return TASK_BLOCKED;
+    }
+
+    case FLOW_EXAMINED:
+        task_sem_release(clinic.machine_permits);
+        flow->state = FLOW_REPORTING;
+        if (!task_sem_acquire(task, clinic.doctor_permits, get_ai_priority(flow->exam))) {
+            return TASK_BLOCKED;
+        }
+        /* fall through */
+
+    case FLOW_REPORTING: {
+        double duration = report_random_time(); // Same duration model as report() in main.c
+        if (duration > sim_config()->report_limit) {
+            pthread_mutex_lock(&clinic.stats_mutex);
+            clinic.reports_delayed++;
+            pthread_mutex_unlock(&clinic.stats_mutex);
+        }
+        flow->state = FLOW_REPORTED;
+        task_sleep(task, duration);
+        return TASK_BLOCKED;
+    }
+
+    case FLOW_REPORTED: {
+        Report *report = do_medical_report(flow->exam);
+        flockfile(clinic.report_file);
+        print_report_db(report, clinic.report_file);
+        funlockfile(clinic.report_file);
+        free_report(report);
+        destroy_exam(flow->exam);
+        flow->exam = NULL;
+        task_sem_release(clinic.doctor_permits);
+
+        double latency = task_now(task_runtime(task)) - flow->arrival;
+        pthread_mutex_lock(&clinic.stats_mutex);
+        clinic.reports++;
+        clinic.latency_sum += latency;
+        if (latency > clinic.latency_max) {
+            clinic.latency_max = latency;
+        }
+        pthread_mutex_unlock(&clinic.stats_mutex);
+        return TASK_DONE;
+    }
+    }
+    return TASK_DONE;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -p, --patients N     Patient flows, each one a task (default %d)\n", FLOWS_DEFAULT_PATIENTS);
+    printf("  -w, --workers N      Worker threads running the tasks, 1 to %d (default %d)\n", TASK_MAX_WORKERS, FLOWS_DEFAULT_WORKERS);
+    printf("  -m, --machines N     RX machines (default %d, the machines of the clinic configuration)\n", sim_config()->machines);
+    printf("  -d, --doctors N      Doctors (default 5)\n");
+    printf("  -o, --db-dir DIR     Write db_*.txt into DIR instead of /dev/null\n");
+    printf("      --arrival-rate R Patients per simulated second (default %.2f)\n", FLOWS_DEFAULT_RATE);
+    printf("      --arrivals KIND  poisson, varying or batch (default poisson)\n");
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"patients", required_argument, NULL, 'p'},
+        {"workers", required_argument, NULL, 'w'},
+        {"machines", required_argument, NULL, 'm'},
+        {"doctors", required_argument, NULL, 'd'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"arrival-rate", required_argument, NULL, 'R'},
+        {"arrivals", required_argument, NULL, 'A'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "p:w:m:d:o:h";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    ArrivalConfig arrivals = {ARRIVAL_POISSON, FLOWS_DEFAULT_RATE, 0.5, 3600.0, 3.0};
+    long patients = FLOWS_DEFAULT_PATIENTS;
+    int workers = FLOWS_DEFAULT_WORKERS;
+    int machines = constants.machines;
+    int doctors = 5;
+    const char *db_dir = NULL;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'p': patients = atol(optarg); break;
+        case 'w': workers = atoi(optarg); break;
+        case 'm': machines = atoi(optarg); break;
+        case 'd': doctors = atoi(optarg); break;
+        case 'o': db_dir = optarg; break;
+        case 'R': arrivals.rate = atof(optarg); break;
+        case 'A': arrivals.kind = arrival_kind_from_name(optarg); break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    ArrivalProcess *process = create_arrival_process(&arrivals, (unsigned int)time(NULL));
+    TaskRuntime *runtime = create_task_runtime(workers);
+    if (patients < 1 || machines < 1 || doctors < 1 || !process || !runtime) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    log_set_quiet(1);   // Console output would be the only thing measured otherwise
+    set_time_scale(0);  // Durations are virtual-clock timers, the exam itself must not sleep
+    rng_seed((unsigned int)time(NULL));
+
+    memset(&clinic, 0, sizeof(clinic));
+    pthread_mutex_init(&clinic.stats_mutex, NULL);
+    clinic.machines = create_machines(machines);
+    clinic.machine_permits = create_task_semaphore(runtime, machines, 1);
+    clinic.doctor_permits = create_task_semaphore(runtime, doctors, TASK_MAX_PRIORITIES);
+    clinic.patient_file = open_db(db_dir, "db_patient.txt");
+    clinic.exam_file = open_db(db_dir, "db_exam.txt");
+    clinic.report_file = open_db(db_dir, "db_report.txt");
+    Flow *flows = (Flow*)calloc(patients, sizeof(Flow));
+    if (!clinic.patient_file || !clinic.exam_file || !clinic.report_file || !flows) {
+        fprintf(stderr, "Error: could not set up the patient flows\n");
+        return 1;
+    }
+
+    // Every flow exists from the start, sleeping until its sampled arrival // Todo fluxo existe desde o início, dormindo até sua chegada
+    long spawned = 0;
+    while (spawned < patients) {
+        int count = 1;
+        arrival_next(process, &count);
+        for (int i = 0; i < count && spawned < patients; i++, spawned++) {
+            flows[spawned].arrival = arrival_clock(process);
+            flows[spawned].state = FLOW_ARRIVING;
+            task_spawn(runtime, patient_flow, &flows[spawned]);
+        }
+    }
+
+    double start = now_seconds();
+    double process_cpu_start = (double)clock() / CLOCKS_PER_SEC;
+    int result = task_runtime_run(runtime);
+    double elapsed = now_seconds() - start;
+    double process_cpu = (double)clock() / CLOCKS_PER_SEC - process_cpu_start;
+    fflush(clinic.patient_file);
+    fflush(clinic.exam_file);
+    fflush(clinic.report_file);
+
+    TaskRuntimeStats stats;
+    get_task_runtime_stats(runtime, &stats);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("{\"patients\": %ld, \"workers\": %d, \"machines\": %d, \"doctors\": %d, \"arrival_rate\": %.3f,\n"
+           " \"wall_seconds\": %.4f, \"simulated_seconds\": %.1f, \"process_cpu_seconds\": %.4f,\n"
+           " \"reports\": %ld, \"reports_delayed\": %ld, \"stuck\": %ld,\n"
+           " \"tasks\": {\"steps\": %ld, \"steps_per_sec\": %.0f, \"timers\": %ld, \"semaphore_waits\": %ld, "
+           "\"peak_concurrent\": %ld, \"peak_sleeping\": %ld, \"bytes_per_flow\": %d},\n"
+           " \"latency_seconds\": {\"mean\": %.2f, \"max\": %.2f},\n"
+           " \"max_rss_kb\": %ld}\n",
+           patients, workers, machines, doctors, arrivals.rate,
+           elapsed, stats.virtual_seconds, process_cpu,
+           clinic.reports, clinic.reports_delayed, stats.stuck,
+           stats.steps, stats.steps / (elapsed > 0 ? elapsed : 1), stats.timers, stats.semaphore_waits,
+           stats.peak_live, stats.peak_sleeping, stats.task_bytes + (int)sizeof(Flow),
+           clinic.reports > 0 ? clinic.latency_sum / clinic.reports : 0.0, clinic.latency_max,
+           usage.ru_maxrss);
+
+    destroy_task_semaphore(clinic.machine_permits);
+    destroy_task_semaphore(clinic.doctor_permits);
+    destroy_task_runtime(runtime);
+    destroy_arrival_process(process);
+    destroy_machines(clinic.machines);
+    fclose(clinic.patient_file);
+    fclose(clinic.exam_file);
+    fclose(clinic.report_file);
+    pthread_mutex_destroy(&clinic.stats_mutex);
+    free(flows);
+
+    return result == 0 ? 0 : 1;
+}
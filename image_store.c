@@ -0,0 +1,245 @@
+#include "image_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define IMAGE_STORE_ALIGN 64   // Every buffer starts on its own cache line // Cada buffer começa em sua própria linha de cache
+
+struct image_buffer {
+    ImageStore *store;
+    unsigned char *data;       // Inside a mapped chunk, never copied // Dentro de um bloco mapeado, nunca copiado
+    int references;            // Changed with atomic builtins // Alterado com builtins atômicos
+    ImageBuffer *next_free;
+};
+
+typedef struct image_chunk {
+    void *memory;
+    size_t bytes;
+    ImageBuffer *buffers;      // Descriptors of the buffers in this chunk // Descritores dos buffers deste bloco
+    struct image_chunk *next;
+} ImageChunk;
+
+struct image_store {
+    pthread_mutex_t mutex;
+    size_t buffer_bytes;
+    size_t stride;             // buffer_bytes rounded up to IMAGE_STORE_ALIGN
+    int buffers_per_chunk;
+    ImageChunk *chunks;
+    ImageBuffer *free_list;
+    int closing;               // The owner called destroy_image_store() // O dono chamou destroy_image_store()
+
+    size_t mapped_bytes;
+    int buffers;
+    int in_use;
+    int peak_in_use;
+    long acquired;
+};
+
+ImageStore *create_image_store(size_t buffer_bytes, int buffers_per_chunk) {
+/**
+ * \brief Create an empty store; memory is mapped on the first acquire // Cria um pool vazio; a memória é mapeada no primeiro acquire
+ *
+ * \param buffer_bytes - Size of every buffer // Tamanho de cada buffer
+ * \param buffers_per_chunk - Buffers per mmap call // Buffers por chamada de mmap
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ImageStore* - Pointer to the store, NULL if the sizes are invalid // Ponteiro para o pool, NULL se os tamanhos forem inválidos
+ */
+    if (buffer_bytes == 0 || buffers_per_chunk < 1) {
+        return NULL;
+    }
+
+    ImageStore *store = (ImageStore*)calloc(1, sizeof(ImageStore));
+    if (!store) {
+        printf("\nError: Memory allocation failed (Image Store)\n");
+        exit(1);
+    }
+
+    pthread_mutex_init(&store->mutex, NULL);
+    store->buffer_bytes = buffer_bytes;
+    store->stride = (buffer_bytes + IMAGE_STORE_ALIGN - 1) / IMAGE_STORE_ALIGN * IMAGE_STORE_ALIGN;
+    store->buffers_per_chunk = buffers_per_chunk;
+    return store;
+}
+
+static void free_store(ImageStore *store) {
+// Unmaps every chunk (no buffer may be in use) // Desmapeia todos os blocos (nenhum buffer pode estar em uso)
+    ImageChunk *chunk = store->chunks;
+    while (chunk) {
+        ImageChunk *next = chunk->next;
+        munmap(chunk->memory, chunk->bytes);
+        free(chunk->buffers);
+        free(chunk);
+        chunk = next;
+    }
+    pthread_mutex_destroy(&store->mutex);
+    free(store);
+}
+
+void destroy_image_store(ImageStore *store) {
+/**
+ * \brief Release the owner's reference, unmapping now or when the last buffer comes back // Libera a referência do dono, desmapeando agora ou quando o último buffer voltar
+ */
+    if (!store) {
+        return;
+    }
+
+    pthread_mutex_lock(&store->mutex);
+    store->closing = 1;
+    int in_use = store->in_use;
+    pthread_mutex_unlock(&store->mutex);
+
+    if (in_use == 0) {
+        free_store(store);
+    }
+}
+
+static int map_chunk(ImageStore *store) {
+// Maps buffers_per_chunk new buffers and pushes them on the free list (mutex held) // Mapeia novos buffers e os coloca na lista livre
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t bytes = (store->stride * store->buffers_per_chunk + page - 1) / page * page;
+
+    void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return -1;
+    }
+
+    ImageChunk *chunk = (ImageChunk*)malloc(sizeof(ImageChunk));
+    ImageBuffer *buffers = (ImageBuffer*)calloc(store->buffers_per_chunk, sizeof(ImageBuffer));
+    if (!chunk || !buffers) {
+        printf("\nError: Memory allocation failed (Image Store Chunk)\n");
+        exit(1);
+    }
+
+    chunk->memory = memory;
+    chunk->bytes = bytes;
+    chunk->buffers = buffers;
+    chunk->next = store->chunks;
+    store->chunks = chunk;
+
+    for (int i = store->buffers_per_chunk - 1; i >= 0; i--) {
+        buffers[i].store = store;
+        buffers[i].data = (unsigned char*)memory + i * store->stride;
+        buffers[i].next_free = store->free_list;
+        store->free_list = &buffers[i];
+    }
+    store->mapped_bytes += bytes;
+    store->buffers += store->buffers_per_chunk;
+    return 0;
+}
+
+ImageBuffer *image_store_acquire(ImageStore *store) {
+/**
+ * \brief Take a buffer from the free list // Pega um buffer da lista livre
+ *
+ * \details The store only grows: memory per in-flight exam is one buffer, whatever happens to it afterwards.
+ * \details O pool só cresce: a memória por exame em andamento é um buffer, não importa o que aconteça com ele depois.
+ *
+ * \return ImageBuffer* - Buffer with one reference, NULL on failure // Buffer com uma referência, NULL em caso de falha
+ */
+    if (!store) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&store->mutex);
+    if (!store->free_list && map_chunk(store) != 0) {
+        pthread_mutex_unlock(&store->mutex);
+        return NULL;
+    }
+
+    ImageBuffer *buffer = store->free_list;
+    store->free_list = buffer->next_free;
+    buffer->next_free = NULL;
+    buffer->references = 1;
+    store->in_use++;
+    store->acquired++;
+    if (store->in_use > store->peak_in_use) {
+        store->peak_in_use = store->in_use;
+    }
+    pthread_mutex_unlock(&store->mutex);
+
+    return buffer;
+}
+
+void image_buffer_retain(ImageBuffer *buffer) {
+/**
+ * \brief Add a reference // Adiciona uma referência
+ */
+    if (buffer) {
+        __atomic_add_fetch(&buffer->references, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void image_buffer_release(ImageBuffer *buffer) {
+/**
+ * \brief Drop a reference and recycle the buffer when it was the last one // Remove uma referência e recicla o buffer quando era a última
+ */
+    if (!buffer || __atomic_sub_fetch(&buffer->references, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    ImageStore *store = buffer->store;
+    pthread_mutex_lock(&store->mutex);
+    buffer->next_free = store->free_list;
+    store->free_list = buffer;
+    store->in_use--;
+    int last = store->closing && store->in_use == 0;
+    pthread_mutex_unlock(&store->mutex);
+
+    if (last) {
+        free_store(store);
+    }
+}
+
+unsigned char *image_buffer_data(ImageBuffer *buffer) {
+/**
+ * \brief Buffer memory // Memória do buffer
+ */
+    return buffer ? buffer->data : NULL;
+}
+
+size_t image_buffer_size(ImageBuffer *buffer) {
+/**
+ * \brief Usable bytes of the buffer // Bytes úteis do buffer
+ */
+    return buffer ? buffer->store->buffer_bytes : 0;
+}
+
+void get_image_store_stats(ImageStore *store, ImageStoreStats *stats) {
+/**
+ * \brief Copy the memory accounting // Copia a contabilidade de memória
+ */
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(ImageStoreStats));
+    if (!store) {
+        return;
+    }
+
+    pthread_mutex_lock(&store->mutex);
+    stats->buffer_bytes = store->buffer_bytes;
+    stats->mapped_bytes = store->mapped_bytes;
+    stats->buffers = store->buffers;
+    stats->in_use = store->in_use;
+    stats->peak_in_use = store->peak_in_use;
+    stats->acquired = store->acquired;
+    pthread_mutex_unlock(&store->mutex);
+}
+
+void print_image_store_stats(ImageStore *store) {
+/**
+ * \brief Print the memory accounting // Imprime a contabilidade de memória
+ */
+    ImageStoreStats stats;
+    get_image_store_stats(store, &stats);
+
+    printf("\nImage Buffers:\n");
+    printf("%ld images in %d buffers of %.1lf KB (peak in flight %d, still in use %d), %.1lf MB mapped\n",
+           stats.acquired, stats.buffers, stats.buffer_bytes / 1024.0, stats.peak_in_use, stats.in_use,
+           stats.mapped_bytes / (1024.0 * 1024.0));
+}
@@ -0,0 +1,94 @@
+#ifndef IMAGE_STORE_H_INCLUDED
+#define IMAGE_STORE_H_INCLUDED
+
+#include <stddef.h>
+
+// Pool of fixed size image buffers carved out of mmapped chunks // Pool de buffers de imagem de tamanho fixo recortados de blocos mapeados com mmap
+typedef struct image_store ImageStore;
+
+// Reference counted handle to one buffer of the store // Handle com contagem de referências para um buffer do pool
+typedef struct image_buffer ImageBuffer;
+
+/**
+ * \brief Memory accounting of the store // Contabilidade de memória do pool
+ */
+typedef struct image_store_stats {
+    size_t buffer_bytes;   // Usable bytes per buffer // Bytes úteis por buffer
+    size_t mapped_bytes;   // Total mapped with mmap // Total mapeado com mmap
+    int buffers;           // Buffers created so far // Buffers criados até agora
+    int in_use;            // Buffers held by at least one reference // Buffers com pelo menos uma referência
+    int peak_in_use;
+    long acquired;         // Buffers handed out since creation // Buffers entregues desde a criação
+} ImageStoreStats;
+
+/**
+ * \brief Create a buffer store // Cria um pool de buffers
+ *
+ * \param buffer_bytes - Size of every buffer // Tamanho de cada buffer
+ * \param buffers_per_chunk - Buffers mapped at once when the store grows // Buffers mapeados de uma vez quando o pool cresce
+ * \return Pointer to the store, NULL if the sizes are invalid // Ponteiro para o pool, NULL se os tamanhos forem inválidos
+ */
+ImageStore *create_image_store(size_t buffer_bytes, int buffers_per_chunk);
+
+/**
+ * \brief Release the owner's reference to the store // Libera a referência do dono ao pool
+ *
+ * \details Buffers still referenced stay valid; the memory is unmapped when the last one is released.
+ * \param store - Pointer to the store // Ponteiro para o pool
+ */
+void destroy_image_store(ImageStore *store);
+
+/**
+ * \brief Take a free buffer, mapping a new chunk if none is left // Pega um buffer livre, mapeando um novo bloco se não houver
+ *
+ * \param store - Pointer to the store // Ponteiro para o pool
+ * \return Buffer with one reference, NULL if the store is NULL or mmap failed // Buffer com uma referência, NULL se o pool for NULL ou o mmap falhar
+ */
+ImageBuffer *image_store_acquire(ImageStore *store);
+
+/**
+ * \brief Add a reference to a buffer // Adiciona uma referência a um buffer
+ *
+ * \param buffer - Buffer handle // Handle do buffer
+ */
+void image_buffer_retain(ImageBuffer *buffer);
+
+/**
+ * \brief Drop a reference; the last one returns the buffer to its store // Remove uma referência; a última devolve o buffer ao pool
+ *
+ * \param buffer - Buffer handle // Handle do buffer
+ */
+void image_buffer_release(ImageBuffer *buffer);
+
+/**
+ * \brief Bytes of a buffer, valid while a reference is held // Bytes de um buffer, válidos enquanto houver uma referência
+ *
+ * \param buffer - Buffer handle // Handle do buffer
+ * \return Pointer to the buffer memory // Ponteiro para a memória do buffer
+ */
+unsigned char *image_buffer_data(ImageBuffer *buffer);
+
+/**
+ * \brief Usable size of a buffer // Tamanho útil de um buffer
+ *
+ * \param buffer - Buffer handle // Handle do buffer
+ * \return Size in bytes // Tamanho em bytes
+ */
+size_t image_buffer_size(ImageBuffer *buffer);
+
+/**
+ * \brief Copy the memory accounting of the store // Copia a contabilidade de memória do pool
+ *
+ * \param store - Pointer to the store // Ponteiro para o pool
+ * \param stats - Receives the values // Recebe os valores
+ */
+void get_image_store_stats(ImageStore *store, ImageStoreStats *stats);
+
+/**
+ * \brief Print the memory accounting of the store // Imprime a contabilidade de memória do pool
+ *
+ * \param store - Pointer to the store // Ponteiro para o pool
+ */
+void print_image_store_stats(ImageStore *store);
+
+#endif // IMAGE_STORE_H_INCLUDED
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "patient.h"
+#include "arrivals.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+#include "shm_ring.h"
+#include "pipeline_record.h"
+
+/*
+ * Intake process of the multi-process pipeline // Processo de entrada do pipeline multiprocesso
+ *
+ * clinic_intake -> clinic_rx -> clinic_report, each its own process, connected by shared memory rings
+ * (shm_ring.c). This one samples the arrivals, writes db_patient.txt and sends every patient as a PatientRecord
+ * to <prefix>_patients. Start the three in any order; if clinic_rx dies the intake stops and exits with 2.
+ */
+
+#define INTAKE_DEFAULT_PATIENTS 1000
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -p, --patients N     Patients sent down the pipeline (default %d)\n", INTAKE_DEFAULT_PATIENTS);
+    printf("  -s, --time-scale X   Multiplier of the arrival gaps, 0 sends as fast as possible (default 0)\n");
+    printf("      --arrival-rate R Patients per simulated second (default %.2f)\n", sim_config()->arrival_rate);
+    printf("      --arrivals KIND  poisson, varying or batch (default poisson)\n");
+    printf("  -o, --db-dir DIR     Directory of db_patient.txt (default .)\n");
+    printf("  -n, --name PREFIX    Shared memory prefix of the rings (default %s)\n", PIPELINE_DEFAULT_PREFIX);
+    printf("      --slots N        Records per ring (default %d)\n", SHM_RING_DEFAULT_SLOTS);
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"patients", required_argument, NULL, 'p'},
+        {"time-scale", required_argument, NULL, 's'},
+        {"arrival-rate", required_argument, NULL, 'R'},
+        {"arrivals", required_argument, NULL, 'A'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"name", required_argument, NULL, 'n'},
+        {"slots", required_argument, NULL, 'S'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "p:s:o:n:h";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    ArrivalConfig arrivals = {ARRIVAL_POISSON, constants.arrival_rate, 0.5, 3600.0, 3.0};
+    long patients = INTAKE_DEFAULT_PATIENTS;
+    double scale = 0;
+    const char *db_dir = ".";
+    const char *prefix = PIPELINE_DEFAULT_PREFIX;
+    int slots = SHM_RING_DEFAULT_SLOTS;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'p': patients = atol(optarg); break;
+        case 's': scale = atof(optarg); break;
+        case 'R': arrivals.rate = atof(optarg); break;
+        case 'A': arrivals.kind = arrival_kind_from_name(optarg); break;
+        case 'o': db_dir = optarg; break;
+        case 'n': prefix = optarg; break;
+        case 'S': slots = atoi(optarg); break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    ArrivalProcess *process = create_arrival_process(&arrivals, (unsigned int)time(NULL));
+    if (patients < 1 || scale < 0 || slots < 1 || !process) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/db_patient.txt", db_dir);
+    FILE *patient_file = fopen(path, "w");
+    if (!patient_file) {
+        perror("Failed to open db_patient.txt");
+        return 1;
+    }
+    char name[128];
+    pipeline_ring_name(prefix, "patients", name, sizeof(name));
+    ShmRing *patient_ring = shm_ring_attach(name, SHM_RING_PRODUCER, slots, sizeof(PatientRecord));
+    if (!patient_ring) {
+        perror("Failed to attach to the patient ring");
+        return 1;
+    }
+
+    log_set_quiet(1);
+    set_time_scale(scale);
+    rng_seed((unsigned int)time(NULL));
+
+    double start = now_seconds();
+    long sent = 0;
+    int lost = 0;
+    while (sent < patients && !lost) {
+        int arriving = 1;
+        my_sleep(arrival_next(process, &arriving)); // Gap until the next arrival, scaled // Intervalo até a próxima chegada
+        for (int i = 0; i < arriving && sent < patients; i++) {
+            Patient *patient = patient_in();
+            print_patient_db(patient, patient_file);
+            PatientRecord record;
+            pack_patient(patient, &record);
+            destroy_patient(patient);
+            if (shm_ring_send(patient_ring, &record, sizeof(record)) != 0) {
+                lost = 1; // clinic_rx died // clinic_rx morreu
+                break;
+            }
+            sent++;
+        }
+    }
+    shm_ring_finish(patient_ring);
+    double elapsed = now_seconds() - start;
+
+    ShmRingStats stats;
+    get_shm_ring_stats(patient_ring, &stats);
+    printf("{\"stage\": \"intake\", \"patients\": %ld, \"seconds\": %.4f, \"records_per_sec\": %.0f, "
+           "\"ring\": {\"sent\": %ld, \"full_sleeps\": %ld, \"wakes\": %ld}, \"downstream_lost\": %d}\n",
+           sent, elapsed, sent / (elapsed > 0 ? elapsed : 1), stats.records, stats.sleeps, stats.wakes, lost);
+
+    shm_ring_detach(patient_ring);
+    destroy_arrival_process(process);
+    fclose(patient_file);
+    return lost ? 2 : 0;
+}
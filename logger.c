@@ -0,0 +1,225 @@
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct log_buffer {
+    size_t used;
+    double last_flush;
+    char data[LOG_THREAD_BUFFER];
+} LogBuffer;
+
+static int runtime_level = LOG_MIN_LEVEL;
+static unsigned int category_mask = LOG_ALL_CATEGORIES;
+static int quiet_mode = 0;
+static int output_fd = STDOUT_FILENO; // Every record goes here, WARN and ERROR to stderr while it is stdout
+
+static __thread LogBuffer *thread_buffer = NULL;
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_key_once = PTHREAD_ONCE_INIT;
+
+static double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void write_all(int fd, const char *data, size_t length) {
+// write(2) until everything is out, retrying on EINTR // write(2) até tudo ser escrito, repetindo em EINTR
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+static void flush_buffer(LogBuffer *buffer) {
+    if (buffer->used > 0) {
+        if (output_fd == STDOUT_FILENO) {
+            fflush(stdout); // Keep ordering with the few printf calls that remain (final status)
+        }
+        write_all(output_fd, buffer->data, buffer->used);
+        buffer->used = 0;
+    }
+    buffer->last_flush = monotonic_seconds();
+}
+
+static void release_buffer(void *value) {
+// Thread exit: nothing buffered is lost // Fim da thread: nada acumulado é perdido
+    LogBuffer *buffer = (LogBuffer*)value;
+    if (buffer) {
+        flush_buffer(buffer);
+        free(buffer);
+    }
+}
+
+static void create_buffer_key(void) {
+    pthread_key_create(&buffer_key, release_buffer);
+}
+
+static LogBuffer *get_thread_buffer(void) {
+    if (!thread_buffer) {
+        pthread_once(&buffer_key_once, create_buffer_key);
+        thread_buffer = (LogBuffer*)malloc(sizeof(LogBuffer));
+        if (!thread_buffer) {
+            return NULL;
+        }
+        thread_buffer->used = 0;
+        thread_buffer->last_flush = monotonic_seconds();
+        pthread_setspecific(buffer_key, thread_buffer);
+    }
+    return thread_buffer;
+}
+
+int log_enabled(int level, LogCategory category) {
+/**
+ * \brief Check whether a record would be written // Verifica se um registro seria escrito
+ *
+ * \return int - 1 if enabled, 0 otherwise // 1 se habilitado, 0 caso contrário
+ */
+    return !quiet_mode && level >= runtime_level && (category_mask & (1u << category));
+}
+
+void log_write(int level, LogCategory category, const char *format, ...) {
+/**
+ * \brief Format one record into the calling thread's buffer // Formata um registro no buffer da thread chamadora
+ *
+ * \details The record is formatted directly after the records already buffered. If it does not fit, the buffer is
+ *          flushed first and the record formatted again, so a flush always contains whole records.
+ *          WARN and ERROR records flush the buffer and go to stderr right away.
+ * \details O registro é formatado logo após os já acumulados. Se não couber, o buffer é descarregado antes e o
+ *          registro formatado de novo, então uma descarga sempre contém registros inteiros.
+ *          Registros WARN e ERROR descarregam o buffer e vão direto para o stderr.
+ */
+    (void)category;
+    LogBuffer *buffer = get_thread_buffer();
+    va_list args;
+
+    if (!buffer || level >= LOG_LEVEL_WARN) {
+        char record[1024];
+        va_start(args, format);
+        int length = vsnprintf(record, sizeof(record), format, args);
+        va_end(args);
+        if (length < 0) {
+            return;
+        }
+        if ((size_t)length >= sizeof(record)) {
+            length = sizeof(record) - 1;
+        }
+        if (buffer) {
+            flush_buffer(buffer);
+        }
+        int fd = buffer && output_fd == STDOUT_FILENO ? STDERR_FILENO : output_fd;
+        write_all(fd, record, (size_t)length);
+        if (length == 0 || record[length - 1] != '\n') {
+            write_all(fd, "\n", 1);
+        }
+        return;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t space = LOG_THREAD_BUFFER - buffer->used;
+        va_start(args, format);
+        int length = vsnprintf(buffer->data + buffer->used, space, format, args);
+        va_end(args);
+        if (length < 0) {
+            return;
+        }
+
+        // One extra byte is kept for the trailing newline // Um byte extra é reservado para a quebra de linha final
+        if ((size_t)length + 1 < space) {
+            buffer->used += (size_t)length;
+            if (length == 0 || buffer->data[buffer->used - 1] != '\n') {
+                buffer->data[buffer->used++] = '\n';
+            }
+            break;
+        }
+
+        if (buffer->used == 0) {
+            // Longer than the whole buffer: write the truncated record on its own // Maior que o buffer inteiro: escreve o registro truncado sozinho
+            buffer->used = LOG_THREAD_BUFFER - 1;
+            buffer->data[buffer->used - 1] = '\n';
+            break;
+        }
+        flush_buffer(buffer);
+    }
+
+    if (monotonic_seconds() - buffer->last_flush >= LOG_FLUSH_INTERVAL) {
+        flush_buffer(buffer);
+    }
+}
+
+void log_flush(void) {
+/**
+ * \brief Write the calling thread's buffered records to the log output // Escreve os registros acumulados da thread chamadora na saída do log
+ */
+    if (thread_buffer) {
+        flush_buffer(thread_buffer);
+    }
+}
+
+void log_set_level(int level) {
+/**
+ * \brief Set the minimum level written at runtime (never below LOG_MIN_LEVEL) // Define o nível mínimo em tempo de execução
+ */
+    runtime_level = level < LOG_MIN_LEVEL ? LOG_MIN_LEVEL : level;
+}
+
+int log_level_from_name(const char *name) {
+/**
+ * \brief Parse a level name // Converte o nome de um nível
+ *
+ * \return int - The level, or -1 if unknown // O nível, ou -1 se desconhecido
+ */
+    static const char *names[] = {"debug", "info", "warn", "error", "off"};
+
+    if (!name) {
+        return -1;
+    }
+    for (int i = 0; i <= LOG_LEVEL_OFF; i++) {
+        if (strcasecmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void log_set_categories(unsigned int mask) {
+/**
+ * \brief Select which categories are written // Seleciona quais categorias são escritas
+ */
+    category_mask = mask & LOG_ALL_CATEGORIES;
+}
+
+void log_set_output(int fd) {
+/**
+ * \brief Send the records to another descriptor // Envia os registros para outro descritor
+ */
+    output_fd = fd;
+}
+
+void log_set_quiet(int quiet) {
+/**
+ * \brief Enable or disable quiet mode // Ativa ou desativa o modo silencioso
+ */
+    quiet_mode = quiet ? 1 : 0;
+}
+
+int log_is_quiet(void) {
+/**
+ * \brief Check whether quiet mode is on // Verifica se o modo silencioso está ativo
+ */
+    return quiet_mode;
+}
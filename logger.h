@@ -0,0 +1,132 @@
+#ifndef LOGGER_H_INCLUDED
+#define LOGGER_H_INCLUDED
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF   4
+
+// Calls below this level are removed by the preprocessor (e.g. make LOG_LEVEL=LOG_LEVEL_OFF) // Chamadas abaixo deste nível são removidas pelo pré-processador
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_THREAD_BUFFER 8192   // Bytes buffered per thread before a flush // Bytes acumulados por thread antes de descarregar
+#define LOG_FLUSH_INTERVAL 0.100 // A thread's buffer is flushed at least this often while it logs // O buffer é descarregado pelo menos nesse intervalo
+
+typedef enum log_category {
+    LOG_CAT_SIM = 0,  // Simulation loop and threads // Laço da simulação e threads
+    LOG_CAT_PATIENT,
+    LOG_CAT_EXAM,
+    LOG_CAT_MACHINE,
+    LOG_CAT_QUEUE,
+    LOG_CAT_REPORT,
+    LOG_CAT_MEMORY,   // Allocation and release messages // Mensagens de alocação e liberação
+    LOG_CAT_COUNT
+} LogCategory;
+
+#define LOG_ALL_CATEGORIES ((1u << LOG_CAT_COUNT) - 1)
+
+/**
+ * \brief Check whether a record would be written at runtime // Verifica se um registro seria escrito em tempo de execução
+ *
+ * \param level - Record level // Nível do registro
+ * \param category - Record category // Categoria do registro
+ * \return 1 if enabled, 0 otherwise // 1 se habilitado, 0 caso contrário
+ */
+int log_enabled(int level, LogCategory category);
+
+/**
+ * \brief Format one record into the calling thread's buffer // Formata um registro no buffer da thread chamadora
+ * \details A record is never split between flushes; WARN and ERROR records go straight to stderr.
+ *
+ * \param level - Record level // Nível do registro
+ * \param category - Record category // Categoria do registro
+ * \param format - printf-style format // Formato estilo printf
+ */
+void log_write(int level, LogCategory category, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * \brief Write the calling thread's buffered records to the log output // Escreve os registros acumulados da thread chamadora na saída do log
+ */
+void log_flush(void);
+
+/**
+ * \brief Send every record to `fd` instead of stdout, e.g. a file while the dashboard owns the terminal
+ *        // Envia todos os registros para `fd` em vez do stdout, p.ex. um arquivo enquanto o painel ocupa o terminal
+ * \details WARN and ERROR records go to stderr only while the output is STDOUT_FILENO. // Registros WARN e ERROR vão
+ *          para o stderr só enquanto a saída é STDOUT_FILENO.
+ *
+ * \param fd - Open descriptor, owned by the caller; STDOUT_FILENO restores the default // Descritor aberto, do chamador
+ */
+void log_set_output(int fd);
+
+/**
+ * \brief Set the minimum level written at runtime // Define o nível mínimo escrito em tempo de execução
+ *
+ * \param level - One of LOG_LEVEL_* // Um dos LOG_LEVEL_*
+ */
+void log_set_level(int level);
+
+/**
+ * \brief Parse a level name ("debug", "info", "warn", "error", "off") // Converte o nome de um nível
+ *
+ * \param name - Level name // Nome do nível
+ * \return The level, or -1 if the name is unknown // O nível, ou -1 se o nome for desconhecido
+ */
+int log_level_from_name(const char *name);
+
+/**
+ * \brief Select which categories are written // Seleciona quais categorias são escritas
+ *
+ * \param mask - Bit mask of (1u << LogCategory) // Máscara de bits de (1u << LogCategory)
+ */
+void log_set_categories(unsigned int mask);
+
+/**
+ * \brief Enable quiet mode: every record is dropped before formatting // Ativa o modo silencioso: todo registro é descartado antes da formatação
+ *
+ * \param quiet - 1 to silence, 0 to restore // 1 para silenciar, 0 para restaurar
+ */
+void log_set_quiet(int quiet);
+
+/**
+ * \brief Check whether quiet mode is on // Verifica se o modo silencioso está ativo
+ *
+ * \return 1 if quiet, 0 otherwise // 1 se silencioso, 0 caso contrário
+ */
+int log_is_quiet(void);
+
+#define LOG_AT(level, category, ...) \
+    do { \
+        if (log_enabled((level), (category))) { \
+            log_write((level), (category), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) ((void)0)
+#endif
+
+#endif // LOGGER_H_INCLUDED
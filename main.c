@@ -6,38 +6,113 @@
 #include "patient.h"
 #include "exam.h"
 #include "rx_machine.h"
-#include "time_control.h"
+#include "time_control.h"
+#include "rng.h"
 #include "medical_check.h"
-#define    MAX_EXECUTION 43.200
-#define MAX_REPORT 7.200
-#include <pthread.h>
-
-
-
-typedef struct t { //Defining Struct  to Doctor's report thread
-    Exam *current_exam;
-    FILE *report_file;
-    double *time_reports;
-    double *tempo_total;
-    int *reports_tempo_ok;
-    int *report_finalizados;
-    double *timer_conditions_array;
-    int *report_counter_array;
-    int *exam_priority_level;
+#include "dashboard.h"
+#include "logger.h"
+#include "arrivals.h"
+#include "arrival_trace.h"
+#include "shutdown.h"
+#include "doctors.h"
+#include "checkpoint.h"
+#include "what_if.h"
+#include "sim_counters.h"
+#include "sim_config.h"
+#include "db_log.h"
+#include <getopt.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#define DASHBOARD_REFRESH 0.500 // Seconds between dashboard redraws
+#define DASHBOARD_LOG_FILE "clinic_log.txt" // Where the event log goes while the dashboard owns the terminal
+#define RNG_STREAM_MAIN 0 // Random streams of the simulation threads, all saved in the checkpoints
+#define RNG_STREAM_ARRIVALS 1
+#define RNG_STREAM_DOCTORS 2 // Plus the doctor's index, up to DOCTOR_MAX
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+
+typedef struct t { //Defining Struct shared by the doctor threads to write the reports
+    FILE *report_file;
+    SimCounters *counters;    // Simulated clock and one shard of report counters per doctor // Relógio e uma fatia de contadores por médico
+    ShutdownControl *shutdown;
+    ExamLedger *ledger;       // Exams the doctors hold, NULL unless checkpointing // Exames com os médicos, NULL sem checkpoints
+    DbLog *report_log;        // One shard per doctor, merged into report_file; NULL writes report_file directly
 } ReportThreadArgs;
 
 typedef struct t2{//Defining Strcut to Patient's arrivals thread
 
     V_queue *patient_queue;
-    FILE *patient_file;
-    double *time_total;
-    double *patient_freeze;
-    int *total_patients;
+    FILE *patient_file;
+    DbLog *patient_log;       // Shards merged into patient_file, NULL writes patient_file directly
+    SimCounters *counters;    // Simulated clock // Relógio simulado
+    ArrivalProcess *arrivals; // Samples when the next patients come // Sorteia quando os próximos pacientes chegam
+    ArrivalTrace *trace;      // Replayed instead of the arrival process when not NULL // Reproduzido no lugar do processo de chegadas
+    double replay_speed;      // Trace seconds per simulated second, 0 replays as fast as possible
+    V_queue *patient_overflow; // Patients parked by OVERFLOW_DIVERT // Pacientes estacionados por OVERFLOW_DIVERT
+    int overflow_policy;       // OverflowPolicy of the patient queue
+    int *total_patients;
+    ShutdownControl *shutdown; // Closes the intake at max_execution // Fecha a entrada em max_execution
+    int arriving;              // Patients sampled and not arrived yet, protected by queue_mutex // Pacientes sorteados que ainda não chegaram
+    double arrival_gap;        // Their gap // O intervalo deles
+    int paused;                // What-if branching: stop before sampling more patients, protected by queue_mutex
+    int stopped;               // Set by the thread as it returns, protected by queue_mutex // Marcado pela thread ao terminar
 }ReportThreadArgs2;
 
-pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER; //Defining Mutex Thread Security
+typedef struct sim_options { // Command line options
+    int use_dashboard;
+    int machines;
+    int routing;          // RxRoutingPolicy
+    const char *speeds;   // Comma separated machine speeds, NULL keeps every machine at 1
+    int ai_batch;         // Exams per AI batch, 0 keeps the per-exam threshold table
+    double ai_timeout;    // Seconds a partial AI batch may wait
+    AiKernel ai_kernel;
+    int image_size;       // Side of the synthetic X-ray image per exam, 0 disables the imaging
+    int image_kernels;    // XrayKernels
+    ArrivalConfig arrivals;
+    const char *trace;    // Arrival trace to replay, NULL samples the arrivals
+    double replay_speed;  // 1 replays the trace in real time, N is N times faster, 0 as fast as possible
+    int patient_capacity; // Patients waiting for a machine, 0 for unbounded
+    int level_capacity;   // Exams waiting per priority level, 0 for unbounded
+    int exam_capacity;    // Exams waiting in all priority levels, 0 for unbounded
+    int overflow_policy;  // OverflowPolicy of both queues
+    int overflow_capacity; // Items parked per overflow queue by OVERFLOW_DIVERT, 0 for unbounded
+    double drain_deadline; // Simulated seconds the clinic gets to finish its patients after closing
+    const char *doctors;  // Comma separated doctor specialties, NULL for DOCTOR_DEFAULT_ROSTER
+    const char *checkpoint; // File written on SIGTERM and every checkpoint_every seconds, NULL for none
+    double checkpoint_every; // Simulated seconds between checkpoints, 0 only on SIGTERM
+    const char *restore;  // Checkpoint to resume from, NULL starts a new simulation
+    double stats_window;  // Simulated seconds covered by the live report statistics
+    double branch_at;     // Simulated seconds at which the what-if branches fork, negative for none
+    int what_if_count;    // Branches, each one a child process
+    WhatIfChange what_if[WHAT_IF_MAX];
+    int db_shards;        // Every writer thread appends to its own shard, merged into the db files in timestamp order
+    int db_io;            // AsyncIoKind of the shard writes
+    int db_sync;          // fdatasync every N shard buffers, 0 for never
+    const char *log_file; // Event log destination, NULL for stdout; defaults to DASHBOARD_LOG_FILE with the dashboard
+    int print_config;     // Print the clinic configuration and exit
+} SimOptions;
+
+pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER; //Defining Mutex Thread Security
+static pthread_cond_t queue_space = PTHREAD_COND_INITIALIZER; // Signaled when the main loop takes a patient (OVERFLOW_BLOCK)
+static AdmissionStats patient_admission; // Patient queue admission counters, protected by queue_mutex
+
+static atomic_int machines_delta; // Machines to add (SIGUSR1) or remove (SIGUSR2), applied by the main loop; lock-free, so signal safe
+static volatile sig_atomic_t checkpoint_requested = 0; // SIGTERM with --checkpoint: save and stop at the next main loop step
+
+static void resize_signal(int signal_number) {
+    atomic_fetch_add(&machines_delta, signal_number == SIGUSR1 ? 1 : -1);
+}
+
+static void checkpoint_signal(int signal_number) {
+    (void)signal_number;
+    checkpoint_requested = 1;
+}
 
-ReportThreadArgs *create_struct_report(Exam *exam,FILE *report_file,double *tempo_simulation, double *time_reports,int *reports_tempo_ok, int * reports_finalizados, double *report_timer_array, int *report_counter_array , int *exam_priority){
+ReportThreadArgs *create_struct_report(FILE *report_file, SimCounters *counters, ShutdownControl *shutdown, ExamLedger *ledger){
 // Function to create and initialize a ReportThreadArgs structure
 // This structure holds the necessary information for the report thread
         ReportThreadArgs *new_args  =(ReportThreadArgs*)malloc(sizeof(ReportThreadArgs));
@@ -46,20 +121,16 @@ ReportThreadArgs *create_struct_report(Exam *exam,FILE *report_file,double *temp
             exit(1);
         }
     // Initialize the structure members with the provided arguments
-    new_args->current_exam = exam;
     new_args->report_file = report_file;
-    new_args->time_reports = time_reports;
-    new_args->tempo_total = tempo_simulation;
-    new_args->reports_tempo_ok = reports_tempo_ok;
-    new_args->report_finalizados = reports_finalizados;
-    new_args->timer_conditions_array = report_timer_array;
-    new_args->report_counter_array = report_counter_array;
-    new_args->exam_priority_level = exam_priority;
-
+    new_args->counters = counters;
+    new_args->shutdown = shutdown;
+    new_args->ledger = ledger;
+    new_args->report_log = NULL;
+
         return new_args;
 }
 
-ReportThreadArgs2 *create_struct_patient(V_queue *patient_queue,FILE *patient_file,double *time_total,double *patient_freeze ,int *pacientes_totais){
+ReportThreadArgs2 *create_struct_patient(V_queue *patient_queue,FILE *patient_file,SimCounters *counters,ArrivalProcess *arrivals ,ArrivalTrace *trace, double replay_speed, V_queue *patient_overflow, int overflow_policy, int *pacientes_totais, ShutdownControl *shutdown){
 // Function to create and initialize a ReportThreadArgs2 structure
 // This structure holds the necessary information for the patient arrival thread
     ReportThreadArgs2 *new_args2 = (ReportThreadArgs2*)malloc(sizeof(ReportThreadArgs2));
@@ -70,21 +141,143 @@ ReportThreadArgs2 *create_struct_patient(V_queue *patient_queue,FILE *patient_fi
     }
     // Initialize the structure members with the provided arguments
     new_args2->patient_queue = patient_queue;
-    new_args2->patient_file = patient_file;
-    new_args2->time_total = time_total;
-    new_args2->patient_freeze = patient_freeze;
-    new_args2->total_patients = pacientes_totais;
+    new_args2->patient_file = patient_file;
+    new_args2->patient_log = NULL;
+    new_args2->counters = counters;
+    new_args2->arrivals = arrivals;
+    new_args2->trace = trace;
+    new_args2->replay_speed = replay_speed;
+    new_args2->patient_overflow = patient_overflow;
+    new_args2->overflow_policy = overflow_policy;
+    new_args2->total_patients = pacientes_totais;
+    new_args2->shutdown = shutdown;
+    new_args2->arriving = 0;
+    new_args2->arrival_gap = 0;
+    new_args2->paused = 0;
+    new_args2->stopped = 0;
     return new_args2;
 }
 
+static void append_db_record(DbLog *log, const char *record, int length){
+// Appends a formatted record to the calling thread's shard, failing like print_*_db() // Falha como print_*_db()
+    if (length < 0 || db_log_append(log, record, length) != 0) {
+        printf("\nError saving a record on the DB shards\n");
+        exit(1);
+    }
+}
+
+static void merge_db_log(DbLog *log, FILE *file){
+// Appends what the shards of a db file hold to it, in timestamp order // Acrescenta o conteúdo das fatias ao arquivo db
+    if (log && db_log_merge(log, file, NULL) != 0) {
+        printf("\nWarning: the DB shards could not be merged, they stay on disk for clinic_merge\n");
+    }
+}
+
+static void admit_arriving_patient(ReportThreadArgs2 *arrival_args, Patient *new_patient){
+// Queues a patient that just arrived, applying the overflow policy when the queue is full (queue_mutex held)
+// Enfileira um paciente que acabou de chegar, aplicando a política de estouro se a fila estiver cheia
+    (*arrival_args->total_patients)++; // Increment the total number of patients
+    if (arrival_args->patient_log) {
+        char record[PATIENT_DB_RECORD];
+        append_db_record(arrival_args->patient_log, record, format_patient_db(new_patient, record, sizeof(record)));
+    } else {
+        print_patient_db(new_patient, arrival_args->patient_file);// Print the patient data to the database
+    }
+
+    AdmissionResult result;
+    while ((result = admit_to_queue(arrival_args->patient_queue, arrival_args->patient_overflow, new_patient,
+                                    arrival_args->overflow_policy, &patient_admission)) == ADMIT_WAIT) {
+        if (shutdown_phase(arrival_args->shutdown) != SHUTDOWN_RUNNING) { // Closing: nobody will make room anymore
+            patient_admission.rejected++;
+            result = ADMIT_REJECTED;
+            break;
+        }
+        patient_admission.waits++;
+        pthread_cond_wait(&queue_space, &queue_mutex);
+    }
+
+    if (result == ADMIT_REJECTED) {
+        LOG_INFO(LOG_CAT_PATIENT, "\nPatient queue full: patient %d turned away", get_patient_id(new_patient));
+        destroy_patient(new_patient);
+    }
+}
+
+static void replay_trace_arrivals(ReportThreadArgs2 *arrival_args){
+// Streams the trace into the patient queue, keeping the gaps between records divided by replay_speed
+// Envia o trace para a fila de pacientes, mantendo os intervalos entre registros divididos por replay_speed
+    TraceRecord record;
+    int pending = arrival_trace_next(arrival_args->trace, &record);
+    double origin = pending ? record.timestamp : 0; // Trace time of the first record // Tempo do primeiro registro no trace
+    double clock = 0;                 // Simulated seconds already slept // Segundos simulados já dormidos
+
+    while (pending && shutdown_phase(arrival_args->shutdown) == SHUTDOWN_RUNNING) {
+        double offset = record.timestamp - origin;
+        if (arrival_args->replay_speed > 0) {
+            double due = offset / arrival_args->replay_speed;
+            if (due >= sim_config()->max_execution) {
+                break; // The rest of the trace comes after the clinic closes
+            }
+            if (due > clock) {
+                if (shutdown_sleep(arrival_args->shutdown, due - clock, SHUTDOWN_DRAINING) != 0) {
+                    break; // The clinic closed meanwhile
+                }
+                clock = due;
+            }
+        }
+
+        // Every record with the same timestamp goes in under one lock
+        pthread_mutex_lock(&queue_mutex);
+        do {
+            time_t now = time(NULL);
+            struct tm arrival;
+            localtime_r(&now, &arrival);
+            Patient *new_patient = create_patient(record.patient_id, record.name, &arrival);
+            if (!new_patient) {
+                printf("\nError creating patient!!!");
+                exit(1);
+            }
+            set_patient_condition(new_patient, record.condition);
+            admit_arriving_patient(arrival_args, new_patient);
+            pending = arrival_trace_next(arrival_args->trace, &record);
+        } while (pending && record.timestamp - origin <= offset);
+        pthread_mutex_unlock(&queue_mutex);
+    }
+}
+
 // Function representing the arrival of patients, running in a separate thread
 void *arrival_of_patients(void *args){
 
     // Cast the argument to the appropriate structure type
     ReportThreadArgs2 *arrival_args = (ReportThreadArgs2*)args;
+    rng_bind_stream(RNG_STREAM_ARRIVALS);
+
+    if (arrival_args->trace) { // Real arrivals from a trace instead of the sampled ones
+        replay_trace_arrivals(arrival_args);
+        return NULL;
+    }
+
+    // Loop until the maximum execution time is reached, sleeping exactly until the next arrival instead of polling
+    while(shutdown_phase(arrival_args->shutdown) == SHUTDOWN_RUNNING){
 
-    // Loop to continuously check for patient arrivals until the maximum execution time is reached
-    while(*arrival_args->time_total < MAX_EXECUTION){
+        // Sampled under the lock, so a checkpoint sees the generator and the patients it promised together
+        pthread_mutex_lock(&queue_mutex);
+        if (arrival_args->paused) { // The main thread is about to fork the what-if branches
+            pthread_mutex_unlock(&queue_mutex);
+            break;
+        }
+        if (arrival_args->arriving == 0) { // A restored run starts with the arrival saved by the checkpoint
+            arrival_args->arriving = 1;
+            arrival_args->arrival_gap = arrival_next(arrival_args->arrivals, &arrival_args->arriving);
+        }
+        double gap = arrival_args->arrival_gap; // Simulated seconds until the next patients arrive
+        int closed = arrival_clock(arrival_args->arrivals) >= sim_config()->max_execution;
+        pthread_mutex_unlock(&queue_mutex);
+        if (closed) {
+            break; // The next arrival would come after the clinic closes
+        }
+        if (shutdown_sleep(arrival_args->shutdown, gap, SHUTDOWN_DRAINING) != 0) {
+            break; // The clinic closed while waiting for these patients
+        }
 
         // Check if the patient queue is available
         if (arrival_args->patient_queue == NULL) {
@@ -99,190 +292,1029 @@ void *arrival_of_patients(void *args){
         }
 
         // If simulation time exceeds 1 second, print a waiting message
-        if(*arrival_args->time_total > 1.00){
-            printf("\nWaiting Patients... %lf secs...\n", *arrival_args->time_total);
+        double clock = simulation_clock(arrival_args->counters);
+        if(clock > 1.00){
+            LOG_DEBUG(LOG_CAT_SIM, "\nWaiting Patients... %lf secs...", clock);
         }
 
 
-        Patient *new_patient = patient_arrival(); // Simulate the arrival of a new patient based on the probability already set in patient_arrival() function
-
-
-        if (new_patient) { // If a new patient arrives, lock the queue and add the patient to the queue
-            pthread_mutex_lock(&queue_mutex);  // Lock the mutex to protect shared resources
-            (*arrival_args->total_patients)++; // Increment the total number of patients
-
-
-            print_patient_db(new_patient, arrival_args->patient_file);// Print the patient data to the database
-
-
-            enqueue(arrival_args->patient_queue, new_patient);// Add the new patient to the patient queue
+        pthread_mutex_lock(&queue_mutex);  // Lock the mutex once for every patient arriving at this instant
+        // Counted down one by one: a checkpoint taken while one waits for room saves only the ones behind it
+        while (arrival_args->arriving > 0) {
+            arrival_args->arriving--;
+            Patient *new_patient = patient_in();
+            if (!new_patient) {
+                printf("\nError creating patient!!!");
+                exit(1);
+            }
+            admit_arriving_patient(arrival_args, new_patient); // Add the new patient to the patient queue
         }
-
-
         pthread_mutex_unlock(&queue_mutex); // Unlock the mutex after modifying the queue
-
-
-        my_sleep(*arrival_args->patient_freeze); // Sleep for the duration specified by patient_freeze before the next possible patient arrival
     }
+    pthread_mutex_lock(&queue_mutex);
+    arrival_args->stopped = 1;
+    pthread_mutex_unlock(&queue_mutex);
     return NULL;
 }
-void *report(void *args) {
-
-// Function that represents the report generation process in a separate thread
-
+static void write_report(Exam *exam, int doctor, void *context) {
+
+// Writes the report of one exam, run by the doctor threads of the DoctorPool; the exam is freed here
 
-    ReportThreadArgs *report_args = (ReportThreadArgs *)args; // Cast the argument to the appropriate structure type
-
 
-        if(*report_args->tempo_total <= MAX_EXECUTION){// Check if the total simulation time is within the allowed execution time
+    ReportThreadArgs *report_args = (ReportThreadArgs *)context; // Shared by every doctor
+    ShutdownControl *shutdown = report_args->shutdown;
+    rng_bind_stream(RNG_STREAM_DOCTORS + doctor); // A doctor always runs on the same pool thread
+    exam_ledger_lock(report_args->ledger);
+    shutdown_count_done(shutdown, SHUTDOWN_STAGE_EXAMS); // The exam left the queues for a doctor
+    exam_ledger_start(report_args->ledger, exam);
+    exam_ledger_unlock(report_args->ledger);
 
-        double report_duration = pre_random_time() * 2 + 2.150; // Calculate the duration of the report generation using a random value --> pre_random_time returns a double between (2 , 3]
-                                                                // Get a random value between 6.150 and 8.150 to the report
+    double report_duration = report_random_time(); // Calculate the duration of the report generation using a random value --> pre_random_time() * report_factor + report_offset
+                                                   // Get a random value between 6.150 and 8.150 to the report, with the default configuration
 
+    if (report_args->report_file == NULL) {
+        LOG_ERROR(LOG_CAT_REPORT, "\nError: Report file is NULL");
+        exam_ledger_lock(report_args->ledger);
+        exam_ledger_remove(report_args->ledger, exam);
+        exam_ledger_unlock(report_args->ledger);
+        destroy_exam(exam);
+        return;
+    }
 
+    // Only this doctor writes its shard, so the counters need no lock; the readers merge the published shards
+    ReportTally *tally = report_tally(report_args->counters, doctor);
+    tally->active++; // A doctor is now busy with this exam
+    publish_report_tally(report_args->counters, doctor);
 
-        if (report_args->current_exam == NULL) {
-            return NULL;
-        }
+    // Simulate the time taken by the patient while waiting in priority queue till get the final report.
+    // The sleep ends early if the drain deadline passes: the report is abandoned and nothing is written.
+    if (shutdown_sleep(shutdown, report_duration, SHUTDOWN_ABANDONING) != 0) {
+        tally->active--;
+        publish_report_tally(report_args->counters, doctor);
+
+        LOG_INFO(LOG_CAT_REPORT, "\nReport abandoned at closing for exam ID: %d", get_exam_id(exam));
+        shutdown_count_abandoned(shutdown, SHUTDOWN_STAGE_REPORTS, 1);
+        exam_ledger_lock(report_args->ledger);
+        exam_ledger_remove(report_args->ledger, exam);
+        exam_ledger_unlock(report_args->ledger);
+        destroy_exam(exam);
+        return;
+    }
 
-        if (report_args->report_file == NULL) {
-            printf("\nError: Report file is NULL\n");
-            return NULL;
-        }
+    // The ledger stays locked until the report line is written: a checkpoint sees either the exam or its report
+    exam_ledger_lock(report_args->ledger);
+
+    tally->active--;
+    tally->time_reports += report_duration;
+    tally->reports++;
+    dashboard_histogram_add(tally->histogram, report_duration);
+
+    if (report_duration > sim_config()->report_limit) { // Check if the report duration exceeds the defined max time for finishing a report
+        tally->delayed++;
+    }
 
-        my_sleep(report_duration); // Simulate the time taken by the patient while waiting in priority queue till get the final report
 
-        pthread_mutex_lock(&queue_mutex);// Lock the mutex to protect shared resources
 
-        *report_args->time_reports += report_duration;
-        (*report_args->report_finalizados)++;
+    LOG_INFO(LOG_CAT_REPORT, "\nDOCTOR %d REPORT DONE FOR EXAM ID: %d", doctor + 1, get_exam_id(exam)); // Log a message indicating that the report has been completed
+    Report *report = do_medical_report(exam);
 
-        if (report_duration > 7.200) { // Check if the report duration exceeds the defined max time for finishing a report
-            (*report_args->reports_tempo_ok)++;
-        }
 
+    int priority;
+    if(strcmp(get_report_condition(report), get_exam_condition(exam)) == 0){  // Compare the report condition with the exam condition
+    priority = get_ai_priority(exam); // If conditions match, the report counts for this exam's condition
+
+    }else{  // If a new diagnostic is given by the doctor, it counts for the report's condition
+    priority = get_report_priority_condition(report);
+
+    }
+    report_stream_add(&tally->stream, priority, simulation_clock(report_args->counters), report_duration);
+    publish_report_tally(report_args->counters, doctor); // Before the ledger is unlocked, for the checkpoints
+    if (report_args->report_log) {
+        char record[REPORT_DB_RECORD];
+        append_db_record(report_args->report_log, record, format_report_db(report, record, sizeof(record)));
+    } else {
+        print_report_db(report, report_args->report_file);// Save the report to the "database"
+    }
+    exam_ledger_remove(report_args->ledger, exam);
+    shutdown_count_done(shutdown, SHUTDOWN_STAGE_REPORTS); // With the exam, so a checkpoint never sees one without the other
+    exam_ledger_unlock(report_args->ledger);
+    release_exam_image(exam); // The image is no longer needed once the report is written
 
+    print_report(report); // and print it
 
-        printf("\nDOCTOR REPORT DONE FOR EXAM ID: %d\n", get_exam_id(report_args->current_exam)); // Print a message indicating that the report has been completed
-        Report *report = do_medical_report(report_args->current_exam);
+    free_report(report);// Free the memory allocated for the report
+    destroy_exam(exam);
+}
+
+typedef struct checkpoint_visit { // Where the visited patients and exams are saved // Onde os pacientes e exames visitados são salvos
+    CheckpointWriter *writer;
+    CheckpointPlace place;
+} CheckpointVisit;
+
+static void save_patient(void *data, void *context) {
+    CheckpointVisit *visit = (CheckpointVisit *)context;
+    checkpoint_add_patient(visit->writer, visit->place, (Patient *)data);
+}
+
+static void save_exam(void *data, void *context) {
+    CheckpointVisit *visit = (CheckpointVisit *)context;
+    checkpoint_add_exam(visit->writer, visit->place, (Exam *)data);
+}
 
+static int save_checkpoint(const char *path, CheckpointState *state, ReportThreadArgs *report_args, ReportThreadArgs2 *arrival_args,
+                           ExamPriorityQueue *exam_queue, Exam *pending_exam, RxPool *machines, FILE *exam_file, DbLog *exam_log) {
+// Saves the simulation between two main loop steps; `state` comes with the counters only the main loop touches
+// Salva a simulação entre dois passos do loop principal; `state` chega com os contadores que só o loop principal usa
+    CheckpointWriter *writer = begin_checkpoint();
+    CheckpointVisit visit = {writer, CHECKPOINT_EXAM_QUEUE};
 
-        if(strcmp(get_report_condition(report), get_exam_condition(report_args->current_exam)) == 0){  // Compare the report condition with the exam condition
-        int exam_condition = get_ai_priority(report_args->current_exam); // If conditions match, update the timing and count for this exam's condition
-        report_args->timer_conditions_array[ exam_condition- 1] += report_duration;
+    // Owned by the main loop: the priority queue, the blocked exam, the machines and db_exam.txt
+    priority_queue_visit(exam_queue, 0, save_exam, &visit);
+    visit.place = CHECKPOINT_EXAM_OVERFLOW;
+    priority_queue_visit(exam_queue, 1, save_exam, &visit);
+    if (pending_exam) {
+        checkpoint_add_exam(writer, CHECKPOINT_EXAM_PENDING, pending_exam);
+    }
+    for (int level = 1; level <= 6; level++) {
+        get_priority_admission_stats(exam_queue, level, &state->exam_admission[level - 1]);
+    }
+    state->machines = machines_count(machines);
+    state->tempo_total = simulation_clock(report_args->counters);
+    merge_db_log(exam_log, exam_file); // The saved sizes cover every record written so far
+    fflush(exam_file);
+    state->db_sizes[1] = ftell(exam_file);
 
-        report_args->report_counter_array[exam_condition-1]++;
+    // Shared with the arrival thread and the doctors, taken in the same order as write_report()
+    exam_ledger_lock(report_args->ledger);
+    pthread_mutex_lock(&queue_mutex);
+    visit.place = CHECKPOINT_PATIENT_QUEUE;
+    queue_visit(arrival_args->patient_queue, save_patient, &visit);
+    visit.place = CHECKPOINT_PATIENT_OVERFLOW;
+    queue_visit(arrival_args->patient_overflow, save_patient, &visit);
+    checkpoint_add_ledger(writer, report_args->ledger);
+    ReportTally tally; // Every finished report was published before its exam left the ledger
+    merge_report_tallies(report_args->counters, &tally);
+    state->time_reports = tally.time_reports;
+    state->pacientes_totais = *arrival_args->total_patients;
+    state->reports_finalizados = tally.reports;
+    state->reports_tempo_ok = tally.delayed;
+    state->reports = tally.stream;
+    memcpy(state->report_histogram, tally.histogram, sizeof(state->report_histogram));
+    state->patient_admission = patient_admission;
+    for (int stage = 0; stage < SHUTDOWN_STAGE_COUNT; stage++) {
+        get_stage_account(report_args->shutdown, (ShutdownStage)stage, &state->stages[stage]);
+    }
+    get_rng_state(&state->rng);
+    get_arrival_state(arrival_args->arrivals, &state->arrival);
+    state->arriving = arrival_args->arriving;
+    state->arrival_gap = arrival_args->arrival_gap;
+    merge_db_log(arrival_args->patient_log, arrival_args->patient_file);
+    fflush(arrival_args->patient_file);
+    state->db_sizes[0] = ftell(arrival_args->patient_file);
+    merge_db_log(report_args->report_log, report_args->report_file);
+    fflush(report_args->report_file);
+    state->db_sizes[2] = ftell(report_args->report_file);
+    pthread_mutex_unlock(&queue_mutex);
+    exam_ledger_unlock(report_args->ledger);
 
-        }else{  // If a new diagnostic is given by the doctor, update the timing and count based on the report's condition
-        int report_priority = get_report_priority_condition(report);
-        report_args->timer_conditions_array[report_priority - 1] += report_duration;
+    return commit_checkpoint(writer, state, path); // The disk is written with every lock released
+}
 
-        report_args->report_counter_array[report_priority - 1] ++;
+static void restore_checkpoint(const Checkpoint *checkpoint, ReportThreadArgs *report_args, ReportThreadArgs2 *arrival_args,
+                               ExamPriorityQueue *exam_queue, Exam **pending_exam, RxPool *machines, DoctorPool *doctors) {
+// Puts back the saved patients and exams, the shared counters and the generators, before the arrival thread starts
+// Devolve os pacientes e exames salvos, os contadores compartilhados e os geradores, antes da thread de chegadas começar
+    const CheckpointState *state = get_checkpoint_state(checkpoint);
+    StageAccount stages[SHUTDOWN_STAGE_COUNT];
+    memcpy(stages, state->stages, sizeof(stages));
 
+    ReportTally tally = {0};
+    tally.time_reports = state->time_reports;
+    tally.reports = state->reports_finalizados;
+    tally.delayed = state->reports_tempo_ok;
+    tally.stream = state->reports;
+    memcpy(tally.histogram, state->report_histogram, sizeof(tally.histogram));
+    restore_report_tally(report_args->counters, &tally);
+    set_simulation_clock(report_args->counters, state->tempo_total);
+    *arrival_args->total_patients = state->pacientes_totais;
+    patient_admission = state->patient_admission;
+    for (int level = 1; level <= 6; level++) {
+        set_priority_admission_stats(exam_queue, level, &state->exam_admission[level - 1]);
+    }
+    if (state->machines != machines_count(machines)) {
+        resize_machines(machines, state->machines);
+    }
+    set_rng_state(&state->rng);
+    set_arrival_state(arrival_args->arrivals, &state->arrival);
+    arrival_args->arriving = state->arriving;
+    arrival_args->arrival_gap = state->arrival_gap;
 
+    for (int i = 0; i < checkpoint_patient_count(checkpoint); i++) {
+        CheckpointPlace place;
+        Patient *patient = checkpoint_patient(checkpoint, i, &place);
+        enqueue(place == CHECKPOINT_PATIENT_OVERFLOW ? arrival_args->patient_overflow : arrival_args->patient_queue, patient);
+    }
+    V_queue *routed = create_queue(); // Handed to the doctors once the stage accounts are back
+    for (int i = 0; i < checkpoint_exam_count(checkpoint); i++) {
+        CheckpointPlace place;
+        Exam *exam = checkpoint_exam(checkpoint, i, &place);
+        switch (place) {
+        case CHECKPOINT_EXAM_QUEUE:
+        case CHECKPOINT_EXAM_OVERFLOW:
+            restore_priority_exam(exam_queue, exam, place == CHECKPOINT_EXAM_OVERFLOW);
+            break;
+        case CHECKPOINT_EXAM_PENDING:
+            *pending_exam = exam;
+            break;
+        default: // A report in progress starts over; the doctor taking it counts the exam again
+            if (place == CHECKPOINT_EXAM_DOCTORS) {
+                StageAccount *exams = &stages[SHUTDOWN_STAGE_EXAMS];
+                if (exams->drained > 0) {
+                    exams->drained--;
+                } else if (exams->finished > 0) {
+                    exams->finished--;
+                }
+            }
+            enqueue(routed, exam);
+            break;
         }
-        pthread_mutex_unlock(&queue_mutex); // Unlock the mutex after updating shared resources
-        print_report_db(report, report_args->report_file);// Save the report to the "database"
-
-        print_report(report); // and print it
-
-        free(report);// Free the memory allocated for the report
-        }else{
+    }
+    for (int stage = 0; stage < SHUTDOWN_STAGE_COUNT; stage++) {
+        set_stage_account(report_args->shutdown, (ShutdownStage)stage, &stages[stage]);
+    }
+    Exam *exam;
+    while ((exam = (Exam *)queue_pop_front(routed)) != NULL) {
+        exam_ledger_lock(report_args->ledger);
+        exam_ledger_add(report_args->ledger, exam);
+        exam_ledger_unlock(report_args->ledger);
+        submit_exam_to_doctors(doctors, exam);
+    }
+    E_free_queue(routed);
+}
+
+static double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void redirect_branch_output(int branch) {
+// The output of a what-if branch, log included, goes to whatif_<branch>.txt // A saída de um ramo vai para whatif_<ramo>.txt
+    char path[64];
+    snprintf(path, sizeof(path), "whatif_%d.txt", branch);
+    FILE *output = fopen(path, "w");
+    if (!output || dup2(fileno(output), STDOUT_FILENO) < 0) {
+        perror(path);
+        exit(1);
+    }
+    fclose(output);
+    log_set_output(STDOUT_FILENO); // Even with --log-file, each branch keeps its own log
+}
 
-        // If the total simulation execution time has been exceeded, terminate the thread
+static FILE *open_branch_db(FILE *shared, const char *name, int branch) {
+// A branch writes db_<name>_<branch>.txt from the fork on; the warm-up stays in the shared file
+// Um ramo escreve db_<nome>_<ramo>.txt a partir do fork; o aquecimento fica no arquivo compartilhado
+    char path[64];
+    snprintf(path, sizeof(path), "db_%s_%d.txt", name, branch);
+    fclose(shared);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    return file;
+}
+
+static DbLog *open_branch_log(DbLog *shared, const char *name, int branch, const SimOptions *sim_options) {
+// The shards of db_<name>_<branch>.txt; the shared ones are empty after the merge before the fork
+// As fatias de db_<nome>_<ramo>.txt; as compartilhadas estão vazias depois da junção antes do fork
+    char path[64];
+    snprintf(path, sizeof(path), "db_%s_%d.txt", name, branch);
+    destroy_db_log(shared);
+    return create_db_log(path, (AsyncIoKind)sim_options->db_io, sim_options->db_sync);
+}
+
+static void print_usage(const char *program) {
+// Prints the command line options // Imprime as opções de linha de comando
+    printf("Usage: %s [options]\n", program);
+    printf("  -q, --quiet            No event output and no dashboard (benchmark mode)\n");
+    printf("  -l, --log-level LEVEL  debug, info, warn, error or off (default: debug)\n");
+    printf("      --no-dashboard     Keep the event log but don't draw the dashboard\n");
+    printf("      --log-file FILE    Write the event log to FILE (default: stdout, %s while the dashboard is on)\n", DASHBOARD_LOG_FILE);
+    printf("  -s, --time-scale X     Multiply every delay by X (0.1 runs ten times faster)\n");
+    printf("  -m, --machines N       Number of X-Ray machines (default %d)\n", sim_config()->machines);
+    printf("  -r, --routing POLICY   first-free, least-loaded, shortest-expected or jsq (default: first-free)\n");
+    printf("  -S, --speeds LIST      Exam speed of each machine, e.g. 1,1,0.5 for two new and one old scanner\n");
+    printf("      --ai-batch N       1 scores each exam with the AI model, 0 disables the AI stage (default 1); larger\n");
+    printf("                         batches are capped to 1 here: only the main loop examines, one exam at a time,\n");
+    printf("                         so a batch never fills (clinic_stress batches the exams of its machine threads)\n");
+    printf("      --ai-timeout MS    Longest wait for an AI batch to fill (default 2 ms; unused with batches of 1)\n");
+    printf("      --ai-kernel NAME   simd or scalar (default simd)\n");
+    printf("      --image-size N     Side of the synthetic X-ray image of each exam, 0 disables it (default %d)\n", XRAY_DEFAULT_SIZE);
+    printf("      --image-kernels K  simd or scalar image preprocessing (default simd)\n");
+    printf("      --arrivals KIND    poisson, varying (sinusoidal rush hours) or batch (default: poisson)\n");
+    printf("      --arrival-rate R   Mean patients per simulated second (default %.2f)\n", sim_config()->arrival_rate);
+    printf("      --arrival-amplitude A  varying: rate swings by +/- A times the mean, 0 to 1 (default 0.5)\n");
+    printf("      --arrival-period S     varying: seconds of one rush cycle (default: the whole simulation)\n");
+    printf("      --arrival-batch N      batch: mean patients per group (default 3)\n");
+    printf("      --trace FILE       Replay arrivals from a CSV (timestamp,patient_id,name[,condition]) or binary trace\n");
+    printf("      --replay-speed X   1 replays the trace in real time, N is N times faster, 0 as fast as possible (default 1)\n");
+    printf("      --patient-capacity N   Patients waiting for a machine, 0 for unbounded (default 0)\n");
+    printf("      --level-capacity N     Exams waiting per priority level, 0 for unbounded (default 0)\n");
+    printf("      --exam-capacity N      Exams waiting in all priority levels, 0 for unbounded (default 0)\n");
+    printf("      --overflow POLICY      block, reject, divert or drop-lowest when a queue is full (default: block)\n");
+    printf("      --overflow-capacity N  divert: items parked per overflow queue, 0 for unbounded (default 0)\n");
+    printf("      --doctors LIST         Specialty of each doctor: general, infectious, pulmonology or oncology\n");
+    printf("                             (default %s)\n", DOCTOR_DEFAULT_ROSTER);
+    printf("      --drain-deadline S     Simulated seconds to finish the patients inside after closing (default %.0f)\n", sim_config()->drain_deadline);
+    printf("      --checkpoint FILE      Save the whole simulation to FILE on SIGTERM (then stop) and every --checkpoint-every\n");
+    printf("      --checkpoint-every S   Simulated seconds between checkpoints, 0 saves only on SIGTERM (default 0)\n");
+    printf("      --restore FILE         Resume the simulation saved in FILE; use the options of the saved run\n");
+    printf("      --stats-window S       Simulated seconds behind the live report rates and means (default %.0f)\n", sim_config()->stats_window);
+    printf("      --db-shards            Each writer thread appends framed records to its own db_*.txt.<n>.shard, merged into\n");
+    printf("                             the db files in timestamp order at checkpoints, before a fork and at the end\n");
+    printf("      --db-io KIND           write or uring: shard buffers written with pwrite() or queued to io_uring, falling\n");
+    printf("                             back to pwrite() where io_uring is unavailable (implies --db-shards; default write)\n");
+    printf("      --db-sync N            fdatasync every N buffers of a shard, linked to the write with uring, 0 never (default 0)\n");
+    printf("      --branch-at S          Fork the simulation at S simulated seconds into one process per --what-if\n");
+    printf("      --what-if CHANGE       A branch: baseline, doctor:SPECIALTY, machines:N or surge:X, joined by '+'\n");
+    printf("                             (e.g. --what-if baseline --what-if doctor:oncology+surge:2)\n");
+    printf("      --config FILE          Clinic constants, one key = value per line; the options above still win\n");
+    printf("      --set KEY=VALUE        Override one clinic constant, after any --config before it\n");
+    printf("      --print-config         Print the resulting constants in the --config format and exit\n");
+    printf("  While running: kill -USR1 adds a machine, kill -USR2 removes one\n");
+    printf("  -h, --help             Show this help\n");
+}
 
-            return NULL;
+// Read twice: sim_config_from_arguments() applies --config and --set, parse_arguments() everything else
+static const struct option long_options[] = {
+    {"quiet", no_argument, NULL, 'q'},
+    {"log-level", required_argument, NULL, 'l'},
+    {"no-dashboard", no_argument, NULL, 'D'},
+    {"log-file", required_argument, NULL, 'f'},
+    {"time-scale", required_argument, NULL, 's'},
+    {"machines", required_argument, NULL, 'm'},
+    {"routing", required_argument, NULL, 'r'},
+    {"speeds", required_argument, NULL, 'S'},
+    {"ai-batch", required_argument, NULL, 'B'},
+    {"ai-timeout", required_argument, NULL, 'T'},
+    {"ai-kernel", required_argument, NULL, 'K'},
+    {"image-size", required_argument, NULL, 'I'},
+    {"image-kernels", required_argument, NULL, 'G'},
+    {"arrivals", required_argument, NULL, 'a'},
+    {"arrival-rate", required_argument, NULL, 'R'},
+    {"arrival-amplitude", required_argument, NULL, 'W'},
+    {"arrival-period", required_argument, NULL, 'P'},
+    {"arrival-batch", required_argument, NULL, 'N'},
+    {"trace", required_argument, NULL, 't'},
+    {"replay-speed", required_argument, NULL, 'X'},
+    {"patient-capacity", required_argument, NULL, 'Q'},
+    {"level-capacity", required_argument, NULL, 'L'},
+    {"exam-capacity", required_argument, NULL, 'C'},
+    {"overflow", required_argument, NULL, 'O'},
+    {"overflow-capacity", required_argument, NULL, 'V'},
+    {"drain-deadline", required_argument, NULL, 'Z'},
+    {"doctors", required_argument, NULL, 'Y'},
+    {"checkpoint", required_argument, NULL, 'c'},
+    {"checkpoint-every", required_argument, NULL, 'E'},
+    {"restore", required_argument, NULL, 'U'},
+    {"stats-window", required_argument, NULL, 'A'},
+    {"branch-at", required_argument, NULL, 'b'},
+    {"what-if", required_argument, NULL, 'w'},
+    {"db-shards", no_argument, NULL, 'H'},
+    {"db-io", required_argument, NULL, 'J'},
+    {"db-sync", required_argument, NULL, 'j'},
+    {"print-config", no_argument, NULL, 'F'},
+    SIM_CONFIG_OPTIONS,
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+static const char short_options[] = "ql:s:m:r:S:h";
 
+static int parse_arguments(int argc, char *argv[], SimOptions *sim_options) {
+// Applies the command line options, returns -1 if the program must stop // Aplica as opções de linha de comando, retorna -1 se o programa deve parar
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, long_options, NULL)) != -1) {
+        switch (option) {
+        case 'q':
+            log_set_quiet(1);
+            sim_options->use_dashboard = 0;
+            break;
+        case 'l': {
+            int level = log_level_from_name(optarg);
+            if (level < 0) {
+                printf("Unknown log level: %s\n", optarg);
+                return -1;
+            }
+            log_set_level(level);
+            break;
         }
-
-
-    return NULL;
-}
-
-
-int main() {
+        case 'D':
+            sim_options->use_dashboard = 0;
+            break;
+        case 'f':
+            sim_options->log_file = optarg;
+            break;
+        case 's':
+            set_time_scale(atof(optarg));
+            break;
+        case 'm':
+            sim_options->machines = atoi(optarg);
+            if (sim_options->machines < 1) {
+                printf("The clinic needs at least one machine\n");
+                return -1;
+            }
+            break;
+        case 'r':
+            sim_options->routing = routing_policy_from_name(optarg);
+            if (sim_options->routing < 0) {
+                printf("Unknown routing policy: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'S':
+            sim_options->speeds = optarg;
+            break;
+        case 'B':
+            sim_options->ai_batch = atoi(optarg);
+            if (sim_options->ai_batch < 0 || sim_options->ai_batch > AI_MAX_BATCH) {
+                printf("The AI batch must be between 0 and %d\n", AI_MAX_BATCH);
+                return -1;
+            }
+            break;
+        case 'T':
+            sim_options->ai_timeout = atof(optarg) / 1000.0;
+            break;
+        case 'K':
+            sim_options->ai_kernel = ai_kernel_from_name(optarg);
+            if (!sim_options->ai_kernel) {
+                printf("Unknown AI kernel: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'I':
+            sim_options->image_size = atoi(optarg);
+            if (sim_options->image_size != 0 && sim_options->image_size < 2) {
+                printf("The image size must be 0 or at least 2\n");
+                return -1;
+            }
+            break;
+        case 'G':
+            sim_options->image_kernels = xray_kernels_from_name(optarg);
+            if (sim_options->image_kernels < 0) {
+                printf("Unknown image kernels: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'a':
+            sim_options->arrivals.kind = arrival_kind_from_name(optarg);
+            if (sim_options->arrivals.kind < 0) {
+                printf("Unknown arrival distribution: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'R':
+            sim_options->arrivals.rate = atof(optarg);
+            break;
+        case 'W':
+            sim_options->arrivals.amplitude = atof(optarg);
+            break;
+        case 'P':
+            sim_options->arrivals.period = atof(optarg);
+            break;
+        case 'N':
+            sim_options->arrivals.batch_mean = atof(optarg);
+            break;
+        case 't':
+            sim_options->trace = optarg;
+            break;
+        case 'Q':
+            sim_options->patient_capacity = atoi(optarg);
+            break;
+        case 'L':
+            sim_options->level_capacity = atoi(optarg);
+            break;
+        case 'C':
+            sim_options->exam_capacity = atoi(optarg);
+            break;
+        case 'V':
+            sim_options->overflow_capacity = atoi(optarg);
+            break;
+        case 'O':
+            sim_options->overflow_policy = overflow_policy_from_name(optarg);
+            if (sim_options->overflow_policy < 0) {
+                printf("Unknown overflow policy: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'Y':
+            sim_options->doctors = optarg;
+            break;
+        case 'c':
+            sim_options->checkpoint = optarg;
+            break;
+        case 'E':
+            sim_options->checkpoint_every = atof(optarg);
+            if (sim_options->checkpoint_every < 0) {
+                printf("The checkpoint interval can't be negative\n");
+                return -1;
+            }
+            break;
+        case 'U':
+            sim_options->restore = optarg;
+            break;
+        case 'A':
+            sim_options->stats_window = atof(optarg);
+            if (sim_options->stats_window <= 0) {
+                printf("The statistics window must be positive\n");
+                return -1;
+            }
+            break;
+        case 'b':
+            sim_options->branch_at = atof(optarg);
+            if (sim_options->branch_at < 0 || sim_options->branch_at >= sim_config()->max_execution) {
+                printf("The branch time must be between 0 and %.1f seconds\n", sim_config()->max_execution);
+                return -1;
+            }
+            break;
+        case 'w':
+            if (sim_options->what_if_count == WHAT_IF_MAX) {
+                printf("At most %d what-if branches\n", WHAT_IF_MAX);
+                return -1;
+            }
+            if (parse_what_if(optarg, &sim_options->what_if[sim_options->what_if_count]) != 0) {
+                printf("Invalid what-if branch: %s\n", optarg);
+                return -1;
+            }
+            sim_options->what_if_count++;
+            break;
+        case 'Z':
+            sim_options->drain_deadline = atof(optarg);
+            if (sim_options->drain_deadline < 0) {
+                printf("The drain deadline can't be negative\n");
+                return -1;
+            }
+            break;
+        case 'X':
+            sim_options->replay_speed = atof(optarg);
+            if (sim_options->replay_speed < 0) {
+                printf("The replay speed can't be negative\n");
+                return -1;
+            }
+            break;
+        case 'H':
+            sim_options->db_shards = 1;
+            break;
+        case 'J':
+            sim_options->db_io = async_io_from_name(optarg);
+            if (sim_options->db_io < 0) {
+                printf("Unknown db output: %s (write or uring)\n", optarg);
+                return -1;
+            }
+            sim_options->db_shards = 1; // Only the shards go through it
+            break;
+        case 'j':
+            sim_options->db_sync = atoi(optarg);
+            if (sim_options->db_sync < 0) {
+                printf("The db sync interval can't be negative\n");
+                return -1;
+            }
+            break;
+        case 'F':
+            sim_options->print_config = 1;
+            break;
+        case CONFIG_OPTION_FILE:
+        case CONFIG_OPTION_SET:
+            break; // Already applied by sim_config_from_arguments()
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (sim_options->ai_batch > 1) {
+        // The main loop waits for each diagnosis before it examines the next patient: a larger batch would only
+        // add --ai-timeout to every exam // O laço principal espera cada diagnóstico: um lote maior só somaria o tempo limite
+        printf("--ai-batch %d capped to 1: clinic_simulation examines one patient at a time\n", sim_options->ai_batch);
+        sim_options->ai_batch = 1;
+    }
+    if (sim_options->checkpoint_every > 0 && !sim_options->checkpoint) {
+        printf("--checkpoint-every needs --checkpoint FILE\n");
+        return -1;
+    }
+    if ((sim_options->checkpoint || sim_options->restore) && sim_options->trace) {
+        printf("Trace replays can't be checkpointed\n");
+        return -1;
+    }
+    if ((sim_options->branch_at >= 0) != (sim_options->what_if_count > 0)) {
+        printf("--branch-at and --what-if go together\n");
+        return -1;
+    }
+    if (sim_options->what_if_count > 0) {
+        if (sim_options->trace || sim_options->checkpoint) {
+            printf("What-if branches can't replay a trace or write checkpoints\n");
+            return -1;
+        }
+        sim_options->use_dashboard = 0; // Every branch would draw on the same terminal
+    }
+    if (sim_options->use_dashboard && !sim_options->log_file) {
+        sim_options->log_file = DASHBOARD_LOG_FILE; // Log lines would tear the redrawn frames
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // The clinic constants: defaults, then --config files and --set, installed before the options read them
+    SimConfig config;
+    if (sim_config_from_arguments(&config, argc, argv, short_options, long_options) != 0) {
+        return 1;
+    }
+    sim_config_install(&config);
+    SimOptions sim_options = {1, config.machines, RX_ROUTE_FIRST_FREE, NULL, 1, 0.002, ai_kernel_simd, XRAY_DEFAULT_SIZE, XRAY_SIMD,
+                              {ARRIVAL_POISSON, config.arrival_rate, 0.5, config.max_execution, 3}, NULL, 1,
+                              0, 0, 0, OVERFLOW_BLOCK, 0, config.drain_deadline, NULL, NULL, 0, NULL, config.stats_window, -1, 0,
+                              {{"", 0, 1, ""}}, 0, ASYNC_IO_WRITE, 0, NULL, 0};
+    if (parse_arguments(argc, argv, &sim_options) != 0) {
+        return 1;
+    }
+    // The options with their own flag win over the file; the installed copy is never written again once threads run
+    config.machines = sim_options.machines;
+    config.arrival_rate = sim_options.arrivals.rate;
+    config.drain_deadline = sim_options.drain_deadline;
+    config.stats_window = sim_options.stats_window;
+    sim_config_install(&config);
+    if (sim_options.print_config) {
+        sim_config_write(stdout, &config);
+        return 0;
+    }
+    int log_fd = -1; // --log-file, closed after the last log_flush()
+    if (sim_options.log_file) {
+        log_fd = open(sim_options.log_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd < 0) {
+            perror(sim_options.log_file);
+            return 1;
+        }
+        log_set_output(log_fd);
+        if (sim_options.use_dashboard) {
+            printf("\n Event log: %s\n", sim_options.log_file);
+        }
+    }
+    signal(SIGUSR1, resize_signal);
+    signal(SIGUSR2, resize_signal);
+    if (sim_options.checkpoint) {
+        signal(SIGTERM, checkpoint_signal);
+    }
+    Checkpoint *checkpoint = NULL;
+    if (sim_options.restore) {
+        checkpoint = load_checkpoint(sim_options.restore);
+        if (!checkpoint) {
+            printf("Can't restore %s: missing, damaged or written by another build\n", sim_options.restore);
+            return 1;
+        }
+    }
+
     printf("\n Simulation started...\n");
-    pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER; // Initialize the mutex to handle concurrency in the queue
-     srand((unsigned int)time(NULL)); // Seed the random number generator for generating random times
+     rng_seed((unsigned int)time(NULL)); // Seed the random number generator for generating random times
+     rng_bind_stream(RNG_STREAM_MAIN); // Restored below with the other streams
 
-     // Declare threads for handling patients and doctor's report
-     pthread_t thread_patient;
-     pthread_t thread_doctor;
+     // Declare the thread for handling patients, the doctors run in their own pool
+     pthread_t thread_patient;
 
 
 
-     FILE *patient_file = fopen("db_patient.txt", "w"); // Open the patient file for writing
+    // A restored run keeps the lines written up to the checkpoint and appends after them
+    const char *db_mode = "w";
+    if (checkpoint) {
+        const long long *db_sizes = get_checkpoint_state(checkpoint)->db_sizes;
+        if (truncate("db_patient.txt", db_sizes[0]) != 0 || truncate("db_exam.txt", db_sizes[1]) != 0 ||
+            truncate("db_report.txt", db_sizes[2]) != 0) {
+            perror("Failed to rewind the db files to the checkpoint");
+            return 1;
+        }
+        db_mode = "a";
+    }
+
+     FILE *patient_file = fopen("db_patient.txt", db_mode); // Open the patient file for writing
     if (!patient_file) {
         perror("Failed to open db_patient.txt");
         return 1;
     }
 
-    FILE *exam_file = fopen("db_exam.txt", "w"); // Open the exam file for writing
+    FILE *exam_file = fopen("db_exam.txt", db_mode); // Open the exam file for writing
     if (!exam_file) {
         perror("Failed to open db_exam.txt");
         fclose(patient_file);
         return 1;
     }
 
-    FILE *report_file = fopen("db_report.txt", "w"); // Open the report file for writing
-    if (!report_file) {
-        perror("Failed to open db_report.txt");
-        fclose(patient_file);
-        fclose(exam_file);
-        return 1;
+    FILE *report_file = fopen("db_report.txt", db_mode); // Open the report file for writing
+    if (!report_file) {
+        perror("Failed to open db_report.txt");
+        fclose(patient_file);
+        fclose(exam_file);
+        return 1;
     }
 
+    // With --db-shards each writer thread appends to its own shard, merged into the files above
+    AsyncIoKind db_io = (AsyncIoKind)sim_options.db_io;
+    DbLog *patient_log = sim_options.db_shards ? create_db_log("db_patient.txt", db_io, sim_options.db_sync) : NULL;
+    DbLog *exam_log = sim_options.db_shards ? create_db_log("db_exam.txt", db_io, sim_options.db_sync) : NULL;
+    DbLog *report_log = sim_options.db_shards ? create_db_log("db_report.txt", db_io, sim_options.db_sync) : NULL;
+
     // Initialize various counters and variables to track the simulation progress
-    int status_delay = 0;
     double tempo_total = 0;//
-    double time_reports = 0;//
-    int pacientes_totais = 0;//
-    int reports_finalizados = 0; //
-    int reports_tempo_ok = 0;//
+    int pacientes_totais = 0;//
     int ia_exames_realizados = 0;
-    int pacientes_fila_prioridade;
-    int last_print_time = 0;
-    double sum_conditions_time[6] = {0.00};
-    int condiotions_count[6] = {0};
+    int trace_labeled = 0, trace_agreed = 0; // Exams whose patient came with a real condition, and how many the AI got right
+    int pacientes_fila_prioridade = 0;
+    // Report counters, one cache-line-padded shard per doctor: durations (Welford mean and variance, EWMA,
+    // windows of the last --stats-window seconds), delays and the histogram, summed only when read
+    SimCounters *counters = create_sim_counters(sim_options.stats_window);
+    ReportTally tally;
+    DashboardSnapshot status;
 
     // Create machines (e.g., X-Ray machines) and patient queue
-    Rx **machines_list = create_machines();
+    RxPool *machines_list = create_machines(sim_options.machines);
+    set_routing_policy(machines_list, (RxRoutingPolicy)sim_options.routing);
+
+    // Batched AI diagnosis stage between the machines and the priority queue
+    AiModel *ai_model = NULL;
+    AiBatcher *ai_stage = NULL;
+    if (sim_options.ai_batch > 0) {
+        ai_model = create_ai_model((unsigned int)time(NULL));
+        ai_stage = create_ai_batcher(ai_model, sim_options.ai_kernel, sim_options.ai_batch, sim_options.ai_timeout);
+        ai_batcher_start(ai_stage);
+        set_ai_batcher(machines_list, ai_stage);
+    }
+    set_exam_imaging(machines_list, sim_options.image_size, sim_options.image_size, (XrayKernels)sim_options.image_kernels);
+    if (sim_options.speeds && set_machine_speeds(machines_list, sim_options.speeds) < 0) {
+        printf("Invalid machine speeds: %s\n", sim_options.speeds);
+        return 1;
+    }
     V_queue *patient_queue = create_queue();
 
     ExamPriorityQueue *exam_priority_queue = new_priority_queue();// Create a priority queue for exams
-
-    double freezing = pre_random_time();  // Generate a random freezing time for patients arrivals
+
+    // Bounded queues: what happens past the limits is chosen by --overflow
+    V_queue *patient_overflow = create_queue();
+    set_queue_capacity(patient_queue, sim_options.patient_capacity);
+    set_queue_capacity(patient_overflow, sim_options.overflow_capacity);
+    set_priority_queue_limits(exam_priority_queue, sim_options.level_capacity, sim_options.exam_capacity,
+                              sim_options.overflow_policy, sim_options.overflow_capacity);
+    Exam *pending_exam = NULL; // OVERFLOW_BLOCK: exam waiting for room, the machines take no patient meanwhile
+
+    double freezing = 0; // Duration of each main loop step
+
+    // Closes the intake at max_execution, then lets the stages drain until the deadline
+    ShutdownControl *shutdown = create_shutdown(sim_options.drain_deadline);
+
+    // Exams handed to the doctors, tracked only when they may have to go into a checkpoint
+    ExamLedger *ledger = sim_options.checkpoint ? create_exam_ledger() : NULL;
+
+    // Doctor threads with specialties, each one working through its own deque of routed exams
+    ReportThreadArgs *report_args = create_struct_report(report_file,counters,shutdown,ledger);
+    report_args->report_log = report_log;
+    DoctorPool *doctor_pool = create_doctor_pool(sim_options.doctors, write_report, report_args);
+    if (!doctor_pool) {
+        printf("Invalid doctors: %s\n", sim_options.doctors);
+        return 1;
+    }
+    doctor_pool_start(doctor_pool);
 
 
      // Create the arguments structure for the patient thread and start the thread
-    ReportThreadArgs2 *args_patiente = create_struct_patient(patient_queue,patient_file,&tempo_total,&freezing,&pacientes_totais);
+    ArrivalProcess *arrivals = create_arrival_process(&sim_options.arrivals, (unsigned int)time(NULL));
+    if (!arrivals) {
+        printf("Invalid arrival parameters\n");
+        return 1;
+    }
+    ArrivalTrace *trace = NULL;
+    if (sim_options.trace) {
+        trace = open_arrival_trace(sim_options.trace);
+        if (!trace) {
+            printf("Can't read the arrival trace %s\n", sim_options.trace);
+            return 1;
+        }
+    }
+    ReportThreadArgs2 *args_patiente = create_struct_patient(patient_queue,patient_file,counters,arrivals,trace,sim_options.replay_speed,patient_overflow,sim_options.overflow_policy,&pacientes_totais,shutdown);
+    args_patiente->patient_log = patient_log;
+    if (checkpoint) { // Resume where the saved run stopped, before anything arrives
+        const CheckpointState *saved = get_checkpoint_state(checkpoint);
+        tempo_total = saved->tempo_total;
+        ia_exames_realizados = saved->ia_exames_realizados;
+        trace_labeled = saved->trace_labeled;
+        trace_agreed = saved->trace_agreed;
+        pacientes_fila_prioridade = saved->pacientes_fila_prioridade;
+        restore_checkpoint(checkpoint, report_args, args_patiente, exam_priority_queue, &pending_exam, machines_list, doctor_pool);
+        printf("\n Resumed from %s at %.3lf simulated seconds\n", sim_options.restore, tempo_total);
+        free_checkpoint(checkpoint);
+    }
     pthread_create(&thread_patient,NULL,arrival_of_patients,(void *)args_patiente);
 
-    while (tempo_total < MAX_EXECUTION) { // Main simulation loop
+    // The dashboard redraws on its own thread from the snapshots published below, so the loop never waits on the terminal
+    Dashboard *dashboard = create_dashboard(DASHBOARD_REFRESH);
+    if (sim_options.use_dashboard) {
+        dashboard_start(dashboard);
+    }
+
+    double next_checkpoint = tempo_total + sim_options.checkpoint_every;
+    int stopped_by_checkpoint = 0;
+
+    // What-if branching: 1 waits for --branch-at, 2 waits for a single thread to be left, 0 is done or off
+    int branching = sim_options.what_if_count > 0;
+    WhatIfRun *what_if = NULL;
+    int branch = -1;
+    int branch_failed = 0;
+    double run_started = monotonic_seconds();
+    double quiet_started = 0;
+
+    for (;;) { // Main simulation loop, it keeps running while the clinic drains
+
+    // Checkpoints are taken between two steps, when the main loop holds no patient or exam of its own
+    if (sim_options.checkpoint && (checkpoint_requested || (sim_options.checkpoint_every > 0 && tempo_total >= next_checkpoint))) {
+        CheckpointState checkpoint_state;
+        memset(&checkpoint_state, 0, sizeof(checkpoint_state));
+        checkpoint_state.ia_exames_realizados = ia_exames_realizados;
+        checkpoint_state.trace_labeled = trace_labeled;
+        checkpoint_state.trace_agreed = trace_agreed;
+        checkpoint_state.pacientes_fila_prioridade = pacientes_fila_prioridade;
+        if (save_checkpoint(sim_options.checkpoint, &checkpoint_state, report_args, args_patiente, exam_priority_queue,
+                            pending_exam, machines_list, exam_file, exam_log) != 0) {
+            LOG_ERROR(LOG_CAT_SIM, "\nCheckpoint to %s failed: %s", sim_options.checkpoint, strerror(errno));
+        } else {
+            LOG_INFO(LOG_CAT_SIM, "\nCheckpoint saved to %s at %.1lf s", sim_options.checkpoint, tempo_total);
+        }
+        while (sim_options.checkpoint_every > 0 && next_checkpoint <= tempo_total) {
+            next_checkpoint += sim_options.checkpoint_every;
+        }
+        if (checkpoint_requested) { // SIGTERM: everything still inside is in the checkpoint, stop here
+            stopped_by_checkpoint = 1;
+            shutdown_begin_drain(shutdown, tempo_total);
+            pthread_mutex_lock(&queue_mutex);
+            pthread_cond_broadcast(&queue_space);
+            pthread_mutex_unlock(&queue_mutex);
+            break;
+        }
+    }
+
+    // fork() copies only the calling thread: the arrivals stop first, then the doctors finish what they hold.
+    // The simulated clock stands still meanwhile, so the branches fork at --branch-at and not after the drain
+    if (branching == 1 && tempo_total >= sim_options.branch_at) {
+        pthread_mutex_lock(&queue_mutex);
+        args_patiente->paused = 1;
+        pthread_mutex_unlock(&queue_mutex);
+        branching = 2;
+        quiet_started = monotonic_seconds();
+    }
+    if (branching == 2) {
+        pthread_mutex_lock(&queue_mutex);
+        int quiet = args_patiente->stopped && doctor_pool_backlog(doctor_pool) == 0 && doctor_pool_busy(doctor_pool) == 0;
+        pthread_mutex_unlock(&queue_mutex);
+        if (quiet) {
+            pthread_join(thread_patient, NULL);
+            doctor_pool_stop(doctor_pool);
+            ai_batcher_stop(ai_stage);
+            log_flush();
+            fflush(stdout);
+            merge_db_log(patient_log, patient_file); // The warm-up goes to the shared files
+            merge_db_log(exam_log, exam_file);
+            merge_db_log(report_log, report_file);
+            fflush(patient_file);
+            fflush(exam_file);
+            fflush(report_file);
+            double warmup_seconds = monotonic_seconds() - run_started;
+            double quiet_seconds = monotonic_seconds() - quiet_started;
+            what_if = what_if_fork(sim_options.what_if, sim_options.what_if_count, &branch);
+            if (!what_if) {
+                printf("\nCould not fork the what-if branches\n");
+                return 1;
+            }
+            if (branch < 0) { // Parent: the branches run the rest of the simulation, it only compares them
+                branch_failed = what_if_wait(what_if);
+                print_what_if_report(what_if, tempo_total, quiet_seconds, warmup_seconds);
+                break;
+            }
+
+            // Child: its own output, then its change, then the threads again
+            const WhatIfChange *change = &sim_options.what_if[branch];
+            redirect_branch_output(branch);
+            patient_file = args_patiente->patient_file = open_branch_db(patient_file, "patient", branch);
+            exam_file = open_branch_db(exam_file, "exam", branch);
+            report_file = report_args->report_file = open_branch_db(report_file, "report", branch);
+            if (sim_options.db_shards) { // Shards of its own too, the shared ones were merged before the fork
+                patient_log = args_patiente->patient_log = open_branch_log(patient_log, "patient", branch, &sim_options);
+                exam_log = open_branch_log(exam_log, "exam", branch, &sim_options);
+                report_log = report_args->report_log = open_branch_log(report_log, "report", branch, &sim_options);
+            }
+            printf("\n What-if branch %d (%s) forked at %.3lf simulated seconds\n", branch, change->label, tempo_total);
+            if (change->add_machines != 0) {
+                int wanted = machines_count(machines_list) + change->add_machines;
+                resize_machines(machines_list, wanted > 0 ? wanted : 1);
+            }
+            if (change->rate_factor != 1) { // Same generator state, only the rate changes
+                ArrivalState arrival_state;
+                get_arrival_state(arrivals, &arrival_state);
+                sim_options.arrivals.rate *= change->rate_factor;
+                ArrivalProcess *surge = create_arrival_process(&sim_options.arrivals, arrival_state.seed);
+                if (!surge) {
+                    printf("Invalid arrival rate in branch %s\n", change->label);
+                    return 1;
+                }
+                set_arrival_state(surge, &arrival_state);
+                destroy_arrival_process(arrivals);
+                arrivals = args_patiente->arrivals = surge;
+            }
+            if (change->doctors[0]) {
+                char roster[2 * WHAT_IF_ROSTER_MAX];
+                snprintf(roster, sizeof(roster), "%s,%s", sim_options.doctors ? sim_options.doctors : DOCTOR_DEFAULT_ROSTER,
+                         change->doctors);
+                DoctorPool *branch_doctors = create_doctor_pool(roster, write_report, report_args);
+                if (!branch_doctors) {
+                    printf("Too many doctors in branch %s\n", change->label);
+                    return 1;
+                }
+                destroy_doctor_pool(doctor_pool);
+                doctor_pool = branch_doctors;
+            }
+            doctor_pool_start(doctor_pool);
+            ai_batcher_start(ai_stage);
+            args_patiente->paused = 0;
+            args_patiente->stopped = 0;
+            pthread_create(&thread_patient,NULL,arrival_of_patients,(void *)args_patiente);
+            run_started = monotonic_seconds();
+            branching = 0;
+        }
+    }
+
+    if (tempo_total >= sim_config()->max_execution && shutdown_phase(shutdown) == SHUTDOWN_RUNNING) {
+        shutdown_begin_drain(shutdown, tempo_total); // Stops the arrivals
+        pthread_mutex_lock(&queue_mutex);
+        pthread_cond_broadcast(&queue_space); // An arrival blocked on a full queue sees the clinic closing
+        pthread_mutex_unlock(&queue_mutex);
+    }
+    if (shutdown_phase(shutdown) != SHUTDOWN_RUNNING) {
+        pthread_mutex_lock(&queue_mutex);
+        int drained = is_queue_empty(patient_queue) && is_queue_empty(patient_overflow) && !pending_exam &&
+                      is_priority_queue_empty(exam_priority_queue) && priority_queue_overflow_size(exam_priority_queue) == 0 &&
+                      doctor_pool_backlog(doctor_pool) == 0 && doctor_pool_busy(doctor_pool) == 0;
+        pthread_mutex_unlock(&queue_mutex);
+        if (drained || shutdown_deadline_passed(shutdown, tempo_total)) {
+            break;
+        }
+    }
 
     freezing =  pre_random_time();
     my_sleep(freezing); // This one is just for the main interations, doesn't affects the patients arrival delay and doctor's report, because they both are other threads
-    tempo_total+= freezing;
-
-
+    if (branching != 2) { // Held while the doctors finish before a what-if fork
+        tempo_total+= freezing;
+        set_simulation_clock(counters, tempo_total);
+    }
 
-    pthread_mutex_lock(&queue_mutex);  // Lock the mutex to safely access the patient queue
-    if(!is_queue_empty(patient_queue)){
 
 
-    Patient *current_patient = P_denqueue(patient_queue);
+    if (pending_exam && offer_priority_exam(exam_priority_queue, pending_exam, NULL) != ADMIT_WAIT) {
+        pending_exam = NULL; // A doctor made room (the policy is block, so it can't be rejected or diverted)
+    }
+
+    pthread_mutex_lock(&queue_mutex);  // Lock the mutex to safely access the patient queue
+    if(!pending_exam && !is_queue_empty(patient_queue)){
+
+
+    Patient *current_patient = P_denqueue(patient_queue);
+    admission_refill(patient_queue, patient_overflow); // A diverted patient takes the freed place
+    pthread_cond_signal(&queue_space);
 
-    pthread_mutex_unlock(&queue_mutex); //Unlock the mutex
+    pthread_mutex_unlock(&queue_mutex); //Unlock the mutex
+    shutdown_count_done(shutdown, SHUTDOWN_STAGE_PATIENTS);
     print_patient(current_patient);
 
     Exam *current_exam = verify_and_ocupate(machines_list, current_patient);
     ia_exames_realizados++;
+    if (get_patient_condition(current_patient)) { // Ground truth from the trace
+        trace_labeled++;
+        trace_agreed += strcmp(get_patient_condition(current_patient), get_exam_condition(current_exam)) == 0;
+    }
+    destroy_patient(current_patient); // The exam keeps everything the next stages need
 
-    print_exam_db(current_exam,exam_file);  // Print exam details to the database file
+    if (exam_log) {
+        char record[EXAM_DB_RECORD];
+        append_db_record(exam_log, record, format_exam_db(current_exam, record, sizeof(record)));
+    } else {
+        print_exam_db(current_exam,exam_file);  // Print exam details to the database file
+    }
 
 
 
-    insert_in_priority_queue(exam_priority_queue, current_exam);// Add the exam to the priority queue
+    Exam *dropped_exam = NULL;
+    AdmissionResult admitted = offer_priority_exam(exam_priority_queue, current_exam, &dropped_exam);// Add the exam to the priority queue
+    if (admitted == ADMIT_WAIT) {
+        pending_exam = current_exam;
+    } else if (admitted == ADMIT_REJECTED) {
+        destroy_exam(current_exam);
+    }
+    if (dropped_exam) {
+        destroy_exam(dropped_exam);
+    }
 
     }else{
 
@@ -292,18 +1324,22 @@ int main() {
 
 
     }
-if (!is_priority_queue_empty(exam_priority_queue)) {  // Check if there are exams in the priority queue and gets the first in priority queue and starts report thread
+// Hand exams to the doctors only while one is free to start it: the rest wait in the priority queue, which keeps their
+// priority order and its capacity limits in force when the doctors are saturated
+while (branching != 2 && !is_priority_queue_empty(exam_priority_queue) &&
+       doctor_pool_backlog(doctor_pool) < doctor_pool_size(doctor_pool) - doctor_pool_busy(doctor_pool)) {
 
 
             Exam *check_exam = get_priority_exams(exam_priority_queue);
             pacientes_fila_prioridade = priority_queue_waiting(exam_priority_queue);
-            int exam_condition = get_ai_priority(check_exam);
-
-            print_exam(check_exam);
-
-            // Create the arguments structure for the doctor thread and start the thread
-            ReportThreadArgs *new_args = create_struct_report(check_exam, report_file,&tempo_total, &time_reports, &reports_tempo_ok, &reports_finalizados,sum_conditions_time,condiotions_count,&exam_condition);
-            pthread_create(&thread_doctor, NULL,report, (void *)new_args);
+
+            print_exam(check_exam);
+
+            // Route the exam to a doctor of its specialty; an idle colleague steals it if that one is busy
+            exam_ledger_lock(ledger);
+            exam_ledger_add(ledger, check_exam);
+            exam_ledger_unlock(ledger);
+            submit_exam_to_doctors(doctor_pool, check_exam);
 
 
    }
@@ -311,51 +1347,172 @@ if (!is_priority_queue_empty(exam_priority_queue)) {  // Check if there are exam
 
 
 
-    // Update the status display every 11 seconds after at least one report is completed
-    if (tempo_total >= last_print_time + 11 && reports_finalizados>1) {
-    system("clear");
-    print_status(tempo_total, time_reports, pacientes_totais,
-    pacientes_fila_prioridade,
-    reports_finalizados, reports_tempo_ok, ia_exames_realizados, sum_conditions_time, condiotions_count);
+    // Apply machine pool resizes requested with SIGUSR1 / SIGUSR2
+    int delta = atomic_exchange(&machines_delta, 0); // A signal between a load and a store would be lost
+    if (delta != 0) {
+        int wanted = machines_count(machines_list) + delta;
+        resize_machines(machines_list, wanted > 0 ? wanted : 1);
+    }
 
-    last_print_time = tempo_total;
-}
+    // Publish a consistent snapshot for the dashboard; the report shards are summed without stopping the doctors
+    merge_report_tallies(counters, &tally);
+    pthread_mutex_lock(&queue_mutex);
+    status.tempo_total = tempo_total;
+    status.pacientes_totais = pacientes_totais;
+    status.patients_waiting = queue_size(patient_queue);
+    status.patients_rejected = patient_admission.rejected;
+    status.patients_diverted = queue_size(patient_overflow);
+    AdmissionStats exam_admission;
+    get_priority_admission_stats(exam_priority_queue, 0, &exam_admission);
+    status.exams_rejected = exam_admission.rejected;
+    status.exams_dropped = exam_admission.dropped;
+    status.exams_diverted = priority_queue_overflow_size(exam_priority_queue);
+    for (int i = 0; i < DASHBOARD_PRIORITIES; i++) {
+        status.priority_depth[i] = priority_queue_level_size(exam_priority_queue, i + 1);
+    }
+    status.machines_total = machines_count(machines_list);
+    status.machines_busy = count_busy_machines(machines_list);
+    status.machine_utilization = machines_utilization(machines_list);
+    pthread_mutex_unlock(&queue_mutex);
+    status.doctors_active = tally.active;
+    status.ia_exames_realizados = ia_exames_realizados;
+    status.reports_finalizados = tally.reports;
+    status.reports_tempo_ok = tally.delayed;
+    status.time_reports = tally.time_reports;
+    status.reports = tally.stream;
+    memcpy(status.report_histogram, tally.histogram, sizeof(tally.histogram));
+
+    dashboard_publish(dashboard, &status);
 
 
 
     }
-    // Wait for both patient and doctor threads to finish
-    pthread_join(thread_patient, NULL);
-    pthread_join(thread_doctor, NULL);
+    // Past the drain deadline: the reports still being written give up, then every thread is joined
+    shutdown_abandon(shutdown);
+    if (!what_if || branch >= 0) { // What-if parent: joined before the fork
+        pthread_join(thread_patient, NULL);
+    }
+    int unassigned = doctor_pool_stop(doctor_pool); // Joins every doctor; exams still routed are freed
 
-     // Final status display at the end of the simulation
-    if(pacientes_totais>1 && reports_finalizados>1){
-    print_status(tempo_total, time_reports, pacientes_totais,
-    pacientes_fila_prioridade,
-    reports_finalizados, reports_tempo_ok, ia_exames_realizados,sum_conditions_time,condiotions_count);
-    }else{
+    // Whatever never left its queue is abandoned; it is freed with the queues below
+    shutdown_count_abandoned(shutdown, SHUTDOWN_STAGE_PATIENTS, queue_size(patient_queue) + queue_size(patient_overflow));
+    shutdown_count_abandoned(shutdown, SHUTDOWN_STAGE_EXAMS, priority_queue_waiting(exam_priority_queue) +
+                             priority_queue_overflow_size(exam_priority_queue) + (pending_exam ? 1 : 0) + unassigned);
+    merge_db_log(patient_log, patient_file); // Every writer is joined: the shards hold the rest of the run
+    merge_db_log(exam_log, exam_file);
+    merge_db_log(report_log, report_file);
+    fflush(patient_file);
+    fflush(exam_file);
+    fflush(report_file);
+    destroy_dashboard(dashboard);
+    log_flush(); // Everything the main thread logged goes out before the final status
+
+    if (what_if && branch < 0) { // The warm-up alone says little, the branches were compared above
+        printf("\nShared warm-up in db_patient.txt, db_exam.txt and db_report.txt, each branch in db_*_<branch>.txt\n");
+    } else {
+         // Final status display at the end of the simulation
+        merge_report_tallies(counters, &tally);
+        print_status(tempo_total, pacientes_totais,
+        pacientes_fila_prioridade,
+        tally.reports, tally.delayed, ia_exames_realizados, &tally.stream);
+
+        if (sim_options.patient_capacity > 0 || sim_options.level_capacity > 0 || sim_options.exam_capacity > 0) {
+            AdmissionStats exam_admission;
+            get_priority_admission_stats(exam_priority_queue, 0, &exam_admission);
+            printf("\nAdmission Control (overflow: %s):\n", overflow_policy_name(sim_options.overflow_policy));
+            print_admission_stats("Patients", &patient_admission, tempo_total);
+            print_admission_stats("Exams", &exam_admission, tempo_total);
+        }
 
-    print_status(tempo_total, 0 , pacientes_totais,
-    0,
-    reports_finalizados, reports_tempo_ok, 0 ,sum_conditions_time,condiotions_count);
+        print_shutdown_report(shutdown);
 
+        ai_batcher_stop(ai_stage);
+        print_machines_stats(machines_list);
+        print_doctor_stats(doctor_pool);
+        if (ai_stage) {
+            print_ai_batch_stats(ai_stage);
+        }
+        if (trace) {
+            TraceStats trace_stats;
+            get_arrival_trace_stats(trace, &trace_stats);
+            printf("\nArrival Trace:\n%ld records read (%ld malformed lines skipped), %.1lf of %.1lf MB parsed\n",
+                   trace_stats.records, trace_stats.skipped, trace_stats.consumed / (1024.0 * 1024.0), trace_stats.bytes / (1024.0 * 1024.0));
+            if (trace_labeled > 0) {
+                printf("AI diagnosis matched the trace condition in %d of %d exams (%.1lf%%)\n",
+                       trace_agreed, trace_labeled, 100.0 * trace_agreed / trace_labeled);
+            }
+        }
+        if (get_exam_image_store(machines_list)) {
+            print_image_store_stats(get_exam_image_store(machines_list));
+        }
+    }
 
+    if (what_if && branch >= 0) { // Hand this branch's outcome to the parent // Entrega o resultado deste ramo ao pai
+        WhatIfResult *result = what_if_result(what_if, branch);
+        result->tempo_total = tempo_total;
+        result->patients = pacientes_totais;
+        result->exams = ia_exames_realizados;
+        merge_report_tallies(counters, &tally);
+        result->reports = tally.reports;
+        result->reports_delayed = tally.delayed;
+        for (int stage = 0; stage < SHUTDOWN_STAGE_COUNT; stage++) {
+            StageAccount account;
+            get_stage_account(shutdown, (ShutdownStage)stage, &account);
+            result->abandoned += account.abandoned;
+        }
+        result->rejected = patient_admission.rejected;
+        result->machines = machines_count(machines_list);
+        result->doctors = doctor_pool_size(doctor_pool);
+        result->real_seconds = monotonic_seconds() - run_started;
+        result->finished = 1;
     }
+    destroy_what_if(what_if);
 
-    // Clean up resources, free memory, and close files
+    // Clean up resources, free memory, and close files
     P_free_queue(patient_queue);
+    P_free_queue(patient_overflow);
+    if (pending_exam) {
+        destroy_exam(pending_exam);
+    }
     destroy_machines(machines_list);
+    destroy_ai_batcher(ai_stage);
+    destroy_ai_model(ai_model);
     free_priority_queue(exam_priority_queue);
 
     free(args_patiente);
-
-
-    fclose(patient_file);
-    fclose(exam_file);
+    destroy_arrival_process(arrivals);
+    close_arrival_trace(trace);
+    destroy_doctor_pool(doctor_pool);
+    free(report_args);
+    destroy_shutdown(shutdown);
+    destroy_exam_ledger(ledger);
+    destroy_sim_counters(counters);
+
+
+    destroy_db_log(patient_log);
+    destroy_db_log(exam_log);
+    destroy_db_log(report_log);
+    fclose(patient_file);
+    fclose(exam_file);
     fclose(report_file);
-
+
+    log_flush();
+    if (log_fd >= 0) {
+        log_set_output(STDOUT_FILENO);
+        close(log_fd);
+    }
+    if (stopped_by_checkpoint) {
+        printf("\nSimulation stopped by SIGTERM, resume it with --restore %s\n", sim_options.checkpoint);
+    }
+    if (what_if && branch < 0) {
+        return branch_failed > 0;
+    }
     printf("\nSimulation Finished\n");
-    printf("\n\nCheck out these files: db_patient.txt,db_exam.txt and db_report.txt!!!\n");
+    if (branch >= 0) {
+        printf("\n\nCheck out these files: db_patient_%d.txt,db_exam_%d.txt and db_report_%d.txt!!!\n", branch, branch, branch);
+    } else {
+        printf("\n\nCheck out these files: db_patient.txt,db_exam.txt and db_report.txt!!!\n");
+    }
     return 0;
 }
 
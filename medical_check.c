@@ -4,7 +4,9 @@
 #include <string.h>
 #include "queue.h"
 #include "rx_machine.h"
-#define MAX_EXECUTION 43.200
+#include "logger.h"
+#include "rng.h"
+#include "sim_config.h"
 #define MAX_CONDITION_SIZE 100
 
 struct report {
@@ -23,8 +25,13 @@ struct examPriority{
         V_queue *priority_4;
         V_queue *priority_3;
         V_queue *priority_2;
-        V_queue *priority_1;
-
+        V_queue *priority_1;
+
+        int total_capacity;                  // Exams waiting in all levels before the policy applies, 0 for none // Exames em todos os nveis antes da poltica ser aplicada
+        int policy;                          // OverflowPolicy
+        V_queue *overflow[6];                // OVERFLOW_DIVERT: exams parked per level (index 0 = priority 1) // Exames estacionados por nvel
+        AdmissionStats admission[6];         // Counters per level (index 0 = priority 1) // Contadores por nvel
+
 };
 
 ExamPriorityQueue *new_priority_queue(){
@@ -52,8 +59,15 @@ ExamPriorityQueue *new_priority_queue(){
     new_queue->priority_4 = create_queue();
     new_queue->priority_3 = create_queue();
     new_queue->priority_2 = create_queue();
-    new_queue->priority_1 = create_queue();
-
+    new_queue->priority_1 = create_queue();
+
+    new_queue->total_capacity = 0;
+    new_queue->policy = OVERFLOW_BLOCK;
+    for (int i = 0; i < 6; i++) {
+        new_queue->overflow[i] = create_queue();
+    }
+    memset(new_queue->admission, 0, sizeof(new_queue->admission));
+
     return new_queue;
 }
 
@@ -73,11 +87,14 @@ void free_priority_queue(ExamPriorityQueue *any){
     E_free_queue(any->priority_4);
     E_free_queue(any->priority_3);
     E_free_queue(any->priority_2);
-    E_free_queue(any->priority_1);
-
+    E_free_queue(any->priority_1);
+    for (int i = 0; i < 6; i++) {
+        E_free_queue(any->overflow[i]);
+    }
+
     free(any);
 
-    printf("\nPriority Queue Destroyed.");
+    LOG_DEBUG(LOG_CAT_MEMORY, "\nPriority Queue Destroyed.");
 
 }
 
@@ -98,30 +115,30 @@ void insert_in_priority_queue(ExamPriorityQueue *any, Exam *exam){
      switch(ia_diagnostic_priority){
     case 6 :
         enqueue(any->priority_6,exam);
-        printf("\nExam inserted on priority 6(Urgent) queue\n");
+        LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 6(Urgent) queue");
         break;
     case 5:
         enqueue(any->priority_5,exam);
-        printf("\nExam inserted on priority 5(High) queue\n");
+        LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 5(High) queue");
         break;
     case 4:
         enqueue(any->priority_4,exam);
-       printf("\nExam inserted on priority 4(Medium) queue\n");
+       LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 4(Medium) queue");
         break;
     case 3:
         enqueue(any->priority_3,exam);
-        printf("\nExam inserted on priority 3(Medium) queue\n");
+        LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 3(Medium) queue");
         break;
     case 2:
         enqueue(any->priority_2,exam);
-        printf("\nExam inserted on priority 2(Low) queue\n");
+        LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 2(Low) queue");
         break;
     case 1:
         enqueue(any->priority_1,exam);
-        printf("\nExam inserted on priority 1(Low) queue\n");
+        LOG_INFO(LOG_CAT_QUEUE, "\nExam inserted on priority 1(Low) queue");
         break;
     default:
-        printf("\nError Inserting Exam on priority queue\n");
+        LOG_ERROR(LOG_CAT_QUEUE, "\nError Inserting Exam on priority queue");
 
         break;
      }
@@ -155,6 +172,191 @@ int is_priority_queue_empty(ExamPriorityQueue *new_queue){
 
 }
 
+static V_queue *level_queue(ExamPriorityQueue *any, int level) {
+// FIFO of one priority level, NULL if the level is invalid // FIFO de um nvel de prioridade, NULL se o nvel for invlido
+    switch (level) {
+    case 6: return any->priority_6;
+    case 5: return any->priority_5;
+    case 4: return any->priority_4;
+    case 3: return any->priority_3;
+    case 2: return any->priority_2;
+    case 1: return any->priority_1;
+    default: return NULL;
+    }
+}
+
+int is_priority_queue_full(ExamPriorityQueue *any) {
+/**
+ * \brief Check if the exams waiting in all levels reached the total capacity // Verifica se os exames esperando em todos os nveis atingiram a capacidade total
+ *
+ * \return int - 1 if bounded and full, 0 otherwise // 1 se limitada e cheia, 0 caso contrrio
+ */
+    return any->total_capacity > 0 && priority_queue_waiting(any) >= any->total_capacity;
+}
+
+static void refill_from_overflow(ExamPriorityQueue *any) {
+// Moves diverted exams back, most urgent first, while there is room // Move exames desviados de volta, os mais urgentes primeiro, enquanto houver espao
+    for (int level = 6; level >= 1 && !is_priority_queue_full(any); level--) {
+        V_queue *queue = level_queue(any, level);
+        while (!is_queue_empty(any->overflow[level - 1]) && !is_queue_full(queue) && !is_priority_queue_full(any)) {
+            enqueue(queue, queue_pop_front(any->overflow[level - 1]));
+        }
+    }
+}
+
+void set_priority_queue_limits(ExamPriorityQueue *any, int level_capacity, int total_capacity, int policy, int overflow_capacity) {
+/**
+ * \brief Bound the priority queue and choose what happens to exams that don't fit // Limita a fila de prioridade e escolhe o que acontece com exames que no cabem
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param level_capacity - Exams per priority level, 0 for unbounded // Exames por nvel de prioridade, 0 para ilimitado
+ * \param total_capacity - Exams in all levels together, 0 for unbounded // Exames em todos os nveis juntos, 0 para ilimitado
+ * \param policy - OverflowPolicy used by offer_priority_exam() // OverflowPolicy usada por offer_priority_exam()
+ * \param overflow_capacity - OVERFLOW_DIVERT: exams parked per level, 0 for unbounded // Exames estacionados por nvel, 0 para ilimitado
+ */
+    for (int level = 1; level <= 6; level++) {
+        set_queue_capacity(level_queue(any, level), level_capacity);
+        set_queue_capacity(any->overflow[level - 1], overflow_capacity);
+    }
+    any->total_capacity = total_capacity > 0 ? total_capacity : 0;
+    any->policy = policy;
+}
+
+AdmissionResult offer_priority_exam(ExamPriorityQueue *any, Exam *exam, Exam **dropped) {
+/**
+ * \brief Insert an exam if its level and the whole queue have room, otherwise apply the overflow policy // Insere um exame se houver espao, seno aplica a poltica de estouro
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param exam - Exam to insert // Exame a inserir
+ * \param dropped - Receives the exam evicted by OVERFLOW_DROP_LOWEST (the caller frees it), NULL otherwise // Recebe o exame descartado (quem chama o libera)
+ *
+ * \details OVERFLOW_DROP_LOWEST only helps when the total capacity is the limit: the newest exam of the lowest non-empty
+ *          level below the newcomer's is evicted. A full level, or no lower exam to evict, rejects the newcomer.
+ * \details OVERFLOW_DROP_LOWEST s ajuda quando o limite  a capacidade total: o exame mais novo do nvel no vazio mais
+ *          baixo abaixo do recm-chegado  descartado. Um nvel cheio, ou nenhum exame inferior, recusa o recm-chegado.
+ *
+ * \return AdmissionResult - ADMIT_WAIT asks the caller to wait for a doctor and offer again // ADMIT_WAIT pede para esperar um mdico e oferecer de novo
+ */
+    if (dropped) {
+        *dropped = NULL;
+    }
+    int level = get_ai_priority(exam);
+    V_queue *queue = level_queue(any, level);
+    if (!queue) {
+        LOG_ERROR(LOG_CAT_QUEUE, "\nError Inserting Exam on priority queue");
+        return ADMIT_REJECTED;
+    }
+    AdmissionStats *stats = &any->admission[level - 1];
+
+    int total_full = is_priority_queue_full(any);
+    if (!total_full && !is_queue_full(queue)) {
+        insert_in_priority_queue(any, exam);
+        stats->admitted++;
+        return ADMIT_ACCEPTED;
+    }
+
+    switch (any->policy) {
+    case OVERFLOW_BLOCK:
+        stats->waits++;
+        return ADMIT_WAIT;
+    case OVERFLOW_DIVERT:
+        if (!is_queue_full(any->overflow[level - 1])) {
+            enqueue(any->overflow[level - 1], exam);
+            stats->diverted++;
+            LOG_INFO(LOG_CAT_QUEUE, "\nPriority queue full: exam diverted to the overflow queue");
+            return ADMIT_DIVERTED;
+        }
+        break;
+    case OVERFLOW_DROP_LOWEST:
+        if (total_full && !is_queue_full(queue)) {
+            for (int lower = 1; lower < level; lower++) {
+                Exam *victim = (Exam*)queue_pop_back(level_queue(any, lower));
+                if (victim) {
+                    any->admission[lower - 1].dropped++;
+                    insert_in_priority_queue(any, exam);
+                    stats->admitted++;
+                    LOG_INFO(LOG_CAT_QUEUE, "\nPriority queue full: dropped a priority %d exam", lower);
+                    if (dropped) {
+                        *dropped = victim;
+                    } else {
+                        destroy_exam(victim);
+                    }
+                    return ADMIT_ACCEPTED;
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    stats->rejected++;
+    LOG_INFO(LOG_CAT_QUEUE, "\nPriority queue full: exam rejected");
+    return ADMIT_REJECTED;
+}
+
+void get_priority_admission_stats(ExamPriorityQueue *any, int level, AdmissionStats *stats) {
+/**
+ * \brief Copy the admission counters of one level, or of all of them // Copia os contadores de admisso de um nvel, ou de todos
+ *
+ * \param level - Priority level (1-6), 0 for the sum of all levels // Nvel de prioridade (1-6), 0 para a soma de todos
+ */
+    memset(stats, 0, sizeof(AdmissionStats));
+    for (int i = 1; i <= 6; i++) {
+        if (level == 0 || level == i) {
+            admission_stats_add(stats, &any->admission[i - 1]);
+        }
+    }
+}
+
+int priority_queue_overflow_size(ExamPriorityQueue *any) {
+/**
+ * \brief Count the exams parked in the overflow queues // Conta os exames estacionados nas filas de estouro
+ */
+    int parked = 0;
+    for (int i = 0; i < 6; i++) {
+        parked += queue_size(any->overflow[i]);
+    }
+    return parked;
+}
+
+void priority_queue_visit(ExamPriorityQueue *any, int parked, QueueVisitor visit, void *context) {
+/**
+ * \brief Visit the waiting or the parked exams, priority 6 first // Visita os exames esperando ou estacionados, prioridade 6 primeiro
+ */
+    for (int level = 6; level >= 1; level--) {
+        queue_visit(parked ? any->overflow[level - 1] : level_queue(any, level), visit, context);
+    }
+}
+
+void restore_priority_exam(ExamPriorityQueue *any, Exam *exam, int parked) {
+/**
+ * \brief Put back an exam saved by a checkpoint // Devolve um exame salvo por um checkpoint
+ *
+ * \details The saved order is kept: levels are FIFOs and the exams come back in the order they were visited.
+ * \details A ordem salva  mantida: os nveis so FIFOs e os exames voltam na ordem em que foram visitados.
+ */
+    int level = get_ai_priority(exam);
+    if (level < 1 || level > 6) {
+        destroy_exam(exam);
+        return;
+    }
+    if (parked) {
+        enqueue(any->overflow[level - 1], exam);
+    } else {
+        insert_in_priority_queue(any, exam);
+    }
+}
+
+void set_priority_admission_stats(ExamPriorityQueue *any, int level, const AdmissionStats *stats) {
+/**
+ * \brief Replace the admission counters of one level // Substitui os contadores de admisso de um nvel
+ */
+    if (level >= 1 && level <= 6) {
+        any->admission[level - 1] = *stats;
+    }
+}
+
 Exam *get_priority_exams(ExamPriorityQueue *any) {
 /**
  * \brief Retrieve the highest priority exam from the priority queue // Recupera o exame de maior prioridade da fila de prioridade
@@ -168,29 +370,34 @@ Exam *get_priority_exams(ExamPriorityQueue *any) {
  *
  * \return Exam* - Pointer to the exam retrieved from the highest priority queue, or NULL if all queues are empty // Ponteiro para o exame recuperado da fila de maior prioridade, ou NULL se todas as filas estiverem vazias
  */
+    Exam *exam = NULL;
+
     // Verifique a fila de maior prioridade primeiro
     if (is_queue_empty(any->priority_6) == 0) { // A fila no est vazia
 
-        return E_dequeue(any->priority_6);
+        exam = E_dequeue(any->priority_6);
     } else if (is_queue_empty(any->priority_5) == 0) {
 
-        return E_dequeue(any->priority_5);
+        exam = E_dequeue(any->priority_5);
     } else if (is_queue_empty(any->priority_4) == 0) {
 
-        return E_dequeue(any->priority_4);
+        exam = E_dequeue(any->priority_4);
     } else if (is_queue_empty(any->priority_3) == 0) {
 
-        return E_dequeue(any->priority_3);
+        exam = E_dequeue(any->priority_3);
     } else if (is_queue_empty(any->priority_2) == 0) {
 
-        return E_dequeue(any->priority_2);
+        exam = E_dequeue(any->priority_2);
     } else if (is_queue_empty(any->priority_1) == 0) {
 
-        return E_dequeue(any->priority_1);
+        exam = E_dequeue(any->priority_1);
     } else {
-        printf("\nThere is no Exam waiting for Doctor");
-        return NULL;
-    }
+        LOG_DEBUG(LOG_CAT_QUEUE, "\nThere is no Exam waiting for Doctor");
+        return NULL;
+    }
+
+    refill_from_overflow(any); // A diverted exam takes the freed place // Um exame desviado ocupa o lugar liberado
+    return exam;
 }
 
 
@@ -217,6 +424,30 @@ int priority_queue_waiting(ExamPriorityQueue *queue) {
 
     return waiting;
 }
+
+int priority_queue_level_size(ExamPriorityQueue *queue, int level) {
+/**
+ * \brief Get the number of exams waiting in one priority level // Obtem o numero de exames esperando em um nivel de prioridade
+ *
+ * \param queue - Pointer to the ExamPriorityQueue structure to be checked // Ponteiro para a estrutura ExamPriorityQueue a ser verificada
+ * \param level - Priority level from 1 (lowest) to 6 (highest) // Nivel de prioridade de 1 (mais baixo) a 6 (mais alto)
+ *
+ * \return int - Number of exams waiting in that level, or 0 if the level is invalid // Numero de exames esperando nesse nivel, ou 0 se o nivel for invalido
+ */
+    if (!queue) {
+        return 0;
+    }
+
+    switch (level) {
+    case 6: return queue_size(queue->priority_6);
+    case 5: return queue_size(queue->priority_5);
+    case 4: return queue_size(queue->priority_4);
+    case 3: return queue_size(queue->priority_3);
+    case 2: return queue_size(queue->priority_2);
+    case 1: return queue_size(queue->priority_1);
+    default: return 0;
+    }
+}
 
 
 int get_ai_priority(Exam *exam) {
@@ -240,13 +471,13 @@ int get_ai_priority(Exam *exam) {
  * \return int - Priority assigned to the exam based on its condition // Prioridade atribuda ao exame com base em sua condio
  */
     if (!exam) {
-        printf("\nNull Pointer to Exam!");
+        LOG_ERROR(LOG_CAT_EXAM, "\nNull Pointer to Exam!");
         return -1; // Retorna um valor de erro se o exame for NULL
     }
 
     char *condition = get_exam_condition(exam);
     if (!condition) {
-        printf("\nError  getting AI Condition\n");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError  getting AI Condition");
         return -1; // Retorna um valor de erro se a condio do exame for NULL
     }
 
@@ -299,7 +530,7 @@ int get_report_priority_condition(Report *report){
 
     char *condition = get_report_condition(report);
     if (!condition) {
-        printf("\nError  getting Report Condition\n");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError  getting Report Condition");
         return -1; // Retorna um valor de erro se a condio do exame for NULL
     }
 
@@ -344,7 +575,7 @@ int get_report_id(Report *report){
  * \return int - ID of the report // ID do relatrio
  */
     if(!report){
-        printf("\nError:: report pointer cannot be NULL");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError:: report pointer cannot be NULL");
         return  -999;
 
     }
@@ -368,7 +599,7 @@ int get_report_exam_id(Report *report){
  * \return int - Exam ID associated with the report // ID do exame associado ao relatrio
  */
     if(!report){
-        printf("\nError:: report pointer cannot be NULL");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError:: report pointer cannot be NULL");
         return -999;
 
 
@@ -392,7 +623,7 @@ char *get_report_condition(Report *report){
  * \return char* - Condition string of the report // String de condio do relatrio
  */
     if(!report){
-        printf("\nError:: report pointer cannot be NULL");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError:: report pointer cannot be NULL");
         return NULL;
 
 
@@ -414,7 +645,7 @@ struct tm *get_report_time(const Report *report) {
  * \return const struct tm* - Time associated with the report // Horrio associado ao relatrio
  */
     if (!report) {
-        printf("\nError: report pointer cannot be NULL");
+        LOG_ERROR(LOG_CAT_REPORT, "\nError: report pointer cannot be NULL");
         return NULL;
     }
 
@@ -429,10 +660,10 @@ Report *do_medical_report(Exam *exam) {
  * \param exam - Pointer to the Exam structure for which the medical report is to be generated // Ponteiro para a estrutura Exam para a qual o relatrio mdico ser gerado
  *
  * \details This function generates a medical report based on the provided exam. It decides whether to keep the original diagnostic or update it with a new one based on a random chance.
- *          The decision is made with an 80% chance to maintain the original diagnostic and a 20% chance to generate a new one.
+ *          The original diagnostic is kept with the ai_keep_percent chance of the clinic configuration (80% by default), otherwise a new one is generated.
  *          The report's timestamp is set to the current local time.
  * \details Esta funo gera um relatrio mdico com base no exame fornecido. Ela decide se mantm o diagnstico original ou o atualiza com um novo, com base em uma chance aleatria.
- *          A deciso  feita com uma chance de 80% de manter o diagnstico original e 20% de gerar um novo.
+ *          O diagnstico original  mantido com a chance ai_keep_percent da configurao (80% por padro), seno um novo  gerado.
  *          O horrio do relatrio  definido como o horrio local atual.
  *
  * \warning If the diagnostic or new diagnostic pointer is NULL, an error message is printed and NULL is returned. // Se o ponteiro do diagnstico ou o novo diagnstico for NULL, uma mensagem de erro  impressa e NULL  retornado.
@@ -442,21 +673,22 @@ Report *do_medical_report(Exam *exam) {
  */
     time_t tempoAtual;
     time(&tempoAtual);
-    struct tm *tempoLocal = localtime(&tempoAtual);
+    struct tm tempoLocal;
+    localtime_r(&tempoAtual, &tempoLocal); // localtime_r: several clinics write reports at once // Reentrante
 
-    int geradorP = rand() % 100 + 1;
+    int geradorP = rng_below(100) + 1;
     Report *new_report = NULL;
 
-    if (geradorP <= 80 ) {
-        new_report = create_report(get_exam_id(exam), get_exam_condition(exam), tempoLocal);
-        printf("\nIA Decision Maintained\n");
+    if (geradorP <= sim_config()->ai_keep_percent) {
+        new_report = create_report(get_exam_id(exam), get_exam_condition(exam), &tempoLocal);
+        LOG_INFO(LOG_CAT_REPORT, "\nIA Decision Maintained");
     } else {
         char *diagnostic = get_exam_condition(exam);
         char *new_diagnostic = diagnostic_by_ai();
 
         // Verificao de ponteiros NULL
         if (diagnostic == NULL || new_diagnostic == NULL) {
-            fprintf(stderr, "Error: Diagnostic or New Diagnostic is NULL.\n");
+            LOG_ERROR(LOG_CAT_REPORT, "Error: Diagnostic or New Diagnostic is NULL.");
             return NULL;
         }else{
 
@@ -467,13 +699,12 @@ Report *do_medical_report(Exam *exam) {
         }
 
         if (attempts >= 10) {
-            printf("\nWarning: Wasn't possible to create a new diagnostic...\n");
+            LOG_WARN(LOG_CAT_REPORT, "\nWarning: Wasn't possible to create a new diagnostic...");
         }
 
-        printf("\nOld diagnostic for patient: %s\n", diagnostic);
-        printf("\nNew diagnostic for patient: %s\n", new_diagnostic);
+        LOG_INFO(LOG_CAT_REPORT, "\nOld diagnostic for patient: %s\n\nNew diagnostic for patient: %s", diagnostic, new_diagnostic);
 
-        new_report = create_report(get_exam_id(exam), new_diagnostic, tempoLocal);
+        new_report = create_report(get_exam_id(exam), new_diagnostic, &tempoLocal);
     }
     }
 
@@ -505,7 +736,7 @@ Report *create_report(int exam_id, const char *condition, const struct tm *repor
             printf("\nError : Memory Allocation Failed (Create_report)\n");
             exit(1);
         }
-        new_report->id = rand()%1000+1;
+        new_report->id = rng_below(1000)+1;
         new_report->exam_id = exam_id;
         new_report->report_time = (struct tm*)malloc(sizeof(struct tm));
         if(!new_report->report_time){
@@ -558,20 +789,25 @@ void print_report(Report *report) {
  * \warning If the report pointer is NULL, a message indicating that the pointer is NULL is printed. // Se o ponteiro do relatrio for NULL, uma mensagem indicando que o ponteiro  NULL  impressa.
  */
     if (report) {
-        printf("\n\t===============================\n");
-        printf("\t    DOCTOR'S REPORT DETAILS\n");
-        printf("\t===============================\n");
-        printf("\tReport ID      : %d\n", get_report_id(report));
-        printf("\tExam ID        : %d\n", get_report_exam_id(report));
-        printf("\tCondition      : %s\n", get_report_condition(report));
-
+        if (!log_enabled(LOG_LEVEL_INFO, LOG_CAT_REPORT)) {
+            return;
+        }
         char buffer[100];
         strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", get_report_time(report));
-        printf("\tReport Time    : %s\n", buffer);
 
-        printf("\t=============================\n");
+        // The whole banner is one log record // O banner inteiro e um unico registro
+        LOG_INFO(LOG_CAT_REPORT,
+                 "\n\t===============================\n"
+                 "\t    DOCTOR'S REPORT DETAILS\n"
+                 "\t===============================\n"
+                 "\tReport ID      : %d\n"
+                 "\tExam ID        : %d\n"
+                 "\tCondition      : %s\n"
+                 "\tReport Time    : %s\n"
+                 "\t=============================\n",
+                 get_report_id(report), get_report_exam_id(report), get_report_condition(report), buffer);
     } else {
-        printf("Report pointer is NULL.\n");
+        LOG_ERROR(LOG_CAT_REPORT, "Report pointer is NULL.");
     }
 }
 
@@ -590,55 +826,70 @@ void print_report_db(Report *report,FILE *report_file){
  *
  * \warning If the report pointer or file pointer is NULL, or if there is an error writing to the file, an error message is printed and the program exits. // Se o ponteiro do relatrio ou o ponteiro do arquivo for NULL, ou se houver um erro ao gravar no arquivo, uma mensagem de erro  impressa e o programa  encerrado.
  */
-if(report){
-    fprintf(report_file, "ID: %d\n", get_report_id(report));
-    fprintf(report_file, "Exam ID: %d\n", get_report_exam_id(report));
-    fprintf(report_file, "Condition: %s\n", get_report_condition(report));
-
-    const struct tm *report_time = get_report_time(report);
-    if (report_time) {
-        fprintf(report_file, "Report Time: %d-%02d-%02d %02d:%02d:%02d\n",
-                report_time->tm_year + 1900,
-                report_time->tm_mon + 1,
-                report_time->tm_mday,
-                report_time->tm_hour,
-                report_time->tm_min,
-                report_time->tm_sec);
-    } else {
-        printf("\nReport time is NULL\n");
-    }
+char record[REPORT_DB_RECORD];
+int length = format_report_db(report, record, sizeof(record));
+if(length >= 0){
+    fwrite(record, 1, length, report_file); // One call: records written by different threads never mix
 
 }else{
     printf("\nError  Saving Report on DB(new_patient)\n");
     exit(1);
 }
 
-}
+}
+
+int format_report_db(Report *report, char *buffer, int size){
+/**
+ * \brief Format the db record of a report // Formata o registro db de um laudo
+ *
+ * \param report - Pointer to the Report structure // Ponteiro para a estrutura Report
+ * \param buffer - Receives the record, the same lines print_report_db() writes // Recebe o registro, as mesmas linhas que print_report_db() grava
+ * \param size - Bytes of the buffer // Bytes do buffer
+ * \return Length of the record, -1 if the report is NULL or the record doesn't fit // Tamanho do registro, -1 se o laudo for NULL ou o registro no couber
+ */
+    if (!report) {
+        return -1;
+    }
+    int length = snprintf(buffer, size, "ID: %d\nExam ID: %d\nCondition: %s\n",
+                          get_report_id(report), get_report_exam_id(report), get_report_condition(report));
+    const struct tm *report_time = get_report_time(report);
+    if (!report_time) {
+        LOG_ERROR(LOG_CAT_REPORT, "\nReport time is NULL");
+    } else if (length < size) {
+        length += snprintf(buffer + length, size - length, "Report Time: %d-%02d-%02d %02d:%02d:%02d\n",
+                           report_time->tm_year + 1900,
+                           report_time->tm_mon + 1,
+                           report_time->tm_mday,
+                           report_time->tm_hour,
+                           report_time->tm_min,
+                           report_time->tm_sec);
+    }
+    return length < size ? length : -1;
+}
+
 
-void print_status(double tempo_total, double time_reports, int pacientes_totais,
+void print_status(double tempo_total, int pacientes_totais,
                  int waiting, int reports_finalizados,
                  int reports_tempo_ok, int ia_exames_realizados,
-                 double *priority_time_sum, int *priority_count) {
+                 const ReportStream *reports) {
 
 /**
  * \brief Print a status report with various metrics // Imprime um relatrio de status com vrias mtricas
  *
  * \param tempo_total - Total execution time of the program in seconds // Tempo total de execuo do programa em segundos
- * \param time_reports - Total time spent generating reports in seconds // Tempo total gasto na gerao de relatrios em segundos
  * \param pacientes_totais - Total number of patients arrived // Nmero total de pacientes que chegaram
  * \param waiting - Number of patients currently in the priority queue // Nmero de pacientes atualmente na fila de prioridade
  * \param reports_finalizados - Number of reports finalized // Nmero de relatrios finalizados
- * \param reports_tempo_ok - Number of reports completed within the acceptable time (> 7,200 seconds) // Nmero de relatrios concludos dentro do tempo aceitvel (> 7.200 segundos)
+ * \param reports_tempo_ok - Number of reports over the report_limit of the clinic configuration (7.200 seconds by default) // Nmero de laudos acima do report_limit da configurao (7.200 segundos por padro)
  * \param ia_exames_realizados - Number of IA exams performed // Nmero de exames de IA realizados
- * \param priority_time_sum - Array of cumulative report times for each priority level // Array com os tempos acumulados de relatrio para cada nvel de prioridade
- * \param priority_count - Array of counts of reports for each priority level // Array com a contagem de relatrios para cada nvel de prioridade
+ * \param reports - Report durations, all time and over the last window // Duraes dos laudos, de sempre e da ltima janela
  *
  * \details This function prints a status report summarizing various metrics related to the execution of the program, including total execution time, patient data, report metrics, and priority-based report times.
- *          The average report time for each priority level is calculated and displayed if there are reports for that priority.
+ *          Each priority level shows the mean and standard deviation of its report times, their range, the EWMA and the mean of the last window.
  * \details Esta funo imprime um relatrio de status resumindo vrias mtricas relacionadas  execuo do programa, incluindo tempo total de execuo, dados dos pacientes, mtricas de relatrios e tempos de relatrio baseados em prioridade.
- *          O tempo mdio de relatrio para cada nvel de prioridade  calculado e exibido se houver relatrios para essa prioridade.
+ *          Cada nvel de prioridade mostra a mdia e o desvio padro dos tempos de laudo, a faixa, a EWMA e a mdia da ltima janela.
  *
- * \warning Ensure that `priority_time_sum` and `priority_count` arrays are properly initialized and have at least 6 elements. // Certifique-se de que os arrays `priority_time_sum` e `priority_count` esto devidamente inicializados e tm pelo menos 6 elementos.
+ * \warning A run without exams or reports prints 0 instead of dividing by zero. // Uma execuo sem exames ou laudos imprime 0 em vez de dividir por zero.
  */
 
     printf("\n========== Status Report ==========\n");
@@ -646,15 +897,19 @@ void print_status(double tempo_total, double time_reports, int pacientes_totais,
     printf("Total Patients Arrived:        %d\n", pacientes_totais);
     printf("Patients in Priority Queue:    %d\n", waiting);
     printf("IA Exams Performed:            %d\n", ia_exames_realizados);
-    printf("Patients with Doctor's report: %d%%\n", reports_finalizados * 100 / ia_exames_realizados);
-    printf("Mean Report Time:              %.2lf seconds\n", time_reports / reports_finalizados);
+    printf("Patients with Doctor's report: %d%%\n", ia_exames_realizados > 0 ? reports_finalizados * 100 / ia_exames_realizados : 0);
+    printf("Mean Report Time:              %.2lf seconds (std dev %.2lf)\n", reports->all.mean, stream_stats_stddev(&reports->all));
     printf("Reports Finalized:             %d\n", reports_finalizados);
-    printf("Reports out of time (delayed) (>7.200): %d\n", reports_tempo_ok);
+    printf("Reports out of time (delayed) (>%.3lf): %d\n", sim_config()->report_limit, reports_tempo_ok);
 
     printf("\nPriority Report Times:\n");
     for (int i = 0; i < 6; i++) {
-        if (priority_count[i] > 0) {
-            printf("Mean Report Time for priority %d, appereances(%d): %.2lf seconds\n", i + 1, priority_count[i],priority_time_sum[i] / priority_count[i]);
+        const StreamStats *stats = &reports->priority[i];
+        if (stats->count > 0) {
+            printf("Mean Report Time for priority %d, appereances(%ld): %.2lf seconds\n", i + 1, stats->count, stats->mean);
+            printf("    std dev %.2lf, min %.2lf, max %.2lf, EWMA %.2lf, last %.0lf s: %.2lf seconds (%ld)\n",
+                   stream_stats_stddev(stats), stats->min, stats->max, stats->ewma, reports->priority_window[i].seconds,
+                   sliding_window_mean(&reports->priority_window[i]), reports->priority_window[i].total_count);
         } else {
             printf("Priority %d: No reports\n", i + 1);
         }
@@ -1,8 +1,13 @@
 #ifndef MEDICAL_CHECK_INCLUDED
 #define MEDICAL_CHECK_INCLUDED
-#include "exam.h"
+#include "exam.h"
+#include "admission.h"
+#include "queue.h"
+#include "stream_stats.h"
 #include <pthread.h>
 
+#define REPORT_DB_RECORD 256  // Bytes of a report db record // Bytes de um registro db de laudo
+
 
 
 typedef struct examPriority  ExamPriorityQueue;
@@ -127,6 +132,16 @@ Report *do_medical_report(Exam *exam);
  */
 void print_report_db(Report *report, FILE *report_file);
 
+/**
+ * \brief Format the db record of a report, the lines print_report_db() writes // Formata o registro db de um laudo
+ *
+ * \param report - Pointer to the report // Ponteiro para o laudo
+ * \param buffer - Receives the record // Recebe o registro
+ * \param size - Bytes of the buffer, REPORT_DB_RECORD is always enough // Bytes do buffer, REPORT_DB_RECORD sempre basta
+ * \return Length of the record, -1 if the report is NULL or the record doesn't fit // Tamanho do registro, -1 se o laudo for NULL ou não couber
+ */
+int format_report_db(Report *report, char *buffer, int size);
+
 /**
  * \brief Get the total number of reports waiting in the priority queue // Obtém o número total de relatórios esperando na fila de prioridade
  *
@@ -135,6 +150,91 @@ void print_report_db(Report *report, FILE *report_file);
  */
 int priority_queue_waiting(ExamPriorityQueue *queue);
 
+/**
+ * \brief Get the number of exams waiting in one priority level // Obtém o número de exames esperando em um nível de prioridade
+ *
+ * \param queue - Pointer to the priority queue to check // Ponteiro para a fila de prioridade a ser verificada
+ * \param level - Priority level (1-6) // Nível de prioridade (1-6)
+ * \return Number of exams waiting in that level, or 0 if the level is invalid // Número de exames esperando nesse nível, ou 0 se o nível for inválido
+ */
+int priority_queue_level_size(ExamPriorityQueue *queue, int level);
+
+/**
+ * \brief Bound the priority queue and choose the overflow policy // Limita a fila de prioridade e escolhe a política de estouro
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param level_capacity - Exams per priority level, 0 for unbounded // Exames por nível de prioridade, 0 para ilimitado
+ * \param total_capacity - Exams in all levels together, 0 for unbounded // Exames em todos os níveis juntos, 0 para ilimitado
+ * \param policy - OverflowPolicy applied by offer_priority_exam() // OverflowPolicy aplicada por offer_priority_exam()
+ * \param overflow_capacity - OVERFLOW_DIVERT: exams parked per level, 0 for unbounded // Exames estacionados por nível, 0 para ilimitado
+ */
+void set_priority_queue_limits(ExamPriorityQueue *any, int level_capacity, int total_capacity, int policy, int overflow_capacity);
+
+/**
+ * \brief Insert an exam within the limits, applying the overflow policy when it doesn't fit // Insere um exame dentro dos limites, aplicando a política de estouro quando não couber
+ *
+ * \details insert_in_priority_queue() keeps inserting without limits.
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param exam - Exam to insert // Exame a inserir
+ * \param dropped - Receives the exam evicted by OVERFLOW_DROP_LOWEST, which the caller frees; may be NULL // Recebe o exame descartado, liberado por quem chama; pode ser NULL
+ * \return ADMIT_ACCEPTED, ADMIT_DIVERTED, ADMIT_REJECTED (the caller keeps the exam) or ADMIT_WAIT (offer again after a doctor took an exam)
+ */
+AdmissionResult offer_priority_exam(ExamPriorityQueue *any, Exam *exam, Exam **dropped);
+
+/**
+ * \brief Check if the exams waiting in all levels reached the total capacity // Verifica se os exames esperando atingiram a capacidade total
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \return 1 if bounded and full, 0 otherwise // 1 se limitada e cheia, 0 caso contrário
+ */
+int is_priority_queue_full(ExamPriorityQueue *any);
+
+/**
+ * \brief Copy the admission counters // Copia os contadores de admissão
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param level - Priority level (1-6), 0 for the sum of all levels // Nível de prioridade (1-6), 0 para a soma de todos
+ * \param stats - Receives the counters // Recebe os contadores
+ */
+void get_priority_admission_stats(ExamPriorityQueue *any, int level, AdmissionStats *stats);
+
+/**
+ * \brief Number of exams parked in the overflow queues // Número de exames estacionados nas filas de estouro
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \return Exams diverted and not yet moved back // Exames desviados ainda não devolvidos
+ */
+int priority_queue_overflow_size(ExamPriorityQueue *any);
+
+/**
+ * \brief Visit the exams waiting in the levels or parked in the overflow queues, without removing them
+ *        // Visita os exames esperando nos níveis ou estacionados nas filas de estouro, sem removê-los
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param parked - 0 for the priority levels, 1 for the overflow queues // 0 para os níveis, 1 para as filas de estouro
+ * \param visit - Called with each Exam*, priority 6 first and oldest first inside a level // Chamada com cada Exam*, prioridade 6 primeiro
+ * \param context - Passed to `visit` // Passado para `visit`
+ */
+void priority_queue_visit(ExamPriorityQueue *any, int parked, QueueVisitor visit, void *context);
+
+/**
+ * \brief Put back an exam saved by a checkpoint, bypassing the limits and the counters // Devolve um exame salvo por um checkpoint, ignorando limites e contadores
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param exam - Exam to put back // Exame a devolver
+ * \param parked - 1 to put it in the overflow queue of its level // 1 para colocá-lo na fila de estouro do seu nível
+ */
+void restore_priority_exam(ExamPriorityQueue *any, Exam *exam, int parked);
+
+/**
+ * \brief Replace the admission counters of one level, when restoring a checkpoint // Substitui os contadores de admissão de um nível, ao restaurar um checkpoint
+ *
+ * \param any - Pointer to the priority queue // Ponteiro para a fila de prioridade
+ * \param level - Priority level (1-6) // Nível de prioridade (1-6)
+ * \param stats - Saved counters // Contadores salvos
+ */
+void set_priority_admission_stats(ExamPriorityQueue *any, int level, const AdmissionStats *stats);
+
 /**
  * \brief Get the AI-assigned priority for a report // Obtém a prioridade atribuída pela IA para um relatório
  *
@@ -147,17 +247,15 @@ int get_report_priority_condition(Report *report);
  * \brief Print a status report with various metrics // Imprime um relatório de status com várias métricas
  *
  * \param tempo_total - Total execution time of the program in seconds // Tempo total de execução do programa em segundos
- * \param time_reports - Total time spent generating reports in seconds // Tempo total gasto na geração de relatórios em segundos
  * \param pacientes_totais - Total number of patients arrived // Número total de pacientes que chegaram
  * \param waiting - Number of patients currently in the priority queue // Número de pacientes atualmente na fila de prioridade
  * \param reports_finalizados - Number of reports finalized // Número de relatórios finalizados
- * \param reports_tempo_ok - Number of reports completed within the acceptable time (> 7,200 seconds) // Número de relatórios concluídos dentro do tempo aceitável (> 7.200 segundos)
+ * \param reports_tempo_ok - Number of reports over the report_limit of the clinic configuration (7.200 seconds by default) // Número de laudos acima do report_limit da configuração (7.200 segundos por padrão)
  * \param ia_exames_realizados - Number of IA exams performed // Número de exames de IA realizados
- * \param priority_time_sum - Array of cumulative report times for each priority level // Array com os tempos acumulados de relatório para cada nível de prioridade
- * \param priority_count - Array of counts of reports for each priority level // Array com a contagem de relatórios para cada nível de prioridade
+ * \param reports - Report durations, all time and over the last window // Durações dos laudos, de sempre e da última janela
  */
-void print_status(double tempo_total, double time_reports, int pacientes_totais,
+void print_status(double tempo_total, int pacientes_totais,
                  int waiting, int reports_finalizados,
                  int reports_tempo_ok, int ia_exames_realizados,
-                 double *priority_time_sum, int *priority_count);
+                 const ReportStream *reports);
 #endif // MEDICAL_CHECK_INCLUDED
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include "db_log.h"
+
+/*
+ * Recovery of db shards // Recuperação das fatias db
+ *
+ * A run with --db-shards merges its shards into the db files at checkpoints and at the end. When it is killed
+ * before that, the records wait in db_*.txt.<n>.shard; this merges them into the db files in timestamp order,
+ * keeping every whole record, and deletes the shards.
+ */
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -d, --dir DIR        Directory with the db_*.txt files and their shards (default .)\n");
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option options[] = {
+        {"dir", required_argument, NULL, 'd'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char *file_names[3] = {"db_patient.txt", "db_exam.txt", "db_report.txt"};
+    const char *dir = ".";
+    int option;
+
+    while ((option = getopt_long(argc, argv, "d:h", options, NULL)) != -1) {
+        switch (option) {
+        case 'd': dir = optarg; break;
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < 3; i++) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, file_names[i]);
+        FILE *output = fopen(path, "a"); // After whatever the last merge wrote // Depois do que a última junção gravou
+        DbLogMerge merge = {0, 0, 0};
+        if (!output || db_log_recover(path, output, &merge) != 0) {
+            perror(path);
+            failed = 1;
+        } else {
+            printf("%s: %ld records from %d shards (%ld ended in a torn record)\n", path, merge.records, merge.shards, merge.torn);
+        }
+        if (output && fclose(output) != 0) {
+            failed = 1;
+        }
+    }
+    return failed;
+}
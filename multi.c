@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "clinic_network.h"
+#include "spsc_channel.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+
+/*
+ * Multi-clinic network // Rede de várias clínicas
+ *
+ * Runs several imaging sites as shards (clinic_network.c): each clinic owns its queues, machines, doctors and db
+ * files, runs on its own thread pinned to its own core, and talks to the next clinic only through SPSC channels,
+ * sending overflow patients and exams for remote reading. Every artificial delay is removed (set_time_scale(0));
+ * a tick admits --loads patients and lets each machine and each doctor handle one. Results are JSON: per clinic
+ * counters and transfers, and total reports/s; --sweep repeats the run with 1, 2, 4 ... clinics to show scaling.
+ */
+
+#define MULTI_DEFAULT_CLINICS 4
+#define MULTI_DEFAULT_PATIENTS 100000           // Per clinic // Por clínica
+#define MULTI_DEFAULT_LOADS "6,3"                // Repeated over the clinics: busy and quiet sites alternate // Repetido pelas clínicas: alternam movimentadas e calmas
+#define MULTI_DEFAULT_TRANSFER 32
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int parse_loads(const char *list, double *loads, int max) {
+// Comma separated arrivals per tick; returns how many were read, -1 if one is not positive // Chegadas por ciclo separadas por vírgula
+    int count = 0;
+    char *copy = strdup(list);
+    char *save = NULL;
+    for (char *item = strtok_r(copy, ",", &save); item && count < max; item = strtok_r(NULL, ",", &save)) {
+        loads[count] = atof(item);
+        if (loads[count] <= 0) {
+            free(copy);
+            return -1;
+        }
+        count++;
+    }
+    free(copy);
+    return count;
+}
+
+static int run_network(int clinics, const ClinicConfig *base, const double *loads, int load_count,
+                       int channel_capacity, const char *db_dir, int pin, int first) {
+// Runs one network and prints one JSON object // Executa uma rede e imprime um objeto JSON
+    ClinicConfig configs[CLINIC_MAX];
+    for (int i = 0; i < clinics; i++) {
+        configs[i] = *base;
+        configs[i].load = loads[i % load_count];
+    }
+    ClinicNetwork *network = create_clinic_network(clinics, configs, channel_capacity, db_dir);
+    if (!network) {
+        fprintf(stderr, "Error: could not set up the clinic network\n");
+        return -1;
+    }
+
+    double start = now_seconds();
+    int result = run_clinic_network(network, pin);
+    double elapsed = now_seconds() - start;
+    if (result != 0) {
+        fprintf(stderr, "Error: could not start every clinic\n");
+        destroy_clinic_network(network);
+        return -1;
+    }
+
+    long reports = 0;
+    long patients_sent = 0;
+    long exams_sent = 0;
+    for (int i = 0; i < clinics; i++) {
+        ClinicStats stats;
+        get_clinic_stats(network, i, &stats);
+        reports += stats.reports;
+        patients_sent += stats.patients_sent;
+        exams_sent += stats.exams_sent;
+    }
+    printf("%s    {\"clinics\": %d, \"pinned\": %d, \"seconds\": %.4f, \"reports\": %ld, \"reports_per_sec\": %.0f, "
+           "\"patients_transferred\": %ld, \"exams_read_remotely\": %ld,\n     \"sites\": [",
+           first ? "" : ",\n", clinics, pin, elapsed, reports, reports / (elapsed > 0 ? elapsed : 1), patients_sent, exams_sent);
+    for (int i = 0; i < clinics; i++) {
+        ClinicStats stats;
+        get_clinic_stats(network, i, &stats);
+        printf("%s\n       {\"clinic\": %d, \"core\": %d, \"load\": %.2f, \"arrivals\": %ld, \"patients_sent\": %ld, \"patients_received\": %ld, "
+               "\"exams\": %ld, \"exams_sent\": %ld, \"exams_received\": %ld, \"reports\": %ld, "
+               "\"peak_patients\": %d, \"peak_exams\": %d, \"ticks\": %ld, \"idle_ticks\": %ld, \"cpu_seconds\": %.4f}",
+               i ? "," : "", i, stats.core, configs[i].load, stats.arrivals, stats.patients_sent, stats.patients_received,
+               stats.exams, stats.exams_sent, stats.exams_received, stats.reports,
+               stats.peak_patients, stats.peak_exams, stats.ticks, stats.idle_ticks, stats.cpu_seconds);
+    }
+    printf("]}");
+    fflush(stdout);
+
+    destroy_clinic_network(network);
+    return 0;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -c, --clinics N      Clinics, each one a shard on its own core, 1 to %d (default %d)\n", CLINIC_MAX, MULTI_DEFAULT_CLINICS);
+    printf("  -p, --patients N     Patients arriving at each clinic (default %d)\n", MULTI_DEFAULT_PATIENTS);
+    printf("  -m, --machines N     RX machines per clinic (default 5)\n");
+    printf("  -d, --doctors N      Doctors per clinic (default 5)\n");
+    printf("  -l, --loads LIST     Arrivals per tick of each clinic, repeated over the clinics (default %s)\n", MULTI_DEFAULT_LOADS);
+    printf("  -o, --db-dir DIR     Write db_*_<clinic>.txt into DIR instead of /dev/null\n");
+    printf("      --patient-transfer N Waiting patients above which arrivals go to the next clinic, 0 never (default %d)\n", MULTI_DEFAULT_TRANSFER);
+    printf("      --exam-transfer N Waiting exams above which new exams are read by the next clinic, 0 never (default %d)\n", MULTI_DEFAULT_TRANSFER);
+    printf("      --channel-capacity N Slots of each SPSC channel (default %d)\n", SPSC_DEFAULT_CAPACITY);
+    printf("      --no-pin         Let the scheduler place the clinic threads\n");
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+    printf("  -s, --sweep          Run 1, 2, 4 ... N clinics with the same patients per clinic\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"clinics", required_argument, NULL, 'c'},
+        {"patients", required_argument, NULL, 'p'},
+        {"machines", required_argument, NULL, 'm'},
+        {"doctors", required_argument, NULL, 'd'},
+        {"loads", required_argument, NULL, 'l'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"patient-transfer", required_argument, NULL, 'P'},
+        {"exam-transfer", required_argument, NULL, 'E'},
+        {"channel-capacity", required_argument, NULL, 'C'},
+        {"no-pin", no_argument, NULL, 'N'},
+        {"sweep", no_argument, NULL, 's'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "c:p:m:d:l:o:sh";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    ClinicConfig base = {MULTI_DEFAULT_PATIENTS, 1.0, 5, 5, MULTI_DEFAULT_TRANSFER, MULTI_DEFAULT_TRANSFER};
+    const char *load_list = MULTI_DEFAULT_LOADS;
+    const char *db_dir = NULL;
+    int clinics = MULTI_DEFAULT_CLINICS;
+    int channel_capacity = SPSC_DEFAULT_CAPACITY;
+    int pin = 1;
+    int sweep = 0;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'c': clinics = atoi(optarg); break;
+        case 'p': base.patients = atol(optarg); break;
+        case 'm': base.machines = atoi(optarg); break;
+        case 'd': base.doctors = atoi(optarg); break;
+        case 'l': load_list = optarg; break;
+        case 'o': db_dir = optarg; break;
+        case 'P': base.patient_transfer = atoi(optarg); break;
+        case 'E': base.exam_transfer = atoi(optarg); break;
+        case 'C': channel_capacity = atoi(optarg); break;
+        case 'N': pin = 0; break;
+        case 's': sweep = 1; break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    double loads[CLINIC_MAX];
+    int load_count = parse_loads(load_list, loads, CLINIC_MAX);
+    if (clinics < 1 || clinics > CLINIC_MAX || base.patients < 1 || base.machines < 1 || base.doctors < 1 ||
+        load_count < 1 || base.patient_transfer < 0 || base.exam_transfer < 0 || channel_capacity < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    log_set_quiet(1);   // Console output would be the only thing measured otherwise
+    set_time_scale(0);  // No artificial delays: exams and reports cost only their CPU work
+    rng_seed((unsigned int)time(NULL));
+
+    printf("{\n  \"runs\": [\n");
+    if (sweep) {
+        int first = 1;
+        for (int count = 1; count <= clinics; count *= 2) {
+            if (run_network(count, &base, loads, load_count, channel_capacity, db_dir, pin, first) != 0) {
+                return 1;
+            }
+            first = 0;
+        }
+    } else if (run_network(clinics, &base, loads, load_count, channel_capacity, db_dir, pin, 1) != 0) {
+        return 1;
+    }
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
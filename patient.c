@@ -3,11 +3,15 @@
 #include <string.h>
 #include <time.h>
 #include "patient.h"
+#include "logger.h"
+#include "rng.h"
+#include "sim_config.h"
 #define MAX_LEN 100
 struct patient {
     int id;
     char *name;
     struct tm *arrival;
+    char *condition; // Ground truth from an arrival trace, NULL when unknown // Condição real vinda de um trace de chegadas, NULL se desconhecida
 };
 
 
@@ -36,10 +40,10 @@ Patient *create_patient(int id, const char *name, const struct tm *arrival){
 
      /* Checks if name or arrival is NULL // Verifica se name ou arrival é nulo */
      if (!name) {
-        printf("\nError: Patient's name cannot be NULL");
+        LOG_ERROR(LOG_CAT_PATIENT, "\nError: Patient's name cannot be NULL");
         return NULL;
      } else if (!arrival){
-         printf("\nError: Patient's arrival cannot be NULL");
+         LOG_ERROR(LOG_CAT_PATIENT, "\nError: Patient's arrival cannot be NULL");
          return NULL;
      }
 
@@ -49,19 +53,20 @@ Patient *create_patient(int id, const char *name, const struct tm *arrival){
 
 
     if(!patient){
-        printf("\nFailed to allocate memory for patient's structure");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for patient's structure");
         return NULL;
     }
 
     /* Assign the patient's id(Type INT) // Atribui o id(INT) do paciente */
     patient->id = id;
+    patient->condition = NULL;
 
     /* Allocates memory for patient's name and checks whether the allocation was successful
     // Aloca memória para o nome do paciente e verifica se a alocação foi bem-sucedida */
     patient->name = (char *) malloc(sizeof(char) * strlen(name) + 1);
 
     if(!patient->name) {
-        printf("\nFailed to allocate memory for name");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for name");
         free(patient);
         return NULL;
     }
@@ -74,7 +79,7 @@ Patient *create_patient(int id, const char *name, const struct tm *arrival){
     patient->arrival = (struct tm *) malloc(sizeof(struct tm));
 
     if (!patient->arrival){
-        printf("\nFailed to allocate memory for arrival");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for arrival");
         free(patient->name);
         free(patient);
         return NULL;
@@ -100,7 +105,7 @@ void destroy_patient(Patient *patient){
 
     /* Checks if the patient pointer is NULL // Verifica se o ponteiro do paciente é nulo */
     if (!patient){
-        printf("\nNULL POINTER!!");
+        LOG_ERROR(LOG_CAT_PATIENT, "\nNULL POINTER!!");
         return;
     }
 
@@ -115,10 +120,11 @@ void destroy_patient(Patient *patient){
         free(patient->arrival);
 
     }
+    free(patient->condition);
 
     /* Free the patient structure itself // Libera a estrutura do paciente */
     free(patient);
-    printf("\nMemory Allocation Freed!(Patient)\n");
+    LOG_DEBUG(LOG_CAT_MEMORY, "\nMemory Allocation Freed!(Patient)");
 }
 
 int get_patient_id(Patient *patient) {
@@ -135,7 +141,7 @@ int get_patient_id(Patient *patient) {
 
      /* Checks if the patient pointer is NULL // Verifica se o ponteiro do paciente é nulo */
      if (!patient){
-        printf("\nError: NULL patient pointer");
+        LOG_ERROR(LOG_CAT_PATIENT, "\nError: NULL patient pointer");
         return 1;
      }
 
@@ -156,7 +162,7 @@ char *get_patient_name(Patient *patient){
 
      /* Checks if the patient pointer is NULL // Verifica se o ponteiro do paciente é nulo */
      if (!patient){
-        printf("\nError: NULL patient pointer");
+        LOG_ERROR(LOG_CAT_PATIENT, "\nError: NULL patient pointer");
         return NULL;
      }
 
@@ -178,17 +184,18 @@ Patient *patient_in(){
 
     time_t tempoAtual;
     time(&tempoAtual);
-    struct tm *tempoLocal = localtime(&tempoAtual);
+    struct tm tempoLocal;
+    localtime_r(&tempoAtual, &tempoLocal); // localtime_r: several clinics create patients at once // Reentrante
 
-    int geradorNome = rand()%30;
-    int geradorSobrenome= rand()%30;
-    int geradorID = rand()%1000+1;
+    int geradorNome = rng_below(32);
+    int geradorSobrenome= rng_below(32);
+    int geradorID = rng_below(1000)+1;
 
     char nomeCompleto[MAX_LEN];
 
 
 
-    const char *nomes[30] = {
+    const char *nomes[32] = {
         "Ana", "Bruno", "Carlos", "Diana", "Eduardo",
         "Fernanda", "Gabriel", "Helena", "Igor", "Julia",
         "Karine", "Lucas", "Mariana", "Nelson", "Olga",
@@ -198,8 +205,8 @@ Patient *patient_in(){
         "Elena", "Francisco"
     };
 
-    // Array com 30 sobrenomes
-    const char *sobrenomes[30] = {
+    // Array com 32 sobrenomes
+    const char *sobrenomes[32] = {
 
         "Almeida", "Barros", "Carvalho", "Dias", "Ferreira",
         "Gonçalves", "Henrique", "Inácio", "Junqueira", "Klein",
@@ -214,7 +221,7 @@ Patient *patient_in(){
 
 
 
-    return create_patient(geradorID,nomeCompleto,tempoLocal);
+    return create_patient(geradorID,nomeCompleto,&tempoLocal);
     }
 
 
@@ -235,7 +242,7 @@ struct tm *get_patient_arrival(Patient *patient){
      /* Checks if the patient pointer is NULL // Verifica se o ponteiro do paciente é nulo */
      if (!patient){
 
-        printf("\nError: NULL patient pointer");
+        LOG_ERROR(LOG_CAT_PATIENT, "\nError: NULL patient pointer");
         return NULL;
      }
 
@@ -249,14 +256,17 @@ Patient *patient_arrival(){
  *
  * \return Pointer to a newly created Patient structure or NULL if no patient is created // Ponteiro para a nova estrutura Patient ou NULL se nenhum paciente for criado
  *
- * \details This function simulates the arrival of a patient with a 20% probability.
+ * \details This function simulates the arrival of a patient during one main loop step: arrival_rate times the mean step
+ *          of the clinic configuration, a 20% probability by default.
  *          If a patient is created, it returns a pointer to the new patient; otherwise, it returns NULL.
- * \details Esta função simula a chegada de um paciente com uma probabilidade de 20%.
+ * \details Esta função simula a chegada de um paciente durante um passo do loop principal: arrival_rate vezes o passo
+ *          médio da configuração da clínica, uma probabilidade de 20% por padrão.
  *          Se um paciente for criado, retorna um ponteiro para o novo paciente; caso contrário, retorna NULL.
  */
 
-     int geradorP = rand()%100 +1;
-     if(geradorP<=20){
+     const SimConfig *config = sim_config();
+     double chance = config->arrival_rate * (config->step_min + config->step_max) / 2;
+     if(rng_uniform() < chance){
         Patient *new_patient = patient_in();
         if(!new_patient){
             printf("\nError creating patient!!!");
@@ -282,18 +292,20 @@ void print_patient(Patient *p) {
  * \details Esta função imprime o ID, nome e horário de chegada de um paciente na saída padrão.
  *          O horário de chegada é formatado como "dd/mm/yyyy hh:mm:ss".
  */
-    if (p) {
-        printf("\n\t=============================\n");
-        printf("\t       NEW PATIENT ARRIVED\n");
-        printf("\t=============================\n");
-        printf("\tPatient ID      : %d\n", get_patient_id(p));
-        printf("\tPatient Name    : %s\n", get_patient_name(p));
-
+    if (p && log_enabled(LOG_LEVEL_INFO, LOG_CAT_PATIENT)) {
         char buffer[100];
         strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", get_patient_arrival(p));
-        printf("\tArrival Time    : %s\n", buffer);
 
-        printf("\t=============================\n");
+        /* The whole banner is one log record, so it can't interleave with other threads // O banner inteiro é um registro */
+        LOG_INFO(LOG_CAT_PATIENT,
+                 "\n\t=============================\n"
+                 "\t       NEW PATIENT ARRIVED\n"
+                 "\t=============================\n"
+                 "\tPatient ID      : %d\n"
+                 "\tPatient Name    : %s\n"
+                 "\tArrival Time    : %s\n"
+                 "\t=============================\n",
+                 get_patient_id(p), get_patient_name(p), buffer);
     }
 }
 
@@ -313,25 +325,13 @@ void print_patient_db(Patient *new_patient, FILE *patient_file){
  *          Se o ponteiro do paciente ou o ponteiro do arquivo for NULL, ou se houver um erro ao gravar no arquivo, uma mensagem de erro é impressa e o programa é encerrado.
  */
     if (new_patient && patient_file) {
-    fprintf(patient_file, "ID: %d\n", get_patient_id(new_patient));
-    fprintf(patient_file, "Name: %s\n", get_patient_name(new_patient));
-    const struct tm *arrival_time = get_patient_arrival(new_patient);
-
-    if (arrival_time) {
-    fprintf(patient_file, "Arrival Time: %d-%02d-%02d %02d:%02d:%02d\n",
-            arrival_time->tm_year + 1900,
-            arrival_time->tm_mon + 1,
-            arrival_time->tm_mday,
-            arrival_time->tm_hour,
-            arrival_time->tm_min,
-            arrival_time->tm_sec);
-    }else{
+    char record[PATIENT_DB_RECORD];
+    int length = format_patient_db(new_patient, record, sizeof(record));
+    if (length < 0) {
     printf("Error Saving Patient on DB\n");
     exit(1);
-
     }
-
-
+    fwrite(record, 1, length, patient_file); // One call: records written by different threads never mix
 
     }else{
     printf("Error Saving Patient on DB(new_patient)\n");
@@ -340,4 +340,61 @@ void print_patient_db(Patient *new_patient, FILE *patient_file){
 
 }
 
-
+int format_patient_db(Patient *patient, char *buffer, int size){
+/** \brief Format the db record of a patient // Formata o registro db de um paciente
+ *
+ * \param patient - Pointer to the Patient structure // Ponteiro para a estrutura Patient
+ * \param buffer - Receives the record, the same lines print_patient_db() writes // Recebe o registro, as mesmas linhas que print_patient_db() grava
+ * \param size - Bytes of the buffer // Bytes do buffer
+ * \return Length of the record, -1 if the patient has no arrival time or the record doesn't fit // Tamanho do registro, -1 se faltar o horário ou o registro não couber
+ */
+    const struct tm *arrival_time = patient ? get_patient_arrival(patient) : NULL;
+    if (!arrival_time) {
+        return -1;
+    }
+    int length = snprintf(buffer, size, "ID: %d\nName: %s\nArrival Time: %d-%02d-%02d %02d:%02d:%02d\n",
+                          get_patient_id(patient), get_patient_name(patient),
+                          arrival_time->tm_year + 1900,
+                          arrival_time->tm_mon + 1,
+                          arrival_time->tm_mday,
+                          arrival_time->tm_hour,
+                          arrival_time->tm_min,
+                          arrival_time->tm_sec);
+    return length < size ? length : -1;
+}
+
+int set_patient_condition(Patient *patient, const char *condition){
+    /** \brief Record the patient's real condition, e.g. read from an arrival trace // Registra a condição real do paciente, por exemplo lida de um trace de chegadas
+     *
+     * \param patient - Pointer to patient's structure // Ponteiro para a estrutura do paciente
+     * \param condition - Condition name as used by the exams, NULL or "" to clear it // Nome da condição como usado pelos exames, NULL ou "" para limpar
+     * \return 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+     */
+    if (!patient) {
+        LOG_ERROR(LOG_CAT_PATIENT, "\nError: NULL patient pointer");
+        return -1;
+    }
+
+    free(patient->condition);
+    patient->condition = NULL;
+    if (!condition || !condition[0]) {
+        return 0;
+    }
+
+    patient->condition = (char *) malloc(strlen(condition) + 1);
+    if (!patient->condition) {
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for condition");
+        return -1;
+    }
+    strcpy(patient->condition, condition);
+    return 0;
+}
+
+const char *get_patient_condition(Patient *patient){
+    /** \brief This function returns the patient's real condition // Esta função retorna a condição real do paciente
+     *
+     * \param patient - Pointer to patient's structure // Ponteiro para a estrutura do paciente
+     * \return The condition name, NULL when unknown // O nome da condição, NULL se desconhecida
+     */
+    return patient ? patient->condition : NULL;
+}
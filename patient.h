@@ -4,6 +4,8 @@
 #include <time.h>
 #include <stddef.h>  // Para NULL e outros tipos úteis
 
+#define PATIENT_DB_RECORD 256  // Bytes of a patient db record, enough for any trace name // Bytes de um registro db de paciente
+
 typedef struct patient Patient;
 
 /**
@@ -71,4 +73,28 @@ void print_patient(Patient *patient);
  * \param file - File pointer where the patient details will be written. // Ponteiro para o arquivo onde os detalhes do paciente serão gravados.
  */
 void print_patient_db(Patient *new_patient, FILE *file);
+/**
+ * \brief Format the db record of a patient, the lines print_patient_db() writes. // Formata o registro db de um paciente.
+ *
+ * \param patient - Pointer to the patient. // Ponteiro para o paciente.
+ * \param buffer - Receives the record, not terminated when it fills the buffer exactly. // Recebe o registro.
+ * \param size - Bytes of the buffer, PATIENT_DB_RECORD is always enough. // Bytes do buffer, PATIENT_DB_RECORD sempre basta.
+ * \return Length of the record, -1 without an arrival time or if it doesn't fit. // Tamanho do registro, -1 sem horário de chegada ou se não couber.
+ */
+int format_patient_db(Patient *patient, char *buffer, int size);
+/**
+ * \brief Set the patient's real condition (ground truth from an arrival trace).
+ *
+ * \param patient - Pointer to the patient. // Ponteiro para o paciente.
+ * \param condition - Condition name, NULL or "" when unknown. // Nome da condição, NULL ou "" se desconhecida.
+ * \return 0 on success, -1 on failure. // 0 em caso de sucesso, -1 em caso de falha.
+ */
+int set_patient_condition(Patient *patient, const char *condition);
+/**
+ * \brief Get the patient's real condition.
+ *
+ * \param patient - Pointer to the patient. // Ponteiro para o paciente.
+ * \return The condition name, NULL when unknown. // O nome da condição, NULL se desconhecida.
+ */
+const char *get_patient_condition(Patient *patient);
 #endif // PATIENT_H_INCLUDED
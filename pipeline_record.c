@@ -0,0 +1,72 @@
+#include "pipeline_record.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static void copy_text(char *destination, const char *source, int size) {
+// Cut to fit, always terminated // Corta para caber, sempre terminado
+    snprintf(destination, size, "%s", source ? source : "");
+}
+
+void pack_patient(Patient *patient, PatientRecord *record) {
+/**
+ * \brief Flatten a patient // Achata um paciente
+ */
+    memset(record, 0, sizeof(*record));
+    record->id = get_patient_id(patient);
+    struct tm arrival = *get_patient_arrival(patient);
+    record->arrival = (long long)mktime(&arrival);
+    copy_text(record->name, get_patient_name(patient), PIPELINE_NAME_MAX);
+    if (get_patient_condition(patient)) {
+        record->has_condition = 1;
+        copy_text(record->condition, get_patient_condition(patient), PIPELINE_CONDITION_MAX);
+    }
+}
+
+Patient *unpack_patient(const PatientRecord *record) {
+/**
+ * \brief Rebuild a patient from its record // Reconstrói um paciente a partir do registro
+ *
+ * \return Patient* - New patient // Novo paciente
+ */
+    time_t arrival_time = (time_t)record->arrival;
+    struct tm arrival;
+    localtime_r(&arrival_time, &arrival);
+    Patient *patient = create_patient(record->id, record->name, &arrival);
+    if (record->has_condition) {
+        set_patient_condition(patient, record->condition);
+    }
+    return patient;
+}
+
+void pack_exam(Exam *exam, ExamRecord *record) {
+/**
+ * \brief Flatten an exam // Achata um exame
+ */
+    memset(record, 0, sizeof(*record));
+    record->id = get_exam_id(exam);
+    record->rx_id = get_exam_rx_id(exam);
+    record->patient_id = get_exam_patient_id(exam);
+    struct tm exam_time = *get_exam_time(exam);
+    record->exam_time = (long long)mktime(&exam_time);
+    copy_text(record->condition, get_exam_condition(exam), PIPELINE_CONDITION_MAX);
+}
+
+Exam *unpack_exam(const ExamRecord *record) {
+/**
+ * \brief Rebuild an exam from its record // Reconstrói um exame a partir do registro
+ *
+ * \return Exam* - New exam // Novo exame
+ */
+    time_t exam_seconds = (time_t)record->exam_time;
+    struct tm exam_time;
+    localtime_r(&exam_seconds, &exam_time);
+    return create_exam(record->id, record->rx_id, record->patient_id, record->condition, &exam_time);
+}
+
+void pipeline_ring_name(const char *prefix, const char *ring, char *name, int size) {
+/**
+ * \brief Shared memory name of a pipeline ring // Nome da memória compartilhada de um anel do pipeline
+ */
+    snprintf(name, size, "%s_%s", prefix, ring);
+}
@@ -0,0 +1,79 @@
+#ifndef PIPELINE_RECORD_H_INCLUDED
+#define PIPELINE_RECORD_H_INCLUDED
+
+#include <stdio.h>
+#include "patient.h"
+#include "exam.h"
+
+#define PIPELINE_DEFAULT_PREFIX "/clinic"   // Rings are <prefix>_patients and <prefix>_exams // Os anéis são <prefix>_patients e <prefix>_exams
+#define PIPELINE_NAME_MAX 64
+#define PIPELINE_CONDITION_MAX 32
+
+/**
+ * \brief A Patient flattened for the shared memory ring between clinic_intake and clinic_rx
+ *        // Um Patient achatado para o anel entre clinic_intake e clinic_rx
+ */
+typedef struct patient_record {
+    int id;
+    int has_condition;                       // The condition came from a trace // A condição veio de um trace
+    long long arrival;                       // time_t of the arrival // time_t da chegada
+    char name[PIPELINE_NAME_MAX];
+    char condition[PIPELINE_CONDITION_MAX];
+} PatientRecord;
+
+/**
+ * \brief An Exam flattened for the shared memory ring between clinic_rx and clinic_report; the image stays behind
+ *        // Um Exam achatado para o anel entre clinic_rx e clinic_report; a imagem fica para trás
+ */
+typedef struct exam_record {
+    int id;
+    int rx_id;
+    int patient_id;
+    int unused;
+    long long exam_time;                     // time_t of the exam // time_t do exame
+    char condition[PIPELINE_CONDITION_MAX];
+} ExamRecord;
+
+/**
+ * \brief Flatten a patient // Achata um paciente
+ *
+ * \param patient - Pointer to the patient // Ponteiro para o paciente
+ * \param record - Receives the record; long names and conditions are cut // Recebe o registro; nomes e condições longos são cortados
+ */
+void pack_patient(Patient *patient, PatientRecord *record);
+
+/**
+ * \brief Rebuild a patient from its record // Reconstrói um paciente a partir do registro
+ *
+ * \param record - Pointer to the record // Ponteiro para o registro
+ * \return New patient, freed with destroy_patient() // Novo paciente, liberado com destroy_patient()
+ */
+Patient *unpack_patient(const PatientRecord *record);
+
+/**
+ * \brief Flatten an exam // Achata um exame
+ *
+ * \param exam - Pointer to the exam // Ponteiro para o exame
+ * \param record - Receives the record // Recebe o registro
+ */
+void pack_exam(Exam *exam, ExamRecord *record);
+
+/**
+ * \brief Rebuild an exam from its record // Reconstrói um exame a partir do registro
+ *
+ * \param record - Pointer to the record // Ponteiro para o registro
+ * \return New exam, freed with destroy_exam() // Novo exame, liberado com destroy_exam()
+ */
+Exam *unpack_exam(const ExamRecord *record);
+
+/**
+ * \brief Shared memory name of a pipeline ring // Nome da memória compartilhada de um anel do pipeline
+ *
+ * \param prefix - Prefix starting with '/' // Prefixo começando com '/'
+ * \param ring - "patients" or "exams"
+ * \param name - Receives the name // Recebe o nome
+ * \param size - Room in `name` // Espaço em `name`
+ */
+void pipeline_ring_name(const char *prefix, const char *ring, char *name, int size);
+
+#endif // PIPELINE_RECORD_H_INCLUDED
@@ -3,10 +3,13 @@
 #include <stdlib.h>
 #include "exam.h"
 #include "patient.h"
+#include "logger.h"
 
 struct void_queue {
     V_node *front;
     V_node *rear;
+    int size;       // Nodes in the queue // Nós na fila
+    int capacity;   // Admission limit checked by is_queue_full(), 0 for none // Limite de admissão, 0 para nenhum
 };
 
 struct void_node {
@@ -27,10 +30,12 @@ V_queue *create_queue() {
      */
     V_queue *new_queue = (V_queue *)malloc(sizeof(V_queue));
     if (!new_queue) {
-        printf("\nFailed to allocate memory for queue.\n");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nFailed to allocate memory for queue.");
         return NULL;
     }
     new_queue->front = new_queue->rear = NULL;
+    new_queue->size = 0;
+    new_queue->capacity = 0;
     return new_queue;
 }
 
@@ -47,7 +52,7 @@ void enqueue(V_queue *q, void *data) {
      */
     V_node *new_node = (V_node *)malloc(sizeof(V_node));
     if (!new_node) {
-        printf("\nError! Memory allocation failed (enqueue).\n");
+        LOG_ERROR(LOG_CAT_MEMORY, "\nError! Memory allocation failed (enqueue).");
         return;
     }
     new_node->data = data;
@@ -59,7 +64,8 @@ void enqueue(V_queue *q, void *data) {
     } else {
         q->front = new_node;
     }
-    q->rear = new_node;
+    q->rear = new_node;
+    q->size++;
 
 }
 
@@ -90,6 +96,7 @@ Patient *P_denqueue(V_queue *patient_queue) {
         }
 
         patient_queue->front = node_to_remove->next;
+        patient_queue->size--;
         if (!patient_queue->front) {
             patient_queue->rear = NULL;
         } else {
@@ -116,14 +123,15 @@ void E_free_queue(V_queue *queue){
      */
     V_node *current = queue->front;
     while(current){
+        V_node *next = current->next; // Read before the node is freed
         destroy_exam((Exam*)current->data);
         free(current);
-        current = current->next;
+        current = next;
 
     }
 
     free(queue);
-    printf("\nExam Queue Deleted!");
+    LOG_DEBUG(LOG_CAT_MEMORY, "\nExam Queue Deleted!");
 
 
 
@@ -140,14 +148,15 @@ void P_free_queue(V_queue *queue){
      */
     V_node *current = queue->front;
     while(current){
+        V_node *next = current->next; // Read before the node is freed
         destroy_patient(current->data);
         free(current);
-        current = current->next;
+        current = next;
 
     }
 
     free(queue);
-    printf("\nPatient Queue Deleted!");
+    LOG_DEBUG(LOG_CAT_MEMORY, "\nPatient Queue Deleted!");
 
 
 
@@ -190,7 +199,8 @@ Exam *E_dequeue(V_queue *queue) {
             return NULL;
         }
 
-        queue->front = node_to_remove->next;
+        queue->front = node_to_remove->next;
+        queue->size--;
         if (!queue->front) {
             queue->rear = NULL;
         } else {
@@ -209,20 +219,100 @@ Exam *E_dequeue(V_queue *queue) {
  * \param fila - Pointer to the queue. // Ponteiro para a fila.
  * \return The number of elements in the queue. // O número de elementos na fila.
  *
- * \details This function iterates through the entire queue, counting the number of nodes
- *          from the front to the rear. It starts from the `front` node and moves to the `next`
- *          node until it reaches the end (NULL), incrementing the `size` counter for each node.
- * \details Esta função percorre toda a fila, contando o número de nós
- *          desde a frente até a traseira. Ela começa a partir do nó `front` e move-se para o nó `next`
- *          até atingir o final (NULL), incrementando o contador `size` para cada nó.
- */
+ * \details The count is kept by enqueue and the dequeue functions, so this is O(1) and bounded queues can check it on every admission.
+ * \details A contagem é mantida por enqueue e pelas funções de retirada, então é O(1) e filas limitadas podem consultá-la a cada admissão.
+ */
 int queue_size(V_queue *fila) {
-    int size = 0;
-    V_node *current = fila->front;
-    while (current) {
-        size++;
-        current = current->next;
+    return fila ? fila->size : 0;
+}
+
+void set_queue_capacity(V_queue *queue, int capacity) {
+    /** \brief Sets the admission limit of the queue // Define o limite de admissão da fila
+     *
+     * \param queue - Pointer to the queue // Ponteiro para a fila
+     * \param capacity - Maximum size reported by is_queue_full(), 0 or less for unbounded // Tamanho máximo informado por is_queue_full(), 0 ou menos para ilimitada
+     *
+     * \details enqueue() itself never refuses data; producers check is_queue_full() and apply their overflow policy.
+     * \details enqueue() nunca recusa dados; os produtores consultam is_queue_full() e aplicam sua política de estouro.
+     */
+    if (queue) {
+        queue->capacity = capacity > 0 ? capacity : 0;
+    }
+}
+
+int queue_capacity(const V_queue *queue) {
+    /** \brief Gets the admission limit of the queue // Obtém o limite de admissão da fila
+     *
+     * \return int - The capacity, 0 when unbounded // A capacidade, 0 quando ilimitada
+     */
+    return queue ? queue->capacity : 0;
+}
+
+int is_queue_full(const V_queue *queue) {
+    /** \brief Checks if the queue reached its capacity // Verifica se a fila atingiu sua capacidade
+     *
+     * \return int - 1 if bounded and full, 0 otherwise // 1 se limitada e cheia, 0 caso contrário
+     */
+    return queue && queue->capacity > 0 && queue->size >= queue->capacity;
+}
+
+void *queue_pop_front(V_queue *queue) {
+    /** \brief Removes and returns the oldest element, whatever its type // Remove e retorna o elemento mais antigo, qualquer que seja o tipo
+     *
+     * \param queue - Pointer to the queue // Ponteiro para a fila
+     * \return Pointer to the data, NULL if the queue is empty // Ponteiro para os dados, NULL se a fila estiver vazia
+     */
+    if (!queue || !queue->front) {
+        return NULL;
+    }
+
+    V_node *node_to_remove = queue->front;
+    void *data = node_to_remove->data;
+    queue->front = node_to_remove->next;
+    if (queue->front) {
+        queue->front->previous = NULL;
+    } else {
+        queue->rear = NULL;
+    }
+    queue->size--;
+    free(node_to_remove);
+    return data;
+}
+
+void *queue_pop_back(V_queue *queue) {
+    /** \brief Removes and returns the newest element of the queue // Remove e retorna o elemento mais novo da fila
+     *
+     * \param queue - Pointer to the queue // Ponteiro para a fila
+     * \return Pointer to the data, NULL if the queue is empty // Ponteiro para os dados, NULL se a fila estiver vazia
+     *
+     * \details Used by load shedding: the element that waited least is the cheapest to drop.
+     * \details Usado no descarte de carga: o elemento que esperou menos é o mais barato de descartar.
+     */
+    if (!queue || !queue->rear) {
+        return NULL;
+    }
+
+    V_node *node_to_remove = queue->rear;
+    void *data = node_to_remove->data;
+    queue->rear = node_to_remove->previous;
+    if (queue->rear) {
+        queue->rear->next = NULL;
+    } else {
+        queue->front = NULL;
+    }
+    queue->size--;
+    free(node_to_remove);
+    return data;
+}
+void queue_visit(const V_queue *queue, QueueVisitor visit, void *context) {
+    /** \brief Visits every element, oldest first, without removing it // Visita cada elemento, do mais antigo ao mais novo, sem removê-lo
+     *
+     * \details Used by checkpoints to save what is waiting in a queue. // Usado pelos checkpoints para salvar o que espera em uma fila.
+     */
+    if (!queue) {
+        return;
+    }
+    for (V_node *node = queue->front; node; node = node->next) {
+        visit(node->data, context);
     }
-    return size;
 }
-
@@ -64,4 +64,50 @@ Exam *E_dequeue(V_queue *queue);
  * \return int - Returns the number of elements in the queue. // Retorna o nmero de elementos na fila.
  */
 int queue_size(V_queue *fila);
+
+/**
+ * \brief Sets the admission limit of the queue // Define o limite de admisso da fila
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \param capacity - Size at which is_queue_full() reports 1, 0 for unbounded // Tamanho em que is_queue_full() retorna 1, 0 para ilimitada
+ */
+void set_queue_capacity(V_queue *queue, int capacity);
+
+/**
+ * \brief Gets the admission limit of the queue // Obtm o limite de admisso da fila
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \return int - The capacity, 0 when unbounded // A capacidade, 0 quando ilimitada
+ */
+int queue_capacity(const V_queue *queue);
+
+/**
+ * \brief Checks if the queue reached its capacity // Verifica se a fila atingiu sua capacidade
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \return int - 1 if bounded and full, 0 otherwise // 1 se limitada e cheia, 0 caso contrrio
+ */
+int is_queue_full(const V_queue *queue);
+
+/**
+ * \brief Removes the oldest element of the queue, whatever its type // Remove o elemento mais antigo da fila, qualquer que seja o tipo
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \return Pointer to the data, NULL if the queue is empty // Ponteiro para os dados, NULL se a fila estiver vazia
+ */
+void *queue_pop_front(V_queue *queue);
+
+/**
+ * \brief Removes the newest element of the queue // Remove o elemento mais novo da fila
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \return Pointer to the data, NULL if the queue is empty // Ponteiro para os dados, NULL se a fila estiver vazia
+ */
+void *queue_pop_back(V_queue *queue);
+
+// Called with every element, oldest first // Chamada com cada elemento, do mais antigo ao mais novo
+typedef void (*QueueVisitor)(void *data, void *context);
+
+/**
+ * \brief Visits every element without removing it // Visita cada elemento sem remov-lo
+ * \param queue - Pointer to the queue // Ponteiro para a fila
+ * \param visit - Called with each element and `context`; it must not change the queue // Chamada com cada elemento e `context`; no pode alterar a fila
+ * \param context - Passed to `visit` // Passado para `visit`
+ */
+void queue_visit(const V_queue *queue, QueueVisitor visit, void *context);
 #endif // QUEUE_H
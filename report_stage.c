@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "exam.h"
+#include "medical_check.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+#include "shm_ring.h"
+#include "pipeline_record.h"
+
+/*
+ * Reporting process of the multi-process pipeline // Processo de laudos do pipeline multiprocesso
+ *
+ * Receives ExamRecords from <prefix>_exams into an ExamPriorityQueue, reports the most urgent first, and writes
+ * db_report.txt. If clinic_rx dies, the exams already received are still reported and the exit status is 2.
+ */
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int receive_exam(ShmRing *ring, ExamPriorityQueue *queue, int wait) {
+// Moves one exam from the ring to the priority queue; returns the size, 0 or -1 like shm_ring_receive()
+    ExamRecord record;
+    int size = shm_ring_receive(ring, &record, sizeof(record), wait);
+    if (size > 0) {
+        insert_in_priority_queue(queue, unpack_exam(&record));
+    }
+    return size;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -s, --time-scale X   Multiplier of the report durations, 0 removes them (default 0)\n");
+    printf("  -o, --db-dir DIR     Directory of db_report.txt (default .)\n");
+    printf("  -n, --name PREFIX    Shared memory prefix of the rings (default %s)\n", PIPELINE_DEFAULT_PREFIX);
+    printf("      --slots N        Records per ring (default %d)\n", SHM_RING_DEFAULT_SLOTS);
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"time-scale", required_argument, NULL, 's'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"name", required_argument, NULL, 'n'},
+        {"slots", required_argument, NULL, 'S'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "s:o:n:h";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    double scale = 0;
+    const char *db_dir = ".";
+    const char *prefix = PIPELINE_DEFAULT_PREFIX;
+    int slots = SHM_RING_DEFAULT_SLOTS;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 's': scale = atof(optarg); break;
+        case 'o': db_dir = optarg; break;
+        case 'n': prefix = optarg; break;
+        case 'S': slots = atoi(optarg); break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (scale < 0 || slots < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/db_report.txt", db_dir);
+    FILE *report_file = fopen(path, "w");
+    if (!report_file) {
+        perror("Failed to open db_report.txt");
+        return 1;
+    }
+    char name[128];
+    pipeline_ring_name(prefix, "exams", name, sizeof(name));
+    ShmRing *exam_ring = shm_ring_attach(name, SHM_RING_CONSUMER, slots, sizeof(ExamRecord));
+    if (!exam_ring) {
+        perror("Failed to attach to the exam ring");
+        return 1;
+    }
+
+    log_set_quiet(1);
+    set_time_scale(scale);
+    rng_seed((unsigned int)time(NULL) ^ 0xa5a5);
+    ExamPriorityQueue *queue = new_priority_queue();
+
+    double start = now_seconds();
+    long reports = 0;
+    long delayed = 0;
+    int upstream_lost = 0;
+    for (;;) {
+        // Take everything already sent, so the most urgent exam is reported first // Pega tudo que já chegou
+        int size;
+        while ((size = receive_exam(exam_ring, queue, 0)) > 0) {
+        }
+        if (is_priority_queue_empty(queue)) {
+            size = receive_exam(exam_ring, queue, 1);
+            if (size <= 0) {
+                upstream_lost = size < 0;
+                break;
+            }
+        }
+
+        Exam *exam = get_priority_exams(queue);
+        double report_duration = report_random_time();
+        my_sleep(report_duration);
+        Report *report = do_medical_report(exam);
+        print_report_db(report, report_file);
+        free_report(report);
+        destroy_exam(exam);
+        reports++;
+        if (report_duration > sim_config()->report_limit) {
+            delayed++;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    ShmRingStats stats;
+    get_shm_ring_stats(exam_ring, &stats);
+    printf("{\"stage\": \"report\", \"reports\": %ld, \"reports_delayed\": %ld, \"seconds\": %.4f, \"records_per_sec\": %.0f,\n"
+           " \"exam_ring\": {\"received\": %ld, \"handoff_mean_us\": %.2f, \"handoff_max_us\": %.2f, \"empty_sleeps\": %ld}, "
+           "\"upstream_lost\": %d}\n",
+           reports, delayed, elapsed, reports / (elapsed > 0 ? elapsed : 1),
+           stats.records, stats.mean_latency_us, stats.max_latency_us, stats.sleeps, upstream_lost);
+
+    shm_ring_detach(exam_ring);
+    free_priority_queue(queue);
+    fclose(report_file);
+    return upstream_lost ? 2 : 0;
+}
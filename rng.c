@@ -0,0 +1,161 @@
+#include "rng.h"
+#include "seqlock.h"
+#include <pthread.h>
+
+#define RNG_CACHE_LINE 64
+
+// One stream for the threads that never bind one, like rand() was
+// Um stream para as threads que nunca ligam um, como era o rand()
+static pthread_mutex_t rng_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t shared_state[4] = {0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL, 0x94d049bb133111ebULL, 1};
+
+// One stream per bound thread, on its own cache line; only its owner writes it
+// Um stream por thread ligada, em sua própria linha de cache; só o dono escreve nele
+typedef struct rng_stream {
+    _Alignas(RNG_CACHE_LINE) SeqLock lock;   // Lets get_rng_state() copy it mid draw // Deixa get_rng_state() copiar no meio de um sorteio
+    uint64_t s[4];
+} RngStream;
+
+static RngStream streams[RNG_STREAMS];
+static pthread_once_t streams_once = PTHREAD_ONCE_INIT;
+static _Thread_local RngStream *bound; // NULL for the shared stream // NULL para o stream compartilhado
+
+static uint64_t splitmix64(uint64_t *x) {
+// Spreads a seed over the four state words // Espalha uma semente pelas quatro palavras do estado
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t step(uint64_t *s) {
+// xoshiro256**, the caller owns `s` // xoshiro256**, quem chama é dono de `s`
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+static void seed_locked(uint64_t seed) {
+// Consecutive splitmix64 words for the shared stream, then for each bound one, rng_mutex held
+// Palavras seguidas do splitmix64 para o stream compartilhado e depois para cada ligado, com rng_mutex travado
+    for (int i = 0; i < 4; i++) {
+        shared_state[i] = splitmix64(&seed);
+    }
+    for (int stream = 0; stream < RNG_STREAMS; stream++) {
+        uint64_t s[4];
+        for (int i = 0; i < 4; i++) {
+            s[i] = splitmix64(&seed);
+        }
+        seqlock_write(&streams[stream].lock, streams[stream].s, s, sizeof(s));
+    }
+}
+
+static void seed_streams(void) {
+// Streams bound before any rng_seed() start from the default seed instead of all zero
+// Streams ligados antes de qualquer rng_seed() partem da semente padrão em vez de tudo zero
+    pthread_mutex_lock(&rng_mutex);
+    if (!(streams[0].s[0] | streams[0].s[1] | streams[0].s[2] | streams[0].s[3])) {
+        seed_locked(1);
+    }
+    pthread_mutex_unlock(&rng_mutex);
+}
+
+void rng_seed(uint64_t seed) {
+/**
+ * \brief Seed the generator shared by the simulation modules // Semeia o gerador compartilhado pelos módulos da simulação
+ */
+    pthread_mutex_lock(&rng_mutex);
+    seed_locked(seed);
+    pthread_mutex_unlock(&rng_mutex);
+}
+
+void rng_bind_stream(int stream) {
+/**
+ * \brief Draw the calling thread's numbers from its own stream // Sorteia os números da thread que chama do seu próprio stream
+ */
+    pthread_once(&streams_once, seed_streams);
+    bound = stream >= 0 && stream < RNG_STREAMS ? &streams[stream] : NULL;
+}
+
+uint64_t rng_next(void) {
+/**
+ * \brief Next 64 random bits // Próximos 64 bits aleatórios
+ */
+    RngStream *stream = bound;
+    if (stream) { // The owner is the only writer, so its plain reads race with nothing // O dono é o único escritor
+        uint64_t s[4] = {stream->s[0], stream->s[1], stream->s[2], stream->s[3]};
+        uint64_t value = step(s);
+        seqlock_write(&stream->lock, stream->s, s, sizeof(s));
+        return value;
+    }
+    pthread_mutex_lock(&rng_mutex);
+    uint64_t value = step(shared_state);
+    pthread_mutex_unlock(&rng_mutex);
+    return value;
+}
+
+int rng_below(int bound) {
+/**
+ * \brief Uniform integer in [0, bound) // Inteiro uniforme em [0, bound)
+ *
+ * \details Multiply-shift of the top 32 bits; the bias is below 2^-32 for the small bounds used here.
+ * \details Multiplicação e deslocamento dos 32 bits altos; o viés fica abaixo de 2^-32 para os limites usados aqui.
+ */
+    if (bound < 1) {
+        return 0;
+    }
+    return (int)(((rng_next() >> 32) * (uint64_t)bound) >> 32);
+}
+
+double rng_uniform(void) {
+/**
+ * \brief Uniform double in [0, 1), 53 random bits // Double uniforme em [0, 1), 53 bits aleatórios
+ */
+    return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void get_rng_state(RngState *state) {
+/**
+ * \brief Copy the state of every stream // Copia o estado de todos os streams
+ *
+ * \details Each bound stream is copied between two of its owner's draws, without stopping the owner.
+ * \details Cada stream ligado é copiado entre dois sorteios do seu dono, sem parar o dono.
+ */
+    pthread_mutex_lock(&rng_mutex);
+    for (int i = 0; i < 4; i++) {
+        state->s[i] = shared_state[i];
+    }
+    pthread_mutex_unlock(&rng_mutex);
+    for (int stream = 0; stream < RNG_STREAMS; stream++) {
+        seqlock_read(&streams[stream].lock, state->streams[stream], streams[stream].s, sizeof(state->streams[stream]));
+    }
+}
+
+void set_rng_state(const RngState *state) {
+/**
+ * \brief Continue from a saved state; all zero streams are ignored // Continua de um estado salvo; streams todos zero são ignorados
+ */
+    pthread_mutex_lock(&rng_mutex);
+    if (state->s[0] | state->s[1] | state->s[2] | state->s[3]) {
+        for (int i = 0; i < 4; i++) {
+            shared_state[i] = state->s[i];
+        }
+    }
+    for (int stream = 0; stream < RNG_STREAMS; stream++) {
+        const uint64_t *s = state->streams[stream];
+        if (s[0] | s[1] | s[2] | s[3]) {
+            seqlock_write(&streams[stream].lock, streams[stream].s, s, sizeof(state->streams[stream]));
+        }
+    }
+    pthread_mutex_unlock(&rng_mutex);
+}
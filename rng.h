@@ -0,0 +1,75 @@
+#ifndef RNG_H_INCLUDED
+#define RNG_H_INCLUDED
+
+#include <stdint.h>
+
+#define RNG_STREAMS 66   // The main thread, the arrivals and DOCTOR_MAX doctors, or CLINIC_MAX shards // Streams próprios
+
+/**
+ * \brief Complete state of the simulation's random generators, saved in checkpoints
+ *        // Estado completo dos geradores aleatórios da simulação, salvo nos checkpoints
+ */
+typedef struct rng_state {
+    uint64_t s[4];                      // Shared stream, xoshiro256** words, never all zero // Stream compartilhado, nunca todo zero
+    uint64_t streams[RNG_STREAMS][4];   // Streams bound with rng_bind_stream() // Streams ligados com rng_bind_stream()
+} RngState;
+
+/**
+ * \brief Seed the generator shared by the simulation modules (replaces srand()) // Semeia o gerador compartilhado (substitui srand())
+ *
+ * \details Seeds the shared stream and every bound stream; call it before the threads start.
+ * \details Semeia o stream compartilhado e todos os streams ligáveis; chame antes das threads começarem.
+ * \param seed - Same seed, same sequence // Mesma semente, mesma sequência
+ */
+void rng_seed(uint64_t seed);
+
+/**
+ * \brief Draw the calling thread's numbers from its own stream // Sorteia os números da thread que chama do seu próprio stream
+ *
+ * \details A bound stream has a single writer, so a draw takes no lock: it only publishes the new state through a
+ *          sequence lock, for get_rng_state(). Threads never bound, or bound to -1, share one stream under a mutex.
+ *          Each stream must be bound by one thread at a time.
+ * \details Um stream ligado tem um único escritor, então um sorteio não trava nada: só publica o novo estado por um
+ *          lock de sequência, para get_rng_state(). Threads nunca ligadas, ou ligadas a -1, dividem um stream com mutex.
+ *          Cada stream deve estar ligado a uma thread por vez.
+ * \param stream - 0 to RNG_STREAMS - 1, or -1 for the shared stream // 0 a RNG_STREAMS - 1, ou -1 para o compartilhado
+ */
+void rng_bind_stream(int stream);
+
+/**
+ * \brief Next 64 random bits // Próximos 64 bits aleatórios
+ *
+ * \return Random value // Valor aleatório
+ */
+uint64_t rng_next(void);
+
+/**
+ * \brief Uniform integer in [0, bound) (replaces rand() % bound) // Inteiro uniforme em [0, bound) (substitui rand() % bound)
+ *
+ * \param bound - Number of values, at least 1 // Número de valores, pelo menos 1
+ * \return Random value, 0 if bound < 1 // Valor aleatório, 0 se bound < 1
+ */
+int rng_below(int bound);
+
+/**
+ * \brief Uniform double in [0, 1) // Double uniforme em [0, 1)
+ *
+ * \return Random value // Valor aleatório
+ */
+double rng_uniform(void);
+
+/**
+ * \brief Copy the state of every stream, while the threads may be drawing // Copia o estado de todos os streams, mesmo com sorteios em curso
+ *
+ * \param state - Receives the state // Recebe o estado
+ */
+void get_rng_state(RngState *state);
+
+/**
+ * \brief Continue from a saved state, before the threads start // Continua de um estado salvo, antes das threads começarem
+ *
+ * \param state - State from get_rng_state() // Estado de get_rng_state()
+ */
+void set_rng_state(const RngState *state);
+
+#endif // RNG_H_INCLUDED
@@ -2,96 +2,479 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "time_control.h"
-#include "patient.h"
+#include "patient.h"
 #include "exam.h"
+#include "logger.h"
+#include "rng.h"
+#include "ai_batch.h"
+#include "xray_image.h"
+#include "sim_config.h"
 #include <string.h>
 #include <time.h>
 #include <stdbool.h>
-#define MAX_EXECUTION 43.200
+#include <pthread.h>
+#if XRAY_FEATURES != AI_FEATURES
+#error "The AI model takes one feature per X-ray grid cell"
+#endif
 struct rx_machine {
     int id;
     bool avaible;
     int patient_id;
+    bool retiring;         // Removed by a resize while busy, freed when its exam ends // Removida por um redimensionamento enquanto ocupada
+    RxPool *pool;
+    double created_at;     // Monotonic seconds // Segundos monotônicos
+    double busy_since;
+    double busy_seconds;
+    long exams_completed;
+    double speed;          // Exam time is divided by this factor // O tempo de exame é dividido por este fator
+    int queued;            // Patients waiting in this machine's own queue // Pacientes esperando na fila própria desta máquina
+    long next_ticket;      // FIFO order inside the machine queue // Ordem FIFO dentro da fila da máquina
+    long serving;
 };
 
-Rx **create_machines() {
+struct rx_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t machine_freed;
+    Rx **machines;
+    int size;
+    int capacity;
+    int busy;
+    int next_id;
+    RxRoutingPolicy policy;
+    AiBatcher *ai;            // Batched AI stage, NULL keeps the per-exam diagnostic_by_ai() // Estágio de IA em lotes
+    int image_width;          // Synthetic image acquired per exam, 0 for none // Imagem sintética adquirida por exame, 0 para nenhuma
+    int image_height;
+    XrayKernels image_kernels;
+    ImageStore *images;       // Acquired image + preprocessed copy per exam, handed to the exam without copying // Imagem adquirida + cópia pré-processada por exame
+    // Totals of machines already removed from the pool // Totais das máquinas já removidas do pool
+    double retired_busy_seconds;
+    double retired_lifetime;
+    long retired_exams;
+};
+
+static double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static Rx *new_machine(RxPool *pool) {
+// Allocates one idle machine with the next free ID // Aloca uma máquina livre com o próximo ID
+    Rx *machine = (Rx*)malloc(sizeof(Rx));
+    if (!machine) {
+        printf("\nError: Memory allocation failed (Machine %d)", pool->next_id);
+        exit(1);
+    }
+
+    machine->id = pool->next_id++;
+    machine->avaible = true;
+    machine->patient_id = 0;
+    machine->retiring = false;
+    machine->pool = pool;
+    machine->created_at = monotonic_seconds();
+    machine->busy_since = 0;
+    machine->busy_seconds = 0;
+    machine->exams_completed = 0;
+    machine->speed = 1.0;
+    machine->queued = 0;
+    machine->next_ticket = 0;
+    machine->serving = 0;
+    return machine;
+}
+
+static void retire_machine(RxPool *pool, Rx *machine, double now) {
+// Keeps the machine's totals in the pool and frees it (pool mutex held) // Guarda os totais da máquina no pool e a libera
+    pool->retired_busy_seconds += machine->busy_seconds;
+    pool->retired_lifetime += now - machine->created_at;
+    pool->retired_exams += machine->exams_completed;
+    free(machine);
+}
+
+RxPool *create_machines(int count) {
 /**
- * @brief Creates a list of X-Machines with initial settings.
- * @details Allocates memory for a fixed number of X-Machines and initializes each one.
- * @return Pointer to an array of pointers to Rx (X-Machines).
+ * @brief Creates a pool of X-Machines with initial settings.
+ * @details Allocates `count` idle machines, numbered from 1. The pool can grow or shrink later with resize_machines().
+ * @param count - Number of machines (values below 1 are raised to 1).
+ * @return Pointer to the new pool.
  */
 
-    Rx **machines_list = (Rx**)malloc(5 * sizeof(Rx*)); // Alocar memória para 5 máquinas
-    if (!machines_list) {
-        printf("\nError: Memory allocation failed (Machines Vector)");
+    RxPool *pool = (RxPool*)calloc(1, sizeof(RxPool));
+    if (!pool) {
+        printf("\nError: Memory allocation failed (Machines Pool)");
         exit(1);
     }
 
-    for (int i = 0; i < 5; i++) {
-        machines_list[i] = (Rx*)malloc(sizeof(Rx));
-        if (!machines_list[i]) {
-            printf("\nError: Memory allocation failed (Machine %d)", i);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->machine_freed, NULL);
+    pool->next_id = 1;
+    resize_machines(pool, count > 0 ? count : 1);
+
+    return pool;
+}
+
+int resize_machines(RxPool *pool, int count) {
+/**
+ * @brief Changes the number of X-Machines while the simulation runs.
+ * @details New machines start idle. When shrinking, idle machines are freed right away and busy ones
+ *          leave the pool now but are freed only when their current exam ends.
+ * @param pool - Pointer to the pool.
+ * @param count - New number of machines (at least 1).
+ * @return The new size, or -1 on invalid arguments.
+ */
+    if (!pool || count < 1) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    if (count > pool->capacity) {
+        Rx **grown = (Rx**)realloc(pool->machines, count * sizeof(Rx*));
+        if (!grown) {
+            printf("\nError: Memory allocation failed (Machines Vector)");
             exit(1);
         }
+        pool->machines = grown;
+        pool->capacity = count;
+    }
+
+    for (int i = pool->size; i < count; i++) {
+        pool->machines[i] = new_machine(pool);
+    }
+
+    double now = monotonic_seconds();
+    for (int i = count; i < pool->size; i++) {
+        Rx *machine = pool->machines[i];
+        if (machine->avaible && machine->queued == 0) {
+            retire_machine(pool, machine, now);
+        } else {
+            // Freed by the exam in progress or by the last patient leaving its queue
+            machine->retiring = true;
+            if (!machine->avaible) {
+                pool->busy--; // No longer counted as part of the pool's occupancy
+            }
+        }
+        pool->machines[i] = NULL;
+    }
+
+    pool->size = count;
+    pthread_cond_broadcast(&pool->machine_freed); // New machines may be free for waiting patients
+    pthread_mutex_unlock(&pool->mutex);
+
+    LOG_INFO(LOG_CAT_MACHINE, "\nX-Machine pool resized to %d machine(s)", count);
+    return count;
+}
+
+static const char *policy_names[] = {"first-free", "least-loaded", "shortest-expected", "jsq"};
+
+void set_routing_policy(RxPool *pool, RxRoutingPolicy policy) {
+/**
+ * @brief Selects how verify_and_ocupate() routes patients to machines.
+ * @param pool - Pointer to the pool.
+ * @param policy - Routing policy.
+ */
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->policy = policy;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+int routing_policy_from_name(const char *name) {
+/**
+ * @brief Parses a routing policy name.
+ * @param name - first-free, least-loaded, shortest-expected or jsq.
+ * @return The policy, or -1 if the name is unknown.
+ */
+    for (int i = 0; name && i < (int)(sizeof(policy_names) / sizeof(policy_names[0])); i++) {
+        if (strcmp(name, policy_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *routing_policy_name(RxRoutingPolicy policy) {
+/**
+ * @brief Returns the name of a routing policy.
+ * @param policy - Routing policy.
+ * @return Constant string with the name.
+ */
+    if ((int)policy < 0 || (int)policy >= (int)(sizeof(policy_names) / sizeof(policy_names[0]))) {
+        return "unknown";
+    }
+    return policy_names[policy];
+}
 
-        machines_list[i]->id = i + 1;
-        machines_list[i]->avaible = true;
-        machines_list[i]->patient_id = 0;
+void set_ai_batcher(RxPool *pool, AiBatcher *batcher) {
+/**
+ * @brief Sends the diagnosis of every exam through a batched AI stage.
+ * @param pool - Pointer to the pool.
+ * @param batcher - Running AI stage, or NULL to go back to diagnostic_by_ai().
+ */
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->ai = batcher;
+        pthread_mutex_unlock(&pool->mutex);
     }
+}
+
+int set_exam_imaging(RxPool *pool, int width, int height, XrayKernels kernels) {
+/**
+ * @brief Makes every exam acquire and preprocess a synthetic image of the given size.
+ * @details The image features feed the AI stage instead of random features.
+ * @param pool - Pointer to the pool.
+ * @param width - Image width, 0 disables the imaging.
+ * @param height - Image height.
+ * @param kernels - Scalar reference or SIMD preprocessing kernels.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+    if (!pool || width < 0 || height < 0 || (width > 0 && (width < 2 || height < 2))) {
+        return -1;
+    }
+
+    ImageStore *images = NULL;
+    if (width > 0) {
+        images = create_image_store((size_t)width * height + (size_t)(width / 2) * (height / 2), RX_IMAGE_CHUNK);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    ImageStore *previous = pool->images;
+    pool->image_width = width;
+    pool->image_height = width > 0 ? height : 0;
+    pool->image_kernels = kernels;
+    pool->images = images;
+    pthread_mutex_unlock(&pool->mutex);
+
+    destroy_image_store(previous); // Exams still holding its buffers keep them valid
+    return 0;
+}
 
-    return machines_list;
+ImageStore *get_exam_image_store(RxPool *pool) {
+/**
+ * @brief Returns the buffer store holding the exam images.
+ * @param pool - Pointer to the pool.
+ * @return The store, NULL when imaging is disabled.
+ */
+    return pool ? pool->images : NULL;
 }
 
-void destroy_machines(Rx **machines_list) {
+int set_machine_speeds(RxPool *pool, const char *list) {
+/**
+ * @brief Sets the exam speed of the machines from a comma separated list.
+ * @details The whole list is validated before any machine changes. Entries beyond the pool size are ignored.
+ * @param pool - Pointer to the pool.
+ * @param list - Speed factors like "1,1,0.5" (all greater than 0).
+ * @return Number of speeds in the list, or -1 if it is invalid.
+ */
+    if (!pool || !list) {
+        return -1;
+    }
+
+    double speeds[64];
+    int count = 0;
+    const char *cursor = list;
+    while (*cursor) {
+        char *end;
+        double speed = strtod(cursor, &end);
+        if (end == cursor || speed <= 0 || count == 64 || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        speeds[count++] = speed;
+        cursor = *end == ',' ? end + 1 : end;
+    }
 
+    pthread_mutex_lock(&pool->mutex);
+    for (int i = 0; i < count && i < pool->size; i++) {
+        pool->machines[i]->speed = speeds[i];
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return count;
+}
+
+void destroy_machines(RxPool *pool) {
 /**
- * @brief Verifies the availability of X-Machines and occupies one for the given patient.
- * @details Searches through the list of X-Machines to find an available machine, assigns the patient to it,
- *          and performs an exam using the machine. If no machine is available, prints a message.
- * @param machines_list - Pointer to the array of pointers to X-Machines.
- * @param patient - Pointer to the patient for whom the exam is to be performed.
- * @return Pointer to the created Exam or NULL if no machine is available.
+ * @brief Frees the pool and every X-Machine in it.
+ * @details Must only be called once no exam is running.
+ * @param pool - Pointer to the pool.
  */
 
-    if (machines_list) {
-        for (int i = 0; i < 5; i++) {
-            if (machines_list[i]) {
-                free(machines_list[i]);
+    if (pool) {
+        for (int i = 0; i < pool->size; i++) {
+            if (pool->machines[i]) {
+                free(pool->machines[i]);
             }
         }
-        free(machines_list);
+        free(pool->machines);
+        destroy_image_store(pool->images);
+        pthread_cond_destroy(&pool->machine_freed);
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool);
+    }
+}
+
+static void release_machine(Rx *machine) {
+// Ends the machine's exam: accounting, then free for the next patient // Encerra o exame da máquina: contabiliza e libera para o próximo paciente
+    RxPool *pool = machine->pool;
+    double now = monotonic_seconds();
+
+    pthread_mutex_lock(&pool->mutex);
+    machine->busy_seconds += now - machine->busy_since;
+    machine->exams_completed++;
+    machine->patient_id = 0;
+    machine->avaible = true;
+
+    if (machine->retiring) {
+        if (machine->queued == 0) {
+            retire_machine(pool, machine, now);
+        } else {
+            pthread_cond_broadcast(&pool->machine_freed); // Its queue has to move to other machines
+        }
+    } else {
+        pool->busy--;
+        if (machine->queued > 0) {
+            pthread_cond_broadcast(&pool->machine_freed); // Only the next ticket of this machine may proceed
+        } else {
+            pthread_cond_signal(&pool->machine_freed);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static double exam_seconds(Rx *machine) {
+// Model duration of one exam on this machine, whatever the time scale // Duração de um exame no modelo, qualquer que seja a escala
+    return sim_config()->exam_time / machine->speed;
+}
+
+static double expected_completion(Rx *machine, double now) {
+// Model seconds until a patient joining this machine's queue now would be examined; in wall seconds a time scale of
+// 0 (clinic_stress) would make every machine cost 0 and the choice ignore the queues
+// Segundos do modelo até um paciente que entra agora na fila desta máquina ser examinado
+    double service = exam_seconds(machine);
+    double remaining = 0;
+    if (!machine->avaible) {
+        // busy_since is wall clock (it feeds the utilization): its elapsed part back in model seconds
+        // busy_since é relógio real (alimenta a utilização): a parte decorrida volta para segundos do modelo
+        double scale = get_time_scale();
+        double elapsed = scale > 0 ? (now - machine->busy_since) / scale : 0;
+        remaining = service - elapsed;
+        if (remaining < 0) {
+            remaining = 0;
+        }
+    }
+    return remaining + machine->queued * service + service;
+}
+
+static Rx *choose_idle_machine(RxPool *pool) {
+// First-free and least-loaded: picks among idle machines only, NULL if all are busy (pool mutex held)
+    Rx *chosen = NULL;
+    for (int i = 0; i < pool->size; i++) {
+        Rx *machine = pool->machines[i];
+        if (!machine->avaible || machine->queued > 0) {
+            continue;
+        }
+        if (pool->policy == RX_ROUTE_FIRST_FREE) {
+            return machine;
+        }
+        if (!chosen || machine->busy_seconds < chosen->busy_seconds ||
+            (machine->busy_seconds == chosen->busy_seconds && machine->speed > chosen->speed)) {
+            chosen = machine;
+        }
+    }
+    return chosen;
+}
+
+static Rx *choose_machine_queue(RxPool *pool) {
+// Shortest-expected-completion and join-shortest-queue: always picks a machine, busy or not (pool mutex held)
+    double now = monotonic_seconds();
+    Rx *chosen = NULL;
+    double chosen_cost = 0;
+
+    for (int i = 0; i < pool->size; i++) {
+        Rx *machine = pool->machines[i];
+        int load = machine->queued + (machine->avaible ? 0 : 1);
+        double cost = pool->policy == RX_ROUTE_SHORTEST_EXPECTED ? expected_completion(machine, now) : load;
+
+        if (!chosen || cost < chosen_cost ||
+            (cost == chosen_cost && machine->speed > chosen->speed)) {
+            chosen = machine;
+            chosen_cost = cost;
+        }
     }
+    return chosen;
 }
 
-Exam *verify_and_ocupate(Rx **machines_list, Patient *patient) {
+static bool wait_in_machine_queue(RxPool *pool, Rx *machine) {
+// Waits in the machine's own FIFO until it is this patient's turn (pool mutex held)
+// Returns false if the machine was removed from the pool meanwhile, so the patient is routed again
+    long ticket = machine->next_ticket++;
+    machine->queued++;
+
+    if (!machine->avaible || machine->serving != ticket) {
+        LOG_WARN(LOG_CAT_MACHINE, "\nX-MACHINE %d is busy, waiting in its queue (%ld ahead).", machine->id, ticket - machine->serving);
+    }
+    while (!machine->retiring && (!machine->avaible || machine->serving != ticket)) {
+        pthread_cond_wait(&pool->machine_freed, &pool->mutex);
+    }
+    machine->queued--;
+
+    if (machine->retiring) {
+        if (machine->queued == 0 && machine->avaible) {
+            retire_machine(pool, machine, monotonic_seconds());
+        }
+        return false;
+    }
+    machine->serving++;
+    return true;
+}
+
+Exam *verify_and_ocupate(RxPool *pool, Patient *patient) {
 /**
  * @brief Verify and occupy an available X-Machine for the given patient // Verifica e ocupa uma Máquina X disponível para o paciente dado
  *
- * @param machines_list - Pointer to the array of X-Machines // Ponteiro para o array de Máquinas X
+ * @details Safe to call from several threads. If every machine is busy, the caller waits until one is released.
+ * @param pool - Pointer to the pool of X-Machines // Ponteiro para o pool de Máquinas X
  * @param patient - Pointer to the patient who needs an exam // Ponteiro para o paciente que precisa de um exame
- * @return Pointer to the created Exam if a machine is available, NULL otherwise // Ponteiro para o exame criado se uma máquina estiver disponível, NULL caso contrário
- */
-    if (machines_list && patient) {
-        for (int i = 0; i < 5; i++) {
-            if (machines_list[i] && machines_list[i]->avaible) {
-                machines_list[i]->patient_id = get_patient_id(patient);
-                machines_list[i]->avaible = false;
-                Exam *new_exam = do_exam_with_AI(machines_list[i]);
-                return new_exam;
+ * @return Pointer to the created Exam, NULL if the arguments are invalid // Ponteiro para o exame criado, NULL se os argumentos forem inválidos
+ */
+    if (!pool || !patient) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        Rx *machine;
+        if (pool->policy == RX_ROUTE_FIRST_FREE || pool->policy == RX_ROUTE_LEAST_LOADED) {
+            machine = choose_idle_machine(pool);
+            if (!machine) {
+                LOG_WARN(LOG_CAT_MACHINE, "\nThere is no X-MACHINE avaible, please wait.");
+                pthread_cond_wait(&pool->machine_freed, &pool->mutex);
+                continue;
+            }
+        } else {
+            machine = choose_machine_queue(pool);
+            if (!wait_in_machine_queue(pool, machine)) {
+                continue;
             }
         }
 
-        printf("\nThere is no X-MACHINE avaible, please wait.");
+        machine->patient_id = get_patient_id(patient);
+        machine->avaible = false;
+        machine->busy_since = monotonic_seconds();
+        pool->busy++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        return do_exam_with_AI(machine);
     }
-    return NULL;
-}
+}
+
 
-
 
 char *diagnostic_by_ai() {
 /**
  * @brief Generate a random diagnostic based on AI
- * @details This function creates a diagnostic based on probability. The probabilities for each diagnostic are as follows:
+ * @details This function creates a diagnostic based on probability. The diagnosis_weights of the clinic configuration
+ *          give the relative frequency of each diagnostic; by default:
  * - "Normal Health": 30%
  * - "Bronchitis": 20%
  * - "Pneumonia": 10%
@@ -101,7 +484,7 @@ char *diagnostic_by_ai() {
  * - "Pulmonary Fibrosis": 5%
  * - "Tuberculosis": 5%
  * - "Lung Cancer": 10%
- * The thresholds array defines cumulative probability thresholds to determine the diagnostic.
+ * The weights are accumulated into thresholds to determine the diagnostic.
  * @return Pointer to a string representing the diagnostic
  */
 
@@ -117,12 +500,18 @@ char *diagnostic_by_ai() {
         "Lung Cancer"
     };
 
-    static const int thresholds[] = {30, 50, 60, 70, 75, 80, 85, 90, 100};
+    const int *weights = sim_config()->diagnosis_weights;
+    int total = 0;
+    for (int i = 0; i < CONFIG_DIAGNOSES; i++) {
+        total += weights[i];
+    }
 
-    int geradorP = rand() % 100 + 1;
+    int geradorP = rng_below(total) + 1;
 
-    for (int i = 0; i < 9; i++) {
-        if (geradorP <= thresholds[i]) {
+    int threshold = 0;
+    for (int i = 0; i < CONFIG_DIAGNOSES; i++) {
+        threshold += weights[i];
+        if (geradorP <= threshold) {
             return diagnostics[i];
         }
     }
@@ -143,24 +532,172 @@ Exam *do_exam_with_AI(Rx *machine) {
  *         a pointer to the new Exam is returned. If the machine is NULL, indicating an invalid machine, the function returns NULL.
  */
     if (machine) {
-        int exam_id = rand() % 1000;
-        printf("\nExam started for (ID): %d", machine->patient_id);
+        int exam_id = rng_below(1000);
+        int machine_id = machine->id;
+        int patient_id = machine->patient_id;
+        pthread_mutex_lock(&machine->pool->mutex); // set_ai_batcher() and set_exam_imaging() may run meanwhile
+        AiBatcher *ai = machine->pool->ai;
+        int image_width = machine->pool->image_width;
+        int image_height = machine->pool->image_height;
+        XrayKernels image_kernels = machine->pool->image_kernels;
+        ImageStore *images = machine->pool->images;
+        pthread_mutex_unlock(&machine->pool->mutex);
+        ImageBuffer *image_buffer = image_store_acquire(images);
+        LOG_INFO(LOG_CAT_MACHINE, "\nExam started for (ID): %d", patient_id);
 
         time_t tempoAtual;
         time(&tempoAtual);
-        struct tm *tempoLocal = localtime(&tempoAtual);
-
-        const char *ai_diagnostic = diagnostic_by_ai();
-        Exam *new_exam = create_exam(exam_id, machine->id, machine->patient_id, ai_diagnostic, tempoLocal);
-        my_sleep(MAX_EXECUTION/4320);
+        struct tm tempoLocal;
+        localtime_r(&tempoAtual, &tempoLocal);
 
-        printf("\nExam finished for (ID): %d", machine->patient_id);
+        // Acquisition and preprocessing run on the machine, the features go to the AI stage
+        // The image and its preprocessed copy are written once into the buffer; only the handle travels with the exam
+        float features[AI_FEATURES];
+        if (image_buffer) {
+            unsigned char *pixels = image_buffer_data(image_buffer);
+            XrayImage image = {image_width, image_height, pixels};
+            XrayImage scratch = {image_width / 2, image_height / 2, pixels + (size_t)image_width * image_height};
+            generate_xray_image(&image, (unsigned int)rng_next());
+            xray_preprocess(&image, &scratch, features, image_kernels);
+        } else {
+            ai_random_features(features);
+        }
 
-        machine->avaible = true;
-        machine->patient_id = 0;
+        const char *ai_diagnostic;
+        if (ai) {
+            // The image is taken first; the machine is free again while the AI stage batches the diagnosis
+            my_sleep(sim_config()->exam_time / machine->speed);
+            LOG_INFO(LOG_CAT_MACHINE, "\nExam finished for (ID): %d", patient_id);
+            release_machine(machine);
+            ai_diagnostic = ai_diagnose(ai, features);
+        } else {
+            ai_diagnostic = diagnostic_by_ai();
+            my_sleep(sim_config()->exam_time / machine->speed);
+            LOG_INFO(LOG_CAT_MACHINE, "\nExam finished for (ID): %d", patient_id);
+            release_machine(machine);
+        }
 
+        Exam *new_exam = create_exam(exam_id, machine_id, patient_id, ai_diagnostic, &tempoLocal);
+        if (new_exam) {
+            set_exam_image(new_exam, image_buffer);
+        } else {
+            image_buffer_release(image_buffer);
+        }
         return new_exam;
     }
     return NULL;
-}
+}
+
+int count_busy_machines(RxPool *pool) {
+/**
+ * @brief Counts how many X-Machines are currently occupied by a patient.
+ * @param pool - Pointer to the pool.
+ * @return Number of machines in the pool that are not available.
+ */
+    int busy = 0;
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        busy = pool->busy;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return busy;
+}
+
+int machines_count(RxPool *pool) {
+/**
+ * @brief Returns the current number of X-Machines in the pool.
+ * @param pool - Pointer to the pool.
+ * @return Number of machines, 0 if the pool is NULL.
+ */
+    int size = 0;
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        size = pool->size;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return size;
+}
+
+int get_machines_stats(RxPool *pool, RxMachineStats *stats, int max_stats, RxMachineStats *total) {
+/**
+ * @brief Copies the utilization accounting of every machine.
+ * @details Busy time includes the exam in progress, idle time is the rest of the machine's lifetime.
+ *          `total` also includes machines already removed by a resize.
+ * @param pool - Pointer to the pool.
+ * @param stats - Array receiving one entry per machine (may be NULL).
+ * @param max_stats - Capacity of `stats`.
+ * @param total - Receives the pool totals, with id 0 (may be NULL).
+ * @return Number of entries written to `stats`.
+ */
+    int written = 0;
+    if (!pool) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    double now = monotonic_seconds();
+    RxMachineStats sum = {0, pool->retired_busy_seconds, pool->retired_lifetime - pool->retired_busy_seconds, pool->retired_exams, 0, 0, 0};
 
+    for (int i = 0; i < pool->size; i++) {
+        Rx *machine = pool->machines[i];
+        double lifetime = now - machine->created_at;
+        double busy = machine->busy_seconds + (machine->avaible ? 0 : now - machine->busy_since);
+
+        RxMachineStats entry;
+        entry.id = machine->id;
+        entry.busy_seconds = busy;
+        entry.idle_seconds = lifetime - busy;
+        entry.exams_completed = machine->exams_completed;
+        entry.utilization = lifetime > 0 ? busy / lifetime : 0;
+        entry.speed = machine->speed;
+        entry.queued = machine->queued;
+
+        sum.busy_seconds += entry.busy_seconds;
+        sum.idle_seconds += entry.idle_seconds;
+        sum.exams_completed += entry.exams_completed;
+        sum.queued += entry.queued;
+
+        if (stats && written < max_stats) {
+            stats[written++] = entry;
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (total) {
+        double lifetime = sum.busy_seconds + sum.idle_seconds;
+        sum.utilization = lifetime > 0 ? sum.busy_seconds / lifetime : 0;
+        *total = sum;
+    }
+    return written;
+}
+
+double machines_utilization(RxPool *pool) {
+/**
+ * @brief Fraction of machine time spent doing exams since the pool was created.
+ * @param pool - Pointer to the pool.
+ * @return Value between 0 and 1.
+ */
+    RxMachineStats total;
+    get_machines_stats(pool, NULL, 0, &total);
+    return total.utilization;
+}
+
+void print_machines_stats(RxPool *pool) {
+/**
+ * @brief Prints the utilization table of the pool.
+ * @param pool - Pointer to the pool.
+ */
+    RxMachineStats stats[64];
+    RxMachineStats total;
+    int count = get_machines_stats(pool, stats, 64, &total);
+
+    printf("\nX-Machine Utilization (routing: %s):\n", routing_policy_name(pool ? pool->policy : RX_ROUTE_FIRST_FREE));
+    for (int i = 0; i < count; i++) {
+        printf("Machine %d (speed %.2lf): exams %ld, busy %.2lf s, idle %.2lf s, utilization %.1lf%%\n",
+               stats[i].id, stats[i].speed, stats[i].exams_completed, stats[i].busy_seconds, stats[i].idle_seconds, stats[i].utilization * 100);
+    }
+    if (machines_count(pool) > count) {
+        printf("(%d more machines not listed)\n", machines_count(pool) - count);
+    }
+    printf("All machines: exams %ld, utilization %.1lf%%\n", total.exams_completed, total.utilization * 100);
+}
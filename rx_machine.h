@@ -3,36 +3,139 @@
 
 #include "exam.h"
 #include "patient.h"
+#include "ai_batch.h"
+#include "xray_image.h"
+
+#define RX_IMAGE_CHUNK 16  // Image buffers mapped at once when the store grows // Buffers de imagem mapeados de uma vez quando o pool cresce
 
 // Define a estrutura para a máquina RX
 typedef struct rx_machine Rx;
 
+// Pool de máquinas RX, redimensionável em tempo de execução
+typedef struct rx_pool RxPool;
+
+/**
+ * @brief How a patient is assigned to a machine // Como um paciente é atribuído a uma máquina
+ */
+typedef enum rx_routing_policy {
+    RX_ROUTE_FIRST_FREE,          // First idle machine in pool order // Primeira máquina livre na ordem do pool
+    RX_ROUTE_LEAST_LOADED,        // Idle machine with the least busy time so far // Máquina livre com menos tempo ocupado até agora
+    RX_ROUTE_SHORTEST_EXPECTED,   // Machine expected to finish this patient first, waiting in its queue if needed // Máquina que deve terminar este paciente primeiro
+    RX_ROUTE_SHORTEST_QUEUE       // Join-shortest-queue over per-machine queues // Entra na menor fila entre as filas de cada máquina
+} RxRoutingPolicy;
+
+/**
+ * @brief Utilization accounting of one X-Machine (or of the whole pool) // Contabilidade de uso de uma máquina RX (ou do pool inteiro)
+ */
+typedef struct rx_machine_stats {
+    int id;                 // Machine ID, 0 for pool totals // ID da máquina, 0 para os totais do pool
+    double busy_seconds;    // Time spent doing exams // Tempo gasto fazendo exames
+    double idle_seconds;    // Time available without a patient // Tempo disponível sem paciente
+    long exams_completed;
+    double utilization;     // busy / (busy + idle)
+    double speed;           // Exam speed factor, 0 for pool totals // Fator de velocidade do exame, 0 para os totais
+    int queued;             // Patients waiting in this machine's queue // Pacientes esperando na fila desta máquina
+} RxMachineStats;
+
 /**
- * @brief Create and initialize a list of X-Machines // Cria e inicializa uma lista de máquinas X
+ * @brief Create and initialize a pool of X-Machines // Cria e inicializa um pool de máquinas X
  *
- * @return Pointer to the array of X-Machines // Ponteiro para o array de Máquinas X
+ * @param count - Number of machines // Número de máquinas
+ * @return Pointer to the pool of X-Machines // Ponteiro para o pool de Máquinas X
+ */
+RxPool *create_machines(int count);
+
+/**
+ * @brief Changes the number of X-Machines at runtime.
+ * @details Busy machines removed by a shrink finish their exam before being freed.
+ * @param pool - Pointer to the pool.
+ * @param count - New number of machines (at least 1).
+ * @return The new size, or -1 on invalid arguments.
+ */
+int resize_machines(RxPool *pool, int count);
+
+/**
+ * @brief Selects how patients are routed to machines.
+ * @param pool - Pointer to the pool.
+ * @param policy - Routing policy.
+ */
+void set_routing_policy(RxPool *pool, RxRoutingPolicy policy);
+
+/**
+ * @brief Parses a routing policy name: first-free, least-loaded, shortest-expected or jsq.
+ * @param name - Policy name.
+ * @return The policy, or -1 if the name is unknown.
+ */
+int routing_policy_from_name(const char *name);
+
+/**
+ * @brief Returns the name of a routing policy.
+ * @param policy - Routing policy.
+ * @return Constant string with the policy name.
+ */
+const char *routing_policy_name(RxRoutingPolicy policy);
+
+/**
+ * @brief Sends the diagnosis of every exam through a batched AI stage.
+ * @details The machine is released once the image is taken, then the caller waits for its batch.
+ * @param pool - Pointer to the pool.
+ * @param batcher - Running AI stage, or NULL to use diagnostic_by_ai() per exam.
  */
-Rx **create_machines();
+void set_ai_batcher(RxPool *pool, AiBatcher *batcher);
 
 /**
- * @brief Frees the memory allocated for the list of X-Machines.
- * @details Deallocates memory for each X-Machine and the array of pointers.
- * @param machines_list - Pointer to the array of pointers to X-Machines.
+ * @brief Makes every exam acquire a synthetic X-ray image and preprocess it.
+ * @details Downsampling, normalization, histogram equalization and feature extraction run while the
+ *          machine is occupied; the resulting features are what the AI stage scores. The pixels live in a
+ *          buffer of the pool's image store and the exam holds a handle to it.
+ * @param pool - Pointer to the pool.
+ * @param width - Image width, 0 disables the imaging.
+ * @param height - Image height.
+ * @param kernels - XRAY_SCALAR reference or XRAY_SIMD kernels.
+ * @return 0 on success, -1 on invalid arguments.
  */
+int set_exam_imaging(RxPool *pool, int width, int height, XrayKernels kernels);
 
-void destroy_machines(Rx **machines_list);
+/**
+ * @brief Returns the buffer store that holds the exam images.
+ * @details Each exam keeps a handle to its buffer until release_exam_image() or destroy_exam().
+ * @param pool - Pointer to the pool.
+ * @return The store, NULL when imaging is disabled.
+ */
+ImageStore *get_exam_image_store(RxPool *pool);
+
+/**
+ * @brief Sets the exam speed of every machine from a comma separated list, e.g. "1,1,0.5".
+ * @details Entry i applies to the i-th machine of the pool. A speed of 2 halves the exam time,
+ *          0.5 doubles it. Machines added later by a resize run at speed 1.
+ * @param pool - Pointer to the pool.
+ * @param list - Comma separated speed factors, all greater than 0.
+ * @return Number of speeds applied, or -1 if the list is invalid.
+ */
+int set_machine_speeds(RxPool *pool, const char *list);
+
+/**
+ * @brief Frees the memory allocated for the pool of X-Machines.
+ * @details Deallocates memory for each X-Machine and the pool itself. No exam may be running.
+ * @param pool - Pointer to the pool.
+ */
+
+void destroy_machines(RxPool *pool);
 /**
  * @brief Verifies the availability of X-Machines and occupies one for the given patient.
- * @param machines_list - Pointer to the array of pointers to X-Machines.
+ * @details Thread safe. The machine is chosen by the pool's routing policy; the caller waits
+ *          for it (or for any machine, with first-free and least-loaded) when it is busy.
+ * @param pool - Pointer to the pool of X-Machines.
  * @param patient - Pointer to the patient for whom the exam is to be performed.
- * @return Pointer to the created Exam or NULL if no machine is available.
+ * @return Pointer to the created Exam or NULL if the arguments are invalid.
  */
-Exam *verify_and_ocupate(Rx **machines_list, Patient *patient);
+Exam *verify_and_ocupate(RxPool *pool, Patient *patient);
 
 /**
  * @brief Performs an exam using the AI diagnostic and marks the machine as available.
  * @details Creates a new exam with a diagnostic generated by the AI, simulates the exam process,
- *          and then marks the machine as available again.
+ *          and then releases the machine to its pool, updating its busy time and exam count.
+ *          With an AI stage set on the pool, the diagnosis happens after the release, in a batch.
  * @param machine - Pointer to the X-Machine performing the exam.
  * @return Pointer to the created Exam or NULL if the machine is not valid.
  */
@@ -45,4 +148,41 @@ Exam *do_exam_with_AI(Rx *machine);
  */
 char *diagnostic_by_ai();
 
+/**
+ * @brief Counts how many X-Machines are currently occupied by a patient.
+ * @param pool - Pointer to the pool.
+ * @return Number of machines that are not available.
+ */
+int count_busy_machines(RxPool *pool);
+
+/**
+ * @brief Returns the current number of X-Machines.
+ * @param pool - Pointer to the pool.
+ * @return Number of machines in the pool.
+ */
+int machines_count(RxPool *pool);
+
+/**
+ * @brief Copies the busy time, idle time and exam count of every machine.
+ * @param pool - Pointer to the pool.
+ * @param stats - Array receiving one entry per machine (may be NULL).
+ * @param max_stats - Capacity of `stats`.
+ * @param total - Receives the pool totals, including removed machines (may be NULL).
+ * @return Number of entries written to `stats`.
+ */
+int get_machines_stats(RxPool *pool, RxMachineStats *stats, int max_stats, RxMachineStats *total);
+
+/**
+ * @brief Fraction of machine time spent doing exams.
+ * @param pool - Pointer to the pool.
+ * @return Utilization between 0 and 1.
+ */
+double machines_utilization(RxPool *pool);
+
+/**
+ * @brief Prints the utilization of every machine and of the pool.
+ * @param pool - Pointer to the pool.
+ */
+void print_machines_stats(RxPool *pool);
+
 #endif // RX_MACHINE_H_INCLUDED
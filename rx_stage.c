@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "patient.h"
+#include "exam.h"
+#include "rx_machine.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+#include "shm_ring.h"
+#include "pipeline_record.h"
+
+/*
+ * Imaging process of the multi-process pipeline // Processo de imagem do pipeline multiprocesso
+ *
+ * Receives PatientRecords from <prefix>_patients, examines each patient on its RX machines, writes db_exam.txt
+ * and sends the exam as an ExamRecord to <prefix>_exams. If clinic_intake dies, the patients already received
+ * are still examined and the exam ring is closed normally, so clinic_report finishes too; the exit status is 2.
+ */
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -m, --machines N     RX machines (default %d, the machines of the clinic configuration)\n", sim_config()->machines);
+    printf("  -s, --time-scale X   Multiplier of the exam durations, 0 removes them (default 0)\n");
+    printf("  -o, --db-dir DIR     Directory of db_exam.txt (default .)\n");
+    printf("  -n, --name PREFIX    Shared memory prefix of the rings (default %s)\n", PIPELINE_DEFAULT_PREFIX);
+    printf("      --slots N        Records per ring (default %d)\n", SHM_RING_DEFAULT_SLOTS);
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"machines", required_argument, NULL, 'm'},
+        {"time-scale", required_argument, NULL, 's'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"name", required_argument, NULL, 'n'},
+        {"slots", required_argument, NULL, 'S'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "m:s:o:n:h";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    int machines = constants.machines;
+    double scale = 0;
+    const char *db_dir = ".";
+    const char *prefix = PIPELINE_DEFAULT_PREFIX;
+    int slots = SHM_RING_DEFAULT_SLOTS;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'm': machines = atoi(optarg); break;
+        case 's': scale = atof(optarg); break;
+        case 'o': db_dir = optarg; break;
+        case 'n': prefix = optarg; break;
+        case 'S': slots = atoi(optarg); break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (machines < 1 || scale < 0 || slots < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/db_exam.txt", db_dir);
+    FILE *exam_file = fopen(path, "w");
+    if (!exam_file) {
+        perror("Failed to open db_exam.txt");
+        return 1;
+    }
+    char name[128];
+    pipeline_ring_name(prefix, "patients", name, sizeof(name));
+    ShmRing *patient_ring = shm_ring_attach(name, SHM_RING_CONSUMER, slots, sizeof(PatientRecord));
+    pipeline_ring_name(prefix, "exams", name, sizeof(name));
+    ShmRing *exam_ring = shm_ring_attach(name, SHM_RING_PRODUCER, slots, sizeof(ExamRecord));
+    if (!patient_ring || !exam_ring) {
+        perror("Failed to attach to the pipeline rings");
+        return 1;
+    }
+
+    log_set_quiet(1);
+    set_time_scale(scale);
+    rng_seed((unsigned int)time(NULL) ^ 0x5a5a);
+    RxPool *pool = create_machines(machines);
+
+    double start = now_seconds();
+    long exams = 0;
+    int upstream_lost = 0;
+    int downstream_lost = 0;
+    PatientRecord patient_record;
+    int size;
+    while ((size = shm_ring_receive(patient_ring, &patient_record, sizeof(patient_record), 1)) > 0) {
+        Patient *patient = unpack_patient(&patient_record);
+        Exam *exam = verify_and_ocupate(pool, patient);
+        destroy_patient(patient);
+        print_exam_db(exam, exam_file);
+
+        ExamRecord exam_record;
+        pack_exam(exam, &exam_record);
+        destroy_exam(exam);
+        exams++;
+        if (shm_ring_send(exam_ring, &exam_record, sizeof(exam_record)) != 0) {
+            downstream_lost = 1; // clinic_report died // clinic_report morreu
+            break;
+        }
+    }
+    upstream_lost = size < 0;
+    shm_ring_finish(exam_ring);
+    double elapsed = now_seconds() - start;
+
+    ShmRingStats in, out;
+    get_shm_ring_stats(patient_ring, &in);
+    get_shm_ring_stats(exam_ring, &out);
+    printf("{\"stage\": \"rx\", \"exams\": %ld, \"machines\": %d, \"seconds\": %.4f, \"records_per_sec\": %.0f,\n"
+           " \"patient_ring\": {\"received\": %ld, \"handoff_mean_us\": %.2f, \"handoff_max_us\": %.2f, \"empty_sleeps\": %ld},\n"
+           " \"exam_ring\": {\"sent\": %ld, \"full_sleeps\": %ld, \"wakes\": %ld}, \"upstream_lost\": %d, \"downstream_lost\": %d}\n",
+           exams, machines, elapsed, exams / (elapsed > 0 ? elapsed : 1),
+           in.records, in.mean_latency_us, in.max_latency_us, in.sleeps,
+           out.records, out.sleeps, out.wakes, upstream_lost, downstream_lost);
+
+    shm_ring_detach(patient_ring);
+    shm_ring_detach(exam_ring);
+    destroy_machines(pool);
+    fclose(exam_file);
+    return upstream_lost || downstream_lost ? 2 : 0;
+}
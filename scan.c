@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include "db_scan.h"
+#include "ai_model.h"
+#include "sim_config.h"
+
+/*
+ * Offline analysis of the db files // Análise offline dos arquivos db
+ *
+ * Maps db_patient.txt, db_exam.txt and db_report.txt and parses each one on every core: the file is cut into
+ * record-aligned chunks, newlines and colons are found 64 bytes at a time, and condition names go through a
+ * perfect hash. Prints the aggregates of print_status() rebuilt from the files, the turnaround percentiles of
+ * each priority, and the parsing throughput.
+ */
+
+#define SCAN_MAX_THREADS 256
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -d, --dir DIR        Directory with the db_*.txt files (default .)\n");
+    printf("  -p, --patients FILE  Patient file (default DIR/db_patient.txt)\n");
+    printf("  -e, --exams FILE     Exam file (default DIR/db_exam.txt)\n");
+    printf("  -r, --reports FILE   Report file (default DIR/db_report.txt)\n");
+    printf("  -t, --threads N      Parser threads, 1 to %d (default: online CPUs)\n", SCAN_MAX_THREADS);
+    printf("  -k, --kernel NAME    simd or scalar (default simd)\n");
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+}
+
+static void print_scan(const DbScanResult *result, int threads, const char *kernel) {
+// The print_status() block, then what only the files can tell // O bloco do print_status(), depois o que só os arquivos contam
+    const StreamStats *all = &result->turnaround[0];
+    printf("\n========== DB Scan Report ==========\n");
+    printf("Total Span:                    %lld seconds\n", result->first_time >= 0 ? result->last_time - result->first_time : 0);
+    printf("Total Patients Arrived:        %ld\n", result->patients);
+    printf("IA Exams Performed:            %ld\n", result->exams);
+    printf("Patients with Doctor's report: %ld%%\n", result->exams > 0 ? result->reports * 100 / result->exams : 0);
+    printf("Mean Turnaround Time:          %.2lf seconds (std dev %.2lf)\n", all->mean, stream_stats_stddev(all));
+    printf("Reports Finalized:             %ld\n", result->reports);
+    printf("Turnarounds over %.3lf wall s:  %ld (file timestamps, not the simulated report delay)\n", sim_config()->report_limit,
+           result->delayed);
+    printf("Reports keeping the IA diagnosis: %ld%% of %ld joined\n", result->matched > 0 ? result->kept * 100 / result->matched : 0, result->matched);
+    printf("Ambiguous joins:               %ld (other exams with the same Exam ID in that second)\n", result->ambiguous);
+
+    printf("\nPriority Turnaround Times (seconds):\n");
+    for (int p = 1; p <= DB_SCAN_PRIORITIES; p++) {
+        const StreamStats *stats = &result->turnaround[p];
+        if (stats->count > 0) {
+            printf("Priority %d, appereances(%ld): mean %.2lf, std dev %.2lf, p50 %d, p90 %d, p99 %d, max %.0lf\n",
+                   p, stats->count, stats->mean, stream_stats_stddev(stats), db_scan_percentile(result, p, 0.50),
+                   db_scan_percentile(result, p, 0.90), db_scan_percentile(result, p, 0.99), stats->max);
+        } else {
+            printf("Priority %d: No reports\n", p);
+        }
+    }
+
+    printf("\nConditions (IA exams / doctor's reports):\n");
+    for (int c = 0; c < DB_SCAN_CONDITIONS; c++) {
+        if (c < AI_CONDITIONS || result->exam_conditions[c] + result->report_conditions[c] > 0) {
+            printf("    %-24s %8ld / %ld\n", c < AI_CONDITIONS ? ai_condition_name(c) : "(unknown)",
+                   result->exam_conditions[c], result->report_conditions[c]);
+        }
+    }
+
+    printf("\nParsed %.1lf MB in %.4lf seconds, %.2lf GB/s (%d threads, %s), %ld malformed records\n",
+           result->bytes / 1e6, result->seconds, result->seconds > 0 ? result->bytes / result->seconds / 1e9 : 0.0,
+           threads, kernel, result->malformed);
+    printf("====================================\n");
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"dir", required_argument, NULL, 'd'},
+        {"patients", required_argument, NULL, 'p'},
+        {"exams", required_argument, NULL, 'e'},
+        {"reports", required_argument, NULL, 'r'},
+        {"threads", required_argument, NULL, 't'},
+        {"kernel", required_argument, NULL, 'k'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "d:p:e:r:t:k:h";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    const char *dir = ".";
+    const char *paths[3] = {NULL, NULL, NULL};
+    static const char *file_names[3] = {"db_patient.txt", "db_exam.txt", "db_report.txt"};
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *kernel_name = "simd";
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'd': dir = optarg; break;
+        case 'p': paths[DB_PATIENTS] = optarg; break;
+        case 'e': paths[DB_EXAMS] = optarg; break;
+        case 'r': paths[DB_REPORTS] = optarg; break;
+        case 't': threads = atoi(optarg); break;
+        case 'k': kernel_name = optarg; break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    int kernel = db_scan_kernel_from_name(kernel_name);
+    if (threads < 1 || threads > SCAN_MAX_THREADS || kernel < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    DbScan *scan = create_db_scan(threads, (DbScanKernel)kernel);
+    char defaults[3][4096];
+    for (int kind = DB_PATIENTS; kind <= DB_REPORTS; kind++) { // Exams before reports, which are joined to them
+        if (!paths[kind]) {
+            snprintf(defaults[kind], sizeof(defaults[kind]), "%s/%s", dir, file_names[kind]);
+            paths[kind] = defaults[kind];
+        }
+        if (db_scan_file(scan, (DbKind)kind, paths[kind]) != 0) {
+            printf("Warning: %s could not be read, skipped\n", paths[kind]);
+        }
+    }
+    DbScanResult *result = (DbScanResult*)malloc(sizeof(DbScanResult));
+    if (!result) {
+        printf("\nError: Memory allocation failed (DB Scan result)\n");
+        exit(1);
+    }
+    get_db_scan_result(scan, result);
+    print_scan(result, threads, kernel_name);
+    free(result);
+    destroy_db_scan(scan);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "seqlock.h"
+#include <stdint.h>
+#include <sched.h>
+
+static void copy_in(void *shared, const void *value, size_t size) {
+// Relaxed atomic stores, one word at a time // Stores atômicos relaxados, uma palavra por vez
+    uint64_t *to = (uint64_t*)shared;
+    const uint64_t *from = (const uint64_t*)value;
+    size_t words = size / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        __atomic_store_n(&to[i], from[i], __ATOMIC_RELAXED);
+    }
+    unsigned char *to_tail = (unsigned char*)(to + words);
+    const unsigned char *from_tail = (const unsigned char*)(from + words);
+    for (size_t i = 0; i < size % sizeof(uint64_t); i++) {
+        __atomic_store_n(&to_tail[i], from_tail[i], __ATOMIC_RELAXED);
+    }
+}
+
+static void copy_out(void *value, const void *shared, size_t size) {
+// Relaxed atomic loads, one word at a time // Loads atômicos relaxados, uma palavra por vez
+    uint64_t *to = (uint64_t*)value;
+    const uint64_t *from = (const uint64_t*)shared;
+    size_t words = size / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+    unsigned char *to_tail = (unsigned char*)(to + words);
+    const unsigned char *from_tail = (const unsigned char*)(from + words);
+    for (size_t i = 0; i < size % sizeof(uint64_t); i++) {
+        to_tail[i] = __atomic_load_n(&from_tail[i], __ATOMIC_RELAXED);
+    }
+}
+
+void seqlock_init(SeqLock *lock) {
+/**
+ * \brief Initialize the lock // Inicializa o lock
+ */
+    atomic_init(&lock->sequence, 0);
+}
+
+void seqlock_write(SeqLock *lock, void *shared, const void *value, size_t size) {
+/**
+ * \brief Publish a new value (single writer) // Publica um novo valor (escritor único)
+ *
+ * \details The fence keeps the odd sequence ahead of the data, the release store keeps the data ahead of the even one.
+ * \details A barreira mantém a sequência ímpar antes dos dados, o store release mantém os dados antes da par.
+ */
+    unsigned int sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    atomic_store_explicit(&lock->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    copy_in(shared, value, size);
+    atomic_store_explicit(&lock->sequence, sequence + 2, memory_order_release);
+}
+
+int seqlock_read(SeqLock *lock, void *value, const void *shared, size_t size) {
+/**
+ * \brief Copy a consistent value (any thread) // Copia um valor consistente (qualquer thread)
+ *
+ * \return int - Number of retries // Número de repetições
+ */
+    int retries = 0;
+    for (;;) {
+        unsigned int before = atomic_load_explicit(&lock->sequence, memory_order_acquire);
+        if (!(before & 1)) {
+            copy_out(value, shared, size);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&lock->sequence, memory_order_relaxed) == before) {
+                return retries;
+            }
+        }
+        retries++;
+        sched_yield(); // The writer may be preempted mid-copy on a single core // O escritor pode ter sido interrompido no meio da cópia
+    }
+}
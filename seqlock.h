@@ -0,0 +1,50 @@
+#ifndef SEQLOCK_H_INCLUDED
+#define SEQLOCK_H_INCLUDED
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * \brief Sequence lock guarding one value with a single writer // Lock de sequência que protege um valor com um único escritor
+ *
+ * \details The writer never waits: it makes the sequence odd, copies the value in and makes it even again.
+ *          Readers never block the writer: they copy the value out and retry if the sequence was odd or moved
+ *          meanwhile. Both copies go word by word through relaxed atomics, so a torn read is thrown away
+ *          instead of being undefined. The value must be 8-byte aligned.
+ * \details O escritor nunca espera: torna a sequência ímpar, copia o valor e a torna par de novo.
+ *          Leitores nunca bloqueiam o escritor: copiam o valor e repetem se a sequência era ímpar ou mudou
+ *          no meio. As duas cópias passam palavra a palavra por atômicos relaxados. O valor deve ter alinhamento de 8 bytes.
+ */
+typedef struct seqlock {
+    atomic_uint sequence;   // Odd while a write is in progress // Ímpar durante uma escrita
+} SeqLock;
+
+/**
+ * \brief Initialize the lock // Inicializa o lock
+ *
+ * \param lock - Pointer to the lock // Ponteiro para o lock
+ */
+void seqlock_init(SeqLock *lock);
+
+/**
+ * \brief Publish a new value (single writer) // Publica um novo valor (escritor único)
+ *
+ * \param lock - Pointer to the lock // Ponteiro para o lock
+ * \param shared - Value read by the other threads // Valor lido pelas outras threads
+ * \param value - New value, private to the writer // Novo valor, privado do escritor
+ * \param size - Bytes of the value // Bytes do valor
+ */
+void seqlock_write(SeqLock *lock, void *shared, const void *value, size_t size);
+
+/**
+ * \brief Copy a consistent value (any thread) // Copia um valor consistente (qualquer thread)
+ *
+ * \param lock - Pointer to the lock // Ponteiro para o lock
+ * \param value - Receives the value // Recebe o valor
+ * \param shared - Value published by seqlock_write() // Valor publicado por seqlock_write()
+ * \param size - Bytes of the value // Bytes do valor
+ * \return Number of retries, 0 if no write got in the way // Número de repetições, 0 se nenhuma escrita atrapalhou
+ */
+int seqlock_read(SeqLock *lock, void *value, const void *shared, size_t size);
+
+#endif // SEQLOCK_H_INCLUDED
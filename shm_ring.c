@@ -0,0 +1,333 @@
+#include "shm_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define SHM_RING_MAGIC 0x52584d43u   // "CMXR", set last by the creator // Gravado por último por quem cria
+#define SHM_RING_LINE 64
+
+// Lives at the start of the shared memory; every field is shared by both processes // Fica no início da memória compartilhada
+typedef struct shm_ring_header {
+    _Alignas(SHM_RING_LINE) _Atomic uint32_t magic;
+    int32_t record_size;
+    int64_t slots;
+    int64_t stride;                       // Bytes per slot, a multiple of the cache line // Bytes por posição
+    _Atomic int32_t producer_pid;         // 0 until the producer attaches // 0 até o produtor se conectar
+    _Atomic int32_t consumer_pid;
+    _Atomic int32_t finished;             // The producer sent its last record // O produtor enviou o último registro
+
+    // Written by the consumer // Escrito pelo consumidor
+    _Alignas(SHM_RING_LINE) _Atomic int64_t head;
+    _Atomic uint32_t space_seq;           // Futex word the producer sleeps on // Palavra de futex em que o produtor dorme
+    _Atomic uint32_t producer_sleeping;
+
+    // Written by the producer // Escrito pelo produtor
+    _Alignas(SHM_RING_LINE) _Atomic int64_t tail;
+    _Atomic uint32_t data_seq;            // Futex word the consumer sleeps on // Palavra de futex em que o consumidor dorme
+    _Atomic uint32_t consumer_sleeping;
+} ShmRingHeader;
+
+typedef struct shm_slot {
+    uint32_t size;
+    uint32_t unused;
+    int64_t sent_ns;                      // CLOCK_MONOTONIC when sent, for the hand-off latency // Instante do envio
+    unsigned char data[];
+} ShmSlot;
+
+struct shm_ring {
+    ShmRingHeader *header;
+    unsigned char *slots;
+    size_t mapped;
+    ShmRingRole role;
+    char name[128];
+    ShmRingStats stats;
+    double latency_sum_us;
+};
+
+static int64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static void futex_wait(_Atomic uint32_t *word, uint32_t expected, double seconds) {
+// Process shared FUTEX_WAIT: returns at once if *word != expected // FUTEX_WAIT compartilhado entre processos
+    struct timespec timeout = {(time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9)};
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t *word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static int process_alive(int32_t pid) {
+// A side that never attached counts as alive: it may still come // Um lado que nunca se conectou conta como vivo
+    return pid == 0 || kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static ShmSlot *slot_at(ShmRing *ring, int64_t index) {
+    return (ShmSlot*)(ring->slots + (index & (ring->header->slots - 1)) * ring->header->stride);
+}
+
+static ShmRingHeader *map_existing(int fd, size_t *mapped) {
+// Maps a ring someone else created, once its creator finished initializing it // Mapeia um anel criado por outro processo
+    struct stat info;
+    for (int tries = 0; tries < 1000; tries++) {
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(ShmRingHeader)) {
+            ShmRingHeader *header = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (header == MAP_FAILED) {
+                return NULL;
+            }
+            if (atomic_load_explicit(&header->magic, memory_order_acquire) == SHM_RING_MAGIC) {
+                *mapped = info.st_size;
+                return header;
+            }
+            munmap(header, info.st_size);
+        }
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+    errno = ETIMEDOUT;
+    return NULL;
+}
+
+ShmRing *shm_ring_attach(const char *name, ShmRingRole role, int slots, int record_size) {
+/**
+ * \brief Attach to a ring, creating it if this process comes first // Conecta a um anel, criando-o se este processo vier primeiro
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ShmRing* - Pointer to the ring, NULL on error (errno set) // Ponteiro para o anel, NULL em caso de erro
+ */
+    if (!name || slots < 1 || record_size < 1 || strlen(name) >= sizeof(((ShmRing*)0)->name)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    ShmRing *ring = (ShmRing*)calloc(1, sizeof(ShmRing));
+    if (!ring) {
+        printf("\nError: Memory allocation failed (Shared Memory Ring)\n");
+        exit(1);
+    }
+    ring->role = role;
+    strcpy(ring->name, name);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            int64_t count = 1;
+            while (count < slots) {
+                count <<= 1;
+            }
+            int64_t stride = (sizeof(ShmSlot) + record_size + SHM_RING_LINE - 1) / SHM_RING_LINE * SHM_RING_LINE;
+            size_t size = sizeof(ShmRingHeader) + count * stride;
+            ShmRingHeader *header = MAP_FAILED;
+            if (ftruncate(fd, size) == 0) {
+                header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if (header == MAP_FAILED) {
+                shm_unlink(name);
+                free(ring);
+                return NULL;
+            }
+            // ftruncate zeroed the memory: only the geometry and the magic need setting
+            header->record_size = record_size;
+            header->slots = count;
+            header->stride = stride;
+            atomic_store_explicit(&header->magic, SHM_RING_MAGIC, memory_order_release);
+            ring->header = header;
+            ring->mapped = size;
+        } else if (errno == EEXIST) {
+            fd = shm_open(name, O_RDWR, 0600);
+            if (fd < 0) {
+                continue; // Removed in between, create it // Removido nesse meio tempo, cria
+            }
+            ring->header = map_existing(fd, &ring->mapped);
+            close(fd);
+            if (!ring->header) {
+                free(ring);
+                return NULL;
+            }
+            if (ring->header->record_size != record_size) {
+                munmap(ring->header, ring->mapped);
+                free(ring);
+                errno = EINVAL;
+                return NULL;
+            }
+        } else {
+            free(ring);
+            return NULL;
+        }
+
+        // Take the role; a dead holder means the ring is left over from a crashed run // Assume o papel
+        _Atomic int32_t *holder = role == SHM_RING_PRODUCER ? &ring->header->producer_pid : &ring->header->consumer_pid;
+        int32_t expected = 0;
+        if (atomic_compare_exchange_strong(holder, &expected, (int32_t)getpid())) {
+            ring->slots = (unsigned char*)ring->header + sizeof(ShmRingHeader);
+            return ring;
+        }
+        munmap(ring->header, ring->mapped);
+        ring->header = NULL;
+        if (process_alive(expected)) {
+            free(ring);
+            errno = EBUSY;
+            return NULL;
+        }
+        shm_unlink(name);
+    }
+    free(ring);
+    errno = EBUSY;
+    return NULL;
+}
+
+void shm_ring_detach(ShmRing *ring) {
+/**
+ * \brief Detach from the ring; the consumer also removes its name // Desconecta do anel; o consumidor também remove o nome
+ */
+    if (!ring) {
+        return;
+    }
+    if (ring->role == SHM_RING_CONSUMER) {
+        shm_unlink(ring->name); // The mapping of a producer still attached stays valid // O mapeamento do produtor continua válido
+    }
+    munmap(ring->header, ring->mapped);
+    free(ring);
+}
+
+int shm_ring_send(ShmRing *ring, const void *record, int size) {
+/**
+ * \brief Copy a record into the ring, waiting while it is full (producer only) // Copia um registro para o anel, esperando enquanto estiver cheio
+ *
+ * \return int - 0 when sent, -1 if the consumer died or the record is too big // 0 se enviado, -1 se o consumidor morreu ou o registro é grande demais
+ */
+    ShmRingHeader *header = ring->header;
+    if (size < 0 || size > header->record_size) {
+        return -1;
+    }
+    int64_t tail = atomic_load_explicit(&header->tail, memory_order_relaxed);
+
+    for (long spins = 0; tail - atomic_load_explicit(&header->head, memory_order_acquire) >= header->slots; spins++) {
+        if (spins < SHM_RING_SPIN) {
+            continue;
+        }
+        uint32_t seq = atomic_load_explicit(&header->space_seq, memory_order_acquire);
+        atomic_store(&header->producer_sleeping, 1);
+        if (tail - atomic_load(&header->head) < header->slots) {
+            atomic_store(&header->producer_sleeping, 0);
+            break;
+        }
+        futex_wait(&header->space_seq, seq, SHM_RING_PEER_CHECK);
+        atomic_store(&header->producer_sleeping, 0);
+        ring->stats.sleeps++;
+        if (!process_alive(atomic_load(&header->consumer_pid))) {
+            return -1;
+        }
+    }
+
+    ShmSlot *slot = slot_at(ring, tail);
+    memcpy(slot->data, record, size);
+    slot->size = (uint32_t)size;
+    slot->sent_ns = monotonic_ns();
+    atomic_store(&header->tail, tail + 1); // Sequentially consistent: ordered before reading consumer_sleeping
+    if (atomic_load(&header->consumer_sleeping)) {
+        atomic_fetch_add(&header->data_seq, 1);
+        futex_wake(&header->data_seq);
+        ring->stats.wakes++;
+    }
+    ring->stats.records++;
+    return 0;
+}
+
+void shm_ring_finish(ShmRing *ring) {
+/**
+ * \brief Mark the end of the stream and wake the consumer (producer only) // Marca o fim do fluxo e acorda o consumidor
+ */
+    atomic_store(&ring->header->finished, 1);
+    atomic_fetch_add(&ring->header->data_seq, 1);
+    futex_wake(&ring->header->data_seq);
+}
+
+int shm_ring_receive(ShmRing *ring, void *record, int max_size, int wait) {
+/**
+ * \brief Copy the oldest record out of the ring (consumer only) // Copia o registro mais antigo do anel (somente o consumidor)
+ *
+ * \return int - Size of the record, 0 if empty without waiting or at the end of the stream, -1 if the producer died
+ *               // Tamanho do registro, 0 se vazio sem espera ou no fim, -1 se o produtor morreu
+ */
+    ShmRingHeader *header = ring->header;
+    int64_t head = atomic_load_explicit(&header->head, memory_order_relaxed);
+
+    for (long spins = 0; atomic_load_explicit(&header->tail, memory_order_acquire) == head; spins++) {
+        if (atomic_load(&header->finished)) {
+            if (atomic_load(&header->tail) == head) {
+                return 0;
+            }
+            break;
+        }
+        if (!wait) {
+            return 0;
+        }
+        if (spins < SHM_RING_SPIN) {
+            continue;
+        }
+        uint32_t seq = atomic_load_explicit(&header->data_seq, memory_order_acquire);
+        atomic_store(&header->consumer_sleeping, 1);
+        if (atomic_load(&header->tail) != head || atomic_load(&header->finished)) {
+            atomic_store(&header->consumer_sleeping, 0);
+            continue;
+        }
+        futex_wait(&header->data_seq, seq, SHM_RING_PEER_CHECK);
+        atomic_store(&header->consumer_sleeping, 0);
+        ring->stats.sleeps++;
+        if (atomic_load(&header->tail) == head && !atomic_load(&header->finished) &&
+            !process_alive(atomic_load(&header->producer_pid))) {
+            return -1;
+        }
+    }
+
+    ShmSlot *slot = slot_at(ring, head);
+    int size = (int)slot->size;
+    double latency_us = (monotonic_ns() - slot->sent_ns) / 1e3;
+    memcpy(record, slot->data, size < max_size ? size : max_size);
+    atomic_store(&header->head, head + 1); // The slot may be reused from now on // A posição pode ser reutilizada
+    if (atomic_load(&header->producer_sleeping)) {
+        atomic_fetch_add(&header->space_seq, 1);
+        futex_wake(&header->space_seq);
+        ring->stats.wakes++;
+    }
+
+    ring->stats.records++;
+    ring->latency_sum_us += latency_us;
+    if (latency_us > ring->stats.max_latency_us) {
+        ring->stats.max_latency_us = latency_us;
+    }
+    return size;
+}
+
+int shm_ring_finished(ShmRing *ring) {
+/**
+ * \brief Whether the producer finished and every record was received // Se o produtor terminou e todos os registros foram recebidos
+ */
+    ShmRingHeader *header = ring->header;
+    return atomic_load(&header->finished) && atomic_load(&header->tail) == atomic_load(&header->head);
+}
+
+void get_shm_ring_stats(ShmRing *ring, ShmRingStats *stats) {
+/**
+ * \brief Copy the counters of this side // Copia os contadores deste lado
+ */
+    *stats = ring->stats;
+    stats->mean_latency_us = ring->stats.records > 0 && ring->role == SHM_RING_CONSUMER ?
+                             ring->latency_sum_us / ring->stats.records : 0.0;
+}
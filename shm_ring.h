@@ -0,0 +1,107 @@
+#ifndef SHM_RING_H_INCLUDED
+#define SHM_RING_H_INCLUDED
+
+#define SHM_RING_DEFAULT_SLOTS 4096
+#define SHM_RING_SPIN 2000          // Empty or full checks before sleeping on the futex // Verificações antes de dormir no futex
+#define SHM_RING_PEER_CHECK 0.100   // Seconds between checks that the other process is alive // Segundos entre verificações do outro processo
+
+/**
+ * \brief Side of the ring a process attaches as // Lado do anel com que um processo se conecta
+ */
+typedef enum shm_ring_role {
+    SHM_RING_PRODUCER,
+    SHM_RING_CONSUMER
+} ShmRingRole;
+
+/**
+ * \brief Hand-off counters seen by one side // Contadores de entrega vistos por um lado
+ */
+typedef struct shm_ring_stats {
+    long records;            // Records sent or received // Registros enviados ou recebidos
+    long sleeps;             // Futex waits after spinning // Esperas no futex depois de girar
+    long wakes;              // Futex wakes issued (producer: for the consumer, consumer: for the producer) // Despertares emitidos
+    double mean_latency_us;  // Consumer: send to receive, microseconds // Consumidor: do envio ao recebimento, microssegundos
+    double max_latency_us;
+} ShmRingStats;
+
+/**
+ * \brief Bounded ring of fixed size records in POSIX shared memory, one producer and one consumer process
+ *        // Anel limitado de registros de tamanho fixo em memória compartilhada POSIX, um processo produtor e um consumidor
+ *
+ * \details shm_open + mmap; the indices are C11 atomics on separate cache lines. A side spins SHM_RING_SPIN times
+ *          on an empty or full ring, then sleeps on a shared futex word; the other side issues FUTEX_WAKE only when
+ *          someone sleeps, so a busy pipeline makes no system calls. A sleeper checks every SHM_RING_PEER_CHECK
+ *          seconds that the other process is still alive, so a crash upstream or downstream ends the wait with an
+ *          error instead of a hang.
+ * \details shm_open + mmap; índices atômicos em linhas de cache separadas. Um lado gira SHM_RING_SPIN vezes e então
+ *          dorme num futex compartilhado; o outro só faz FUTEX_WAKE se alguém dorme. Quem dorme verifica a cada
+ *          SHM_RING_PEER_CHECK segundos se o outro processo ainda vive.
+ */
+typedef struct shm_ring ShmRing;
+
+/**
+ * \brief Attach to a ring, creating it if this process comes first // Conecta a um anel, criando-o se este processo vier primeiro
+ *
+ * \details A ring left behind by processes that are all dead is removed and created again.
+ * \details Um anel deixado por processos que já morreram é removido e criado de novo.
+ * \param name - Shared memory name, starting with '/' // Nome da memória compartilhada, começando com '/'
+ * \param role - SHM_RING_PRODUCER or SHM_RING_CONSUMER; one process per role // Um processo por papel
+ * \param slots - Records the ring holds, rounded up to a power of two (used only by the creator) // Registros que o anel guarda
+ * \param record_size - Largest record in bytes; both sides must agree // Maior registro em bytes; os dois lados devem concordar
+ * \return Pointer to the ring, NULL on error (errno set) // Ponteiro para o anel, NULL em caso de erro
+ */
+ShmRing *shm_ring_attach(const char *name, ShmRingRole role, int slots, int record_size);
+
+/**
+ * \brief Detach from the ring; the consumer also removes its name // Desconecta do anel; o consumidor também remove o nome
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ */
+void shm_ring_detach(ShmRing *ring);
+
+/**
+ * \brief Copy a record into the ring, waiting while it is full (producer only) // Copia um registro para o anel, esperando enquanto estiver cheio
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ * \param record - Bytes to send // Bytes a enviar
+ * \param size - Bytes, up to the record size of the ring // Bytes, até o tamanho de registro do anel
+ * \return 0 when sent, -1 if the consumer died or the record is too big // 0 se enviado, -1 se o consumidor morreu ou o registro é grande demais
+ */
+int shm_ring_send(ShmRing *ring, const void *record, int size);
+
+/**
+ * \brief Mark the end of the stream and wake the consumer (producer only) // Marca o fim do fluxo e acorda o consumidor
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ */
+void shm_ring_finish(ShmRing *ring);
+
+/**
+ * \brief Copy the oldest record out of the ring (consumer only) // Copia o registro mais antigo do anel (somente o consumidor)
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ * \param record - Receives the bytes // Recebe os bytes
+ * \param max_size - Room in `record` // Espaço em `record`
+ * \param wait - 1 waits for a record, 0 returns at once when the ring is empty // 1 espera um registro, 0 retorna se vazio
+ * \return Size of the record; 0 if the ring is empty and `wait` is 0, or at the end of the stream;
+ *         -1 if the producer died without finishing // Tamanho do registro; 0 se vazio sem espera ou no fim; -1 se o produtor morreu
+ */
+int shm_ring_receive(ShmRing *ring, void *record, int max_size, int wait);
+
+/**
+ * \brief Whether the producer finished and every record was received // Se o produtor terminou e todos os registros foram recebidos
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ * \return 1 at the end of the stream, 0 otherwise // 1 no fim do fluxo, 0 caso contrário
+ */
+int shm_ring_finished(ShmRing *ring);
+
+/**
+ * \brief Copy the counters of this side // Copia os contadores deste lado
+ *
+ * \param ring - Pointer to the ring // Ponteiro para o anel
+ * \param stats - Receives the counters // Recebe os contadores
+ */
+void get_shm_ring_stats(ShmRing *ring, ShmRingStats *stats);
+
+#endif // SHM_RING_H_INCLUDED
@@ -0,0 +1,200 @@
+#include "shutdown.h"
+#include "time_control.h"
+#include "logger.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+static const char *stage_labels[SHUTDOWN_STAGE_COUNT] = {"Patients", "Exams", "Reports"};
+
+struct shutdown_control {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;        // Broadcast on every phase change, on CLOCK_MONOTONIC // Sinalizada a cada mudança de fase
+    ShutdownPhase phase;
+    double drain_deadline;
+    double drain_started;          // Simulated time the intake closed // Tempo simulado do fechamento da entrada
+    StageAccount accounts[SHUTDOWN_STAGE_COUNT];
+};
+
+ShutdownControl *create_shutdown(double drain_deadline) {
+/**
+ * \brief Create the shutdown state, in SHUTDOWN_RUNNING // Cria o estado de encerramento, em SHUTDOWN_RUNNING
+ *
+ * \param drain_deadline - Simulated seconds the stages get to drain once the intake closes // Segundos simulados para esvaziar os estágios
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return ShutdownControl* - Pointer to the state // Ponteiro para o estado
+ */
+    ShutdownControl *control = (ShutdownControl*)calloc(1, sizeof(ShutdownControl));
+    if (!control) {
+        printf("\nError: Memory allocation failed (Shutdown)\n");
+        exit(1);
+    }
+
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&control->changed, &attributes);
+    pthread_condattr_destroy(&attributes);
+    pthread_mutex_init(&control->mutex, NULL);
+
+    control->phase = SHUTDOWN_RUNNING;
+    control->drain_deadline = drain_deadline > 0 ? drain_deadline : 0;
+    return control;
+}
+
+void destroy_shutdown(ShutdownControl *control) {
+/**
+ * \brief Free the shutdown state // Libera o estado de encerramento
+ */
+    if (!control) {
+        return;
+    }
+    pthread_mutex_destroy(&control->mutex);
+    pthread_cond_destroy(&control->changed);
+    free(control);
+}
+
+static void set_phase(ShutdownControl *control, ShutdownPhase phase) {
+// Phases only move forward // As fases só avançam
+    pthread_mutex_lock(&control->mutex);
+    if (phase > control->phase) {
+        control->phase = phase;
+        pthread_cond_broadcast(&control->changed);
+    }
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void shutdown_begin_drain(ShutdownControl *control, double now) {
+/**
+ * \brief Close the intake and wake the sleepers waiting for it // Fecha a entrada e acorda quem espera por isso
+ */
+    pthread_mutex_lock(&control->mutex);
+    if (control->phase == SHUTDOWN_RUNNING) {
+        control->drain_started = now;
+    }
+    pthread_mutex_unlock(&control->mutex);
+    set_phase(control, SHUTDOWN_DRAINING);
+    LOG_INFO(LOG_CAT_SIM, "\nClinic closed to new patients, draining for up to %.1lf s...", control->drain_deadline);
+}
+
+int shutdown_deadline_passed(ShutdownControl *control, double now) {
+/**
+ * \brief Check whether the drain deadline passed // Verifica se o prazo de esvaziamento passou
+ *
+ * \return int - 1 while draining past the deadline, 0 otherwise // 1 se esvaziando além do prazo, 0 caso contrário
+ */
+    pthread_mutex_lock(&control->mutex);
+    int passed = control->phase != SHUTDOWN_RUNNING && now - control->drain_started >= control->drain_deadline;
+    pthread_mutex_unlock(&control->mutex);
+    return passed;
+}
+
+void shutdown_abandon(ShutdownControl *control) {
+/**
+ * \brief Give up on what is left and wake every sleeper // Abandona o que sobrou e acorda todos
+ */
+    set_phase(control, SHUTDOWN_ABANDONING);
+}
+
+ShutdownPhase shutdown_phase(ShutdownControl *control) {
+/**
+ * \brief Current phase // Fase atual
+ */
+    pthread_mutex_lock(&control->mutex);
+    ShutdownPhase phase = control->phase;
+    pthread_mutex_unlock(&control->mutex);
+    return phase;
+}
+
+int shutdown_sleep(ShutdownControl *control, double seconds, ShutdownPhase wake_phase) {
+/**
+ * \brief my_sleep() that returns early when the shutdown reaches a phase // my_sleep() que retorna antes quando o encerramento chega a uma fase
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param seconds - Simulated seconds to sleep // Segundos simulados a dormir
+ * \param wake_phase - Phase that interrupts the sleep // Fase que interrompe o sono
+ *
+ * \return int - 0 if the whole delay passed, -1 if the shutdown interrupted it // 0 se o atraso inteiro passou, -1 se foi interrompido
+ */
+    seconds *= get_time_scale();
+    if (seconds > 0) {
+        log_flush(); // Same as my_sleep(): a thread going idle hands its log records over first
+    }
+
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    if (seconds > 0) {
+        long nanoseconds = until.tv_nsec + (long)((seconds - (time_t)seconds) * 1e9);
+        until.tv_sec += (time_t)seconds + nanoseconds / 1000000000L;
+        until.tv_nsec = nanoseconds % 1000000000L;
+    }
+
+    pthread_mutex_lock(&control->mutex);
+    int interrupted = 0;
+    while (!(interrupted = control->phase >= wake_phase) && seconds > 0) {
+        if (pthread_cond_timedwait(&control->changed, &control->mutex, &until) == ETIMEDOUT) {
+            interrupted = control->phase >= wake_phase;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&control->mutex);
+    return interrupted ? -1 : 0;
+}
+
+void shutdown_count_done(ShutdownControl *control, ShutdownStage stage) {
+/**
+ * \brief Count one item done by a stage, as finished or drained depending on the phase // Conta um item concluído por um estágio
+ */
+    pthread_mutex_lock(&control->mutex);
+    if (control->phase == SHUTDOWN_RUNNING) {
+        control->accounts[stage].finished++;
+    } else {
+        control->accounts[stage].drained++;
+    }
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void shutdown_count_abandoned(ShutdownControl *control, ShutdownStage stage, long count) {
+/**
+ * \brief Count items a stage gave up // Conta itens abandonados por um estágio
+ */
+    pthread_mutex_lock(&control->mutex);
+    control->accounts[stage].abandoned += count;
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void get_stage_account(ShutdownControl *control, ShutdownStage stage, StageAccount *account) {
+/**
+ * \brief Copy the account of a stage // Copia a contabilidade de um estágio
+ */
+    pthread_mutex_lock(&control->mutex);
+    *account = control->accounts[stage];
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void set_stage_account(ShutdownControl *control, ShutdownStage stage, const StageAccount *account) {
+/**
+ * \brief Replace the account of a stage // Substitui a contabilidade de um estágio
+ */
+    pthread_mutex_lock(&control->mutex);
+    control->accounts[stage] = *account;
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void print_shutdown_report(ShutdownControl *control) {
+/**
+ * \brief Print the finished, drained and abandoned counters of every stage // Imprime os contadores de cada estágio
+ */
+    printf("\nShutdown (drain deadline %.1lf s):\n", control->drain_deadline);
+    for (int stage = 0; stage < SHUTDOWN_STAGE_COUNT; stage++) {
+        StageAccount account;
+        get_stage_account(control, (ShutdownStage)stage, &account);
+        printf("%-10s finished %ld, drained %ld, abandoned %ld\n",
+               stage_labels[stage], account.finished, account.drained, account.abandoned);
+    }
+}
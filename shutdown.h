@@ -0,0 +1,135 @@
+#ifndef SHUTDOWN_H_INCLUDED
+#define SHUTDOWN_H_INCLUDED
+
+/**
+ * \brief Phases of the end of a simulation // Fases do fim de uma simulação
+ */
+typedef enum shutdown_phase {
+    SHUTDOWN_RUNNING,     // Intake open // Entrada aberta
+    SHUTDOWN_DRAINING,    // Intake closed, the stages finish what they hold // Entrada fechada, os estágios terminam o que têm
+    SHUTDOWN_ABANDONING   // Drain deadline passed, whatever is left is given up // Prazo esgotado, o que sobrou é abandonado
+} ShutdownPhase;
+
+/**
+ * \brief Pipeline stages accounted at shutdown // Estágios do pipeline contabilizados no encerramento
+ */
+typedef enum shutdown_stage {
+    SHUTDOWN_STAGE_PATIENTS,   // Patients waiting for a machine // Pacientes esperando uma máquina
+    SHUTDOWN_STAGE_EXAMS,      // Exams waiting for a doctor // Exames esperando um médico
+    SHUTDOWN_STAGE_REPORTS,    // Reports being written // Laudos sendo escritos
+    SHUTDOWN_STAGE_COUNT
+} ShutdownStage;
+
+/**
+ * \brief What happened to the items of one stage // O que aconteceu com os itens de um estágio
+ */
+typedef struct stage_account {
+    long finished;    // Done while the intake was open // Concluídos com a entrada aberta
+    long drained;     // Done after the intake closed // Concluídos depois do fechamento da entrada
+    long abandoned;   // Still there at the drain deadline // Ainda lá no prazo de esvaziamento
+} StageAccount;
+
+// Shutdown protocol state shared by every thread of a run // Estado do protocolo de encerramento compartilhado pelas threads
+typedef struct shutdown_control ShutdownControl;
+
+/**
+ * \brief Create the shutdown state, in SHUTDOWN_RUNNING // Cria o estado de encerramento, em SHUTDOWN_RUNNING
+ *
+ * \param drain_deadline - Simulated seconds the stages get to drain once the intake closes // Segundos simulados para esvaziar os estágios
+ * \return Pointer to the state // Ponteiro para o estado
+ */
+ShutdownControl *create_shutdown(double drain_deadline);
+
+/**
+ * \brief Free the shutdown state, once no thread uses it // Libera o estado, quando nenhuma thread o usa mais
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ */
+void destroy_shutdown(ShutdownControl *control);
+
+/**
+ * \brief Close the intake: move to SHUTDOWN_DRAINING and wake the sleepers waiting for it // Fecha a entrada e acorda quem espera por isso
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param now - Simulated time the drain starts; the deadline counts from here // Tempo simulado do início do esvaziamento
+ */
+void shutdown_begin_drain(ShutdownControl *control, double now);
+
+/**
+ * \brief Check whether the drain deadline passed // Verifica se o prazo de esvaziamento passou
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param now - Current simulated time // Tempo simulado atual
+ * \return 1 while draining past the deadline, 0 otherwise // 1 se esvaziando além do prazo, 0 caso contrário
+ */
+int shutdown_deadline_passed(ShutdownControl *control, double now);
+
+/**
+ * \brief Give up on what is left: move to SHUTDOWN_ABANDONING and wake every sleeper // Abandona o que sobrou e acorda todos
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ */
+void shutdown_abandon(ShutdownControl *control);
+
+/**
+ * \brief Current phase // Fase atual
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \return The ShutdownPhase // A ShutdownPhase
+ */
+ShutdownPhase shutdown_phase(ShutdownControl *control);
+
+/**
+ * \brief my_sleep() that returns early when the shutdown reaches a phase // my_sleep() que retorna antes quando o encerramento chega a uma fase
+ *
+ * \details The delay is scaled by the time scale, like my_sleep(). // O atraso é escalado pela escala de tempo, como no my_sleep().
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param seconds - Simulated seconds to sleep // Segundos simulados a dormir
+ * \param wake_phase - Phase that interrupts the sleep // Fase que interrompe o sono
+ * \return 0 if the whole delay passed, -1 if the shutdown interrupted it // 0 se o atraso inteiro passou, -1 se foi interrompido
+ */
+int shutdown_sleep(ShutdownControl *control, double seconds, ShutdownPhase wake_phase);
+
+/**
+ * \brief Count one item done by a stage, as finished or drained depending on the phase // Conta um item concluído por um estágio
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param stage - ShutdownStage
+ */
+void shutdown_count_done(ShutdownControl *control, ShutdownStage stage);
+
+/**
+ * \brief Count items a stage gave up // Conta itens abandonados por um estágio
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param stage - ShutdownStage
+ * \param count - Number of items // Número de itens
+ */
+void shutdown_count_abandoned(ShutdownControl *control, ShutdownStage stage, long count);
+
+/**
+ * \brief Copy the account of a stage // Copia a contabilidade de um estágio
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param stage - ShutdownStage
+ * \param account - Receives the counters // Recebe os contadores
+ */
+void get_stage_account(ShutdownControl *control, ShutdownStage stage, StageAccount *account);
+
+/**
+ * \brief Replace the account of a stage, when restoring a checkpoint // Substitui a contabilidade de um estágio, ao restaurar um checkpoint
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ * \param stage - ShutdownStage
+ * \param account - Saved counters // Contadores salvos
+ */
+void set_stage_account(ShutdownControl *control, ShutdownStage stage, const StageAccount *account);
+
+/**
+ * \brief Print the finished, drained and abandoned counters of every stage // Imprime os contadores de cada estágio
+ *
+ * \param control - Pointer to the state // Ponteiro para o estado
+ */
+void print_shutdown_report(ShutdownControl *control);
+
+#endif // SHUTDOWN_H_INCLUDED
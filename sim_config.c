@@ -0,0 +1,289 @@
+#include "sim_config.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "stream_stats.h"
+
+#define CONFIG_LINE 512
+
+// The values the simulation always had; 0.08 patients per second is the old 20% chance every ~2.5 s step
+// Os valores que a simulação sempre teve; 0,08 pacientes por segundo é a antiga chance de 20% a cada passo de ~2,5 s
+#define CONFIG_DEFAULTS {43.200, 7.200, 2.000, 3.000, 2.000, 2.150, 0.010, 80, {30, 20, 10, 10, 5, 5, 5, 5, 10}, 5, 0.08, 15.000, \
+                         STREAM_DEFAULT_WINDOW}
+
+typedef enum config_kind {
+    CONFIG_REAL,
+    CONFIG_INTEGER,
+    CONFIG_WEIGHTS
+} ConfigKind;
+
+typedef struct config_key {
+    const char *name;
+    ConfigKind kind;
+    size_t offset;
+    double minimum;
+    double maximum;       // Ignored unless above minimum // Ignorado se não for maior que o mínimo
+    const char *help;
+} ConfigKey;
+
+static const ConfigKey config_keys[] = {
+    {"max_execution", CONFIG_REAL, offsetof(SimConfig, max_execution), 0.001, 0, "Simulated seconds the clinic takes patients"},
+    {"report_limit", CONFIG_REAL, offsetof(SimConfig, report_limit), 0, 0, "Reports taking longer are counted as delayed"},
+    {"step_min", CONFIG_REAL, offsetof(SimConfig, step_min), 0, 0, "Shortest main loop step, in simulated seconds"},
+    {"step_max", CONFIG_REAL, offsetof(SimConfig, step_max), 0, 0, "Longest main loop step"},
+    {"report_factor", CONFIG_REAL, offsetof(SimConfig, report_factor), 0, 0, "Report duration = step * report_factor + report_offset"},
+    {"report_offset", CONFIG_REAL, offsetof(SimConfig, report_offset), 0, 0, "Added to every report duration"},
+    {"exam_time", CONFIG_REAL, offsetof(SimConfig, exam_time), 0, 0, "Seconds of an exam on a speed 1 machine"},
+    {"ai_keep_percent", CONFIG_INTEGER, offsetof(SimConfig, ai_keep_percent), 0, 100, "Chance the doctor keeps the AI diagnosis"},
+    {"diagnosis_weights", CONFIG_WEIGHTS, offsetof(SimConfig, diagnosis_weights), 0, 0,
+     "Normal, bronchitis, pneumonia, COVID, embolism, effusion, fibrosis, tuberculosis, cancer"},
+    {"machines", CONFIG_INTEGER, offsetof(SimConfig, machines), 1, 0, "X-Ray machines"},
+    {"arrival_rate", CONFIG_REAL, offsetof(SimConfig, arrival_rate), 0.0001, 0, "Mean patients per simulated second"},
+    {"drain_deadline", CONFIG_REAL, offsetof(SimConfig, drain_deadline), 0, 0, "Simulated seconds to drain the clinic after closing"},
+    {"stats_window", CONFIG_REAL, offsetof(SimConfig, stats_window), 0.001, 0, "Simulated seconds behind the live report statistics"},
+};
+
+static SimConfig installed = CONFIG_DEFAULTS; // Read by every thread, written only before they start
+
+void sim_config_defaults(SimConfig *config) {
+/**
+ * \brief The built-in values // Os valores de fábrica
+ */
+    static const SimConfig defaults = CONFIG_DEFAULTS;
+    *config = defaults;
+}
+
+static int parse_number(const char *text, const ConfigKey *key, double *number) {
+// A number within the key's range // Um número dentro do intervalo da chave
+    char *end;
+    *number = strtod(text, &end);
+    while (isspace((unsigned char)*end)) {
+        end++;
+    }
+    if (end == text || *end != '\0' || *number < key->minimum) {
+        return -1;
+    }
+    if (key->maximum > key->minimum && *number > key->maximum) {
+        return -1;
+    }
+    if (key->kind == CONFIG_INTEGER && *number != (double)(int)*number) {
+        return -1;
+    }
+    return 0;
+}
+
+int sim_config_set(SimConfig *config, const char *key, const char *value) {
+/**
+ * \brief Set one value from its text // Define um valor a partir do seu texto
+ *
+ * \return int - 0 on success, -1 for an unknown key or a bad value // 0 em sucesso, -1 para chave desconhecida ou valor inválido
+ */
+    for (size_t i = 0; i < sizeof(config_keys) / sizeof(config_keys[0]); i++) {
+        const ConfigKey *entry = &config_keys[i];
+        if (strcmp(entry->name, key) != 0) {
+            continue;
+        }
+        char *field = (char*)config + entry->offset;
+        double number;
+        switch (entry->kind) {
+        case CONFIG_REAL:
+            if (parse_number(value, entry, &number) != 0) {
+                return -1;
+            }
+            *(double*)field = number;
+            return 0;
+        case CONFIG_INTEGER:
+            if (parse_number(value, entry, &number) != 0) {
+                return -1;
+            }
+            *(int*)field = (int)number;
+            return 0;
+        case CONFIG_WEIGHTS: {
+            int weights[CONFIG_DIAGNOSES];
+            int count = 0;
+            char list[CONFIG_LINE];
+            snprintf(list, sizeof(list), "%s", value);
+            for (char *save = NULL, *item = strtok_r(list, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+                if (count == CONFIG_DIAGNOSES || parse_number(item, entry, &number) != 0 || number != (double)(int)number) {
+                    return -1;
+                }
+                weights[count++] = (int)number;
+            }
+            if (count != CONFIG_DIAGNOSES) {
+                return -1;
+            }
+            memcpy(field, weights, sizeof(weights));
+            return 0;
+        }
+        }
+    }
+    return -1;
+}
+
+static char *trim(char *text) {
+// Strips the blanks around `text` // Remove os espaços ao redor de `text`
+    while (isspace((unsigned char)*text)) {
+        text++;
+    }
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+int sim_config_load(SimConfig *config, const char *path) {
+/**
+ * \brief Apply a `key = value` file // Aplica um arquivo `chave = valor`
+ *
+ * \return int - 0 on success, -1 if unreadable, else the first bad line // 0 em sucesso, -1 se ilegível, senão a primeira linha inválida
+ */
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    char line[CONFIG_LINE];
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char *text = trim(line);
+        if (*text == '\0') {
+            continue;
+        }
+        char *equals = strchr(text, '=');
+        if (!equals) {
+            fclose(file);
+            return number;
+        }
+        *equals = '\0';
+        if (sim_config_set(config, trim(text), trim(equals + 1)) != 0) {
+            fclose(file);
+            return number;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+int sim_config_check(const SimConfig *config) {
+/**
+ * \brief Check the values that depend on each other // Verifica os valores que dependem uns dos outros
+ */
+    if (config->step_max < config->step_min) {
+        printf("step_max can't be below step_min\n");
+        return -1;
+    }
+    int total = 0;
+    for (int i = 0; i < CONFIG_DIAGNOSES; i++) {
+        total += config->diagnosis_weights[i];
+    }
+    if (total <= 0) {
+        printf("At least one diagnosis weight must be positive\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int apply_file(SimConfig *config, const char *file) {
+// One --config FILE // Um --config FILE
+    int line = sim_config_load(config, file);
+    if (line < 0) {
+        printf("Can't read the configuration %s\n", file);
+        return -1;
+    }
+    if (line > 0) {
+        printf("%s:%d: unknown key or invalid value\n", file, line);
+        return -1;
+    }
+    return 0;
+}
+
+static int apply_assignment(SimConfig *config, const char *assignment) {
+// One --set KEY=VALUE // Um --set KEY=VALUE
+    char key[CONFIG_LINE];
+    const char *equals = strchr(assignment, '=');
+    size_t length = equals ? (size_t)(equals - assignment) : 0;
+    if (!equals || length >= sizeof(key)) {
+        printf("--set takes KEY=VALUE: %s\n", assignment);
+        return -1;
+    }
+    memcpy(key, assignment, length);
+    key[length] = '\0';
+    if (sim_config_set(config, key, equals + 1) != 0) {
+        printf("Unknown key or invalid value: %s\n", assignment);
+        return -1;
+    }
+    return 0;
+}
+
+int sim_config_from_arguments(SimConfig *config, int argc, char *argv[], const char *short_options,
+                              const struct option *long_options) {
+/**
+ * \brief Defaults, then every --config FILE and --set KEY=VALUE, in command line order // Padrões, depois cada --config e --set, em ordem
+ *
+ * \return int - 0 on success, -1 after printing the error // 0 em sucesso, -1 depois de imprimir o erro
+ */
+    sim_config_defaults(config);
+    int reported = opterr;
+    opterr = 0; // The program's own pass reports the bad options // A passada do programa relata as opções inválidas
+    optind = 1;
+    int status = 0;
+    int option;
+    while (status == 0 && (option = getopt_long(argc, argv, short_options, long_options, NULL)) != -1) {
+        if (option == CONFIG_OPTION_FILE) {
+            status = apply_file(config, optarg);
+        } else if (option == CONFIG_OPTION_SET) {
+            status = apply_assignment(config, optarg);
+        }
+    }
+    opterr = reported;
+    optind = 0; // getopt_long() starts over for the program's loop // O getopt_long() recomeça para o loop do programa
+    return status != 0 ? -1 : sim_config_check(config);
+}
+
+void sim_config_install(const SimConfig *config) {
+/**
+ * \brief Make `config` the one every module reads // Torna `config` a lida por todos os módulos
+ *
+ * \details Threads created afterwards see it through pthread_create(); nothing writes it again.
+ * \details As threads criadas depois a veem por meio do pthread_create(); nada a escreve de novo.
+ */
+    installed = *config;
+}
+
+const SimConfig *sim_config(void) {
+/**
+ * \brief The installed configuration // A configuração instalada
+ */
+    return &installed;
+}
+
+void sim_config_write(FILE *out, const SimConfig *config) {
+/**
+ * \brief Write a configuration in the file format // Escreve uma configuração no formato do arquivo
+ */
+    for (size_t i = 0; i < sizeof(config_keys) / sizeof(config_keys[0]); i++) {
+        const ConfigKey *entry = &config_keys[i];
+        const char *field = (const char*)config + entry->offset;
+        fprintf(out, "# %s\n%s = ", entry->help, entry->name);
+        switch (entry->kind) {
+        case CONFIG_REAL:
+            fprintf(out, "%g\n", *(const double*)field);
+            break;
+        case CONFIG_INTEGER:
+            fprintf(out, "%d\n", *(const int*)field);
+            break;
+        case CONFIG_WEIGHTS:
+            for (int d = 0; d < CONFIG_DIAGNOSES; d++) {
+                fprintf(out, d ? ",%d" : "%d", ((const int*)field)[d]);
+            }
+            fprintf(out, "\n");
+            break;
+        }
+    }
+}
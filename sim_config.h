@@ -0,0 +1,118 @@
+#ifndef SIM_CONFIG_H_INCLUDED
+#define SIM_CONFIG_H_INCLUDED
+
+#include <stdio.h>
+#include <getopt.h>
+
+#define CONFIG_DIAGNOSES 9            // Conditions of the diagnosis table, as many as AI_CONDITIONS // Condições da tabela de diagnósticos
+#define CONFIG_OPTION_FILE 0x100      // getopt value of --config, past every short option // Valor do getopt de --config
+#define CONFIG_OPTION_SET 0x101       // getopt value of --set // Valor do getopt de --set
+
+// The entries every program adds to its getopt_long() table; sim_config_from_arguments() applies them, the program skips them
+// As entradas que todo programa adiciona à sua tabela do getopt_long(); sim_config_from_arguments() as aplica, o programa as ignora
+#define SIM_CONFIG_OPTIONS \
+    {"config", required_argument, NULL, CONFIG_OPTION_FILE}, \
+    {"set", required_argument, NULL, CONFIG_OPTION_SET}
+
+/**
+ * \brief Constants of the clinic model, the same for every module and thread // Constantes do modelo da clínica, as mesmas para todos
+ *
+ * \details Built once from the defaults, a `key = value` file and the command line, then installed before any
+ *          thread starts and only read afterwards.
+ * \details Montada uma vez a partir dos padrões, de um arquivo `chave = valor` e da linha de comando, depois instalada
+ *          antes de qualquer thread começar e apenas lida em seguida.
+ */
+typedef struct sim_config {
+    double max_execution;                   // Simulated seconds the clinic takes patients // Segundos simulados em que a clínica recebe pacientes
+    double report_limit;                    // Reports taking longer are delayed // Laudos mais longos são atrasados
+    double step_min;                        // Shortest main loop step, pre_random_time() // Menor passo do loop principal
+    double step_max;                        // Longest main loop step // Maior passo do loop principal
+    double report_factor;                   // Report duration = step * report_factor + report_offset // Duração do laudo
+    double report_offset;
+    double exam_time;                       // Seconds of an exam on a speed 1 machine // Segundos de um exame numa máquina de velocidade 1
+    int ai_keep_percent;                    // Chance the doctor keeps the AI diagnosis // Chance do médico manter o diagnóstico da IA
+    int diagnosis_weights[CONFIG_DIAGNOSES]; // Relative frequency of each condition // Frequência relativa de cada condição
+    int machines;                           // X-Ray machines when no option says otherwise // Máquinas RX sem outra opção
+    double arrival_rate;                    // Mean patients per simulated second // Média de pacientes por segundo simulado
+    double drain_deadline;                  // Simulated seconds to drain the clinic after it closes // Segundos para esvaziar a clínica
+    double stats_window;                    // Simulated seconds behind the live report statistics // Segundos das estatísticas recentes
+} SimConfig;
+
+/**
+ * \brief The built-in values // Os valores de fábrica
+ *
+ * \param config - Receives the defaults // Recebe os padrões
+ */
+void sim_config_defaults(SimConfig *config);
+
+/**
+ * \brief Set one value from its text // Define um valor a partir do seu texto
+ *
+ * \param config - Pointer to the configuration // Ponteiro para a configuração
+ * \param key - Name of the value, as written in a config file // Nome do valor, como escrito no arquivo
+ * \param value - Text of the value; diagnosis_weights takes a comma separated list // Texto do valor; diagnosis_weights recebe uma lista
+ * \return 0 on success, -1 if the key is unknown or the value out of range // 0 em sucesso, -1 se a chave não existe ou o valor é inválido
+ */
+int sim_config_set(SimConfig *config, const char *key, const char *value);
+
+/**
+ * \brief Apply a `key = value` file; blank lines and text after '#' are skipped // Aplica um arquivo `chave = valor`
+ *
+ * \param config - Pointer to the configuration // Ponteiro para a configuração
+ * \param path - Path of the file // Caminho do arquivo
+ * \return 0 on success, -1 if the file can't be read, else the number of the first bad line
+ *         // 0 em sucesso, -1 se o arquivo não pode ser lido, senão o número da primeira linha inválida
+ */
+int sim_config_load(SimConfig *config, const char *path);
+
+/**
+ * \brief Defaults, then every --config FILE and --set KEY=VALUE of the command line, in order
+ *        // Padrões, depois cada --config FILE e --set KEY=VALUE da linha de comando, em ordem
+ *
+ * \details A first, silent getopt_long() pass over the program's own tables, so --conf, --se and --config=FILE are
+ *          read exactly as the program's loop reads them. Afterwards getopt starts over (optind = 0) and the program's
+ *          loop, which skips these two, reports any bad option.
+ * \details Uma primeira passada silenciosa do getopt_long() pelas tabelas do próprio programa, então --conf, --se e
+ *          --config=FILE são lidos exatamente como o loop do programa os lê. Depois o getopt recomeça (optind = 0) e o
+ *          loop do programa, que ignora estas duas, relata qualquer opção inválida.
+ * \param config - Receives the configuration // Recebe a configuração
+ * \param argc - Argument count of main() // Contagem de argumentos do main()
+ * \param argv - Arguments of main() // Argumentos do main()
+ * \param short_options - The program's getopt_long() short options // As opções curtas do programa
+ * \param long_options - The program's getopt_long() table, with SIM_CONFIG_OPTIONS // A tabela do programa, com SIM_CONFIG_OPTIONS
+ * \return 0 on success, -1 after printing what is wrong // 0 em sucesso, -1 depois de imprimir o erro
+ */
+int sim_config_from_arguments(SimConfig *config, int argc, char *argv[], const char *short_options,
+                              const struct option *long_options);
+
+/**
+ * \brief Check the values that depend on each other // Verifica os valores que dependem uns dos outros
+ *
+ * \param config - Pointer to the configuration // Ponteiro para a configuração
+ * \return 0 if consistent, -1 after printing what is wrong // 0 se consistente, -1 depois de imprimir o erro
+ */
+int sim_config_check(const SimConfig *config);
+
+/**
+ * \brief Make `config` the one every module reads, before any thread starts // Torna `config` a lida por todos, antes das threads
+ *
+ * \param config - Configuration to copy // Configuração a copiar
+ */
+void sim_config_install(const SimConfig *config);
+
+/**
+ * \brief The installed configuration, the defaults if none was installed // A configuração instalada, os padrões se nenhuma foi
+ *
+ * \return Read-only pointer, valid for the whole run // Ponteiro somente leitura, válido durante toda a execução
+ */
+const SimConfig *sim_config(void);
+
+/**
+ * \brief Write a configuration in the file format, one commented key per line // Escreve uma configuração no formato do arquivo
+ *
+ * \param out - Destination stream // Fluxo de destino
+ * \param config - Pointer to the configuration // Ponteiro para a configuração
+ */
+void sim_config_write(FILE *out, const SimConfig *config);
+
+#endif // SIM_CONFIG_H_INCLUDED
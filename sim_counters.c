@@ -0,0 +1,131 @@
+#include "sim_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "seqlock.h"
+
+typedef struct counter_shard {
+    _Alignas(COUNTER_CACHE_LINE) ReportTally local;       // Written by its doctor only // Escrita só pelo seu médico
+    _Alignas(COUNTER_CACHE_LINE) SeqLock lock;
+    ReportTally published;                                // Copy of `local` readers merge // Cópia de `local` que os leitores somam
+} CounterShard;
+
+struct sim_counters {
+    _Alignas(COUNTER_CACHE_LINE) _Atomic double clock;   // Written once per main loop step // Escrito uma vez por passo do loop
+    double window_seconds;
+    atomic_int used;                                      // Shards below it were published at least once // Fatias abaixo foram publicadas
+    CounterShard shards[COUNTER_SHARDS];
+};
+
+static void reset_tally(ReportTally *tally, double window_seconds) {
+    memset(tally, 0, sizeof(*tally));
+    report_stream_init(&tally->stream, window_seconds);
+}
+
+SimCounters *create_sim_counters(double window_seconds) {
+/**
+ * \brief Create the counters, all zero // Cria os contadores, todos zerados
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return SimCounters* - Pointer to the counters // Ponteiro para os contadores
+ */
+    SimCounters *counters = (SimCounters*)aligned_alloc(COUNTER_CACHE_LINE, sizeof(SimCounters));
+    if (!counters) {
+        printf("\nError: Memory allocation failed (Counters)\n");
+        exit(1);
+    }
+    atomic_init(&counters->clock, 0.0);
+    counters->window_seconds = window_seconds;
+    atomic_init(&counters->used, 0);
+    for (int i = 0; i < COUNTER_SHARDS; i++) {
+        CounterShard *shard = &counters->shards[i];
+        reset_tally(&shard->local, window_seconds);
+        seqlock_init(&shard->lock);
+        shard->published = shard->local;
+    }
+    return counters;
+}
+
+void destroy_sim_counters(SimCounters *counters) {
+/**
+ * \brief Free the counters // Libera os contadores
+ */
+    free(counters);
+}
+
+void set_simulation_clock(SimCounters *counters, double now) {
+/**
+ * \brief Set the simulated time // Define o tempo simulado
+ */
+    atomic_store_explicit(&counters->clock, now, memory_order_release);
+}
+
+double simulation_clock(SimCounters *counters) {
+/**
+ * \brief Simulated time last set by the main loop // Tempo simulado definido pelo loop principal
+ */
+    return atomic_load_explicit(&counters->clock, memory_order_acquire);
+}
+
+ReportTally *report_tally(SimCounters *counters, int shard) {
+/**
+ * \brief Private copy of a shard // Cópia privada de uma fatia
+ */
+    return &counters->shards[shard % COUNTER_SHARDS].local;
+}
+
+void publish_report_tally(SimCounters *counters, int shard) {
+/**
+ * \brief Publish the changes made to a shard // Publica as mudanças feitas em uma fatia
+ */
+    shard %= COUNTER_SHARDS;
+    CounterShard *owned = &counters->shards[shard];
+    seqlock_write(&owned->lock, &owned->published, &owned->local, sizeof(ReportTally));
+    int used = atomic_load_explicit(&counters->used, memory_order_relaxed);
+    while (used <= shard && !atomic_compare_exchange_weak(&counters->used, &used, shard + 1)) {
+    }
+}
+
+void merge_report_tallies(SimCounters *counters, ReportTally *total) {
+/**
+ * \brief Sum of every published shard // Soma de todas as fatias publicadas
+ *
+ * \details Each shard is consistent on its own; two shards may be a report apart, like two doctors finishing together.
+ * \details Cada fatia é consistente; duas fatias podem estar um laudo distantes, como dois médicos terminando juntos.
+ */
+    reset_tally(total, counters->window_seconds);
+    ReportTally shard;
+    int used = atomic_load(&counters->used); // Only the shards of doctors that ever reported are copied
+    for (int i = 0; i < used; i++) {
+        seqlock_read(&counters->shards[i].lock, &shard, &counters->shards[i].published, sizeof(ReportTally));
+        if (shard.reports == 0 && shard.active == 0) {
+            continue; // A doctor that never started a report, or a shard no doctor owns
+        }
+        total->time_reports += shard.time_reports;
+        total->reports += shard.reports;
+        total->delayed += shard.delayed;
+        total->active += shard.active;
+        for (int bin = 0; bin < DASHBOARD_HIST_BINS; bin++) {
+            total->histogram[bin] += shard.histogram[bin];
+        }
+        report_stream_merge(&total->stream, &shard.stream);
+    }
+    report_stream_advance(&total->stream, simulation_clock(counters)); // A quiet spell empties the windows
+}
+
+void restore_report_tally(SimCounters *counters, const ReportTally *total) {
+/**
+ * \brief Put saved totals back into shard 0 and clear the others // Devolve totais salvos à fatia 0 e zera as outras
+ */
+    for (int i = 0; i < COUNTER_SHARDS; i++) {
+        reset_tally(&counters->shards[i].local, counters->window_seconds);
+    }
+    counters->shards[0].local = *total;
+    counters->shards[0].local.active = 0; // Reports in progress start over // Laudos em andamento recomeçam
+    int used = atomic_load(&counters->used);
+    for (int i = 0; i < (used > 1 ? used : 1); i++) {
+        publish_report_tally(counters, i);
+    }
+}
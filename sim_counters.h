@@ -0,0 +1,98 @@
+#ifndef SIM_COUNTERS_H_INCLUDED
+#define SIM_COUNTERS_H_INCLUDED
+
+#include "dashboard.h"
+
+#define COUNTER_SHARDS 64         // One per doctor, as many as DOCTOR_MAX // Um por médico, tantos quanto DOCTOR_MAX
+#define COUNTER_CACHE_LINE 64
+
+/**
+ * \brief Report counters of one doctor thread, or of all of them once merged
+ *        // Contadores de laudos de uma thread de médico, ou de todas depois de somados
+ */
+typedef struct report_tally {
+    double time_reports;                   // Sum of report durations // Soma das durações dos laudos
+    int reports;                           // Reports finished // Laudos finalizados
+    int delayed;                           // Reports over the time limit // Laudos acima do tempo limite
+    int active;                            // Reports in progress; one shard may go negative, the sum can't // Laudos em andamento
+    int histogram[DASHBOARD_HIST_BINS];    // Report durations // Durações dos laudos
+    ReportStream stream;
+} ReportTally;
+
+// Per-thread report shards and the simulated clock, readable by any thread without the queue lock
+// Fatias de contadores por thread e o relógio simulado, legíveis por qualquer thread sem o lock das filas
+typedef struct sim_counters SimCounters;
+
+/**
+ * \brief Create the counters, all zero // Cria os contadores, todos zerados
+ *
+ * \details Every shard sits on its own cache lines: a doctor writing its shard never invalidates a line another
+ *          doctor writes. Each shard is published through its own seqlock, so a reader merges consistent shards
+ *          without stopping anyone.
+ * \details Cada fatia fica em suas próprias linhas de cache: um médico escrevendo sua fatia nunca invalida uma linha
+ *          que outro escreve. Cada fatia é publicada por seu próprio seqlock, então um leitor soma fatias consistentes
+ *          sem parar ninguém.
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ * \param window_seconds - Length of the live report windows // Tamanho das janelas recentes dos laudos
+ * \return Pointer to the counters // Ponteiro para os contadores
+ */
+SimCounters *create_sim_counters(double window_seconds);
+
+/**
+ * \brief Free the counters // Libera os contadores
+ *
+ * \param counters - Pointer to the counters, may be NULL // Ponteiro para os contadores, pode ser NULL
+ */
+void destroy_sim_counters(SimCounters *counters);
+
+/**
+ * \brief Set the simulated time (main loop only) // Define o tempo simulado (somente o loop principal)
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \param now - Simulated seconds // Segundos simulados
+ */
+void set_simulation_clock(SimCounters *counters, double now);
+
+/**
+ * \brief Simulated time last set by the main loop (any thread) // Tempo simulado definido pelo loop principal (qualquer thread)
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \return Simulated seconds // Segundos simulados
+ */
+double simulation_clock(SimCounters *counters);
+
+/**
+ * \brief Private copy of a shard, to be changed by its thread only // Cópia privada de uma fatia, alterada só pela sua thread
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \param shard - 0 to COUNTER_SHARDS - 1, the doctor index // O índice do médico
+ * \return Pointer to the tally; readers see the changes after publish_report_tally() // Os leitores veem as mudanças depois de publish_report_tally()
+ */
+ReportTally *report_tally(SimCounters *counters, int shard);
+
+/**
+ * \brief Publish the changes made to a shard // Publica as mudanças feitas em uma fatia
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \param shard - Shard given to report_tally() // Fatia dada a report_tally()
+ */
+void publish_report_tally(SimCounters *counters, int shard);
+
+/**
+ * \brief Sum of every published shard, windows advanced to the simulated clock // Soma de todas as fatias publicadas
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \param total - Receives the sum // Recebe a soma
+ */
+void merge_report_tallies(SimCounters *counters, ReportTally *total);
+
+/**
+ * \brief Put saved totals back into shard 0 and clear the others, before any doctor runs
+ *        // Devolve totais salvos à fatia 0 e zera as outras, antes de algum médico rodar
+ *
+ * \param counters - Pointer to the counters // Ponteiro para os contadores
+ * \param total - Totals from merge_report_tallies() // Totais de merge_report_tallies()
+ */
+void restore_report_tally(SimCounters *counters, const ReportTally *total);
+
+#endif // SIM_COUNTERS_H_INCLUDED
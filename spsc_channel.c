@@ -0,0 +1,108 @@
+#include "spsc_channel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+struct spsc_channel {
+    // Consumer side // Lado do consumidor
+    _Alignas(SPSC_CACHE_LINE) atomic_long head;   // Next item to receive // Próximo item a receber
+    long cached_tail;                             // Last tail the consumer saw // Último tail visto pelo consumidor
+
+    // Producer side // Lado do produtor
+    _Alignas(SPSC_CACHE_LINE) atomic_long tail;   // Next free slot // Próxima posição livre
+    long cached_head;                             // Last head the producer saw // Último head visto pelo produtor
+
+    // Read only after creation // Só leitura depois da criação
+    _Alignas(SPSC_CACHE_LINE) long mask;
+    void **slots;
+};
+
+SpscChannel *create_spsc_channel(int capacity) {
+/**
+ * \brief Create an empty channel // Cria um canal vazio
+ *
+ * \param capacity - Slots, rounded up to a power of two // Posições, arredondadas para potência de dois
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return SpscChannel* - Pointer to the channel, NULL if capacity < 1 // Ponteiro para o canal, NULL se capacity < 1
+ */
+    if (capacity < 1) {
+        return NULL;
+    }
+    long slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    SpscChannel *channel = (SpscChannel*)aligned_alloc(SPSC_CACHE_LINE, sizeof(SpscChannel));
+    void **ring = (void**)calloc(slots, sizeof(void*));
+    if (!channel || !ring) {
+        printf("\nError: Memory allocation failed (SPSC Channel)\n");
+        exit(1);
+    }
+    atomic_init(&channel->head, 0);
+    atomic_init(&channel->tail, 0);
+    channel->cached_tail = 0;
+    channel->cached_head = 0;
+    channel->mask = slots - 1;
+    channel->slots = ring;
+    return channel;
+}
+
+void destroy_spsc_channel(SpscChannel *channel) {
+/**
+ * \brief Free the channel // Libera o canal
+ */
+    if (!channel) {
+        return;
+    }
+    free(channel->slots);
+    free(channel);
+}
+
+int spsc_send(SpscChannel *channel, void *item) {
+/**
+ * \brief Send an item (producer only) // Envia um item (somente o produtor)
+ *
+ * \return int - 1 if sent, 0 if the channel is full // 1 se enviado, 0 se o canal estiver cheio
+ */
+    long tail = atomic_load_explicit(&channel->tail, memory_order_relaxed);
+    if (tail - channel->cached_head > channel->mask) {
+        // Looks full: refresh the consumer's index, the only read of its cache line // Parece cheio: atualiza o índice do consumidor
+        channel->cached_head = atomic_load_explicit(&channel->head, memory_order_acquire);
+        if (tail - channel->cached_head > channel->mask) {
+            return 0;
+        }
+    }
+    channel->slots[tail & channel->mask] = item;
+    atomic_store_explicit(&channel->tail, tail + 1, memory_order_release); // The item is visible before the new tail
+    return 1;
+}
+
+void *spsc_receive(SpscChannel *channel) {
+/**
+ * \brief Receive the oldest item (consumer only) // Recebe o item mais antigo (somente o consumidor)
+ *
+ * \return void* - The item, NULL if the channel is empty // O item, NULL se o canal estiver vazio
+ */
+    long head = atomic_load_explicit(&channel->head, memory_order_relaxed);
+    if (head == channel->cached_tail) {
+        channel->cached_tail = atomic_load_explicit(&channel->tail, memory_order_acquire);
+        if (head == channel->cached_tail) {
+            return NULL;
+        }
+    }
+    void *item = channel->slots[head & channel->mask];
+    atomic_store_explicit(&channel->head, head + 1, memory_order_release); // The slot may be reused from now on
+    return item;
+}
+
+int spsc_size(SpscChannel *channel) {
+/**
+ * \brief Items in the channel // Itens no canal
+ */
+    long tail = atomic_load_explicit(&channel->tail, memory_order_acquire);
+    long head = atomic_load_explicit(&channel->head, memory_order_acquire);
+    return (int)(tail - head);
+}
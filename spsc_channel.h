@@ -0,0 +1,58 @@
+#ifndef SPSC_CHANNEL_H_INCLUDED
+#define SPSC_CHANNEL_H_INCLUDED
+
+#define SPSC_CACHE_LINE 64        // Producer and consumer indices live on separate lines // Índices do produtor e do consumidor em linhas separadas
+#define SPSC_DEFAULT_CAPACITY 1024
+
+/**
+ * \brief Bounded single producer, single consumer ring of pointers // Anel limitado de ponteiros com um produtor e um consumidor
+ *
+ * \details Lock free: the producer only writes `tail`, the consumer only writes `head`, each on its own cache line,
+ *          and each side keeps a cached copy of the other's index so it touches the shared line only when the ring
+ *          looks full or empty. Items are never NULL.
+ * \details Sem locks: o produtor só escreve `tail`, o consumidor só escreve `head`, cada um em sua linha de cache,
+ *          e cada lado guarda uma cópia do índice do outro. Itens nunca são NULL.
+ */
+typedef struct spsc_channel SpscChannel;
+
+/**
+ * \brief Create an empty channel // Cria um canal vazio
+ *
+ * \param capacity - Slots, rounded up to a power of two // Posições, arredondadas para potência de dois
+ * \return Pointer to the channel, NULL if capacity < 1 // Ponteiro para o canal, NULL se capacity < 1
+ */
+SpscChannel *create_spsc_channel(int capacity);
+
+/**
+ * \brief Free the channel; the items left are not freed // Libera o canal; os itens restantes não são liberados
+ *
+ * \param channel - Pointer to the channel // Ponteiro para o canal
+ */
+void destroy_spsc_channel(SpscChannel *channel);
+
+/**
+ * \brief Send an item (producer only) // Envia um item (somente o produtor)
+ *
+ * \param channel - Pointer to the channel // Ponteiro para o canal
+ * \param item - Non NULL pointer; the receiver takes ownership // Ponteiro não NULL; quem recebe fica com ele
+ * \return 1 if sent, 0 if the channel is full // 1 se enviado, 0 se o canal estiver cheio
+ */
+int spsc_send(SpscChannel *channel, void *item);
+
+/**
+ * \brief Receive the oldest item (consumer only) // Recebe o item mais antigo (somente o consumidor)
+ *
+ * \param channel - Pointer to the channel // Ponteiro para o canal
+ * \return The item, NULL if the channel is empty // O item, NULL se o canal estiver vazio
+ */
+void *spsc_receive(SpscChannel *channel);
+
+/**
+ * \brief Items in the channel, a snapshot when read by a third thread // Itens no canal, uma amostra se lido por outra thread
+ *
+ * \param channel - Pointer to the channel // Ponteiro para o canal
+ * \return Number of items // Número de itens
+ */
+int spsc_size(SpscChannel *channel);
+
+#endif // SPSC_CHANNEL_H_INCLUDED
@@ -0,0 +1,230 @@
+#include "stream_stats.h"
+#include <math.h>
+#include <string.h>
+
+void stream_stats_init(StreamStats *stats) {
+/**
+ * \brief Empty statistics // Estatísticas vazias
+ */
+    memset(stats, 0, sizeof(*stats));
+}
+
+void stream_stats_add(StreamStats *stats, double value) {
+/**
+ * \brief Add a sample: Welford's update, then the EWMA and the extremes // Adiciona uma amostra: atualização de Welford, EWMA e extremos
+ */
+    stats->count++;
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+    if (stats->count == 1) {
+        stats->min = stats->max = stats->ewma = value;
+        return;
+    }
+    if (value < stats->min) {
+        stats->min = value;
+    }
+    if (value > stats->max) {
+        stats->max = value;
+    }
+    stats->ewma += STREAM_EWMA_ALPHA * (value - stats->ewma);
+}
+
+double stream_stats_variance(const StreamStats *stats) {
+/**
+ * \brief Sample variance // Variância amostral
+ *
+ * \return double - Variance, 0 with fewer than two samples // Variância, 0 com menos de duas amostras
+ */
+    return stats->count > 1 ? stats->m2 / (stats->count - 1) : 0.0;
+}
+
+double stream_stats_stddev(const StreamStats *stats) {
+/**
+ * \brief Sample standard deviation // Desvio padrão amostral
+ */
+    return sqrt(stream_stats_variance(stats));
+}
+
+void sliding_window_init(SlidingWindow *window, double seconds) {
+/**
+ * \brief Empty window // Janela vazia
+ */
+    memset(window, 0, sizeof(*window));
+    window->seconds = seconds > 0 ? seconds : STREAM_DEFAULT_WINDOW;
+    window->width = window->seconds / STREAM_WINDOW_BUCKETS;
+    window->started = -1;
+}
+
+static void advance_to_bucket(SlidingWindow *window, long bucket) {
+// Makes `bucket` the newest one, clearing the buckets it reuses // Torna `bucket` a mais nova, limpando as faixas reaproveitadas
+    if (bucket <= window->newest) {
+        return;
+    }
+    long steps = bucket - window->newest;
+    if (steps > STREAM_WINDOW_BUCKETS) {
+        steps = STREAM_WINDOW_BUCKETS; // Everything expired: clearing every bucket once is enough
+    }
+    for (long i = 1; i <= steps; i++) {
+        int slot = (int)((window->newest + i) % STREAM_WINDOW_BUCKETS);
+        window->total_count -= window->count[slot];
+        window->total_sum -= window->sum[slot];
+        window->count[slot] = 0;
+        window->sum[slot] = 0;
+    }
+    window->newest = bucket;
+    if (window->total_count == 0) {
+        window->total_sum = 0; // Drop the rounding left by the subtractions // Descarta o arredondamento das subtrações
+    }
+}
+
+void sliding_window_advance(SlidingWindow *window, double now) {
+/**
+ * \brief Drop the buckets older than the window // Descarta as faixas mais velhas que a janela
+ */
+    advance_to_bucket(window, (long)(now / window->width));
+}
+
+void sliding_window_add(SlidingWindow *window, double now, double value) {
+/**
+ * \brief Add a sample at `now` // Adiciona uma amostra em `now`
+ */
+    sliding_window_advance(window, now);
+    int slot = (int)(window->newest % STREAM_WINDOW_BUCKETS);
+    window->count[slot]++;
+    window->sum[slot] += value;
+    window->total_count++;
+    window->total_sum += value;
+    if (window->started < 0) {
+        window->started = now;
+    }
+}
+
+double sliding_window_rate(const SlidingWindow *window, double now) {
+/**
+ * \brief Samples per second over the window // Amostras por segundo na janela
+ *
+ * \details Until the window has been filled once, the rate is taken over the time since the first sample.
+ * \details Até a janela ser preenchida uma vez, a taxa é tomada sobre o tempo desde a primeira amostra.
+ *
+ * \return double - Rate, 0 if nothing happened yet // Taxa, 0 se nada aconteceu ainda
+ */
+    if (window->started < 0) {
+        return 0.0;
+    }
+    double covered = now - window->started;
+    if (covered > window->seconds) {
+        covered = window->seconds;
+    }
+    if (covered < window->width) {
+        covered = window->width;
+    }
+    return window->total_count / covered;
+}
+
+double sliding_window_mean(const SlidingWindow *window) {
+/**
+ * \brief Mean of the samples in the window // Média das amostras na janela
+ */
+    return window->total_count > 0 ? window->total_sum / window->total_count : 0.0;
+}
+
+void stream_stats_merge(StreamStats *into, const StreamStats *from) {
+/**
+ * \brief Add the samples of `from` to `into` // Soma as amostras de `from` em `into`
+ *
+ * \details Chan's pairwise update: mean and variance come out as if every sample had been added to `into`.
+ *          The EWMA has no exact merge; the result weighs each side by its count.
+ * \details Atualização em pares de Chan: média e variância saem como se cada amostra tivesse sido somada em `into`.
+ *          A EWMA não tem junção exata; o resultado pondera cada lado pela contagem.
+ */
+    if (from->count == 0) {
+        return;
+    }
+    if (into->count == 0) {
+        *into = *from;
+        return;
+    }
+    long count = into->count + from->count;
+    double delta = from->mean - into->mean;
+    into->mean += delta * from->count / count;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * from->count / count);
+    into->ewma = (into->ewma * into->count + from->ewma * from->count) / count;
+    if (from->min < into->min) {
+        into->min = from->min;
+    }
+    if (from->max > into->max) {
+        into->max = from->max;
+    }
+    into->count = count;
+}
+
+void sliding_window_merge(SlidingWindow *into, const SlidingWindow *from) {
+/**
+ * \brief Add the buckets of `from` to `into`; both must have the same length // Soma as faixas de `from` em `into`; mesmo tamanho
+ *
+ * \details Buckets are numbered by time / width, so equal windows line up bucket by bucket.
+ * \details As faixas são numeradas por tempo / largura, então janelas iguais se alinham faixa a faixa.
+ */
+    if (from->started < 0 || from->width != into->width) {
+        return;
+    }
+    SlidingWindow aligned = *from;
+    advance_to_bucket(&aligned, into->newest);
+    advance_to_bucket(into, aligned.newest);
+    for (int i = 0; i < STREAM_WINDOW_BUCKETS; i++) {
+        into->count[i] += aligned.count[i];
+        into->sum[i] += aligned.sum[i];
+    }
+    into->total_count += aligned.total_count;
+    into->total_sum += aligned.total_sum;
+    if (into->started < 0 || aligned.started < into->started) {
+        into->started = aligned.started;
+    }
+}
+
+void report_stream_init(ReportStream *stream, double window_seconds) {
+/**
+ * \brief Empty report statistics // Estatísticas de laudos vazias
+ */
+    stream_stats_init(&stream->all);
+    sliding_window_init(&stream->window, window_seconds);
+    for (int i = 0; i < STREAM_PRIORITIES; i++) {
+        stream_stats_init(&stream->priority[i]);
+        sliding_window_init(&stream->priority_window[i], window_seconds);
+    }
+}
+
+void report_stream_add(ReportStream *stream, int priority, double now, double duration) {
+/**
+ * \brief Add a finished report // Adiciona um laudo finalizado
+ */
+    stream_stats_add(&stream->all, duration);
+    sliding_window_add(&stream->window, now, duration);
+    if (priority >= 1 && priority <= STREAM_PRIORITIES) {
+        stream_stats_add(&stream->priority[priority - 1], duration);
+        sliding_window_add(&stream->priority_window[priority - 1], now, duration);
+    }
+}
+
+void report_stream_merge(ReportStream *into, const ReportStream *from) {
+/**
+ * \brief Add the reports of `from` to `into` // Soma os laudos de `from` em `into`
+ */
+    stream_stats_merge(&into->all, &from->all);
+    sliding_window_merge(&into->window, &from->window);
+    for (int i = 0; i < STREAM_PRIORITIES; i++) {
+        stream_stats_merge(&into->priority[i], &from->priority[i]);
+        sliding_window_merge(&into->priority_window[i], &from->priority_window[i]);
+    }
+}
+
+void report_stream_advance(ReportStream *stream, double now) {
+/**
+ * \brief Advance every window to `now` // Avança todas as janelas até `now`
+ */
+    sliding_window_advance(&stream->window, now);
+    for (int i = 0; i < STREAM_PRIORITIES; i++) {
+        sliding_window_advance(&stream->priority_window[i], now);
+    }
+}
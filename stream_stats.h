@@ -0,0 +1,182 @@
+#ifndef STREAM_STATS_H_INCLUDED
+#define STREAM_STATS_H_INCLUDED
+
+#define STREAM_PRIORITIES 6
+#define STREAM_WINDOW_BUCKETS 32       // Buckets of a sliding window // Faixas de uma janela deslizante
+#define STREAM_EWMA_ALPHA 0.2          // Weight of the newest sample in the EWMA // Peso da amostra mais nova na EWMA
+#define STREAM_DEFAULT_WINDOW 10.000   // Simulated seconds covered by the live windows // Segundos simulados cobertos pelas janelas
+
+/**
+ * \brief Running mean and variance (Welford), EWMA, min and max of a stream of samples, O(1) per sample
+ *        // Média e variância contínuas (Welford), EWMA, mínimo e máximo de um fluxo de amostras, O(1) por amostra
+ *
+ * \details Welford's update never subtracts two large sums, so the variance stays exact after millions of samples.
+ * \details A atualização de Welford nunca subtrai duas somas grandes, então a variância fica exata após milhões de amostras.
+ */
+typedef struct stream_stats {
+    long count;
+    double mean;
+    double m2;       // Sum of squared distances to the mean // Soma dos quadrados das distâncias à média
+    double min;
+    double max;
+    double ewma;     // Recent mean, weighted by STREAM_EWMA_ALPHA // Média recente, ponderada por STREAM_EWMA_ALPHA
+} StreamStats;
+
+/**
+ * \brief Count and sum of the samples of the last `seconds`, in STREAM_WINDOW_BUCKETS time buckets
+ *        // Contagem e soma das amostras dos últimos `seconds`, em STREAM_WINDOW_BUCKETS faixas de tempo
+ *
+ * \details A value type: it can be copied into a snapshot or a checkpoint. The oldest bucket is dropped as a whole,
+ *          so the window covers between seconds - width and seconds.
+ * \details Um tipo valor: pode ser copiado para um snapshot ou checkpoint. A faixa mais antiga sai inteira,
+ *          então a janela cobre entre seconds - width e seconds.
+ */
+typedef struct sliding_window {
+    double seconds;                        // Length of the window // Tamanho da janela
+    double width;                          // seconds / STREAM_WINDOW_BUCKETS
+    long newest;                           // Bucket number (time / width) of the newest bucket // Número da faixa mais nova
+    int count[STREAM_WINDOW_BUCKETS];
+    double sum[STREAM_WINDOW_BUCKETS];
+    long total_count;                      // Over the live buckets // Sobre as faixas vivas
+    double total_sum;
+    double started;                        // Time of the first sample, the window is shorter before it fills // Tempo da primeira amostra
+} SlidingWindow;
+
+/**
+ * \brief Report durations, all time and live, overall and per priority // Durações dos laudos, de sempre e recentes, no total e por prioridade
+ */
+typedef struct report_stream {
+    StreamStats all;
+    StreamStats priority[STREAM_PRIORITIES];          // Index 0 = priority 1 // Índice 0 = prioridade 1
+    SlidingWindow window;
+    SlidingWindow priority_window[STREAM_PRIORITIES];
+} ReportStream;
+
+/**
+ * \brief Empty statistics // Estatísticas vazias
+ *
+ * \param stats - Statistics to reset // Estatísticas a zerar
+ */
+void stream_stats_init(StreamStats *stats);
+
+/**
+ * \brief Add a sample // Adiciona uma amostra
+ *
+ * \param stats - Pointer to the statistics // Ponteiro para as estatísticas
+ * \param value - The sample // A amostra
+ */
+void stream_stats_add(StreamStats *stats, double value);
+
+/**
+ * \brief Sample variance // Variância amostral
+ *
+ * \param stats - Pointer to the statistics // Ponteiro para as estatísticas
+ * \return Variance, 0 with fewer than two samples // Variância, 0 com menos de duas amostras
+ */
+double stream_stats_variance(const StreamStats *stats);
+
+/**
+ * \brief Sample standard deviation // Desvio padrão amostral
+ *
+ * \param stats - Pointer to the statistics // Ponteiro para as estatísticas
+ * \return Standard deviation, 0 with fewer than two samples // Desvio padrão, 0 com menos de duas amostras
+ */
+double stream_stats_stddev(const StreamStats *stats);
+
+/**
+ * \brief Add the samples of another set of statistics // Soma as amostras de outro conjunto de estatísticas
+ *
+ * \details Exact for the count, mean, variance and extremes (Chan's update); the EWMA is weighted by count.
+ * \details Exata para contagem, média, variância e extremos (atualização de Chan); a EWMA é ponderada pela contagem.
+ * \param into - Receives the samples // Recebe as amostras
+ * \param from - Statistics to add // Estatísticas a somar
+ */
+void stream_stats_merge(StreamStats *into, const StreamStats *from);
+
+/**
+ * \brief Empty window // Janela vazia
+ *
+ * \param window - Window to reset // Janela a zerar
+ * \param seconds - Length of the window, values <= 0 use STREAM_DEFAULT_WINDOW // Tamanho da janela
+ */
+void sliding_window_init(SlidingWindow *window, double seconds);
+
+/**
+ * \brief Drop the buckets older than the window // Descarta as faixas mais velhas que a janela
+ *
+ * \details At most STREAM_WINDOW_BUCKETS buckets are cleared, however long the time jumped. Time never goes back.
+ * \details No máximo STREAM_WINDOW_BUCKETS faixas são limpas, por maior que seja o salto. O tempo nunca volta.
+ * \param window - Pointer to the window // Ponteiro para a janela
+ * \param now - Current time // Tempo atual
+ */
+void sliding_window_advance(SlidingWindow *window, double now);
+
+/**
+ * \brief Add a sample at `now` // Adiciona uma amostra em `now`
+ *
+ * \param window - Pointer to the window // Ponteiro para a janela
+ * \param now - Time of the sample // Tempo da amostra
+ * \param value - The sample // A amostra
+ */
+void sliding_window_add(SlidingWindow *window, double now, double value);
+
+/**
+ * \brief Add the samples of another window of the same length // Soma as amostras de outra janela do mesmo tamanho
+ *
+ * \param into - Receives the samples, advanced to the newer of the two // Recebe as amostras, avançada até a mais nova das duas
+ * \param from - Window to add // Janela a somar
+ */
+void sliding_window_merge(SlidingWindow *into, const SlidingWindow *from);
+
+/**
+ * \brief Samples per second over the window // Amostras por segundo na janela
+ *
+ * \param window - Pointer to a window advanced to `now` // Ponteiro para uma janela avançada até `now`
+ * \param now - Current time // Tempo atual
+ * \return Rate, 0 if nothing happened yet // Taxa, 0 se nada aconteceu ainda
+ */
+double sliding_window_rate(const SlidingWindow *window, double now);
+
+/**
+ * \brief Mean of the samples in the window // Média das amostras na janela
+ *
+ * \param window - Pointer to a window advanced to `now` // Ponteiro para uma janela avançada até `now`
+ * \return Mean, 0 if the window is empty // Média, 0 se a janela estiver vazia
+ */
+double sliding_window_mean(const SlidingWindow *window);
+
+/**
+ * \brief Empty report statistics // Estatísticas de laudos vazias
+ *
+ * \param stream - Statistics to reset // Estatísticas a zerar
+ * \param window_seconds - Length of the live windows // Tamanho das janelas recentes
+ */
+void report_stream_init(ReportStream *stream, double window_seconds);
+
+/**
+ * \brief Add a finished report // Adiciona um laudo finalizado
+ *
+ * \param stream - Pointer to the statistics // Ponteiro para as estatísticas
+ * \param priority - 1 to STREAM_PRIORITIES, anything else only counts in the totals // Fora de 1 a 6 conta só nos totais
+ * \param now - Simulated time // Tempo simulado
+ * \param duration - Report duration // Duração do laudo
+ */
+void report_stream_add(ReportStream *stream, int priority, double now, double duration);
+
+/**
+ * \brief Add the reports of another stream with the same window length // Soma os laudos de outro fluxo com o mesmo tamanho de janela
+ *
+ * \param into - Receives the reports // Recebe os laudos
+ * \param from - Stream to add // Fluxo a somar
+ */
+void report_stream_merge(ReportStream *into, const ReportStream *from);
+
+/**
+ * \brief Advance every window to `now` // Avança todas as janelas até `now`
+ *
+ * \param stream - Pointer to the statistics // Ponteiro para as estatísticas
+ * \param now - Simulated time // Tempo simulado
+ */
+void report_stream_advance(ReportStream *stream, double now);
+
+#endif // STREAM_STATS_H_INCLUDED
@@ -0,0 +1,690 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include "queue.h"
+#include "patient.h"
+#include "exam.h"
+#include "rx_machine.h"
+#include "medical_check.h"
+#include "time_control.h"
+#include "sim_config.h"
+#include "rng.h"
+#include "logger.h"
+#include "arrival_trace.h"
+#include "db_log.h"
+#include <limits.h>
+
+/*
+ * End-to-end stress benchmark // Benchmark de estresse ponta a ponta
+ *
+ * Drives arrival -> RX machine + AI diagnosis -> priority queue -> doctor report -> DB write with every
+ * artificial delay removed (set_time_scale(0)). Stages are connected the same way the simulation connects
+ * them: V_queue and ExamPriorityQueue behind a mutex, a single machine list, stdio db files.
+ * Results are JSON: sustained events/s, queue depths, CPU time per stage, and an optional thread sweep.
+ */
+
+#define STRESS_DEFAULT_PATIENTS 1000000
+#define STRESS_DEFAULT_BACKLOG 10000
+#define STRESS_DEFAULT_AI_BATCH 1
+#define STRESS_SAMPLE_INTERVAL 0.010   // Seconds between queue depth samples // Segundos entre amostras das filas
+#define STRESS_MAX_THREADS 64
+
+enum stress_stage { STAGE_ARRIVAL = 0, STAGE_MACHINE, STAGE_DOCTOR, STAGE_COUNT };
+static const char *stage_names[STAGE_COUNT] = {"arrival", "rx_machine_ai", "doctor_report"};
+
+typedef struct stress_config {
+    long patients;
+    int machines;      // Machine stage threads // Threads do estágio de máquinas
+    int doctors;       // Doctor stage threads // Threads do estágio de médicos
+    int backlog;       // Arrival waits while this many patients are queued // A chegada espera enquanto houver essa quantidade na fila
+    const char *db_dir;
+    int routing;       // RxRoutingPolicy of the machine pool // Política de roteamento do pool de máquinas
+    int ai_batch;      // Exams per AI kernel call, 0 disables the AI stage // Exames por chamada do kernel de IA
+    double ai_timeout;
+    AiKernel ai_kernel;
+    int image_size;    // Synthetic X-ray image side per exam, 0 for none // Lado da imagem sintética por exame, 0 para nenhuma
+    int image_kernels; // XrayKernels
+    const char *trace; // Arrival trace replayed instead of patient_in() // Trace de chegadas reproduzido no lugar do patient_in()
+    double replay_speed; // Trace seconds per wall second, 0 as fast as possible // Segundos do trace por segundo real, 0 o mais rápido possível
+    int overflow;      // OverflowPolicy of the patient and priority queues // Política de estouro das filas
+    int level_capacity;    // Exams per priority level, 0 for unbounded // Exames por nível de prioridade, 0 para ilimitado
+    int exam_capacity;     // Exams in all levels, 0 for unbounded // Exames em todos os níveis, 0 para ilimitado
+    int overflow_capacity; // Items per overflow queue, 0 for unbounded // Itens por fila de estouro, 0 para ilimitado
+    int db_shards;         // Each writer thread appends to its own shard of db_dir, merged after the run // Uma fatia por thread
+    int db_io;             // AsyncIoKind of the shard writes // Tipo de gravação das fatias
+    int db_sync;           // fdatasync every N shard buffers, 0 for never // fdatasync a cada N buffers, 0 para nunca
+} StressConfig;
+
+typedef struct stress_pipeline {
+    const StressConfig *config;
+
+    pthread_mutex_t patient_mutex;
+    pthread_cond_t patient_ready;
+    pthread_cond_t patient_space;
+    V_queue *patients;
+    V_queue *patient_overflow;
+    AdmissionStats patient_admission;
+    int patient_depth;
+    int arrivals_done;
+    long arrivals;
+    ArrivalTrace *trace;
+
+    RxPool *machines;
+    AiModel *ai_model;
+    AiBatcher *ai_stage;
+
+    pthread_mutex_t exam_mutex;
+    pthread_cond_t exam_ready;
+    pthread_cond_t exam_space;
+    ExamPriorityQueue *exams;
+    int exam_depth;
+    int machines_running;
+
+    FILE *patient_file;
+    FILE *exam_file;
+    FILE *report_file;
+    DbLog *patient_log;    // NULL without --db-shards // NULL sem --db-shards
+    DbLog *exam_log;
+    DbLog *report_log;
+
+    pthread_mutex_t stats_mutex;
+    int streams;           // Random streams handed out, past RNG_STREAMS the threads share one // Streams aleatórios entregues
+    long reports_done;
+    long reports_delayed;
+    long trace_labeled;    // Exams whose patient came with a real condition // Exames cujo paciente veio com a condição real
+    long trace_agreed;     // ... and the AI diagnosed it // ... e a IA diagnosticou
+    double stage_cpu[STAGE_COUNT];
+    int stage_threads[STAGE_COUNT];
+
+    volatile int sampling;
+    double patient_depth_sum;
+    double exam_depth_sum;
+    int patient_depth_max;
+    int exam_depth_max;
+    long samples;
+} StressPipeline;
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static double thread_cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void add_stage_cpu(StressPipeline *pipeline, int stage) {
+// Called by each worker when it finishes // Chamado por cada thread ao terminar
+    double cpu = thread_cpu_seconds();
+    pthread_mutex_lock(&pipeline->stats_mutex);
+    pipeline->stage_cpu[stage] += cpu;
+    pipeline->stage_threads[stage]++;
+    pthread_mutex_unlock(&pipeline->stats_mutex);
+}
+
+static void bind_random_stream(StressPipeline *pipeline) {
+// Called by each worker when it starts, so its draws take no lock // Chamado por cada thread ao começar
+    pthread_mutex_lock(&pipeline->stats_mutex);
+    int stream = pipeline->streams++;
+    pthread_mutex_unlock(&pipeline->stats_mutex);
+    rng_bind_stream(stream < RNG_STREAMS ? stream : -1);
+}
+
+static void save_record(FILE *file, DbLog *log, const char *record, int length) {
+// One formatted record, in one call to the shared file or to the calling thread's shard
+// Um registro formatado, numa só chamada ao arquivo compartilhado ou à fatia da thread
+    if (length < 0 || (log && db_log_append(log, record, length) != 0)) {
+        fprintf(stderr, "Error: could not save a db record\n");
+        exit(1);
+    }
+    if (!log) {
+        fwrite(record, 1, length, file);
+    }
+}
+
+static Patient *next_trace_patient(StressPipeline *pipeline, double start, double *origin) {
+// Reads the next trace record, waiting for its time when replay_speed > 0 // Lê o próximo registro, esperando seu horário quando replay_speed > 0
+    TraceRecord record;
+    if (!arrival_trace_next(pipeline->trace, &record)) {
+        return NULL;
+    }
+    if (pipeline->arrivals == 0) {
+        *origin = record.timestamp;
+    }
+
+    if (pipeline->config->replay_speed > 0) {
+        // my_sleep() is disabled in the stress run, so wait on the wall clock directly
+        double wait = start + (record.timestamp - *origin) / pipeline->config->replay_speed - now_seconds();
+        if (wait > 0) {
+            struct timespec delay = {(time_t)wait, (long)((wait - (time_t)wait) * 1e9)};
+            nanosleep(&delay, NULL);
+        }
+    }
+
+    time_t now = time(NULL);
+    struct tm arrival;
+    localtime_r(&now, &arrival);
+    Patient *patient = create_patient(record.patient_id, record.name, &arrival);
+    set_patient_condition(patient, record.condition);
+    return patient;
+}
+
+static void *arrival_stage(void *args) {
+// Creates every patient as fast as the backlog allows // Cria todos os pacientes tão rápido quanto o limite permite
+    StressPipeline *pipeline = (StressPipeline*)args;
+    double start = now_seconds();
+    double origin = 0;
+    bind_random_stream(pipeline);
+
+    for (long i = 0; i < pipeline->config->patients; i++) {
+        Patient *patient = pipeline->trace ? next_trace_patient(pipeline, start, &origin) : patient_in();
+        if (!patient) {
+            break; // End of the trace // Fim do trace
+        }
+        pipeline->arrivals++;
+
+        char record[PATIENT_DB_RECORD];
+        save_record(pipeline->patient_file, pipeline->patient_log, record, format_patient_db(patient, record, sizeof(record)));
+
+        pthread_mutex_lock(&pipeline->patient_mutex);
+        AdmissionResult result;
+        while ((result = admit_to_queue(pipeline->patients, pipeline->patient_overflow, patient,
+                                        pipeline->config->overflow, &pipeline->patient_admission)) == ADMIT_WAIT) {
+            pipeline->patient_admission.waits++;
+            pthread_cond_wait(&pipeline->patient_space, &pipeline->patient_mutex);
+        }
+        if (result == ADMIT_REJECTED) {
+            destroy_patient(patient);
+        } else {
+            pipeline->patient_depth = queue_size(pipeline->patients) + queue_size(pipeline->patient_overflow);
+            pthread_cond_signal(&pipeline->patient_ready);
+        }
+        pthread_mutex_unlock(&pipeline->patient_mutex);
+    }
+
+    pthread_mutex_lock(&pipeline->patient_mutex);
+    pipeline->arrivals_done = 1;
+    pthread_cond_broadcast(&pipeline->patient_ready);
+    pthread_mutex_unlock(&pipeline->patient_mutex);
+
+    add_stage_cpu(pipeline, STAGE_ARRIVAL);
+    return NULL;
+}
+
+static void *machine_stage(void *args) {
+// Takes patients, runs the exam with AI diagnosis, and queues the exam by priority // Retira pacientes, faz o exame e enfileira por prioridade
+    StressPipeline *pipeline = (StressPipeline*)args;
+    long labeled = 0;
+    long agreed = 0;
+    bind_random_stream(pipeline);
+
+    for (;;) {
+        pthread_mutex_lock(&pipeline->patient_mutex);
+        while (pipeline->patient_depth == 0 && !pipeline->arrivals_done) {
+            pthread_cond_wait(&pipeline->patient_ready, &pipeline->patient_mutex);
+        }
+        if (pipeline->patient_depth == 0) {
+            pthread_mutex_unlock(&pipeline->patient_mutex);
+            break;
+        }
+        Patient *patient = P_denqueue(pipeline->patients);
+        admission_refill(pipeline->patients, pipeline->patient_overflow);
+        pipeline->patient_depth = queue_size(pipeline->patients) + queue_size(pipeline->patient_overflow);
+        pthread_cond_signal(&pipeline->patient_space);
+        pthread_mutex_unlock(&pipeline->patient_mutex);
+
+        Exam *exam = verify_and_ocupate(pipeline->machines, patient);
+        if (get_patient_condition(patient)) {
+            labeled++;
+            agreed += strcmp(get_patient_condition(patient), get_exam_condition(exam)) == 0;
+        }
+        destroy_patient(patient);
+
+        char record[EXAM_DB_RECORD];
+        save_record(pipeline->exam_file, pipeline->exam_log, record, format_exam_db(exam, record, sizeof(record)));
+
+        pthread_mutex_lock(&pipeline->exam_mutex);
+        Exam *dropped = NULL;
+        AdmissionResult result;
+        while ((result = offer_priority_exam(pipeline->exams, exam, &dropped)) == ADMIT_WAIT) {
+            pthread_cond_wait(&pipeline->exam_space, &pipeline->exam_mutex);
+        }
+        pipeline->exam_depth = priority_queue_waiting(pipeline->exams) + priority_queue_overflow_size(pipeline->exams);
+        if (result != ADMIT_REJECTED) {
+            pthread_cond_signal(&pipeline->exam_ready);
+        }
+        pthread_mutex_unlock(&pipeline->exam_mutex);
+        if (result == ADMIT_REJECTED) {
+            destroy_exam(exam);
+        }
+        if (dropped) {
+            destroy_exam(dropped);
+        }
+    }
+
+    pthread_mutex_lock(&pipeline->exam_mutex);
+    pipeline->machines_running--;
+    pthread_cond_broadcast(&pipeline->exam_ready);
+    pthread_mutex_unlock(&pipeline->exam_mutex);
+
+    pthread_mutex_lock(&pipeline->stats_mutex);
+    pipeline->trace_labeled += labeled;
+    pipeline->trace_agreed += agreed;
+    pthread_mutex_unlock(&pipeline->stats_mutex);
+
+    add_stage_cpu(pipeline, STAGE_MACHINE);
+    return NULL;
+}
+
+static void *doctor_stage(void *args) {
+// Takes the most urgent exam, writes the report and updates the counters // Retira o exame mais urgente, grava o laudo e atualiza os contadores
+    StressPipeline *pipeline = (StressPipeline*)args;
+    long done = 0;
+    long delayed = 0;
+    bind_random_stream(pipeline);
+
+    for (;;) {
+        pthread_mutex_lock(&pipeline->exam_mutex);
+        while (pipeline->exam_depth == 0 && pipeline->machines_running > 0) {
+            pthread_cond_wait(&pipeline->exam_ready, &pipeline->exam_mutex);
+        }
+        if (pipeline->exam_depth == 0) {
+            pthread_mutex_unlock(&pipeline->exam_mutex);
+            break;
+        }
+        Exam *exam = get_priority_exams(pipeline->exams);
+        pipeline->exam_depth = priority_queue_waiting(pipeline->exams) + priority_queue_overflow_size(pipeline->exams);
+        pthread_cond_signal(&pipeline->exam_space);
+        pthread_mutex_unlock(&pipeline->exam_mutex);
+
+        double report_duration = report_random_time(); // Same duration model as report() in main.c, without the sleep
+        Report *report = do_medical_report(exam);
+
+        char record[REPORT_DB_RECORD];
+        save_record(pipeline->report_file, pipeline->report_log, record, format_report_db(report, record, sizeof(record)));
+
+        done++;
+        if (report_duration > sim_config()->report_limit) {
+            delayed++;
+        }
+        free_report(report);
+        destroy_exam(exam);
+    }
+
+    pthread_mutex_lock(&pipeline->stats_mutex);
+    pipeline->reports_done += done;
+    pipeline->reports_delayed += delayed;
+    pthread_mutex_unlock(&pipeline->stats_mutex);
+
+    add_stage_cpu(pipeline, STAGE_DOCTOR);
+    return NULL;
+}
+
+static void *sampler(void *args) {
+// Samples the queue depths at a fixed interval // Amostra a profundidade das filas em intervalo fixo
+    StressPipeline *pipeline = (StressPipeline*)args;
+    struct timespec interval = {0, (long)(STRESS_SAMPLE_INTERVAL * 1e9)};
+
+    while (pipeline->sampling) {
+        pthread_mutex_lock(&pipeline->patient_mutex);
+        int patients = pipeline->patient_depth;
+        pthread_mutex_unlock(&pipeline->patient_mutex);
+
+        pthread_mutex_lock(&pipeline->exam_mutex);
+        int exams = pipeline->exam_depth;
+        pthread_mutex_unlock(&pipeline->exam_mutex);
+
+        pipeline->patient_depth_sum += patients;
+        pipeline->exam_depth_sum += exams;
+        if (patients > pipeline->patient_depth_max) pipeline->patient_depth_max = patients;
+        if (exams > pipeline->exam_depth_max) pipeline->exam_depth_max = exams;
+        pipeline->samples++;
+
+        nanosleep(&interval, NULL);
+    }
+    return NULL;
+}
+
+static FILE *open_db(const char *dir, const char *name) {
+    char path[512];
+    if (!dir) {
+        return fopen("/dev/null", "w");
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return fopen(path, "w");
+}
+
+static DbLog *open_db_log(const StressConfig *config, const char *name) {
+    char path[512];
+    if (!config->db_shards) {
+        return NULL;
+    }
+    snprintf(path, sizeof(path), "%s/%s", config->db_dir, name);
+    return create_db_log(path, (AsyncIoKind)config->db_io, config->db_sync);
+}
+
+static int merge_db_log(DbLog *log, FILE *file, DbLogMerge *total) {
+// Appends a log's shards to its db file and adds up the counts // Acrescenta as fatias ao arquivo db e soma as contagens
+    DbLogMerge merge = {0, 0, 0};
+    int status = log ? db_log_merge(log, file, &merge) : 0;
+    total->records += merge.records;
+    total->torn += merge.torn;
+    total->shards += merge.shards;
+    return status;
+}
+
+static int run_stress(const StressConfig *config, int first) {
+// Runs the pipeline once and prints one JSON object // Executa o pipeline uma vez e imprime um objeto JSON
+    StressPipeline pipeline;
+    pthread_t arrival, sampling_thread;
+    pthread_t machines[STRESS_MAX_THREADS], doctors[STRESS_MAX_THREADS];
+
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.config = config;
+    pthread_mutex_init(&pipeline.patient_mutex, NULL);
+    pthread_cond_init(&pipeline.patient_ready, NULL);
+    pthread_cond_init(&pipeline.patient_space, NULL);
+    pthread_mutex_init(&pipeline.exam_mutex, NULL);
+    pthread_cond_init(&pipeline.exam_ready, NULL);
+    pthread_cond_init(&pipeline.exam_space, NULL);
+    pthread_mutex_init(&pipeline.stats_mutex, NULL);
+
+    pipeline.patients = create_queue();
+    pipeline.patient_overflow = create_queue();
+    set_queue_capacity(pipeline.patients, config->backlog);
+    set_queue_capacity(pipeline.patient_overflow, config->overflow_capacity);
+    pipeline.machines = create_machines(config->machines);
+    set_routing_policy(pipeline.machines, (RxRoutingPolicy)config->routing);
+    if (config->ai_batch > 0) {
+        pipeline.ai_model = create_ai_model(1);
+        pipeline.ai_stage = create_ai_batcher(pipeline.ai_model, config->ai_kernel, config->ai_batch, config->ai_timeout);
+        ai_batcher_start(pipeline.ai_stage);
+        set_ai_batcher(pipeline.machines, pipeline.ai_stage);
+    }
+    set_exam_imaging(pipeline.machines, config->image_size, config->image_size, (XrayKernels)config->image_kernels);
+    if (config->trace && !(pipeline.trace = open_arrival_trace(config->trace))) {
+        fprintf(stderr, "Error: can't read the arrival trace %s\n", config->trace);
+        return -1;
+    }
+    pipeline.exams = new_priority_queue();
+    set_priority_queue_limits(pipeline.exams, config->level_capacity, config->exam_capacity, config->overflow, config->overflow_capacity);
+    pipeline.machines_running = config->machines;
+    pipeline.patient_file = open_db(config->db_dir, "db_patient.txt");
+    pipeline.exam_file = open_db(config->db_dir, "db_exam.txt");
+    pipeline.report_file = open_db(config->db_dir, "db_report.txt");
+    if (!pipeline.patients || !pipeline.patient_file || !pipeline.exam_file || !pipeline.report_file) {
+        fprintf(stderr, "Error: could not set up the stress pipeline\n");
+        return -1;
+    }
+    pipeline.patient_log = open_db_log(config, "db_patient.txt");
+    pipeline.exam_log = open_db_log(config, "db_exam.txt");
+    pipeline.report_log = open_db_log(config, "db_report.txt");
+
+    double start = now_seconds();
+    double process_cpu_start = (double)clock() / CLOCKS_PER_SEC;
+
+    pipeline.sampling = 1;
+    pthread_create(&sampling_thread, NULL, sampler, &pipeline);
+    pthread_create(&arrival, NULL, arrival_stage, &pipeline);
+    for (int i = 0; i < config->machines; i++) {
+        pthread_create(&machines[i], NULL, machine_stage, &pipeline);
+    }
+    for (int i = 0; i < config->doctors; i++) {
+        pthread_create(&doctors[i], NULL, doctor_stage, &pipeline);
+    }
+
+    pthread_join(arrival, NULL);
+    for (int i = 0; i < config->machines; i++) {
+        pthread_join(machines[i], NULL);
+    }
+    for (int i = 0; i < config->doctors; i++) {
+        pthread_join(doctors[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+    DbLogMerge merged = {0, 0, 0}; // Timed apart: the run above measures only the writers // Medida à parte
+    int merge_failed = merge_db_log(pipeline.patient_log, pipeline.patient_file, &merged) != 0;
+    merge_failed |= merge_db_log(pipeline.exam_log, pipeline.exam_file, &merged) != 0;
+    merge_failed |= merge_db_log(pipeline.report_log, pipeline.report_file, &merged) != 0;
+    double merge_seconds = now_seconds() - start - elapsed;
+    fflush(pipeline.patient_file);
+    fflush(pipeline.exam_file);
+    fflush(pipeline.report_file);
+    double process_cpu = (double)clock() / CLOCKS_PER_SEC - process_cpu_start;
+    pipeline.sampling = 0;
+    pthread_join(sampling_thread, NULL);
+
+    long samples = pipeline.samples > 0 ? pipeline.samples : 1;
+    AiBatchStats ai_stats;
+    ai_batcher_stop(pipeline.ai_stage);
+    get_ai_batch_stats(pipeline.ai_stage, &ai_stats);
+    ImageStoreStats image_stats;
+    get_image_store_stats(get_exam_image_store(pipeline.machines), &image_stats);
+    printf("%s    {\"patients\": %ld, \"machine_threads\": %d, \"doctor_threads\": %d, \"routing\": \"%s\", \"image_size\": %d, "
+           "\"seconds\": %.4f, \"patients_per_sec\": %.0f, \"events_per_sec\": %.0f, "
+           "\"reports\": %ld, \"reports_delayed\": %ld, \"process_cpu_seconds\": %.4f, \"machine_utilization\": %.3f,\n"
+           "     \"images\": {\"buffers\": %d, \"peak_in_flight\": %d, \"mapped_mb\": %.1f},\n"
+           "     \"ai\": {\"batch\": %d, \"mean_batch\": %.2f, \"mean_wait_ms\": %.3f, \"kernel_seconds\": %.4f},\n"
+           "     \"queue_depth\": {\"patient_mean\": %.1f, \"patient_max\": %d, \"priority_mean\": %.1f, \"priority_max\": %d},\n"
+           "     \"stage_cpu_seconds\": {",
+           first ? "" : ",\n", pipeline.arrivals, config->machines, config->doctors, routing_policy_name((RxRoutingPolicy)config->routing), config->image_size,
+           elapsed, pipeline.reports_done / elapsed,
+           // Each patient goes through 5 events: arrival, exam, diagnosis, queue insert, report
+           pipeline.reports_done * 5.0 / elapsed,
+           pipeline.reports_done, pipeline.reports_delayed, process_cpu, machines_utilization(pipeline.machines),
+           image_stats.buffers, image_stats.peak_in_use, image_stats.mapped_bytes / (1024.0 * 1024.0),
+           config->ai_batch, ai_stats.mean_batch, ai_stats.mean_wait_seconds * 1e3, ai_stats.kernel_seconds,
+           pipeline.patient_depth_sum / samples, pipeline.patient_depth_max,
+           pipeline.exam_depth_sum / samples, pipeline.exam_depth_max);
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        printf("%s\"%s\": %.4f", s ? ", " : "", stage_names[s], pipeline.stage_cpu[s]);
+    }
+    printf("}");
+    AdmissionStats exam_admission;
+    get_priority_admission_stats(pipeline.exams, 0, &exam_admission);
+    printf(",\n     \"admission\": {\"overflow\": \"%s\", \"patients_rejected\": %ld, \"patients_diverted\": %ld, \"patient_waits\": %ld, "
+           "\"exams_rejected\": %ld, \"exams_diverted\": %ld, \"exams_dropped\": %ld, \"exam_waits\": %ld}",
+           overflow_policy_name(config->overflow), pipeline.patient_admission.rejected, pipeline.patient_admission.diverted,
+           pipeline.patient_admission.waits, exam_admission.rejected, exam_admission.diverted, exam_admission.dropped,
+           exam_admission.waits);
+    if (pipeline.trace) {
+        TraceStats trace_stats;
+        get_arrival_trace_stats(pipeline.trace, &trace_stats);
+        printf(",\n     \"trace\": {\"records\": %ld, \"skipped\": %ld, \"binary\": %d, \"replay_speed\": %.2f, \"labeled\": %ld, \"ai_agreement\": %.3f}",
+               trace_stats.records, trace_stats.skipped, trace_stats.binary, config->replay_speed, pipeline.trace_labeled,
+               pipeline.trace_labeled > 0 ? (double)pipeline.trace_agreed / pipeline.trace_labeled : 0.0);
+    }
+    if (config->db_shards) {
+        AsyncIoStats io;
+        memset(&io, 0, sizeof(io));
+        add_db_log_io_stats(pipeline.patient_log, &io);
+        add_db_log_io_stats(pipeline.exam_log, &io);
+        add_db_log_io_stats(pipeline.report_log, &io);
+        printf(",\n     \"db_shards\": {\"shards\": %d, \"records\": %ld, \"torn\": %ld, \"merge_seconds\": %.4f, \"merged\": %s, "
+               "\"io\": \"%s\", \"uring_shards\": %d, \"fixed_shards\": %d, \"writes\": %ld, \"syncs\": %ld, \"stalls\": %ld, \"retries\": %ld}",
+               merged.shards, merged.records, merged.torn, merge_seconds, merge_failed ? "false" : "true",
+               config->db_io == ASYNC_IO_URING ? "uring" : "write", io.uring, io.fixed, io.writes, io.syncs, io.stalls, io.retries);
+    }
+    printf("}");
+    fflush(stdout);
+
+    P_free_queue(pipeline.patients);
+    P_free_queue(pipeline.patient_overflow);
+    close_arrival_trace(pipeline.trace);
+    destroy_machines(pipeline.machines);
+    destroy_ai_batcher(pipeline.ai_stage);
+    destroy_ai_model(pipeline.ai_model);
+    free_priority_queue(pipeline.exams);
+    destroy_db_log(pipeline.patient_log);
+    destroy_db_log(pipeline.exam_log);
+    destroy_db_log(pipeline.report_log);
+    fclose(pipeline.patient_file);
+    fclose(pipeline.exam_file);
+    fclose(pipeline.report_file);
+    pthread_mutex_destroy(&pipeline.patient_mutex);
+    pthread_cond_destroy(&pipeline.patient_ready);
+    pthread_cond_destroy(&pipeline.patient_space);
+    pthread_mutex_destroy(&pipeline.exam_mutex);
+    pthread_cond_destroy(&pipeline.exam_ready);
+    pthread_cond_destroy(&pipeline.exam_space);
+    pthread_mutex_destroy(&pipeline.stats_mutex);
+
+    return 0;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -p, --patients N     Patients pushed through the pipeline (default %d)\n", STRESS_DEFAULT_PATIENTS);
+    printf("  -m, --machines N     Machine stage threads (default 5)\n");
+    printf("  -d, --doctors N      Doctor stage threads (default 5)\n");
+    printf("  -b, --backlog N      Maximum patients waiting for a machine (default %d)\n", STRESS_DEFAULT_BACKLOG);
+    printf("  -o, --db-dir DIR     Write db_*.txt into DIR instead of /dev/null\n");
+    printf("  -r, --routing POLICY first-free, least-loaded, shortest-expected or jsq (default first-free)\n");
+    printf("      --ai-batch N     Exams per AI kernel call, 0 disables the AI stage (default %d)\n", STRESS_DEFAULT_AI_BATCH);
+    printf("      --ai-timeout MS  Longest wait for an AI batch to fill (default 1 ms)\n");
+    printf("      --ai-kernel NAME simd or scalar (default simd)\n");
+    printf("      --image-size N   Synthetic X-ray image side per exam, 0 disables it (default 0)\n");
+    printf("      --image-kernels K simd or scalar image preprocessing (default simd)\n");
+    printf("      --trace FILE     Replay a CSV or binary arrival trace instead of random patients (all of it unless -p)\n");
+    printf("      --replay-speed X Trace seconds per wall second, 0 replays as fast as possible (default 0)\n");
+    printf("      --trace-export OUT Convert --trace to a binary trace in OUT and exit\n");
+    printf("      --overflow POLICY block, reject, divert or drop-lowest when a queue is full (default block)\n");
+    printf("      --level-capacity N Exams per priority level, 0 for unbounded (default 0)\n");
+    printf("      --exam-capacity N Exams in all priority levels, 0 for unbounded (default 0)\n");
+    printf("      --overflow-capacity N divert: items per overflow queue, 0 for unbounded (default 0)\n");
+    printf("      --config FILE    Clinic constants, one key = value per line (see clinic_simulation --print-config)\n");
+    printf("      --set KEY=VALUE  Override one clinic constant, after any --config before it\n");
+    printf("      --db-shards      Each thread appends to its own DIR/db_*.txt.<n>.shard, merged by timestamp after the run (needs -o)\n");
+    printf("      --db-io KIND     write or uring: shard buffers written with pwrite() or queued to io_uring (implies --db-shards)\n");
+    printf("      --db-sync N      fdatasync every N buffers of a shard, linked to the write with uring, 0 for never (default 0)\n");
+    printf("  -s, --sweep          Run 1, 2, 4 ... %d machine/doctor threads\n", STRESS_MAX_THREADS);
+}
+
+int main(int argc, char *argv[]) {
+    SimConfig constants;
+    static const struct option options[] = {
+        {"patients", required_argument, NULL, 'p'},
+        {"machines", required_argument, NULL, 'm'},
+        {"doctors", required_argument, NULL, 'd'},
+        {"backlog", required_argument, NULL, 'b'},
+        {"db-dir", required_argument, NULL, 'o'},
+        {"routing", required_argument, NULL, 'r'},
+        {"ai-batch", required_argument, NULL, 'B'},
+        {"ai-timeout", required_argument, NULL, 'T'},
+        {"ai-kernel", required_argument, NULL, 'K'},
+        {"image-size", required_argument, NULL, 'I'},
+        {"image-kernels", required_argument, NULL, 'G'},
+        {"trace", required_argument, NULL, 't'},
+        {"replay-speed", required_argument, NULL, 'X'},
+        {"trace-export", required_argument, NULL, 'E'},
+        {"overflow", required_argument, NULL, 'O'},
+        {"level-capacity", required_argument, NULL, 'L'},
+        {"exam-capacity", required_argument, NULL, 'C'},
+        {"overflow-capacity", required_argument, NULL, 'V'},
+        {"db-shards", no_argument, NULL, 'H'},
+        {"db-io", required_argument, NULL, 'J'},
+        {"db-sync", required_argument, NULL, 'j'},
+        {"sweep", no_argument, NULL, 's'},
+        SIM_CONFIG_OPTIONS,
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    static const char short_options[] = "p:m:d:b:o:r:sh";
+    if (sim_config_from_arguments(&constants, argc, argv, short_options, options) != 0) {
+        return 1;
+    }
+    sim_config_install(&constants); // Read by every module from here on // Lida por todos os módulos daqui em diante
+    StressConfig config = {STRESS_DEFAULT_PATIENTS, 5, 5, STRESS_DEFAULT_BACKLOG, NULL, RX_ROUTE_FIRST_FREE,
+                           STRESS_DEFAULT_AI_BATCH, 0.001, ai_kernel_simd, 0, XRAY_SIMD, NULL, 0,
+                           OVERFLOW_BLOCK, 0, 0, 0, 0, ASYNC_IO_WRITE, 0};
+    const char *trace_export = NULL;
+    int patients_given = 0;
+    int sweep = 0;
+    int option;
+
+    while ((option = getopt_long(argc, argv, short_options, options, NULL)) != -1) {
+        switch (option) {
+        case 'p': config.patients = atol(optarg); patients_given = 1; break;
+        case 'm': config.machines = atoi(optarg); break;
+        case 'd': config.doctors = atoi(optarg); break;
+        case 'b': config.backlog = atoi(optarg); break;
+        case 'o': config.db_dir = optarg; break;
+        case 'r': config.routing = routing_policy_from_name(optarg); break;
+        case 'B': config.ai_batch = atoi(optarg); break;
+        case 'T': config.ai_timeout = atof(optarg) / 1000.0; break;
+        case 'K': config.ai_kernel = ai_kernel_from_name(optarg); break;
+        case 'I': config.image_size = atoi(optarg); break;
+        case 'G': config.image_kernels = xray_kernels_from_name(optarg); break;
+        case 't': config.trace = optarg; break;
+        case 'X': config.replay_speed = atof(optarg); break;
+        case 'E': trace_export = optarg; break;
+        case 'O': config.overflow = overflow_policy_from_name(optarg); break;
+        case 'L': config.level_capacity = atoi(optarg); break;
+        case 'C': config.exam_capacity = atoi(optarg); break;
+        case 'V': config.overflow_capacity = atoi(optarg); break;
+        case 'H': config.db_shards = 1; break;
+        case 'J': config.db_io = async_io_from_name(optarg); config.db_shards = 1; break;
+        case 'j': config.db_sync = atoi(optarg); break;
+        case 's': sweep = 1; break;
+        case CONFIG_OPTION_FILE: case CONFIG_OPTION_SET: break; // Applied above
+        default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (config.patients < 1 || config.backlog < 1 || config.routing < 0 ||
+        config.ai_batch < 0 || config.ai_batch > AI_MAX_BATCH || !config.ai_kernel ||
+        config.image_size < 0 || config.image_size == 1 || config.image_kernels < 0 ||
+        config.replay_speed < 0 || (trace_export && !config.trace) || (config.db_shards && !config.db_dir) || config.overflow < 0 ||
+        config.db_io < 0 || config.db_sync < 0 ||
+        config.level_capacity < 0 || config.exam_capacity < 0 || config.overflow_capacity < 0 ||
+        config.machines < 1 || config.machines > STRESS_MAX_THREADS ||
+        config.doctors < 1 || config.doctors > STRESS_MAX_THREADS) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (trace_export) {
+        ArrivalTrace *trace = open_arrival_trace(config.trace);
+        FILE *output = fopen(trace_export, "wb");
+        long written = trace && output ? write_binary_trace(trace, output) : -1;
+        if (output && fclose(output) != 0) {
+            written = -1;
+        }
+        close_arrival_trace(trace);
+        if (written < 0) {
+            fprintf(stderr, "Error: could not convert %s to %s\n", config.trace, trace_export);
+            return 1;
+        }
+        printf("%ld records written to %s\n", written, trace_export);
+        return 0;
+    }
+    if (config.trace && !patients_given) {
+        config.patients = LONG_MAX; // The whole trace // O trace inteiro
+    }
+
+    log_set_quiet(1);   // Console output would be the only thing measured otherwise
+    set_time_scale(0);  // No artificial delays: exams and reports cost only their CPU work
+    rng_seed((unsigned int)time(NULL));
+
+    printf("{\n  \"runs\": [\n");
+    if (sweep) {
+        int first = 1;
+        for (int threads = 1; threads <= STRESS_MAX_THREADS; threads *= 2) {
+            config.machines = threads;
+            config.doctors = threads;
+            if (run_stress(&config, first) != 0) {
+                return 1;
+            }
+            first = 0;
+        }
+    } else if (run_stress(&config, 1) != 0) {
+        return 1;
+    }
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
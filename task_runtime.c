@@ -0,0 +1,419 @@
+#include "task_runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define TASK_HEAP_INITIAL 1024
+
+typedef enum task_state { TASK_RUNNABLE, TASK_RUNNING, TASK_WAITING } TaskState;
+
+struct task {
+    Task *next;            // Run queue or semaphore wait list // Fila de prontas ou lista de espera do semáforo
+    TaskStep step;
+    void *data;
+    TaskRuntime *runtime;
+    double wake_at;        // Virtual time of its timer // Tempo virtual do seu timer
+    long sequence;         // Breaks timer ties in FIFO order // Desempata timers em ordem FIFO
+    TaskState state;
+    int woken;             // Woken while its step was still running // Acordada enquanto o passo ainda rodava
+};
+
+typedef struct task_list {
+    Task *head;
+    Task *tail;
+} TaskList;
+
+struct task_runtime {
+    pthread_mutex_t mutex;      // Guards everything below and every semaphore // Protege tudo abaixo e todos os semáforos
+    pthread_cond_t work;        // A task became runnable, or the run ended // Uma tarefa ficou pronta, ou a execução acabou
+    int workers;
+    TaskList runnable;
+    Task **timers;              // Min-heap on (wake_at, sequence) // Min-heap por (wake_at, sequence)
+    long timer_count;
+    long timer_capacity;
+    long sequence;
+    double now;
+    int running;                // Steps executing right now // Passos executando agora
+    long live;
+    int finished;
+    TaskRuntimeStats stats;
+};
+
+struct task_semaphore {
+    TaskRuntime *runtime;
+    int permits;
+    int priorities;
+    int waiting;
+    TaskList waiters[TASK_MAX_PRIORITIES];
+};
+
+static void list_push(TaskList *list, Task *task) {
+    task->next = NULL;
+    if (list->tail) {
+        list->tail->next = task;
+    } else {
+        list->head = task;
+    }
+    list->tail = task;
+}
+
+static Task *list_pop(TaskList *list) {
+    Task *task = list->head;
+    if (task) {
+        list->head = task->next;
+        if (!list->head) {
+            list->tail = NULL;
+        }
+        task->next = NULL;
+    }
+    return task;
+}
+
+TaskRuntime *create_task_runtime(int workers) {
+/**
+ * \brief Create a runtime with its clock at 0 // Cria um runtime com o relógio em 0
+ *
+ * \param workers - Worker threads, 1 to TASK_MAX_WORKERS // Threads de trabalho, de 1 a TASK_MAX_WORKERS
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return TaskRuntime* - Pointer to the runtime, NULL if `workers` is out of range // Ponteiro para o runtime, NULL se `workers` estiver fora do intervalo
+ */
+    if (workers < 1 || workers > TASK_MAX_WORKERS) {
+        return NULL;
+    }
+    TaskRuntime *runtime = (TaskRuntime*)calloc(1, sizeof(TaskRuntime));
+    Task **timers = (Task**)malloc(TASK_HEAP_INITIAL * sizeof(Task*));
+    if (!runtime || !timers) {
+        printf("\nError: Memory allocation failed (Task Runtime)\n");
+        exit(1);
+    }
+    pthread_mutex_init(&runtime->mutex, NULL);
+    pthread_cond_init(&runtime->work, NULL);
+    runtime->workers = workers;
+    runtime->timers = timers;
+    runtime->timer_capacity = TASK_HEAP_INITIAL;
+    runtime->stats.task_bytes = sizeof(Task);
+    return runtime;
+}
+
+void destroy_task_runtime(TaskRuntime *runtime) {
+/**
+ * \brief Free the runtime // Libera o runtime
+ *
+ * \details Tasks still queued or sleeping are freed too, their data is not. Tasks stuck on a semaphore belong to it.
+ * \details Tarefas ainda na fila ou dormindo também são liberadas, seus dados não.
+ */
+    if (!runtime) {
+        return;
+    }
+    Task *task;
+    while ((task = list_pop(&runtime->runnable)) != NULL) {
+        free(task);
+    }
+    for (long i = 0; i < runtime->timer_count; i++) {
+        free(runtime->timers[i]);
+    }
+    pthread_mutex_destroy(&runtime->mutex);
+    pthread_cond_destroy(&runtime->work);
+    free(runtime->timers);
+    free(runtime);
+}
+
+static int timer_before(const Task *a, const Task *b) {
+    return a->wake_at < b->wake_at || (a->wake_at == b->wake_at && a->sequence < b->sequence);
+}
+
+static void timer_push(TaskRuntime *runtime, Task *task) {
+// Sift up in the min-heap (mutex held) // Sobe no min-heap (mutex travado)
+    if (runtime->timer_count == runtime->timer_capacity) {
+        long capacity = runtime->timer_capacity * 2;
+        Task **timers = (Task**)realloc(runtime->timers, capacity * sizeof(Task*));
+        if (!timers) {
+            printf("\nError: Memory allocation failed (Task Timers)\n");
+            exit(1);
+        }
+        runtime->timers = timers;
+        runtime->timer_capacity = capacity;
+    }
+    long child = runtime->timer_count++;
+    while (child > 0) {
+        long parent = (child - 1) / 2;
+        if (!timer_before(task, runtime->timers[parent])) {
+            break;
+        }
+        runtime->timers[child] = runtime->timers[parent];
+        child = parent;
+    }
+    runtime->timers[child] = task;
+    if (runtime->timer_count > runtime->stats.peak_sleeping) {
+        runtime->stats.peak_sleeping = runtime->timer_count;
+    }
+}
+
+static Task *timer_pop(TaskRuntime *runtime) {
+// Removes the earliest timer (mutex held) // Remove o timer mais próximo (mutex travado)
+    Task *first = runtime->timers[0];
+    Task *last = runtime->timers[--runtime->timer_count];
+    long parent = 0;
+    for (;;) {
+        long child = parent * 2 + 1;
+        if (child >= runtime->timer_count) {
+            break;
+        }
+        if (child + 1 < runtime->timer_count && timer_before(runtime->timers[child + 1], runtime->timers[child])) {
+            child++;
+        }
+        if (!timer_before(runtime->timers[child], last)) {
+            break;
+        }
+        runtime->timers[parent] = runtime->timers[child];
+        parent = child;
+    }
+    if (runtime->timer_count > 0) {
+        runtime->timers[parent] = last;
+    }
+    return first;
+}
+
+static void make_runnable(TaskRuntime *runtime, Task *task) {
+// Queues a task whose wait is over; if its step is still running, the worker requeues it on return (mutex held)
+// Enfileira uma tarefa cuja espera acabou; se o passo ainda roda, a thread a reenfileira no retorno (mutex travado)
+    if (task->state == TASK_RUNNING) {
+        task->woken = 1;
+        return;
+    }
+    task->state = TASK_RUNNABLE;
+    list_push(&runtime->runnable, task);
+    pthread_cond_signal(&runtime->work);
+}
+
+Task *task_spawn(TaskRuntime *runtime, TaskStep step, void *data) {
+/**
+ * \brief Create a runnable task // Cria uma tarefa pronta
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return Task* - Pointer to the task // Ponteiro para a tarefa
+ */
+    Task *task = (Task*)calloc(1, sizeof(Task));
+    if (!task) {
+        printf("\nError: Memory allocation failed (Task)\n");
+        exit(1);
+    }
+    task->step = step;
+    task->data = data;
+    task->runtime = runtime;
+    task->state = TASK_WAITING;
+
+    pthread_mutex_lock(&runtime->mutex);
+    runtime->live++;
+    runtime->stats.spawned++;
+    if (runtime->live > runtime->stats.peak_live) {
+        runtime->stats.peak_live = runtime->live;
+    }
+    make_runnable(runtime, task);
+    pthread_mutex_unlock(&runtime->mutex);
+    return task;
+}
+
+static void *task_worker(void *args) {
+// Runs steps until no task is left; the last idle worker moves the clock // Roda passos até não sobrar tarefa; a última thread ociosa move o relógio
+    TaskRuntime *runtime = (TaskRuntime*)args;
+
+    pthread_mutex_lock(&runtime->mutex);
+    while (!runtime->finished) {
+        Task *task = list_pop(&runtime->runnable);
+        if (task) {
+            task->state = TASK_RUNNING;
+            task->woken = 0;
+            runtime->running++;
+            runtime->stats.steps++;
+            pthread_mutex_unlock(&runtime->mutex);
+
+            TaskStatus status = task->step(task, task->data);
+
+            pthread_mutex_lock(&runtime->mutex);
+            runtime->running--;
+            if (status == TASK_DONE) {
+                runtime->live--;
+                runtime->stats.completed++;
+                free(task);
+            } else if (status == TASK_YIELD || task->woken) {
+                task->state = TASK_WAITING;
+                make_runnable(runtime, task);
+            } else {
+                task->state = TASK_WAITING;
+            }
+            continue;
+        }
+
+        if (runtime->running > 0) {
+            pthread_cond_wait(&runtime->work, &runtime->mutex); // A running step may still spawn or wake tasks
+            continue;
+        }
+
+        if (runtime->timer_count > 0) {
+            // Nothing can happen before the next timer, so the clock jumps there
+            runtime->now = runtime->timers[0]->wake_at;
+            while (runtime->timer_count > 0 && runtime->timers[0]->wake_at <= runtime->now) {
+                make_runnable(runtime, timer_pop(runtime));
+            }
+            pthread_cond_broadcast(&runtime->work);
+            continue;
+        }
+
+        // Nothing runnable, running or sleeping: the run is over (tasks still alive wait on semaphores forever)
+        runtime->stats.stuck = runtime->live;
+        runtime->finished = 1;
+        pthread_cond_broadcast(&runtime->work);
+    }
+    pthread_mutex_unlock(&runtime->mutex);
+    return NULL;
+}
+
+int task_runtime_run(TaskRuntime *runtime) {
+/**
+ * \brief Run every task to completion on the worker threads // Executa todas as tarefas até o fim nas threads de trabalho
+ *
+ * \return int - 0 when every task finished, -1 if some were left blocked forever // 0 se todas terminaram, -1 se alguma ficou bloqueada para sempre
+ */
+    pthread_t workers[TASK_MAX_WORKERS];
+    int started = 0;
+
+    runtime->finished = 0;
+    for (int i = 1; i < runtime->workers; i++) {
+        if (pthread_create(&workers[started], NULL, task_worker, runtime) == 0) {
+            started++;
+        }
+    }
+    task_worker(runtime); // The calling thread is one of the workers // A thread que chamou é uma das threads de trabalho
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    runtime->stats.virtual_seconds = runtime->now;
+    return runtime->stats.stuck > 0 ? -1 : 0;
+}
+
+double task_now(TaskRuntime *runtime) {
+/**
+ * \brief Current virtual time // Tempo virtual atual
+ */
+    pthread_mutex_lock(&runtime->mutex);
+    double now = runtime->now;
+    pthread_mutex_unlock(&runtime->mutex);
+    return now;
+}
+
+TaskRuntime *task_runtime(Task *task) {
+/**
+ * \brief Runtime a task belongs to // Runtime ao qual a tarefa pertence
+ */
+    return task->runtime;
+}
+
+void task_sleep(Task *task, double seconds) {
+/**
+ * \brief Wake the task after `seconds` of virtual time // Acorda a tarefa depois de `seconds` de tempo virtual
+ */
+    TaskRuntime *runtime = task->runtime;
+    pthread_mutex_lock(&runtime->mutex);
+    task->wake_at = runtime->now + (seconds > 0 ? seconds : 0);
+    task->sequence = runtime->sequence++;
+    runtime->stats.timers++;
+    timer_push(runtime, task); // Can't fire before the step returns: the clock only moves with no step running
+    pthread_mutex_unlock(&runtime->mutex);
+}
+
+TaskSemaphore *create_task_semaphore(TaskRuntime *runtime, int permits, int priorities) {
+/**
+ * \brief Create a semaphore // Cria um semáforo
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return TaskSemaphore* - Pointer to the semaphore // Ponteiro para o semáforo
+ */
+    TaskSemaphore *semaphore = (TaskSemaphore*)calloc(1, sizeof(TaskSemaphore));
+    if (!semaphore) {
+        printf("\nError: Memory allocation failed (Task Semaphore)\n");
+        exit(1);
+    }
+    semaphore->runtime = runtime;
+    semaphore->permits = permits > 0 ? permits : 0;
+    semaphore->priorities = priorities < 1 ? 1 : priorities > TASK_MAX_PRIORITIES ? TASK_MAX_PRIORITIES : priorities;
+    return semaphore;
+}
+
+void destroy_task_semaphore(TaskSemaphore *semaphore) {
+/**
+ * \brief Free a semaphore // Libera um semáforo
+ */
+    free(semaphore);
+}
+
+int task_sem_acquire(Task *task, TaskSemaphore *semaphore, int priority) {
+/**
+ * \brief Take a permit, or queue the task for one // Pega uma permissão, ou enfileira a tarefa por uma
+ *
+ * \return int - 1 if the permit was taken, 0 if the task was queued // 1 se pegou a permissão, 0 se a tarefa foi enfileirada
+ */
+    TaskRuntime *runtime = semaphore->runtime;
+    if (priority < 0) {
+        priority = 0;
+    } else if (priority >= semaphore->priorities) {
+        priority = semaphore->priorities - 1;
+    }
+
+    pthread_mutex_lock(&runtime->mutex);
+    int acquired = semaphore->permits > 0;
+    if (acquired) {
+        semaphore->permits--;
+    } else {
+        list_push(&semaphore->waiters[priority], task);
+        semaphore->waiting++;
+        runtime->stats.semaphore_waits++;
+    }
+    pthread_mutex_unlock(&runtime->mutex);
+    return acquired;
+}
+
+void task_sem_release(TaskSemaphore *semaphore) {
+/**
+ * \brief Give a permit back, handing it to the most urgent waiter if any // Devolve uma permissão ao esperante mais urgente
+ */
+    TaskRuntime *runtime = semaphore->runtime;
+    pthread_mutex_lock(&runtime->mutex);
+    Task *next = NULL;
+    for (int level = semaphore->priorities - 1; level >= 0 && !next; level--) {
+        next = list_pop(&semaphore->waiters[level]);
+    }
+    if (next) {
+        semaphore->waiting--;
+        make_runnable(runtime, next); // The permit goes straight to it // A permissão vai direto para ela
+    } else {
+        semaphore->permits++;
+    }
+    pthread_mutex_unlock(&runtime->mutex);
+}
+
+int task_sem_waiting(TaskSemaphore *semaphore) {
+/**
+ * \brief Tasks waiting on a semaphore // Tarefas esperando um semáforo
+ */
+    pthread_mutex_lock(&semaphore->runtime->mutex);
+    int waiting = semaphore->waiting;
+    pthread_mutex_unlock(&semaphore->runtime->mutex);
+    return waiting;
+}
+
+void get_task_runtime_stats(TaskRuntime *runtime, TaskRuntimeStats *stats) {
+/**
+ * \brief Copy the counters of the runtime // Copia os contadores do runtime
+ */
+    pthread_mutex_lock(&runtime->mutex);
+    *stats = runtime->stats;
+    stats->virtual_seconds = runtime->now;
+    pthread_mutex_unlock(&runtime->mutex);
+}
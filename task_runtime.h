@@ -0,0 +1,165 @@
+#ifndef TASK_RUNTIME_H_INCLUDED
+#define TASK_RUNTIME_H_INCLUDED
+
+#define TASK_MAX_WORKERS 64       // Worker threads of one runtime // Threads de trabalho de um runtime
+#define TASK_MAX_PRIORITIES 8     // Wait levels of a TaskSemaphore // Níveis de espera de um TaskSemaphore
+
+/**
+ * \brief What a task step asks the scheduler to do next // O que um passo da tarefa pede ao escalonador
+ */
+typedef enum task_status {
+    TASK_YIELD,     // Run the next step later, behind the tasks already runnable // Roda o próximo passo depois das tarefas prontas
+    TASK_BLOCKED,   // The step called task_sleep() or a task_sem_acquire() that returned 0 // O passo chamou task_sleep() ou um task_sem_acquire() que retornou 0
+    TASK_DONE       // The task is finished and freed // A tarefa terminou e é liberada
+} TaskStatus;
+
+// M:N scheduler of stackless tasks over a few worker threads, with a virtual clock // Escalonador M:N de tarefas sem pilha com relógio virtual
+typedef struct task_runtime TaskRuntime;
+
+// One task: a step function and its state, no stack of its own // Uma tarefa: uma função de passo e seu estado, sem pilha própria
+typedef struct task Task;
+
+// Counting semaphore whose waiters are tasks, served by priority then FIFO // Semáforo contador cujos esperantes são tarefas
+typedef struct task_semaphore TaskSemaphore;
+
+/**
+ * \brief Runs one step of a task // Executa um passo de uma tarefa
+ *
+ * \details A step never blocks its worker thread: it keeps where it stopped in `data` and returns, after arranging
+ *          its wake up when it returns TASK_BLOCKED. It may spawn tasks and release semaphores.
+ * \details Um passo nunca bloqueia sua thread: guarda onde parou em `data` e retorna, depois de combinar como
+ *          será acordado quando retornar TASK_BLOCKED. Pode criar tarefas e liberar semáforos.
+ * \param task - The running task // A tarefa em execução
+ * \param data - Pointer given to task_spawn() // Ponteiro passado para task_spawn()
+ * \return The TaskStatus // O TaskStatus
+ */
+typedef TaskStatus (*TaskStep)(Task *task, void *data);
+
+/**
+ * \brief Counters of a runtime // Contadores de um runtime
+ */
+typedef struct task_runtime_stats {
+    long spawned;
+    long completed;
+    long steps;            // Step calls, one per resume // Chamadas de passo, uma por retomada
+    long timers;           // task_sleep() calls // Chamadas de task_sleep()
+    long semaphore_waits;  // task_sem_acquire() calls that had to wait // Chamadas de task_sem_acquire() que esperaram
+    long peak_live;        // Most tasks alive at once // Máximo de tarefas vivas ao mesmo tempo
+    long peak_sleeping;    // Most tasks waiting on a timer at once // Máximo de tarefas esperando um timer ao mesmo tempo
+    long stuck;            // Tasks left blocked with no timer and no one to release them // Tarefas bloqueadas sem timer e sem quem as libere
+    double virtual_seconds; // Clock at the end of the run // Relógio no fim da execução
+    int task_bytes;        // Size of the runtime's part of a task // Tamanho da parte do runtime em uma tarefa
+} TaskRuntimeStats;
+
+/**
+ * \brief Create a runtime with its clock at 0 // Cria um runtime com o relógio em 0
+ *
+ * \param workers - Worker threads, 1 to TASK_MAX_WORKERS // Threads de trabalho, de 1 a TASK_MAX_WORKERS
+ * \return Pointer to the runtime, NULL if `workers` is out of range // Ponteiro para o runtime, NULL se `workers` estiver fora do intervalo
+ */
+TaskRuntime *create_task_runtime(int workers);
+
+/**
+ * \brief Free the runtime; call it after task_runtime_run() // Libera o runtime; chame depois de task_runtime_run()
+ *
+ * \param runtime - Pointer to the runtime // Ponteiro para o runtime
+ */
+void destroy_task_runtime(TaskRuntime *runtime);
+
+/**
+ * \brief Create a runnable task; thread safe, also from inside a step // Cria uma tarefa pronta; seguro entre threads, inclusive dentro de um passo
+ *
+ * \param runtime - Pointer to the runtime // Ponteiro para o runtime
+ * \param step - Step function // Função de passo
+ * \param data - State of the task, owned by the caller // Estado da tarefa, pertence a quem chamou
+ * \return Pointer to the task, valid until its step returns TASK_DONE // Ponteiro para a tarefa, válido até o passo retornar TASK_DONE
+ */
+Task *task_spawn(TaskRuntime *runtime, TaskStep step, void *data);
+
+/**
+ * \brief Run every task to completion on the worker threads // Executa todas as tarefas até o fim nas threads de trabalho
+ *
+ * \details The clock is virtual: when no task is runnable and no step is running, it jumps to the earliest timer.
+ *          Simulated hours pass as fast as the steps run.
+ * \details O relógio é virtual: quando nenhuma tarefa está pronta e nenhum passo roda, ele salta para o próximo timer.
+ * \param runtime - Pointer to the runtime // Ponteiro para o runtime
+ * \return 0 when every task finished, -1 if some were left blocked forever // 0 se todas terminaram, -1 se alguma ficou bloqueada para sempre
+ */
+int task_runtime_run(TaskRuntime *runtime);
+
+/**
+ * \brief Current virtual time // Tempo virtual atual
+ *
+ * \param runtime - Pointer to the runtime // Ponteiro para o runtime
+ * \return Simulated seconds since the run started // Segundos simulados desde o início
+ */
+double task_now(TaskRuntime *runtime);
+
+/**
+ * \brief Runtime a task belongs to // Runtime ao qual a tarefa pertence
+ *
+ * \param task - Pointer to the task // Ponteiro para a tarefa
+ * \return Pointer to the runtime // Ponteiro para o runtime
+ */
+TaskRuntime *task_runtime(Task *task);
+
+/**
+ * \brief Wake the task after `seconds` of virtual time; the step then returns TASK_BLOCKED // Acorda a tarefa depois de `seconds`; o passo então retorna TASK_BLOCKED
+ *
+ * \param task - The running task // A tarefa em execução
+ * \param seconds - Simulated seconds, 0 or less wakes it at the current time // Segundos simulados, 0 ou menos acorda no tempo atual
+ */
+void task_sleep(Task *task, double seconds);
+
+/**
+ * \brief Create a semaphore // Cria um semáforo
+ *
+ * \param runtime - Runtime of the tasks that will use it // Runtime das tarefas que vão usá-lo
+ * \param permits - Initial permits // Permissões iniciais
+ * \param priorities - Wait levels, 1 to TASK_MAX_PRIORITIES // Níveis de espera, de 1 a TASK_MAX_PRIORITIES
+ * \return Pointer to the semaphore // Ponteiro para o semáforo
+ */
+TaskSemaphore *create_task_semaphore(TaskRuntime *runtime, int permits, int priorities);
+
+/**
+ * \brief Free a semaphore nobody waits on // Libera um semáforo sem esperantes
+ *
+ * \param semaphore - Pointer to the semaphore // Ponteiro para o semáforo
+ */
+void destroy_task_semaphore(TaskSemaphore *semaphore);
+
+/**
+ * \brief Take a permit, or queue the task for one // Pega uma permissão, ou enfileira a tarefa por uma
+ *
+ * \param task - The running task // A tarefa em execução
+ * \param semaphore - Pointer to the semaphore // Ponteiro para o semáforo
+ * \param priority - Wait level, higher is served first (0 to priorities - 1) // Nível de espera, maior é atendido antes
+ * \return 1 if the permit was taken, 0 if the step must return TASK_BLOCKED; it resumes holding the permit
+ *         // 1 se pegou a permissão, 0 se o passo deve retornar TASK_BLOCKED; ele volta já com a permissão
+ */
+int task_sem_acquire(Task *task, TaskSemaphore *semaphore, int priority);
+
+/**
+ * \brief Give a permit back, handing it to the most urgent waiter if any // Devolve uma permissão, entregando-a ao esperante mais urgente
+ *
+ * \param semaphore - Pointer to the semaphore // Ponteiro para o semáforo
+ */
+void task_sem_release(TaskSemaphore *semaphore);
+
+/**
+ * \brief Tasks waiting on a semaphore // Tarefas esperando um semáforo
+ *
+ * \param semaphore - Pointer to the semaphore // Ponteiro para o semáforo
+ * \return Number of tasks // Número de tarefas
+ */
+int task_sem_waiting(TaskSemaphore *semaphore);
+
+/**
+ * \brief Copy the counters of the runtime // Copia os contadores do runtime
+ *
+ * \param runtime - Pointer to the runtime // Ponteiro para o runtime
+ * \param stats - Receives the counters // Recebe os contadores
+ */
+void get_task_runtime_stats(TaskRuntime *runtime, TaskRuntimeStats *stats);
+
+#endif // TASK_RUNTIME_H_INCLUDED
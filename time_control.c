@@ -2,9 +2,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "time_control.h"
+#include "logger.h"
+#include "rng.h"
+#include "sim_config.h"
 #include <errno.h>
 #define TIME_UNITY 1
 
+static double time_scale = TIME_UNITY; // Multiplier applied by my_sleep()
+
 #include <time.h>
 
 void my_sleep(double seconds) {
@@ -14,6 +19,14 @@ void my_sleep(double seconds) {
      * @param seconds Number of seconds to suspend execution.
      */
     struct timespec req, rem;
+
+    seconds *= time_scale;
+    if (seconds <= 0) {
+        return;
+    }
+
+    log_flush(); // A thread going idle hands its buffered log records to the console first
+
     req.tv_sec = (time_t)seconds;
     req.tv_nsec = (seconds - req.tv_sec) * 1e9;
 
@@ -42,18 +55,43 @@ void stopping(unsigned int sec) {
 
 double pre_random_time() {
     /**
-     * @brief Generates a random time duration between 2 and 3 second.
+     * @brief Generates a random time duration between step_min and step_max seconds (2 and 3 by default).
 
      * @param None.
      *
-     * @return A random time duration as a double, within the range [2, 3).
+     * @return A random time duration as a double, within the range [step_min, step_max).
      */
-    srand(time(NULL));
+    const SimConfig *config = sim_config();
+    double fracTempo = rng_uniform();
 
 
-    double fracTempo = (double)rand() / RAND_MAX;
+    return (config->step_min + fracTempo * (config->step_max - config->step_min)); // returns double rando time
+
+    }
+
+double report_random_time() {
+    /**
+     * @brief Generates the duration of a doctor's report: pre_random_time() * report_factor + report_offset.
+     *
+     * @return A random time duration as a double, within [6.150, 8.150) by default.
+     */
+    const SimConfig *config = sim_config();
+    return pre_random_time() * config->report_factor + config->report_offset;
+}
 
 
-    return (2.0+ fracTempo); // returns double rando time
+void set_time_scale(double scale) {
+    /**
+     * @brief Scales every delay made through my_sleep().
+     *
+     * @param scale Multiplier, 0 removes the delays.
+     */
+    time_scale = scale > 0 ? scale : 0;
+}
 
-    }
+double get_time_scale() {
+    /**
+     * @brief Returns the multiplier currently applied by my_sleep().
+     */
+    return time_scale;
+}
@@ -18,10 +18,31 @@ void my_sleep(double seconds);
 void stopping(unsigned int seconds);
 
 /**
- * @brief Generates a random time value between 2 and 3 seconds.
+ * @brief Generates a random time value between step_min and step_max seconds of the clinic configuration (2 and 3 by default).
  * @details This function generates a random floating-point time value for use in simulations or timing-related scenarios.
  * @return A random double value representing time.
  */
 double pre_random_time();
 
+/**
+ * @brief Generates the duration of a doctor's report.
+ * @details pre_random_time() * report_factor + report_offset of the clinic configuration, between 6.150 and 8.150 seconds by default.
+ *          The one duration model shared by the simulation, the stress run, the task flows and the report process.
+ * @return A random double value representing time.
+ */
+double report_random_time();
+
+/**
+ * @brief Scales every delay made through my_sleep().
+ * @details 1.0 keeps real time, 0.5 runs twice as fast and 0 removes the delays entirely (stress runs).
+ * @param scale - Multiplier applied to the seconds given to my_sleep(). Negative values are treated as 0.
+ */
+void set_time_scale(double scale);
+
+/**
+ * @brief Returns the multiplier currently applied by my_sleep().
+ * @return The time scale.
+ */
+double get_time_scale();
+
 #endif // MY_SLEEP_H_INCLUDED
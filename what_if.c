@@ -0,0 +1,193 @@
+#include "what_if.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "doctors.h"
+
+struct what_if_run {
+    int count;                    // Children forked // Filhos criados
+    int slots;                    // Branches asked for, the size of `results` // Ramos pedidos, o tamanho de `results`
+    pid_t pids[WHAT_IF_MAX];
+    WhatIfChange changes[WHAT_IF_MAX];
+    WhatIfResult *results;        // MAP_SHARED, one slot per branch // Uma posição por ramo
+};
+
+static int parse_one(char *item, WhatIfChange *change) {
+// One change of a spec, e.g. "doctor:oncology" // Uma mudança da especificação
+    if (strcmp(item, "baseline") == 0) {
+        return 0;
+    }
+    char *value = strchr(item, ':');
+    if (!value || !value[1]) {
+        return -1;
+    }
+    *value++ = '\0';
+    char *end;
+    if (strcmp(item, "doctor") == 0) {
+        if (specialty_from_name(value) < 0 ||
+            strlen(change->doctors) + strlen(value) + 2 > sizeof(change->doctors)) {
+            return -1;
+        }
+        if (change->doctors[0]) {
+            strcat(change->doctors, ",");
+        }
+        strcat(change->doctors, value);
+    } else if (strcmp(item, "machines") == 0) {
+        long machines = strtol(value, &end, 10);
+        if (*end) {
+            return -1;
+        }
+        change->add_machines += (int)machines;
+    } else if (strcmp(item, "surge") == 0) {
+        double factor = strtod(value, &end);
+        if (*end || factor <= 0) {
+            return -1;
+        }
+        change->rate_factor *= factor;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int parse_what_if(const char *spec, WhatIfChange *change) {
+/**
+ * \brief Parse a branch change // Interpreta a mudança de um ramo
+ *
+ * \return int - 0 on success, -1 if the spec is invalid // 0 em caso de sucesso, -1 se for inválida
+ */
+    memset(change, 0, sizeof(*change));
+    change->rate_factor = 1;
+    snprintf(change->label, sizeof(change->label), "%s", spec);
+
+    char copy[WHAT_IF_ROSTER_MAX];
+    if (!spec[0] || strlen(spec) >= sizeof(copy)) {
+        return -1;
+    }
+    strcpy(copy, spec);
+    char *saveptr = NULL;
+    for (char *item = strtok_r(copy, "+", &saveptr); item; item = strtok_r(NULL, "+", &saveptr)) {
+        if (parse_one(item, change) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+WhatIfRun *what_if_fork(const WhatIfChange *changes, int count, int *branch) {
+/**
+ * \brief Fork one child per change // Cria um filho por mudança
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return WhatIfRun* - Pointer to the run, NULL if nothing could be forked // Ponteiro para a execução, NULL se nada pôde ser criado
+ */
+    *branch = -1;
+    if (count < 1 || count > WHAT_IF_MAX) {
+        return NULL;
+    }
+    WhatIfRun *run = (WhatIfRun*)calloc(1, sizeof(WhatIfRun));
+    if (!run) {
+        printf("\nError: Memory allocation failed (What-if)\n");
+        exit(1);
+    }
+    run->results = (WhatIfResult*)mmap(NULL, count * sizeof(WhatIfResult), PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (run->results == MAP_FAILED) {
+        free(run);
+        return NULL;
+    }
+    memset(run->results, 0, count * sizeof(WhatIfResult));
+    run->slots = count;
+    memcpy(run->changes, changes, count * sizeof(WhatIfChange));
+
+    for (int i = 0; i < count; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            *branch = i;
+            return run; // The child continues the simulation as branch i // O filho continua a simulação como o ramo i
+        }
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        run->pids[run->count++] = pid;
+    }
+    if (run->count == 0) {
+        destroy_what_if(run);
+        return NULL;
+    }
+    return run;
+}
+
+WhatIfResult *what_if_result(WhatIfRun *run, int branch) {
+/**
+ * \brief Slot of a branch in the shared memory // Posição de um ramo na memória compartilhada
+ */
+    return &run->results[branch];
+}
+
+int what_if_wait(WhatIfRun *run) {
+/**
+ * \brief Wait for every child // Espera todos os filhos
+ *
+ * \return int - Branches that failed // Ramos que falharam
+ */
+    int failed = 0;
+    for (int i = 0; i < run->count; i++) {
+        int status = 0;
+        WhatIfResult *result = &run->results[i];
+        if (waitpid(run->pids[i], &status, 0) < 0 || !WIFEXITED(status)) {
+            result->exit_status = -1;
+        } else {
+            result->exit_status = WEXITSTATUS(status);
+        }
+        if (result->exit_status != 0 || !result->finished) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void print_what_if_report(WhatIfRun *run, double branch_time, double quiet_seconds, double warmup_seconds) {
+/**
+ * \brief Print the branches side by side // Imprime os ramos lado a lado
+ */
+    printf("\nWhat-if branches forked at %.1lf simulated seconds (clock held for %.2lf real s while the doctors finished):\n",
+           branch_time, quiet_seconds);
+    printf("%-30.30s %8s %8s %8s %9s %9s %9s %8s %8s %8s\n", "Branch", "Patients", "Exams", "Reports", "Delayed%",
+           "Abandoned", "Rejected", "Machines", "Doctors", "Real s");
+    const WhatIfResult *first = NULL;
+    for (int i = 0; i < run->count; i++) {
+        const WhatIfResult *result = &run->results[i];
+        if (!result->finished) {
+            printf("%-30.30s failed (exit status %d), see whatif_%d.txt\n", run->changes[i].label, result->exit_status, i);
+            continue;
+        }
+        printf("%-30.30s %8d %8d %8d %8.1lf%% %9ld %9ld %8d %8d %8.2lf\n", run->changes[i].label, result->patients,
+               result->exams, result->reports, result->reports > 0 ? 100.0 * result->reports_delayed / result->reports : 0.0,
+               result->abandoned, result->rejected, result->machines, result->doctors, result->real_seconds);
+        if (!first) {
+            first = result;
+        } else {
+            printf("%-30.30s %8s %+8d %+8d %9s %+9ld %+9ld\n", "  vs first branch", "", result->exams - first->exams,
+                   result->reports - first->reports, "", result->abandoned - first->abandoned, result->rejected - first->rejected);
+        }
+    }
+    printf("Warm-up simulated once in %.2lf s and shared copy-on-write by %d branches (%.2lf s saved)\n",
+           warmup_seconds, run->count, warmup_seconds * (run->count - 1));
+}
+
+void destroy_what_if(WhatIfRun *run) {
+/**
+ * \brief Free the run // Libera a execução
+ */
+    if (!run) {
+        return;
+    }
+    munmap(run->results, run->slots * sizeof(WhatIfResult));
+    free(run);
+}
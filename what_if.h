@@ -0,0 +1,106 @@
+#ifndef WHAT_IF_H_INCLUDED
+#define WHAT_IF_H_INCLUDED
+
+#include <sys/types.h>
+
+#define WHAT_IF_MAX 16          // Branches of one run // Ramos de uma execução
+#define WHAT_IF_LABEL_MAX 64
+#define WHAT_IF_ROSTER_MAX 256
+
+/**
+ * \brief What one branch changes when it continues from the shared state // O que um ramo muda ao continuar do estado compartilhado
+ *
+ * \details Written as changes joined by '+': baseline, doctor:SPECIALTY (one more doctor, may repeat),
+ *          machines:N (N more machines, negative removes) and surge:X (arrival rate times X),
+ *          e.g. "doctor:oncology+surge:2".
+ * \details Escrito como mudanças unidas por '+': baseline, doctor:ESPECIALIDADE (mais um médico, pode repetir),
+ *          machines:N (N máquinas a mais, negativo remove) e surge:X (taxa de chegada vezes X).
+ */
+typedef struct what_if_change {
+    char label[WHAT_IF_LABEL_MAX];      // As given on the command line // Como dado na linha de comando
+    int add_machines;
+    double rate_factor;                 // 1 keeps the arrival rate // 1 mantém a taxa de chegada
+    char doctors[WHAT_IF_ROSTER_MAX];   // Comma separated specialties to add, "" for none // Especialidades a adicionar
+} WhatIfChange;
+
+/**
+ * \brief Outcome of one branch, written by the child into memory shared with the parent
+ *        // Resultado de um ramo, escrito pelo filho na memória compartilhada com o pai
+ */
+typedef struct what_if_result {
+    int finished;                 // 1 once the child filled it // 1 quando o filho o preencheu
+    int exit_status;              // From waitpid(), -1 if the child was killed by a signal // De waitpid(), -1 se morto por um sinal
+    double tempo_total;           // Simulated seconds at the end // Segundos simulados no fim
+    int patients;                 // Patients arrived, warm-up included // Pacientes que chegaram, incluindo o aquecimento
+    int exams;
+    int reports;
+    int reports_delayed;
+    long abandoned;               // Patients, exams and reports given up at the drain deadline // Abandonados no prazo
+    long rejected;                // Patients turned away by a full queue // Pacientes recusados
+    int machines;
+    int doctors;
+    double real_seconds;          // Wall time of the branch after the fork // Tempo real do ramo depois do fork
+} WhatIfResult;
+
+// Children forked from one state and their shared results // Filhos criados de um estado e seus resultados compartilhados
+typedef struct what_if_run WhatIfRun;
+
+/**
+ * \brief Parse a branch change // Interpreta a mudança de um ramo
+ *
+ * \param spec - Changes joined by '+' // Mudanças unidas por '+'
+ * \param change - Receives the change // Recebe a mudança
+ * \return 0 on success, -1 if the spec is invalid // 0 em caso de sucesso, -1 se for inválida
+ */
+int parse_what_if(const char *spec, WhatIfChange *change);
+
+/**
+ * \brief Fork one child per change // Cria um filho por mudança
+ *
+ * \details Call it with a single thread running: fork() copies only the caller, and a lock held by another
+ *          thread would stay locked forever in the children. The memory is shared copy-on-write, so each child
+ *          starts from the warmed-up state at the cost of the pages it changes. Flush every FILE before.
+ * \details Chame com uma única thread rodando: fork() copia só quem chama, e um lock de outra thread ficaria
+ *          travado para sempre nos filhos. A memória é compartilhada copy-on-write. Esvazie os buffers antes.
+ * \param changes - One change per branch // Uma mudança por ramo
+ * \param count - 1 to WHAT_IF_MAX
+ * \param branch - Receives the branch of the child (0 to count - 1), or -1 in the parent // Recebe o ramo do filho, ou -1 no pai
+ * \return Pointer to the run, NULL if nothing could be forked // Ponteiro para a execução, NULL se nada pôde ser criado
+ */
+WhatIfRun *what_if_fork(const WhatIfChange *changes, int count, int *branch);
+
+/**
+ * \brief Slot of a branch in the shared memory // Posição de um ramo na memória compartilhada
+ *
+ * \param run - Pointer to the run // Ponteiro para a execução
+ * \param branch - 0 to count - 1
+ * \return Pointer to the result // Ponteiro para o resultado
+ */
+WhatIfResult *what_if_result(WhatIfRun *run, int branch);
+
+/**
+ * \brief Wait for every child (parent only) // Espera todos os filhos (somente o pai)
+ *
+ * \param run - Pointer to the run // Ponteiro para a execução
+ * \return Branches that failed // Ramos que falharam
+ */
+int what_if_wait(WhatIfRun *run);
+
+/**
+ * \brief Print the branches side by side, with the difference to the first one // Imprime os ramos lado a lado, com a diferença para o primeiro
+ *
+ * \param run - Pointer to a run already waited // Ponteiro para uma execução já esperada
+ * \param branch_time - Simulated seconds at the fork // Segundos simulados no fork
+ * \param quiet_seconds - Wall time the clock stood still while the doctors finished before the fork // Tempo real com o relógio parado antes do fork
+ * \param warmup_seconds - Wall time of the warm-up, simulated once for every branch // Tempo real do aquecimento, simulado uma vez para todos os ramos
+ */
+void print_what_if_report(WhatIfRun *run, double branch_time, double quiet_seconds, double warmup_seconds);
+
+/**
+ * \brief Free the run; a child calls it too, after filling its result // Libera a execução; um filho também chama, depois de preencher o resultado
+ *
+ * \param run - Pointer to the run, may be NULL // Ponteiro para a execução, pode ser NULL
+ */
+void destroy_what_if(WhatIfRun *run);
+
+#endif // WHAT_IF_H_INCLUDED
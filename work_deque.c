@@ -0,0 +1,128 @@
+#include "work_deque.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+// Circular array; `capacity` is a power of two // Array circular; `capacity` é potência de dois
+typedef struct work_array {
+    long capacity;
+    struct work_array *retired;   // Older array it replaced // Array mais antigo que ele substituiu
+    _Atomic(void*) slots[];
+} WorkArray;
+
+struct work_deque {
+    atomic_long top;      // Next item to steal // Próximo item a roubar
+    atomic_long bottom;   // Next free slot of the owner // Próxima posição livre da dona
+    _Atomic(WorkArray*) array;
+};
+
+static WorkArray *create_array(long capacity) {
+// Allocates an empty circular array // Aloca um array circular vazio
+    WorkArray *array = (WorkArray*)malloc(sizeof(WorkArray) + capacity * sizeof(_Atomic(void*)));
+    if (!array) {
+        printf("\nError: Memory allocation failed (Work Deque)\n");
+        exit(1);
+    }
+    array->capacity = capacity;
+    array->retired = NULL;
+    return array;
+}
+
+WorkDeque *create_work_deque(void) {
+/**
+ * \brief Create an empty deque // Cria um deque vazio
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return WorkDeque* - Pointer to the deque // Ponteiro para o deque
+ */
+    WorkDeque *deque = (WorkDeque*)malloc(sizeof(WorkDeque));
+    if (!deque) {
+        printf("\nError: Memory allocation failed (Work Deque)\n");
+        exit(1);
+    }
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, create_array(WORK_DEQUE_INITIAL));
+    return deque;
+}
+
+void destroy_work_deque(WorkDeque *deque) {
+/**
+ * \brief Free the deque and every array it grew out of // Libera o deque e todos os arrays que ele já usou
+ */
+    if (!deque) {
+        return;
+    }
+    WorkArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array) {
+        WorkArray *older = array->retired;
+        free(array);
+        array = older;
+    }
+    free(deque);
+}
+
+static WorkArray *grow(WorkDeque *deque, WorkArray *array, long top, long bottom) {
+// Copies the live items into an array twice as big; the old one stays readable for thieves
+// Copia os itens vivos para um array com o dobro do tamanho; o antigo continua legível para ladrões
+    WorkArray *bigger = create_array(array->capacity * 2);
+    for (long i = top; i < bottom; i++) {
+        void *item = atomic_load_explicit(&array->slots[i & (array->capacity - 1)], memory_order_relaxed);
+        atomic_store_explicit(&bigger->slots[i & (bigger->capacity - 1)], item, memory_order_relaxed);
+    }
+    bigger->retired = array;
+    atomic_store_explicit(&deque->array, bigger, memory_order_release);
+    return bigger;
+}
+
+void work_deque_push(WorkDeque *deque, void *item) {
+/**
+ * \brief Push at the bottom (owner only) // Insere embaixo (somente a dona)
+ */
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    WorkArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if (bottom - top > array->capacity - 1) {
+        array = grow(deque, array, top, bottom);
+    }
+    atomic_store_explicit(&array->slots[bottom & (array->capacity - 1)], item, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // The item is visible before the new bottom // O item fica visível antes do novo bottom
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+}
+
+void *work_deque_steal(WorkDeque *deque) {
+/**
+ * \brief Steal the oldest item from the top (any thread) // Rouba o item mais antigo do topo (qualquer thread)
+ *
+ * \details A lost CAS means another thread took that item, so the next one is tried.
+ * \details Um CAS perdido significa que outra thread pegou aquele item, então o próximo é tentado.
+ *
+ * \return void* - The item, NULL if the deque is empty // O item, NULL se o deque estiver vazio
+ */
+    for (;;) {
+        long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+        if (top >= bottom) {
+            return NULL;
+        }
+
+        WorkArray *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+        void *item = atomic_load_explicit(&array->slots[top & (array->capacity - 1)], memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                    memory_order_seq_cst, memory_order_relaxed)) {
+            return item;
+        }
+    }
+}
+
+long work_deque_size(WorkDeque *deque) {
+/**
+ * \brief Items in the deque, exact only when nobody is pushing or stealing // Itens no deque, exato só sem operações concorrentes
+ */
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    return bottom > top ? bottom - top : 0;
+}
@@ -0,0 +1,57 @@
+#ifndef WORK_DEQUE_H_INCLUDED
+#define WORK_DEQUE_H_INCLUDED
+
+#define WORK_DEQUE_INITIAL 32   // Slots of a new deque, doubled when full // Posições de um deque novo, dobradas quando cheio
+
+/**
+ * \brief Chase-Lev work stealing deque of pointers // Deque de roubo de trabalho Chase-Lev de ponteiros
+ *
+ * \details One thread, the owner, pushes at the bottom; every consumer steals from the top with one CAS, so items
+ *          come out in FIFO order.
+ *          Items are never NULL. Grown arrays are kept until the deque is destroyed, so a thief reading an old
+ *          array never touches freed memory.
+ * \details Uma thread, a dona, insere embaixo; todo consumidor rouba do topo com um CAS, então os itens saem em
+ *          ordem FIFO.
+ *          Itens nunca são NULL. Arrays antigos são mantidos até a destruição do deque.
+ */
+typedef struct work_deque WorkDeque;
+
+/**
+ * \brief Create an empty deque // Cria um deque vazio
+ *
+ * \return Pointer to the deque // Ponteiro para o deque
+ */
+WorkDeque *create_work_deque(void);
+
+/**
+ * \brief Free the deque; the items left are not freed // Libera o deque; os itens restantes não são liberados
+ *
+ * \param deque - Pointer to the deque // Ponteiro para o deque
+ */
+void destroy_work_deque(WorkDeque *deque);
+
+/**
+ * \brief Push at the bottom (owner only) // Insere embaixo (somente a dona)
+ *
+ * \param deque - Pointer to the deque // Ponteiro para o deque
+ * \param item - Non NULL pointer // Ponteiro não NULL
+ */
+void work_deque_push(WorkDeque *deque, void *item);
+
+/**
+ * \brief Steal the oldest item from the top (any thread) // Rouba o item mais antigo do topo (qualquer thread)
+ *
+ * \param deque - Pointer to the deque // Ponteiro para o deque
+ * \return The item, NULL if the deque is empty // O item, NULL se o deque estiver vazio
+ */
+void *work_deque_steal(WorkDeque *deque);
+
+/**
+ * \brief Items in the deque, exact only when nobody is pushing or stealing // Itens no deque, exato só sem operações concorrentes
+ *
+ * \param deque - Pointer to the deque // Ponteiro para o deque
+ * \return Number of items // Número de itens
+ */
+long work_deque_size(WorkDeque *deque);
+
+#endif // WORK_DEQUE_H_INCLUDED
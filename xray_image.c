@@ -0,0 +1,463 @@
+#include "xray_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define XRAY_LANES 16
+
+// GCC vector extensions: 16 pixels per 128-bit vector, widened to 16-bit lanes for arithmetic
+typedef unsigned char PixelVector __attribute__((vector_size(XRAY_LANES)));
+typedef signed char PixelMask __attribute__((vector_size(XRAY_LANES)));
+typedef unsigned short WideVector __attribute__((vector_size(XRAY_LANES * sizeof(unsigned short))));
+
+static const PixelVector even_lanes = {0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30};
+static const PixelVector odd_lanes = {1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31};
+
+XrayImage *create_xray_image(int width, int height) {
+/**
+ * \brief Create an image with uninitialized pixels // Cria uma imagem com pixels não inicializados
+ *
+ * \warning If memory allocation fails, an error message is printed and the program exits. // Se a alocação falhar, uma mensagem de erro é impressa e o programa é encerrado.
+ *
+ * \return XrayImage* - Pointer to the image, NULL if the size is invalid // Ponteiro para a imagem, NULL se o tamanho for inválido
+ */
+    if (width < 2 || height < 2) {
+        return NULL;
+    }
+
+    XrayImage *image = (XrayImage*)malloc(sizeof(XrayImage));
+    unsigned char *pixels = (unsigned char*)malloc((size_t)width * height);
+    if (!image || !pixels) {
+        printf("\nError: Memory allocation failed (X-Ray Image %dx%d)\n", width, height);
+        exit(1);
+    }
+
+    image->width = width;
+    image->height = height;
+    image->pixels = pixels;
+    return image;
+}
+
+void destroy_xray_image(XrayImage *image) {
+/**
+ * \brief Free an image // Libera uma imagem
+ */
+    if (image) {
+        free(image->pixels);
+        free(image);
+    }
+}
+
+static void ellipse_span(int y, float center_x, float center_y, float radius_x, float radius_y, int *from, int *to) {
+// Columns [from, to) of row y inside the ellipse, empty when from >= to // Colunas [from, to) da linha y dentro da elipse
+    float dy = (y - center_y) / radius_y;
+    *from = 0;
+    *to = 0;
+    if (dy * dy <= 1.0f) {
+        float half = radius_x * sqrtf(1.0f - dy * dy);
+        *from = (int)ceilf(center_x - half);
+        *to = (int)floorf(center_x + half) + 1;
+    }
+}
+
+void generate_xray_image(XrayImage *image, unsigned int seed) {
+/**
+ * \brief Draw a synthetic chest X-ray // Desenha um raio X sintético do tórax
+ *
+ * \details Dark lung fields with brighter ribs, a bright spine, soft tissue with a vertical gradient and uniform
+ *          noise. One seed in three also gets a bright lesion inside a lung.
+ * \details Pulmões escuros com costelas mais claras, coluna clara, tecido com gradiente vertical e ruído uniforme.
+ *          Uma semente em cada três também recebe uma lesão clara dentro de um pulmão.
+ *
+ * \param image - Image to fill // Imagem a ser preenchida
+ * \param seed - Image seed // Semente da imagem
+ */
+    if (!image) {
+        return;
+    }
+
+    int width = image->width;
+    int height = image->height;
+    unsigned int noise = seed * 2654435761u + 1;
+    int has_lesion = seed % 3 == 0;
+    float lesion_x = width * (0.2f + (seed % 7) * 0.02f);
+    float lesion_y = height * (0.3f + (seed % 11) * 0.025f);
+
+    int body_from = width / 10, body_to = width - width / 10;
+    int spine_from = (int)(width * 0.46f) + 1, spine_to = (int)ceilf(width * 0.54f);
+
+    for (int y = 0; y < height; y++) {
+        unsigned char *row = image->pixels + (size_t)y * width;
+        int rib = (y * 18 / height) % 2;
+        int left_from, left_to, right_from, right_to, lesion_from, lesion_to;
+        ellipse_span(y, width * 0.3f, height * 0.45f, width * 0.17f, height * 0.3f, &left_from, &left_to);
+        ellipse_span(y, width * 0.7f, height * 0.45f, width * 0.17f, height * 0.3f, &right_from, &right_to);
+        ellipse_span(y, lesion_x, lesion_y, width * 0.05f, width * 0.05f, &lesion_from, &lesion_to);
+        if (!has_lesion) {
+            lesion_to = lesion_from;
+        }
+
+        for (int x = 0; x < width; x++) {
+            int value;
+            if (x < body_from || x >= body_to) {
+                value = 20;                                   // Outside the body // Fora do corpo
+            } else if (x >= spine_from && x < spine_to) {
+                value = 200;                                  // Spine // Coluna
+            } else if ((x >= left_from && x < left_to) || (x >= right_from && x < right_to)) {
+                value = 60 + rib * 35;                        // Lungs and ribs // Pulmões e costelas
+                if (x >= lesion_from && x < lesion_to) {
+                    value = 180;
+                }
+            } else {
+                value = 140;                                  // Soft tissue // Tecido
+            }
+
+            noise = noise * 1103515245u + 12345u;
+            value += y * 30 / height + (int)((noise >> 16) % 25) - 12;
+            row[x] = (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+    }
+}
+
+/* ----- Downsampling ----- */
+
+static void downsample_row_scalar(const unsigned char *top, const unsigned char *bottom, unsigned char *out, int from, int to) {
+    for (int x = from; x < to; x++) {
+        out[x] = (unsigned char)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+    }
+}
+
+static void downsample_row_simd(const unsigned char *top, const unsigned char *bottom, unsigned char *out, int width) {
+// 32 source pixels of two rows become 16 output pixels // 32 pixels de duas linhas viram 16 pixels de saída
+    int x = 0;
+    for (; x + XRAY_LANES <= width; x += XRAY_LANES) {
+        PixelVector top_low, top_high, bottom_low, bottom_high;
+        memcpy(&top_low, top + 2 * x, XRAY_LANES);
+        memcpy(&top_high, top + 2 * x + XRAY_LANES, XRAY_LANES);
+        memcpy(&bottom_low, bottom + 2 * x, XRAY_LANES);
+        memcpy(&bottom_high, bottom + 2 * x + XRAY_LANES, XRAY_LANES);
+
+        WideVector sum = __builtin_convertvector(__builtin_shuffle(top_low, top_high, even_lanes), WideVector);
+        sum += __builtin_convertvector(__builtin_shuffle(top_low, top_high, odd_lanes), WideVector);
+        sum += __builtin_convertvector(__builtin_shuffle(bottom_low, bottom_high, even_lanes), WideVector);
+        sum += __builtin_convertvector(__builtin_shuffle(bottom_low, bottom_high, odd_lanes), WideVector);
+        sum = (sum + 2) >> 2;
+
+        PixelVector result = __builtin_convertvector(sum, PixelVector);
+        memcpy(out + x, &result, XRAY_LANES);
+    }
+    downsample_row_scalar(top, bottom, out, x, width);
+}
+
+int xray_downsample(const XrayImage *source, XrayImage *target, XrayKernels kernels) {
+/**
+ * \brief 2x2 box downsampling, rounding to nearest // Redução 2x2 pela média, arredondando
+ *
+ * \return int - 0 on success, -1 if target is not half the size of source // 0 em caso de sucesso, -1 se target não tiver metade do tamanho
+ */
+    if (!source || !target || target->width != source->width / 2 || target->height != source->height / 2) {
+        return -1;
+    }
+
+    for (int y = 0; y < target->height; y++) {
+        const unsigned char *top = source->pixels + (size_t)(2 * y) * source->width;
+        const unsigned char *bottom = top + source->width;
+        unsigned char *out = target->pixels + (size_t)y * target->width;
+        if (kernels == XRAY_SIMD) {
+            downsample_row_simd(top, bottom, out, target->width);
+        } else {
+            downsample_row_scalar(top, bottom, out, 0, target->width);
+        }
+    }
+    return 0;
+}
+
+/* ----- Normalization ----- */
+
+static PixelVector pixel_select(PixelMask mask, PixelVector a, PixelVector b) {
+    return (PixelVector)((mask & (PixelMask)a) | (~mask & (PixelMask)b));
+}
+
+static void pixel_range_simd(const unsigned char *pixels, size_t count, int *lowest, int *highest) {
+    PixelVector low, high;
+    size_t i = 0;
+    memset(&low, 255, XRAY_LANES);
+    memset(&high, 0, XRAY_LANES);
+
+    for (; i + XRAY_LANES <= count; i += XRAY_LANES) {
+        PixelVector value;
+        memcpy(&value, pixels + i, XRAY_LANES);
+        low = pixel_select((PixelMask)(value < low), value, low);
+        high = pixel_select((PixelMask)(value > high), value, high);
+    }
+
+    int min = 255, max = 0;
+    for (int lane = 0; lane < XRAY_LANES; lane++) {
+        min = low[lane] < min ? low[lane] : min;
+        max = high[lane] > max ? high[lane] : max;
+    }
+    for (; i < count; i++) {
+        min = pixels[i] < min ? pixels[i] : min;
+        max = pixels[i] > max ? pixels[i] : max;
+    }
+    *lowest = min;
+    *highest = max;
+}
+
+void xray_normalize(XrayImage *image, XrayKernels kernels) {
+/**
+ * \brief Min-max contrast stretch to 0..255 // Esticamento de contraste mín-máx para 0..255
+ *
+ * \details Uses the fixed point scale 65280 / range so the scalar and SIMD versions give identical pixels.
+ *          Images with a single gray level are left unchanged.
+ * \details Usa a escala em ponto fixo 65280 / faixa para as versões escalar e SIMD darem pixels idênticos.
+ *          Imagens com um único nível de cinza não são alteradas.
+ */
+    if (!image) {
+        return;
+    }
+
+    size_t count = (size_t)image->width * image->height;
+    unsigned char *pixels = image->pixels;
+    int min = 255, max = 0;
+
+    if (kernels == XRAY_SIMD) {
+        pixel_range_simd(pixels, count, &min, &max);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            min = pixels[i] < min ? pixels[i] : min;
+            max = pixels[i] > max ? pixels[i] : max;
+        }
+    }
+    if (max <= min) {
+        return;
+    }
+
+    unsigned int scale = 65280 / (max - min);
+    size_t i = 0;
+    if (kernels == XRAY_SIMD) {
+        for (; i + XRAY_LANES <= count; i += XRAY_LANES) {
+            PixelVector value;
+            memcpy(&value, pixels + i, XRAY_LANES);
+            WideVector wide = __builtin_convertvector(value, WideVector);
+            wide = ((wide - (unsigned short)min) * (unsigned short)scale) >> 8;
+            value = __builtin_convertvector(wide, PixelVector);
+            memcpy(pixels + i, &value, XRAY_LANES);
+        }
+    }
+    for (; i < count; i++) {
+        pixels[i] = (unsigned char)(((pixels[i] - min) * scale) >> 8);
+    }
+}
+
+/* ----- Histogram equalization ----- */
+
+void xray_equalize(XrayImage *image, XrayKernels kernels) {
+/**
+ * \brief Histogram equalization through a 256 entry lookup table // Equalização de histograma por uma tabela de 256 entradas
+ *
+ * \details The SIMD variant counts into 4 interleaved histograms, so consecutive equal pixels don't wait on the
+ *          same counter. The lookup itself is a gather, which is done one pixel at a time in both variants.
+ * \details A variante SIMD conta em 4 histogramas intercalados, para pixels iguais consecutivos não esperarem pelo
+ *          mesmo contador. A consulta à tabela é um gather, feito pixel a pixel nas duas variantes.
+ */
+    if (!image) {
+        return;
+    }
+
+    size_t count = (size_t)image->width * image->height;
+    unsigned char *pixels = image->pixels;
+    unsigned int histogram[256] = {0};
+
+    if (kernels == XRAY_SIMD) {
+        unsigned int partial[4][256];
+        size_t i = 0;
+        memset(partial, 0, sizeof(partial));
+        for (; i + 4 <= count; i += 4) {
+            partial[0][pixels[i]]++;
+            partial[1][pixels[i + 1]]++;
+            partial[2][pixels[i + 2]]++;
+            partial[3][pixels[i + 3]]++;
+        }
+        for (; i < count; i++) {
+            partial[0][pixels[i]]++;
+        }
+        for (int v = 0; v < 256; v++) {
+            histogram[v] = partial[0][v] + partial[1][v] + partial[2][v] + partial[3][v];
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            histogram[pixels[i]]++;
+        }
+    }
+
+    unsigned char lookup[256];
+    size_t cumulative = 0, first = 0;
+    for (int v = 0; v < 256; v++) {
+        if (first == 0 && histogram[v] > 0) {
+            first = histogram[v];
+        }
+        cumulative += histogram[v];
+        histogram[v] = (unsigned int)cumulative;
+    }
+    if (count == first) {
+        return; // A single gray level // Um único nível de cinza
+    }
+    for (int v = 0; v < 256; v++) {
+        lookup[v] = histogram[v] < first ? 0 :
+                    (unsigned char)(((histogram[v] - first) * 255 + (count - first) / 2) / (count - first));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = lookup[pixels[i]];
+    }
+}
+
+/* ----- Feature extraction ----- */
+
+static void grid_sums_scalar(const XrayImage *image, unsigned long *sums) {
+    for (int cy = 0; cy < XRAY_GRID; cy++) {
+        for (int cx = 0; cx < XRAY_GRID; cx++) {
+            unsigned long sum = 0;
+            for (int y = cy * image->height / XRAY_GRID; y < (cy + 1) * image->height / XRAY_GRID; y++) {
+                const unsigned char *row = image->pixels + (size_t)y * image->width;
+                for (int x = cx * image->width / XRAY_GRID; x < (cx + 1) * image->width / XRAY_GRID; x++) {
+                    sum += row[x];
+                }
+            }
+            sums[cy * XRAY_GRID + cx] = sum;
+        }
+    }
+}
+
+static int grid_sums_simd(const XrayImage *image, unsigned long *sums) {
+// Adds whole rows into 16-bit column sums, flushed to 32 bits every 256 rows before they can overflow
+    int width = image->width;
+    unsigned short *partial = (unsigned short*)calloc(width, sizeof(unsigned short));
+    unsigned int *columns = (unsigned int*)malloc(sizeof(unsigned int) * width);
+    if (!partial || !columns) {
+        free(partial);
+        free(columns);
+        return -1;
+    }
+
+    for (int cy = 0; cy < XRAY_GRID; cy++) {
+        int rows = 0;
+        memset(columns, 0, sizeof(unsigned int) * width);
+
+        for (int y = cy * image->height / XRAY_GRID; y < (cy + 1) * image->height / XRAY_GRID; y++) {
+            const unsigned char *row = image->pixels + (size_t)y * width;
+            int x = 0;
+            for (; x + XRAY_LANES <= width; x += XRAY_LANES) {
+                PixelVector value;
+                WideVector sum;
+                memcpy(&value, row + x, XRAY_LANES);
+                memcpy(&sum, partial + x, sizeof(sum));
+                sum += __builtin_convertvector(value, WideVector);
+                memcpy(partial + x, &sum, sizeof(sum));
+            }
+            for (; x < width; x++) {
+                partial[x] += row[x];
+            }
+
+            if (++rows == 256) {
+                for (x = 0; x < width; x++) {
+                    columns[x] += partial[x];
+                    partial[x] = 0;
+                }
+                rows = 0;
+            }
+        }
+        for (int x = 0; x < width; x++) {
+            columns[x] += partial[x];
+            partial[x] = 0;
+        }
+
+        for (int cx = 0; cx < XRAY_GRID; cx++) {
+            unsigned long sum = 0;
+            for (int x = cx * width / XRAY_GRID; x < (cx + 1) * width / XRAY_GRID; x++) {
+                sum += columns[x];
+            }
+            sums[cy * XRAY_GRID + cx] = sum;
+        }
+    }
+
+    free(partial);
+    free(columns);
+    return 0;
+}
+
+void xray_extract_features(const XrayImage *image, float *features, XrayKernels kernels) {
+/**
+ * \brief Mean gray level of each grid cell, mapped from 0..255 to [-1, 1] // Nível de cinza médio de cada célula, mapeado de 0..255 para [-1, 1]
+ */
+    if (!image || !features) {
+        return;
+    }
+
+    unsigned long sums[XRAY_FEATURES];
+    if (kernels != XRAY_SIMD || grid_sums_simd(image, sums) != 0) {
+        grid_sums_scalar(image, sums);
+    }
+
+    for (int cy = 0; cy < XRAY_GRID; cy++) {
+        int cell_height = (cy + 1) * image->height / XRAY_GRID - cy * image->height / XRAY_GRID;
+        for (int cx = 0; cx < XRAY_GRID; cx++) {
+            int cell_width = (cx + 1) * image->width / XRAY_GRID - cx * image->width / XRAY_GRID;
+            long cell_pixels = (long)cell_width * cell_height;
+            double mean = cell_pixels > 0 ? (double)sums[cy * XRAY_GRID + cx] / cell_pixels : 0;
+            features[cy * XRAY_GRID + cx] = (float)(mean / 127.5 - 1.0);
+        }
+    }
+}
+
+int xray_preprocess(const XrayImage *image, XrayImage *scratch, float *features, XrayKernels kernels) {
+/**
+ * \brief Downsample, normalize, equalize and extract features // Reduz, normaliza, equaliza e extrai características
+ *
+ * \return int - 0 on success, -1 if scratch is not half the size of image // 0 em caso de sucesso, -1 se scratch não tiver metade do tamanho
+ */
+    if (xray_downsample(image, scratch, kernels) != 0) {
+        return -1;
+    }
+    xray_normalize(scratch, kernels);
+    xray_equalize(scratch, kernels);
+    xray_extract_features(scratch, features, kernels);
+    return 0;
+}
+
+int xray_exam_features(int width, int height, unsigned int seed, XrayKernels kernels, float *features) {
+/**
+ * \brief Acquire one synthetic image and run the whole pipeline on it // Adquire uma imagem sintética e roda o pipeline completo
+ *
+ * \return int - 0 on success, -1 if the size is invalid // 0 em caso de sucesso, -1 se o tamanho for inválido
+ */
+    XrayImage *image = create_xray_image(width, height);
+    XrayImage *scratch = create_xray_image(width / 2, height / 2);
+    int result = -1;
+
+    if (image && scratch) {
+        generate_xray_image(image, seed);
+        result = xray_preprocess(image, scratch, features, kernels);
+    }
+
+    destroy_xray_image(scratch);
+    destroy_xray_image(image);
+    return result;
+}
+
+int xray_kernels_from_name(const char *name) {
+/**
+ * \brief Parse a kernel set name // Interpreta o nome de um conjunto de kernels
+ *
+ * \return int - XRAY_SCALAR, XRAY_SIMD or -1 // XRAY_SCALAR, XRAY_SIMD ou -1
+ */
+    if (name && strcmp(name, "scalar") == 0) {
+        return XRAY_SCALAR;
+    }
+    if (name && strcmp(name, "simd") == 0) {
+        return XRAY_SIMD;
+    }
+    return -1;
+}
@@ -0,0 +1,115 @@
+#ifndef XRAY_IMAGE_H_INCLUDED
+#define XRAY_IMAGE_H_INCLUDED
+
+#define XRAY_GRID 4                               // Features are the mean of a XRAY_GRID x XRAY_GRID grid // Características são a média de uma grade XRAY_GRID x XRAY_GRID
+#define XRAY_FEATURES (XRAY_GRID * XRAY_GRID)
+#define XRAY_DEFAULT_SIZE 512                     // Default exam resolution (square) // Resolução padrão do exame (quadrada)
+
+/**
+ * \brief 8-bit grayscale image // Imagem em tons de cinza de 8 bits
+ */
+typedef struct xray_image {
+    int width;
+    int height;
+    unsigned char *pixels;   // width * height bytes, row after row // width * height bytes, linha após linha
+} XrayImage;
+
+/**
+ * \brief Implementation used by the preprocessing kernels // Implementação usada pelos kernels de pré-processamento
+ */
+typedef enum xray_kernels {
+    XRAY_SCALAR,   // Reference implementation, one pixel at a time // Implementação de referência, um pixel por vez
+    XRAY_SIMD      // 16 pixels per vector // 16 pixels por vetor
+} XrayKernels;
+
+/**
+ * \brief Create an image with uninitialized pixels // Cria uma imagem com pixels não inicializados
+ *
+ * \param width - Width in pixels (at least 2) // Largura em pixels (pelo menos 2)
+ * \param height - Height in pixels (at least 2) // Altura em pixels (pelo menos 2)
+ * \return Pointer to the image, NULL if the size is invalid // Ponteiro para a imagem, NULL se o tamanho for inválido
+ */
+XrayImage *create_xray_image(int width, int height);
+
+/**
+ * \brief Free an image // Libera uma imagem
+ *
+ * \param image - Pointer to the image // Ponteiro para a imagem
+ */
+void destroy_xray_image(XrayImage *image);
+
+/**
+ * \brief Draw a synthetic chest X-ray: two lung fields, a spine, a vertical gradient and noise // Desenha um raio X sintético do tórax
+ *
+ * \param image - Image to fill // Imagem a ser preenchida
+ * \param seed - Same seed, same image // Mesma semente, mesma imagem
+ */
+void generate_xray_image(XrayImage *image, unsigned int seed);
+
+/**
+ * \brief 2x2 box downsampling // Redução 2x2 pela média
+ *
+ * \param source - Input image // Imagem de entrada
+ * \param target - Output image with exactly half the width and height (rounded down) // Imagem de saída com metade da largura e altura
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ * \return 0 on success, -1 if the sizes don't match // 0 em caso de sucesso, -1 se os tamanhos não combinarem
+ */
+int xray_downsample(const XrayImage *source, XrayImage *target, XrayKernels kernels);
+
+/**
+ * \brief Stretch the pixel range to the full 0..255 scale, in place // Estica a faixa de pixels para a escala 0..255, no lugar
+ *
+ * \param image - Image to normalize // Imagem a ser normalizada
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ */
+void xray_normalize(XrayImage *image, XrayKernels kernels);
+
+/**
+ * \brief Histogram equalization, in place // Equalização de histograma, no lugar
+ *
+ * \param image - Image to equalize // Imagem a ser equalizada
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ */
+void xray_equalize(XrayImage *image, XrayKernels kernels);
+
+/**
+ * \brief Mean of each grid cell, mapped to [-1, 1] // Média de cada célula da grade, mapeada para [-1, 1]
+ *
+ * \param image - Preprocessed image // Imagem pré-processada
+ * \param features - Receives XRAY_FEATURES values // Recebe XRAY_FEATURES valores
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ */
+void xray_extract_features(const XrayImage *image, float *features, XrayKernels kernels);
+
+/**
+ * \brief Whole pipeline: downsample, normalize, equalize and extract features // Pipeline completo: reduz, normaliza, equaliza e extrai características
+ *
+ * \param image - Acquired image, left unchanged // Imagem adquirida, não é alterada
+ * \param scratch - Half size image that receives the preprocessed pixels // Imagem com metade do tamanho que recebe os pixels pré-processados
+ * \param features - Receives XRAY_FEATURES values // Recebe XRAY_FEATURES valores
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ * \return 0 on success, -1 if the sizes don't match // 0 em caso de sucesso, -1 se os tamanhos não combinarem
+ */
+int xray_preprocess(const XrayImage *image, XrayImage *scratch, float *features, XrayKernels kernels);
+
+/**
+ * \brief Acquire and preprocess one exam image // Adquire e pré-processa a imagem de um exame
+ *
+ * \param width - Acquisition width // Largura da aquisição
+ * \param height - Acquisition height // Altura da aquisição
+ * \param seed - Image seed // Semente da imagem
+ * \param kernels - Scalar or SIMD // Escalar ou SIMD
+ * \param features - Receives XRAY_FEATURES values // Recebe XRAY_FEATURES valores
+ * \return 0 on success, -1 on failure // 0 em caso de sucesso, -1 em caso de falha
+ */
+int xray_exam_features(int width, int height, unsigned int seed, XrayKernels kernels, float *features);
+
+/**
+ * \brief Parse a kernel set name // Interpreta o nome de um conjunto de kernels
+ *
+ * \param name - "scalar" or "simd" // "scalar" ou "simd"
+ * \return The kernel set, or -1 if the name is unknown // O conjunto de kernels, ou -1 se o nome for desconhecido
+ */
+int xray_kernels_from_name(const char *name);
+
+#endif // XRAY_IMAGE_H_INCLUDED